@@ -0,0 +1,88 @@
+#include <arrow/api.h>
+#include <arrow/testing/random.h>
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <pefa/execution/execution.h>
+
+using namespace pefa;
+using namespace pefa::query_compiler;
+
+class AggregateBenchmarkFixture : public benchmark::Fixture {
+protected:
+  static constexpr int64_t num_rows = 10000000;
+  static constexpr int64_t chunk_size = 1 << 20;
+  std::shared_ptr<arrow::Table> m_table;
+
+public:
+  void SetUp(const ::benchmark::State &state) override {
+    // number of distinct keys is passed as benchmark argument, so hash table either fits in L1 or
+    // does not fit in caches at all
+    arrow::random::RandomArrayGenerator generator(152);
+    std::vector<std::shared_ptr<arrow::Array>> key_chunks;
+    std::vector<std::shared_ptr<arrow::Array>> value_chunks;
+    for (int64_t offset = 0; offset < num_rows; offset += chunk_size) {
+      auto length = std::min(chunk_size, num_rows - offset);
+      key_chunks.push_back(generator.Numeric<arrow::Int32Type>(
+          length, 0, static_cast<int32_t>(state.range(0) - 1)));
+      value_chunks.push_back(generator.Numeric<arrow::DoubleType>(length, -1.0, 1.0));
+    }
+    auto schema = arrow::schema(
+        {arrow::field("key", arrow::int32()), arrow::field("value", arrow::float64())});
+    m_table = arrow::Table::Make(schema, {std::make_shared<arrow::ChunkedArray>(key_chunks),
+                                          std::make_shared<arrow::ChunkedArray>(value_chunks)});
+  }
+
+  void run_aggregate(benchmark::State &state, bool filter) {
+    auto ctx = std::make_shared<execution::ExecutionContext>(m_table);
+    if (filter) {
+      ctx = execution::generate_filter_bitmap(ctx, col("value")->GT(lit(0.0)));
+    }
+    std::vector<Aggregate> aggregates{{Aggregate::Op::SUM, "value", "sum"},
+                                      {Aggregate::Op::COUNT, "value", "count"},
+                                      {Aggregate::Op::MAX, "value", "max"}};
+    for (auto _ : state) {
+      benchmark::DoNotOptimize(execution::aggregate(ctx, {"key"}, aggregates));
+    }
+    state.SetItemsProcessed(state.iterations() * num_rows);
+  }
+};
+
+BENCHMARK_DEFINE_F(AggregateBenchmarkFixture, BenchmarkAggregate)(benchmark::State &state) {
+  run_aggregate(state, false);
+}
+BENCHMARK_REGISTER_F(AggregateBenchmarkFixture, BenchmarkAggregate)
+    ->Arg(16)
+    ->Arg(1 << 12)
+    ->Arg(1 << 20);
+
+BENCHMARK_DEFINE_F(AggregateBenchmarkFixture, BenchmarkAggregateFiltered)
+(benchmark::State &state) {
+  run_aggregate(state, true);
+}
+BENCHMARK_REGISTER_F(AggregateBenchmarkFixture, BenchmarkAggregateFiltered)
+    ->Arg(16)
+    ->Arg(1 << 12)
+    ->Arg(1 << 20);
+
+// filter and aggregation without keys either as separate steps, which write and read bitmap, or
+// as a single fused reduction
+BENCHMARK_DEFINE_F(AggregateBenchmarkFixture, BenchmarkReduction)(benchmark::State &state) {
+  auto ctx = std::make_shared<execution::ExecutionContext>(m_table);
+  auto predicate = col("value")->GT(lit(0.0))->AND(col("key")->LT(lit(8)));
+  std::vector<Aggregate> aggregates{{Aggregate::Op::SUM, "value", "sum"},
+                                    {Aggregate::Op::COUNT, "", "count"},
+                                    {Aggregate::Op::MAX, "value", "max"}};
+  bool fused = state.range(1) != 0;
+  for (auto _ : state) {
+    if (fused) {
+      benchmark::DoNotOptimize(execution::aggregate(ctx, {}, aggregates, predicate));
+    } else {
+      auto filtered = execution::generate_filter_bitmap(ctx, predicate);
+      benchmark::DoNotOptimize(execution::aggregate(filtered, {}, aggregates));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * num_rows);
+}
+BENCHMARK_REGISTER_F(AggregateBenchmarkFixture, BenchmarkReduction)
+    ->Args({16, 0})
+    ->Args({16, 1});
@@ -37,3 +37,62 @@ BENCHMARK_DEFINE_F(FilterKernelBenchmarkFixture, BenchmarkFilter)
 BENCHMARK_REGISTER_F(FilterKernelBenchmarkFixture, BenchmarkFilter)
     ->RangeMultiplier(100)
     ->Range(1000, 100000000);
+
+// same filter over values in [0, 100) of every numeric type
+template <typename ArrowType>
+class TypedFilterKernelBenchmarkFixture : public benchmark::Fixture {
+protected:
+  std::unique_ptr<kernels::FilterKernel> m_filter;
+  std::shared_ptr<arrow::DataType> m_type;
+
+public:
+  void SetUp(const ::benchmark::State &state) override {
+    m_type = arrow::TypeTraits<ArrowType>::type_singleton();
+
+    auto field = std::make_shared<arrow::Field>("field", m_type);
+    auto expr = (col("field")->EQ(lit(4)))->OR(col("field")->GT(lit(15)));
+    m_filter = kernels::FilterKernel::create_cpu(field, expr);
+    m_filter->compile();
+  }
+
+  void run_filter(benchmark::State &state, double null_probability = 0) {
+    using CType = typename ArrowType::c_type;
+    arrow::random::RandomArrayGenerator generator(152);
+    auto array = generator.Numeric<ArrowType>(state.range(0), 0, 100, null_probability);
+    auto bitmap = arrow::AllocateBitmap(state.range(0)).ValueOrDie();
+    std::memset(bitmap->mutable_data(), 255, bitmap->size());
+    auto &filter = *m_filter;
+    for (auto _ : state) {
+      filter.execute(array, bitmap->mutable_data(), 0);
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0) * sizeof(CType));
+  }
+};
+
+#define PEFA_FILTER_BENCHMARK(name, arrow_type)                                                    \
+  BENCHMARK_TEMPLATE_DEFINE_F(TypedFilterKernelBenchmarkFixture, name, arrow_type)                 \
+  (benchmark::State & state) {                                                                     \
+    run_filter(state);                                                                             \
+  }                                                                                                \
+  BENCHMARK_REGISTER_F(TypedFilterKernelBenchmarkFixture, name)                                    \
+      ->RangeMultiplier(100)                                                                       \
+      ->Range(1000, 100000000);
+
+PEFA_FILTER_BENCHMARK(BenchmarkFilterInt8, arrow::Int8Type)
+PEFA_FILTER_BENCHMARK(BenchmarkFilterInt16, arrow::Int16Type)
+PEFA_FILTER_BENCHMARK(BenchmarkFilterInt32, arrow::Int32Type)
+PEFA_FILTER_BENCHMARK(BenchmarkFilterInt64, arrow::Int64Type)
+PEFA_FILTER_BENCHMARK(BenchmarkFilterFloat, arrow::FloatType)
+PEFA_FILTER_BENCHMARK(BenchmarkFilterDouble, arrow::DoubleType)
+
+#define PEFA_FILTER_NULLABLE_BENCHMARK(name, arrow_type)                                           \
+  BENCHMARK_TEMPLATE_DEFINE_F(TypedFilterKernelBenchmarkFixture, name, arrow_type)                 \
+  (benchmark::State & state) {                                                                     \
+    run_filter(state, 0.1);                                                                        \
+  }                                                                                                \
+  BENCHMARK_REGISTER_F(TypedFilterKernelBenchmarkFixture, name)                                    \
+      ->RangeMultiplier(100)                                                                       \
+      ->Range(1000, 100000000);
+
+PEFA_FILTER_NULLABLE_BENCHMARK(BenchmarkFilterNullableInt32, arrow::Int32Type)
+PEFA_FILTER_NULLABLE_BENCHMARK(BenchmarkFilterNullableDouble, arrow::DoubleType)
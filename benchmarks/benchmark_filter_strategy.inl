@@ -0,0 +1,122 @@
+#include <arrow/api.h>
+#include <arrow/testing/random.h>
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <numeric>
+#include <pefa/execution/execution.h>
+#include <string>
+#include <variant>
+#include <vector>
+
+using namespace pefa;
+using namespace pefa::query_compiler;
+
+class FilterStrategyBenchmarkFixture : public benchmark::Fixture {
+protected:
+  static constexpr int64_t num_rows = 10000000;
+  static constexpr int64_t chunk_size = 1 << 20;
+  std::shared_ptr<arrow::Table> m_table;
+
+public:
+  void SetUp(const ::benchmark::State &state) override {
+    // column "a" is sorted, so "a < x" rejects long runs of rows and decides whole words
+    arrow::random::RandomArrayGenerator generator(152);
+    std::vector<std::shared_ptr<arrow::Array>> a_chunks;
+    std::vector<std::shared_ptr<arrow::Array>> b_chunks;
+    for (int64_t offset = 0; offset < num_rows; offset += chunk_size) {
+      auto length = std::min(chunk_size, num_rows - offset);
+      auto buffer = arrow::AllocateBuffer(sizeof(int32_t) * length).ValueOrDie();
+      auto data = reinterpret_cast<int32_t *>(buffer->mutable_data());
+      std::iota(data, data + length, static_cast<int32_t>(offset));
+      a_chunks.push_back(std::make_shared<arrow::Int32Array>(
+          length, std::shared_ptr<arrow::Buffer>(std::move(buffer))));
+      b_chunks.push_back(generator.Numeric<arrow::DoubleType>(length, -1.0, 1.0));
+    }
+    auto schema = arrow::schema(
+        {arrow::field("a", arrow::int32()), arrow::field("b", arrow::float64())});
+    m_table = arrow::Table::Make(schema, {std::make_shared<arrow::ChunkedArray>(a_chunks),
+                                          std::make_shared<arrow::ChunkedArray>(b_chunks)});
+  }
+
+  void run_filter(benchmark::State &state, execution::FilterStrategy strategy) {
+    auto config = std::make_shared<execution::ExecutionConfig>();
+    config->filter_strategy = strategy;
+    // selectivity of "a < x" in percents is passed as benchmark argument
+    auto expr = col("b")->GT(lit(0.0))->AND(
+        col("a")->LT(lit(static_cast<int>(num_rows * state.range(0) / 100))));
+    auto ctx = std::make_shared<execution::ExecutionContext>(m_table, config);
+    for (auto _ : state) {
+      benchmark::DoNotOptimize(execution::generate_filter_bitmap(ctx, expr));
+    }
+    state.SetItemsProcessed(state.iterations() * num_rows);
+  }
+};
+
+BENCHMARK_DEFINE_F(FilterStrategyBenchmarkFixture, BenchmarkFusedAnd)(benchmark::State &state) {
+  run_filter(state, execution::FilterStrategy::FUSED);
+}
+BENCHMARK_REGISTER_F(FilterStrategyBenchmarkFixture, BenchmarkFusedAnd)->Arg(1)->Arg(10)->Arg(50);
+
+BENCHMARK_DEFINE_F(FilterStrategyBenchmarkFixture, BenchmarkShortCircuitAnd)
+(benchmark::State &state) {
+  run_filter(state, execution::FilterStrategy::SHORT_CIRCUIT);
+}
+BENCHMARK_REGISTER_F(FilterStrategyBenchmarkFixture, BenchmarkShortCircuitAnd)
+    ->Arg(1)
+    ->Arg(10)
+    ->Arg(50);
+
+// list of values, which are spread over column "a", with number of values passed as argument
+static std::vector<std::variant<int, double, std::string, bool>> in_list_values(int64_t count,
+                                                                               int64_t range) {
+  std::vector<std::variant<int, double, std::string, bool>> values;
+  for (int64_t i = 0; i < count; i++) {
+    values.emplace_back(static_cast<int>(i * range / count));
+  }
+  return values;
+}
+
+BENCHMARK_DEFINE_F(FilterStrategyBenchmarkFixture, BenchmarkEqualityChain)
+(benchmark::State &state) {
+  auto config = std::make_shared<execution::ExecutionConfig>();
+  config->filter_strategy = execution::FilterStrategy::SHORT_CIRCUIT;
+  std::shared_ptr<BooleanExpr> expr = BooleanConst::create(false);
+  for (auto &value : in_list_values(state.range(0), num_rows)) {
+    expr = expr->OR(col("a")->EQ(lit(value)));
+  }
+  auto ctx = std::make_shared<execution::ExecutionContext>(m_table, config);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(execution::generate_filter_bitmap(ctx, expr));
+  }
+  state.SetItemsProcessed(state.iterations() * num_rows);
+}
+BENCHMARK_REGISTER_F(FilterStrategyBenchmarkFixture, BenchmarkEqualityChain)
+    ->Arg(4)
+    ->Arg(32)
+    ->Arg(200);
+
+// the first argument is number of values, and the second one is range they are spread over, so
+// dense lists are looked up in bitset and sparse ones are binary searched
+BENCHMARK_DEFINE_F(FilterStrategyBenchmarkFixture, BenchmarkInList)(benchmark::State &state) {
+  auto expr = col("a")->IN(in_list_values(state.range(0), state.range(1)));
+  auto ctx = std::make_shared<execution::ExecutionContext>(m_table);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(execution::generate_filter_bitmap(ctx, expr));
+  }
+  state.SetItemsProcessed(state.iterations() * num_rows);
+}
+BENCHMARK_REGISTER_F(FilterStrategyBenchmarkFixture, BenchmarkInList)
+    ->Args({4, num_rows})
+    ->Args({32, 10000})
+    ->Args({200, 10000})
+    ->Args({200, num_rows});
+
+BENCHMARK_DEFINE_F(FilterStrategyBenchmarkFixture, BenchmarkBetween)(benchmark::State &state) {
+  auto expr = col("a")->BETWEEN(1000, static_cast<int>(num_rows / 2));
+  auto ctx = std::make_shared<execution::ExecutionContext>(m_table);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(execution::generate_filter_bitmap(ctx, expr));
+  }
+  state.SetItemsProcessed(state.iterations() * num_rows);
+}
+BENCHMARK_REGISTER_F(FilterStrategyBenchmarkFixture, BenchmarkBetween);
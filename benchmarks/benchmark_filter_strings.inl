@@ -0,0 +1,103 @@
+#include <arrow/api.h>
+#include <arrow/util/logging.h>
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <pefa/execution/execution.h>
+#include <pefa/io/file_scan.h>
+#include <string>
+#include <vector>
+
+using namespace pefa;
+using namespace pefa::query_compiler;
+
+// string predicates over payment_type column of taxi trips, which holds a few short values, as
+// plain utf8 column and as dictionary-encoded one
+class StringFilterBenchmarkFixture : public benchmark::Fixture {
+protected:
+  std::shared_ptr<arrow::Table> m_table;
+  std::shared_ptr<arrow::Table> m_dictionary_table;
+
+  // every chunk is encoded with its own dictionary
+  static std::shared_ptr<arrow::Table> dictionary_encode(const arrow::Table &table) {
+    std::vector<std::shared_ptr<arrow::Array>> chunks;
+    for (auto &chunk : table.column(0)->chunks()) {
+      auto &strings = static_cast<const arrow::StringArray &>(*chunk);
+      arrow::StringDictionaryBuilder builder;
+      for (int64_t i = 0; i < strings.length(); i++) {
+        ARROW_CHECK_OK(strings.IsNull(i) ? builder.AppendNull()
+                                         : builder.Append(strings.GetView(i)));
+      }
+      std::shared_ptr<arrow::Array> encoded;
+      ARROW_CHECK_OK(builder.Finish(&encoded));
+      chunks.push_back(encoded);
+    }
+    auto column = std::make_shared<arrow::ChunkedArray>(chunks);
+    return arrow::Table::Make(arrow::schema({arrow::field("payment_type", column->type())}),
+                              {column});
+  }
+
+public:
+  void SetUp(const ::benchmark::State &state) override {
+    // csv is parsed once for all benchmarks
+    static auto table = io::read_file(TEST_DATA_DIR "chicago_taxi_trips_2016_01.csv",
+                                      FileFormat::CSV, {"payment_type"});
+    static auto dictionary_table = dictionary_encode(*table);
+    m_table = table;
+    m_dictionary_table = dictionary_table;
+  }
+
+  void run_filter(benchmark::State &state, const std::shared_ptr<BooleanExpr> &expr,
+                  bool dictionary = false) {
+    auto config = std::make_shared<execution::ExecutionConfig>();
+    // zone maps are disabled, so that kernel is measured alone
+    config->use_zone_maps = false;
+    auto ctx = std::make_shared<execution::ExecutionContext>(
+        dictionary ? m_dictionary_table : m_table, config);
+    for (auto _ : state) {
+      benchmark::DoNotOptimize(execution::generate_filter_bitmap(ctx, expr));
+    }
+    state.SetItemsProcessed(state.iterations() * m_table->num_rows());
+  }
+};
+
+BENCHMARK_DEFINE_F(StringFilterBenchmarkFixture, BenchmarkStringEquals)
+(benchmark::State &state) {
+  run_filter(state, col("payment_type")->EQ(lit(std::string("Cash"))));
+}
+BENCHMARK_REGISTER_F(StringFilterBenchmarkFixture, BenchmarkStringEquals);
+
+BENCHMARK_DEFINE_F(StringFilterBenchmarkFixture, BenchmarkStringLess)
+(benchmark::State &state) {
+  run_filter(state, col("payment_type")->LT(lit(std::string("Credit"))));
+}
+BENCHMARK_REGISTER_F(StringFilterBenchmarkFixture, BenchmarkStringLess);
+
+BENCHMARK_DEFINE_F(StringFilterBenchmarkFixture, BenchmarkStringPrefix)
+(benchmark::State &state) {
+  run_filter(state, col("payment_type")->STARTS_WITH("Cred"));
+}
+BENCHMARK_REGISTER_F(StringFilterBenchmarkFixture, BenchmarkStringPrefix);
+
+BENCHMARK_DEFINE_F(StringFilterBenchmarkFixture, BenchmarkStringLikeSuffix)
+(benchmark::State &state) {
+  run_filter(state, col("payment_type")->LIKE("%Card"));
+}
+BENCHMARK_REGISTER_F(StringFilterBenchmarkFixture, BenchmarkStringLikeSuffix);
+
+BENCHMARK_DEFINE_F(StringFilterBenchmarkFixture, BenchmarkStringLikeGeneral)
+(benchmark::State &state) {
+  run_filter(state, col("payment_type")->LIKE("C%d"));
+}
+BENCHMARK_REGISTER_F(StringFilterBenchmarkFixture, BenchmarkStringLikeGeneral);
+
+BENCHMARK_DEFINE_F(StringFilterBenchmarkFixture, BenchmarkDictionaryEquals)
+(benchmark::State &state) {
+  run_filter(state, col("payment_type")->EQ(lit(std::string("Cash"))), true);
+}
+BENCHMARK_REGISTER_F(StringFilterBenchmarkFixture, BenchmarkDictionaryEquals);
+
+BENCHMARK_DEFINE_F(StringFilterBenchmarkFixture, BenchmarkDictionaryLikeGeneral)
+(benchmark::State &state) {
+  run_filter(state, col("payment_type")->LIKE("C%d"), true);
+}
+BENCHMARK_REGISTER_F(StringFilterBenchmarkFixture, BenchmarkDictionaryLikeGeneral);
@@ -0,0 +1,89 @@
+#include <arrow/api.h>
+#include <arrow/io/api.h>
+#include <arrow/ipc/api.h>
+#include <arrow/testing/random.h>
+#include <arrow/util/logging.h>
+#include <benchmark/benchmark.h>
+#include <fcntl.h>
+#include <filesystem>
+#include <memory>
+#include <pefa/io/ipc_source.h>
+#include <pefa/query_compiler/query_compiler.h>
+#include <unistd.h>
+
+using namespace pefa;
+using namespace pefa::query_compiler;
+
+class IpcSourceBenchmarkFixture : public benchmark::Fixture {
+protected:
+  static constexpr int64_t num_rows = 10000000;
+  static constexpr int64_t batch_size = 1 << 20;
+  std::string m_path;
+
+public:
+  void SetUp(const ::benchmark::State &state) override {
+    // only "a" and "b" are referenced by query, "c" and "d" should never be read
+    arrow::random::RandomArrayGenerator generator(152);
+    auto schema = arrow::schema({arrow::field("a", arrow::int32()),
+                                 arrow::field("b", arrow::float64()),
+                                 arrow::field("c", arrow::int64()),
+                                 arrow::field("d", arrow::float64())});
+    m_path = (std::filesystem::temp_directory_path() / "pefa_ipc_source_benchmark.arrow").string();
+    auto sink = arrow::io::FileOutputStream::Open(m_path).ValueOrDie();
+    auto writer = arrow::ipc::RecordBatchFileWriter::Open(sink.get(), schema).ValueOrDie();
+    for (int64_t offset = 0; offset < num_rows; offset += batch_size) {
+      auto length = std::min(batch_size, num_rows - offset);
+      auto batch = arrow::RecordBatch::Make(
+          schema, length,
+          {generator.Numeric<arrow::Int32Type>(length, 0, 100),
+           generator.Numeric<arrow::DoubleType>(length, -1.0, 1.0),
+           generator.Numeric<arrow::Int64Type>(length, 0, 100),
+           generator.Numeric<arrow::DoubleType>(length, -1.0, 1.0)});
+      ARROW_CHECK_OK(writer->WriteRecordBatch(*batch));
+    }
+    ARROW_CHECK_OK(writer->Close());
+    ARROW_CHECK_OK(sink->Close());
+  }
+
+  void TearDown(const ::benchmark::State &state) override {
+    std::filesystem::remove(m_path);
+  }
+
+  // asks kernel to drop cached pages of the file, so the next scan reads them from disk
+  void drop_page_cache() {
+    auto fd = open(m_path.c_str(), O_RDONLY);
+    fdatasync(fd);
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    close(fd);
+  }
+
+  void run_scan(benchmark::State &state, bool cold) {
+    auto query = QueryCompiler().project({"a", "b"}).filter(
+        col("a")->LT(lit(10))->AND(col("b")->GT(lit(0.0))));
+    for (auto _ : state) {
+      if (cold) {
+        state.PauseTiming();
+        drop_page_cache();
+        state.ResumeTiming();
+      }
+      auto reader = query.execute(io::IpcFileSource::open(m_path, query.input_columns()));
+      std::shared_ptr<arrow::RecordBatch> batch;
+      int64_t rows = 0;
+      while (reader->ReadNext(&batch).ok() && batch) {
+        rows += batch->num_rows();
+      }
+      benchmark::DoNotOptimize(rows);
+    }
+    state.SetBytesProcessed(state.iterations() * num_rows * (sizeof(int32_t) + sizeof(double)));
+  }
+};
+
+BENCHMARK_DEFINE_F(IpcSourceBenchmarkFixture, BenchmarkIpcScanWarm)(benchmark::State &state) {
+  run_scan(state, false);
+}
+BENCHMARK_REGISTER_F(IpcSourceBenchmarkFixture, BenchmarkIpcScanWarm);
+
+BENCHMARK_DEFINE_F(IpcSourceBenchmarkFixture, BenchmarkIpcScanCold)(benchmark::State &state) {
+  run_scan(state, true);
+}
+BENCHMARK_REGISTER_F(IpcSourceBenchmarkFixture, BenchmarkIpcScanCold);
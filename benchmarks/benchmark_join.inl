@@ -0,0 +1,85 @@
+#include <arrow/api.h>
+#include <arrow/testing/random.h>
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <pefa/execution/execution.h>
+#include <pefa/query_compiler/query_compiler.h>
+
+using namespace pefa;
+using namespace pefa::query_compiler;
+
+class JoinBenchmarkFixture : public benchmark::Fixture {
+protected:
+  static constexpr int64_t num_rows = 10000000;
+  static constexpr int64_t chunk_size = 1 << 20;
+  std::shared_ptr<arrow::Table> m_left;
+  std::shared_ptr<arrow::Table> m_right;
+
+public:
+  void SetUp(const ::benchmark::State &state) override {
+    // number of rows of build side is passed as benchmark argument, every probe key matches at
+    // most one of them
+    auto build_rows = state.range(0);
+    arrow::random::RandomArrayGenerator generator(152);
+    std::vector<std::shared_ptr<arrow::Array>> key_chunks;
+    std::vector<std::shared_ptr<arrow::Array>> value_chunks;
+    for (int64_t offset = 0; offset < num_rows; offset += chunk_size) {
+      auto length = std::min(chunk_size, num_rows - offset);
+      key_chunks.push_back(generator.Numeric<arrow::Int64Type>(length, 0, build_rows * 2));
+      value_chunks.push_back(generator.Numeric<arrow::DoubleType>(length, -1.0, 1.0));
+    }
+    auto left_schema = arrow::schema(
+        {arrow::field("key", arrow::int64()), arrow::field("value", arrow::float64())});
+    m_left = arrow::Table::Make(
+        left_schema, {std::make_shared<arrow::ChunkedArray>(key_chunks),
+                      std::make_shared<arrow::ChunkedArray>(value_chunks)});
+
+    arrow::Int64Builder key_builder;
+    for (int64_t i = 0; i < build_rows; i++) {
+      (void)key_builder.Append(i * 2);
+    }
+    std::shared_ptr<arrow::Array> keys;
+    (void)key_builder.Finish(&keys);
+    auto right_schema = arrow::schema(
+        {arrow::field("key", arrow::int64()), arrow::field("payload", arrow::int32())});
+    m_right = arrow::Table::Make(right_schema,
+                                 {keys, generator.Numeric<arrow::Int32Type>(build_rows, 0, 1000)});
+  }
+
+  void run_join(benchmark::State &state, JoinType type) {
+    auto left = execution::generate_filter_bitmap(
+        std::make_shared<execution::ExecutionContext>(m_left), col("value")->GT(lit(0.0)));
+    auto right = std::make_shared<execution::ExecutionContext>(m_right);
+    for (auto _ : state) {
+      benchmark::DoNotOptimize(execution::join(left, right, "key", "key", type));
+    }
+    state.SetItemsProcessed(state.iterations() * num_rows);
+  }
+};
+
+BENCHMARK_DEFINE_F(JoinBenchmarkFixture, BenchmarkInnerJoin)(benchmark::State &state) {
+  run_join(state, JoinType::INNER);
+}
+BENCHMARK_REGISTER_F(JoinBenchmarkFixture, BenchmarkInnerJoin)->Arg(1 << 10)->Arg(1 << 20);
+
+BENCHMARK_DEFINE_F(JoinBenchmarkFixture, BenchmarkSemiJoin)(benchmark::State &state) {
+  run_join(state, JoinType::SEMI);
+}
+BENCHMARK_REGISTER_F(JoinBenchmarkFixture, BenchmarkSemiJoin)->Arg(1 << 10)->Arg(1 << 20);
+
+// right side keeps about 1% of its rows, so most of probe rows are rejected by runtime filter
+BENCHMARK_DEFINE_F(JoinBenchmarkFixture, BenchmarkSelectiveJoin)(benchmark::State &state) {
+  auto config = std::make_shared<execution::ExecutionConfig>();
+  config->use_runtime_filters = state.range(1) != 0;
+  auto query = QueryCompiler()
+                   .filter(col("value")->GT(lit(0.0)))
+                   .join(QueryCompiler().filter(col("payload")->LT(lit(10))), m_right, "key",
+                         "key", JoinType::SEMI);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(query.execute(m_left, config));
+  }
+  state.SetItemsProcessed(state.iterations() * num_rows);
+}
+BENCHMARK_REGISTER_F(JoinBenchmarkFixture, BenchmarkSelectiveJoin)
+    ->Args({1 << 20, 0})
+    ->Args({1 << 20, 1});
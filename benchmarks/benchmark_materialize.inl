@@ -0,0 +1,64 @@
+#include <arrow/api.h>
+#include <arrow/testing/random.h>
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <pefa/execution/execution.h>
+#include <random>
+
+using namespace pefa;
+
+template <typename ArrowType>
+class MaterializeBenchmarkFixture : public benchmark::Fixture {
+protected:
+  static constexpr int64_t num_rows = 10000000;
+  std::shared_ptr<arrow::Table> m_table;
+
+public:
+  void SetUp(const ::benchmark::State &state) override {
+    arrow::random::RandomArrayGenerator generator(152);
+    auto type = arrow::TypeTraits<ArrowType>::type_singleton();
+    auto schema = arrow::schema({arrow::field("a", type)});
+    m_table = arrow::Table::Make(schema, {std::make_shared<arrow::ChunkedArray>(
+                                             generator.Numeric<ArrowType>(num_rows, 0, 100))});
+  }
+
+  void run_materialize(benchmark::State &state) {
+    using CType = typename ArrowType::c_type;
+    // percent of selected rows is passed as benchmark argument
+    auto bitmap = arrow::AllocateBitmap(num_rows).ValueOrDie();
+    std::mt19937 random(42);
+    std::bernoulli_distribution selected(state.range(0) / 100.0);
+    for (int64_t byte = 0; byte < bitmap->size(); byte++) {
+      uint8_t value = 0;
+      for (int bit = 0; bit < 8; bit++) {
+        value |= selected(random) << bit;
+      }
+      bitmap->mutable_data()[byte] = value;
+    }
+    auto ctx = std::make_shared<execution::ExecutionContext>(m_table);
+    ctx->metadata->filter_bitmap = bitmap;
+    for (auto _ : state) {
+      benchmark::DoNotOptimize(execution::materialize_filter(ctx));
+    }
+    state.SetBytesProcessed(state.iterations() * num_rows * sizeof(CType));
+  }
+};
+
+#define PEFA_MATERIALIZE_BENCHMARK(name, arrow_type)                                               \
+  BENCHMARK_TEMPLATE_DEFINE_F(MaterializeBenchmarkFixture, name, arrow_type)                       \
+  (benchmark::State & state) {                                                                     \
+    run_materialize(state);                                                                        \
+  }                                                                                                \
+  BENCHMARK_REGISTER_F(MaterializeBenchmarkFixture, name)                                          \
+      ->Arg(0)                                                                                     \
+      ->Arg(1)                                                                                     \
+      ->Arg(10)                                                                                    \
+      ->Arg(50)                                                                                    \
+      ->Arg(90)                                                                                    \
+      ->Arg(100);
+
+PEFA_MATERIALIZE_BENCHMARK(BenchmarkMaterializeInt8, arrow::Int8Type)
+PEFA_MATERIALIZE_BENCHMARK(BenchmarkMaterializeInt16, arrow::Int16Type)
+PEFA_MATERIALIZE_BENCHMARK(BenchmarkMaterializeInt32, arrow::Int32Type)
+PEFA_MATERIALIZE_BENCHMARK(BenchmarkMaterializeInt64, arrow::Int64Type)
+PEFA_MATERIALIZE_BENCHMARK(BenchmarkMaterializeDouble, arrow::DoubleType)
@@ -0,0 +1,45 @@
+#include <arrow/api.h>
+#include <arrow/testing/random.h>
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <pefa/execution/execution.h>
+
+using namespace pefa;
+using namespace pefa::query_compiler;
+
+class ProjectionBenchmarkFixture : public benchmark::Fixture {
+protected:
+  static constexpr int64_t num_rows = 10000000;
+  static constexpr int64_t chunk_size = 1 << 20;
+  std::shared_ptr<execution::ExecutionContext> m_ctx;
+
+public:
+  void SetUp(const ::benchmark::State &state) override {
+    arrow::random::RandomArrayGenerator generator(153);
+    std::vector<std::shared_ptr<arrow::Array>> a_chunks;
+    std::vector<std::shared_ptr<arrow::Array>> b_chunks;
+    for (int64_t offset = 0; offset < num_rows; offset += chunk_size) {
+      auto length = std::min(chunk_size, num_rows - offset);
+      a_chunks.push_back(generator.Numeric<arrow::Int32Type>(length, -1000000, 1000000, 0.01));
+      b_chunks.push_back(generator.Numeric<arrow::DoubleType>(length, -1000.0, 1000.0));
+    }
+    auto schema =
+        arrow::schema({arrow::field("a", arrow::int32()), arrow::field("b", arrow::float64())});
+    m_ctx = std::make_shared<execution::ExecutionContext>(
+        arrow::Table::Make(schema, {std::make_shared<arrow::ChunkedArray>(a_chunks),
+                                    std::make_shared<arrow::ChunkedArray>(b_chunks)}));
+  }
+};
+
+// SELECT a * 1.1 AS x, CAST(b AS int32) AS y, a + b * 2 AS z
+BENCHMARK_DEFINE_F(ProjectionBenchmarkFixture, BenchmarkComputedColumns)
+(benchmark::State &state) {
+  std::vector<Projection> projections{{col("a")->MUL(lit(1.1)), "x"},
+                                      {col("b")->CAST(arrow::int32()), "y"},
+                                      {col("a")->ADD(col("b")->MUL(lit(2))), "z"}};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(execution::select(m_ctx, projections));
+  }
+  state.SetItemsProcessed(state.iterations() * num_rows);
+}
+BENCHMARK_REGISTER_F(ProjectionBenchmarkFixture, BenchmarkComputedColumns);
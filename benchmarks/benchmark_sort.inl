@@ -0,0 +1,43 @@
+#include <arrow/api.h>
+#include <arrow/testing/random.h>
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <pefa/execution/execution.h>
+
+using namespace pefa;
+using namespace pefa::query_compiler;
+
+class SortBenchmarkFixture : public benchmark::Fixture {
+protected:
+  static constexpr int64_t num_rows = 10000000;
+  static constexpr int64_t chunk_size = 1 << 20;
+  std::shared_ptr<execution::ExecutionContext> m_ctx;
+
+public:
+  void SetUp(const ::benchmark::State &state) override {
+    arrow::random::RandomArrayGenerator generator(153);
+    std::vector<std::shared_ptr<arrow::Array>> key_chunks;
+    std::vector<std::shared_ptr<arrow::Array>> value_chunks;
+    for (int64_t offset = 0; offset < num_rows; offset += chunk_size) {
+      auto length = std::min(chunk_size, num_rows - offset);
+      key_chunks.push_back(generator.Numeric<arrow::Int64Type>(length, -1000000000, 1000000000));
+      value_chunks.push_back(generator.Numeric<arrow::DoubleType>(length, -1.0, 1.0));
+    }
+    auto schema = arrow::schema(
+        {arrow::field("key", arrow::int64()), arrow::field("value", arrow::float64())});
+    auto table =
+        arrow::Table::Make(schema, {std::make_shared<arrow::ChunkedArray>(key_chunks),
+                                    std::make_shared<arrow::ChunkedArray>(value_chunks)});
+    m_ctx = execution::generate_filter_bitmap(
+        std::make_shared<execution::ExecutionContext>(table), col("value")->GT(lit(0.0)));
+  }
+};
+
+// limit is passed as benchmark argument, negative limit sorts all rows
+BENCHMARK_DEFINE_F(SortBenchmarkFixture, BenchmarkSort)(benchmark::State &state) {
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(execution::sort(m_ctx, "key", true, state.range(0)));
+  }
+  state.SetItemsProcessed(state.iterations() * num_rows);
+}
+BENCHMARK_REGISTER_F(SortBenchmarkFixture, BenchmarkSort)->Arg(100)->Arg(10000)->Arg(-1);
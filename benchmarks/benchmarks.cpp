@@ -1,3 +1,11 @@
+#include "benchmark_aggregate.inl"
 #include "benchmark_filter_kernel.inl"
+#include "benchmark_filter_strategy.inl"
+#include "benchmark_filter_strings.inl"
+#include "benchmark_ipc_source.inl"
+#include "benchmark_join.inl"
+#include "benchmark_materialize.inl"
+#include "benchmark_projection.inl"
+#include "benchmark_sort.inl"
 
 BENCHMARK_MAIN();
@@ -0,0 +1,386 @@
+#include "execution.h"
+#include "execution_context.h"
+#include "hash_table.h"
+#include "pefa/kernels/aggregate.h"
+#include "pefa/kernels/kernel_cache.h"
+#include "pefa/kernels/reduction.h"
+#include "row_selection.h"
+#include "table_segments.h"
+#include "thread_pool.h"
+#include "zone_maps.h"
+
+#include <algorithm>
+#include <arrow/api.h>
+#include <arrow/util/bit_util.h>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <pefa/utils/exceptions.h>
+#include <type_traits>
+#include <utility>
+
+namespace pefa::execution {
+namespace {
+// Keys are stored as 64-bit words, so equal values give equal words. Floating point zeros of both
+// signs and all NaNs are considered equal, like in SQL GROUP BY
+template <typename T>
+uint64_t to_key_word(T value) {
+  if constexpr (std::is_floating_point_v<T>) {
+    double normalized = value == 0 ? 0.0 : value;
+    if (std::isnan(normalized)) {
+      normalized = std::numeric_limits<double>::quiet_NaN();
+    }
+    uint64_t word;
+    std::memcpy(&word, &normalized, sizeof(word));
+    return word;
+  } else if constexpr (std::is_signed_v<T>) {
+    return static_cast<uint64_t>(static_cast<int64_t>(value));
+  } else {
+    return static_cast<uint64_t>(value);
+  }
+}
+
+template <typename T>
+T from_key_word(uint64_t word) {
+  if constexpr (std::is_floating_point_v<T>) {
+    double value;
+    std::memcpy(&value, &word, sizeof(value));
+    return static_cast<T>(value);
+  } else {
+    return static_cast<T>(word);
+  }
+}
+
+// Writes key word of column for every row to keys[r * width + index], where r is position of
+// row in rows. Null values are written as zero words with bit index set in the last word of key
+template <typename T>
+void fill_key_words(const arrow::Array &chunk, const std::vector<int64_t> &rows, size_t index,
+                    size_t width, uint64_t *keys) {
+  auto values = chunk.data()->GetValues<T>(1);
+  bool has_nulls = chunk.null_count() != 0;
+  for (size_t r = 0; r < rows.size(); r++) {
+    auto key = keys + r * width;
+    if (has_nulls && chunk.IsNull(rows[r])) {
+      key[index] = 0;
+      key[width - 1] |= uint64_t{1} << index;
+    } else {
+      key[index] = to_key_word(values[rows[r]]);
+    }
+  }
+}
+
+struct AggregateState {
+  Aggregate::Op op;
+  // position of input column or -1 for COUNT of rows, which has no kernel
+  int column;
+  std::shared_ptr<kernels::AggregateKernel> kernel;
+  std::shared_ptr<arrow::DataType> accumulator_type;
+  // accumulators and counts of values of every group
+  std::vector<uint8_t> accumulators;
+  std::vector<int64_t> counts;
+
+  void resize(size_t num_groups) {
+    auto width = static_cast<const arrow::FixedWidthType &>(*accumulator_type).bit_width() / 8;
+    accumulators.resize(num_groups * width);
+    counts.resize(num_groups);
+  }
+};
+
+// array of type with value(i) at position i, which is null if valid(i) is false
+template <typename T, typename ValueFn, typename ValidFn>
+std::shared_ptr<arrow::Array> make_array(const std::shared_ptr<arrow::DataType> &type,
+                                         int64_t length, ValueFn value, ValidFn valid) {
+  auto buffer = arrow::AllocateBuffer(sizeof(T) * length).ValueOrDie();
+  auto values = reinterpret_cast<T *>(buffer->mutable_data());
+  auto validity = arrow::AllocateBitmap(length).ValueOrDie();
+  int64_t null_count = 0;
+  for (int64_t i = 0; i < length; i++) {
+    bool is_valid = valid(i);
+    values[i] = value(i);
+    arrow::BitUtil::SetBitTo(validity->mutable_data(), i, is_valid);
+    null_count += !is_valid;
+  }
+  return arrow::MakeArray(arrow::ArrayData::Make(
+      type, length,
+      {null_count != 0 ? std::move(validity) : nullptr,
+       std::shared_ptr<arrow::Buffer>(std::move(buffer))},
+      null_count));
+}
+
+template <typename Acc>
+std::shared_ptr<arrow::Array> finalize(const AggregateState &state, int64_t num_groups) {
+  auto acc = reinterpret_cast<const Acc *>(state.accumulators.data());
+  auto &counts = state.counts;
+  // aggregates of groups without values are null, except for COUNT
+  auto has_values = [&](int64_t group) { return counts[group] != 0; };
+  switch (state.op) {
+  case Aggregate::Op::COUNT:
+    return make_array<int64_t>(
+        arrow::int64(), num_groups, [&](int64_t group) { return counts[group]; },
+        [](int64_t group) { return true; });
+  case Aggregate::Op::AVG:
+    return make_array<double>(
+        arrow::float64(), num_groups,
+        [&](int64_t group) {
+          return has_values(group) ? static_cast<double>(acc[group]) / counts[group] : 0;
+        },
+        has_values);
+  default:
+    return make_array<Acc>(
+        state.accumulator_type, num_groups,
+        [&](int64_t group) { return has_values(group) ? acc[group] : Acc{}; }, has_values);
+  }
+}
+
+// appends finalized aggregates of every group and their fields to result
+void finalize_all(const std::vector<Aggregate> &aggregates, std::vector<AggregateState> &states,
+                  int64_t num_groups, std::vector<std::shared_ptr<arrow::Field>> &fields,
+                  std::vector<std::shared_ptr<arrow::Array>> &result) {
+  for (size_t i = 0; i < states.size(); i++) {
+    auto &state = states[i];
+    state.resize(num_groups);
+    result.push_back(visit_numeric_type(*state.accumulator_type, [&](auto tag) {
+      return finalize<decltype(tag)>(state, num_groups);
+    }));
+    fields.push_back(arrow::field(aggregates[i].name, result.back()->type()));
+  }
+}
+
+// reduction kernel reads values of fixed width columns only, so predicates over other columns,
+// including dictionary ones, produce bitmap by filter kernel first
+bool references_fixed_width_only(const arrow::Schema &schema, const BooleanExpr &predicate) {
+  std::vector<std::string> names;
+  referenced_columns(predicate, names);
+  return std::all_of(names.begin(), names.end(), [&](const std::string &name) {
+    auto field = schema.GetFieldByName(name);
+    return !field || (field->type()->id() != arrow::Type::DICTIONARY &&
+                      dynamic_cast<const arrow::FixedWidthType *>(field->type().get()));
+  });
+}
+
+// pieces of segments are small enough to give every thread some work even for a single segment
+constexpr int64_t reduction_piece_length = 1 << 16;
+
+// Aggregation without keys of rows, where predicate is true. Segments are sliced into pieces,
+// which are reduced in parallel into their own states, and partial states are merged at the end
+std::shared_ptr<ExecutionContext> reduce(const std::shared_ptr<ExecutionContext> &ctx,
+                                         const std::vector<Aggregate> &aggregates,
+                                         const std::shared_ptr<BooleanExpr> &predicate) {
+  auto &table = *ctx->table;
+  std::vector<std::string> names;
+  referenced_columns(*predicate, names);
+  for (auto &aggregate : aggregates) {
+    if (!aggregate.column.empty() &&
+        std::find(names.begin(), names.end(), aggregate.column) == names.end()) {
+      names.push_back(aggregate.column);
+    }
+  }
+  // kernel needs some input to know number of rows
+  if (names.empty()) {
+    names.push_back(table.schema()->field(0)->name());
+  }
+
+  std::vector<std::shared_ptr<const arrow::Field>> fields;
+  std::vector<std::shared_ptr<arrow::ChunkedArray>> columns;
+  std::vector<std::shared_ptr<ColumnMetadata>> columns_metadata;
+  for (auto &name : names) {
+    auto index = table.schema()->GetFieldIndex(name);
+    if (index < 0) {
+      throw ColumnNotFoundException(name);
+    }
+    fields.push_back(table.schema()->field(index));
+    columns.push_back(table.column(index));
+    columns_metadata.push_back(ctx->metadata->columns[index]);
+  }
+  auto kernel = kernels::get_kernel_cache()->get_reduction_kernel(fields, predicate, aggregates);
+  auto segments = split_into_segments(columns);
+  struct Piece {
+    size_t segment;
+    int64_t offset;
+    int64_t length;
+  };
+  std::vector<Piece> pieces;
+  for (size_t i = 0; i < segments.size(); i++) {
+    for (int64_t offset = 0; offset < segments[i].length; offset += reduction_piece_length) {
+      pieces.push_back({i, offset, std::min(reduction_piece_length, segments[i].length - offset)});
+    }
+  }
+
+  auto state_size = kernel->state_size();
+  std::vector<int64_t> states(std::max<size_t>(pieces.size(), 1) * state_size);
+  tf::Taskflow taskflow;
+  taskflow.parallel_for(0, static_cast<int>(pieces.size()), 1, [&](int piece_num) {
+    auto &piece = pieces[piece_num];
+    auto &segment = segments[piece.segment];
+    auto state = states.data() + piece_num * state_size;
+    kernel->init(state);
+    if (ctx->config->use_zone_maps) {
+      std::vector<const ChunkMetadata *> chunks;
+      for (size_t i = 0; i < columns.size(); i++) {
+        auto &chunk_metadata = *columns_metadata[i]->chunks[segment.chunks[i]];
+        chunk_metadata.ensure_computed(*columns[i]->chunk(segment.chunks[i]));
+        chunks.push_back(&chunk_metadata);
+      }
+      if (evaluate_zone_maps(*predicate, fields, chunks) == ZoneMapResult::NONE) {
+        return;
+      }
+    }
+    std::vector<std::shared_ptr<const arrow::Array>> slices;
+    for (auto &column : segment.columns) {
+      slices.push_back(column->Slice(piece.offset, piece.length));
+    }
+    kernel->execute(slices, state);
+  });
+  get_executor().run(taskflow).wait();
+  if (pieces.empty()) {
+    kernel->init(states.data());
+  }
+  for (size_t i = 1; i < pieces.size(); i++) {
+    kernel->merge(states.data(), states.data() + i * state_size);
+  }
+
+  std::vector<AggregateState> aggregate_states;
+  for (size_t j = 0; j < aggregates.size(); j++) {
+    auto type = aggregates[j].column.empty()
+                    ? arrow::int64()
+                    : table.schema()->GetFieldByName(aggregates[j].column)->type();
+    AggregateState state{aggregates[j].op, -1, nullptr,
+                         kernels::AggregateKernel::accumulator_type(type, aggregates[j].op)};
+    state.resize(1);
+    // accumulator is stored at the beginning of its word
+    std::memcpy(state.accumulators.data(), states.data() + 2 * j, state.accumulators.size());
+    state.counts[0] = states[2 * j + 1];
+    aggregate_states.push_back(std::move(state));
+  }
+  std::vector<std::shared_ptr<arrow::Field>> result_fields;
+  std::vector<std::shared_ptr<arrow::Array>> result;
+  finalize_all(aggregates, aggregate_states, 1, result_fields, result);
+  return std::make_shared<ExecutionContext>(
+      arrow::Table::Make(arrow::schema(result_fields), result, 1), ctx->config);
+}
+} // namespace
+
+std::shared_ptr<ExecutionContext> aggregate(const std::shared_ptr<ExecutionContext> &ctx,
+                                            const std::vector<std::string> &keys,
+                                            const std::vector<Aggregate> &aggregates,
+                                            const std::shared_ptr<BooleanExpr> &predicate) {
+  auto &metadata = *ctx->metadata;
+  if (predicate && !references_fixed_width_only(*ctx->table->schema(), *predicate)) {
+    return aggregate(generate_filter_bitmap(ctx, predicate), keys, aggregates);
+  }
+  if (keys.empty() && !metadata.filter_bitmap && !metadata.selection_vector) {
+    if (aggregates.empty()) {
+      throw NotImplementedException("Aggregation without keys and aggregates is not supported");
+    }
+    return reduce(ctx, aggregates, predicate ? predicate : BooleanConst::create(true));
+  }
+  if (predicate) {
+    return aggregate(generate_filter_bitmap(ctx, predicate), keys, aggregates);
+  }
+
+  auto &table = *ctx->table;
+  auto column = [&](const std::string &name) {
+    auto index = table.schema()->GetFieldIndex(name);
+    if (index < 0) {
+      throw ColumnNotFoundException(name);
+    }
+    return table.column(index);
+  };
+  // keys are followed by inputs of aggregates, so they are split into segments together
+  std::vector<std::shared_ptr<arrow::ChunkedArray>> columns;
+  for (auto &key : keys) {
+    columns.push_back(column(key));
+  }
+  std::vector<AggregateState> states;
+  for (auto &aggregate : aggregates) {
+    if (aggregate.column.empty()) {
+      states.push_back({aggregate.op, -1, nullptr, arrow::int64()});
+      continue;
+    }
+    auto index = static_cast<int>(columns.size());
+    columns.push_back(column(aggregate.column));
+    auto type = columns.back()->type();
+    auto kernel = kernels::get_kernel_cache()->get_aggregate_kernel(type, aggregate.op);
+    states.push_back({aggregate.op, index, kernel,
+                      kernels::AggregateKernel::accumulator_type(type, aggregate.op)});
+  }
+  if (columns.empty()) {
+    if (aggregates.empty()) {
+      throw NotImplementedException("Aggregation without keys and aggregates is not supported");
+    }
+    // only rows are counted, but segments still need some column
+    columns.push_back(table.column(0));
+  }
+  // nulls of keys are marked by bits of an additional word
+  if (keys.size() > 64) {
+    throw NotImplementedException("Aggregation by more than 64 keys is not supported");
+  }
+  auto width = keys.empty() ? 0 : keys.size() + 1;
+  GroupHashTable groups(width);
+  std::vector<uint64_t> key_words;
+  if (keys.empty()) {
+    // without keys every row belongs to the single group, which exists even for empty input
+    key_words.assign(1, 0);
+    (void)groups.find_or_insert(key_words.data(), 0);
+  }
+
+  // segments are processed one by one, as they share hash table, but only selected rows of every
+  // segment are hashed and aggregated
+  std::vector<int64_t> rows;
+  std::vector<int32_t> group_ids;
+  for (auto &segment : split_into_segments(columns)) {
+    selected_rows(metadata, segment.offset, segment.length, rows);
+    if (rows.empty()) {
+      continue;
+    }
+    group_ids.assign(segment.length, -1);
+    if (keys.empty()) {
+      for (auto row : rows) {
+        group_ids[row] = 0;
+      }
+    } else {
+      key_words.assign(rows.size() * width, 0);
+      for (size_t k = 0; k < keys.size(); k++) {
+        auto &chunk = *segment.columns[k];
+        visit_numeric_type(*chunk.type(), [&](auto tag) {
+          fill_key_words<decltype(tag)>(chunk, rows, k, width, key_words.data());
+        });
+      }
+      for (size_t r = 0; r < rows.size(); r++) {
+        auto key = key_words.data() + r * width;
+        group_ids[rows[r]] = groups.find_or_insert(key, GroupHashTable::hash(key, width));
+      }
+    }
+    for (auto &state : states) {
+      state.resize(groups.size());
+      if (state.column < 0) {
+        for (auto row : rows) {
+          state.counts[group_ids[row]]++;
+        }
+      } else {
+        state.kernel->execute(*segment.columns[state.column], group_ids.data(),
+                              state.accumulators.data(), state.counts.data());
+      }
+    }
+  }
+
+  auto num_groups = static_cast<int64_t>(groups.size());
+  std::vector<std::shared_ptr<arrow::Field>> fields;
+  std::vector<std::shared_ptr<arrow::Array>> result;
+  for (size_t k = 0; k < keys.size(); k++) {
+    auto &type = columns[k]->type();
+    fields.push_back(arrow::field(keys[k], type));
+    result.push_back(visit_numeric_type(*type, [&](auto tag) {
+      using T = decltype(tag);
+      return make_array<T>(
+          type, num_groups,
+          [&](int64_t group) { return from_key_word<T>(groups.key(group)[k]); },
+          [&](int64_t group) { return ((groups.key(group)[width - 1] >> k) & 1) == 0; });
+    }));
+  }
+  finalize_all(aggregates, states, num_groups, fields, result);
+  return std::make_shared<ExecutionContext>(
+      arrow::Table::Make(arrow::schema(fields), result, num_groups), ctx->config);
+}
+} // namespace pefa::execution
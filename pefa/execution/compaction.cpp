@@ -0,0 +1,111 @@
+#include "compaction.h"
+
+#include <arrow/util/bit_util.h>
+
+namespace pefa::execution {
+int64_t count_selected(const uint8_t *bitmap, int64_t offset, int64_t length) {
+  int64_t count = 0;
+  int64_t i = 0;
+  for (; i < length && (offset + i) % 8 != 0; i++) {
+    count += is_selected(bitmap, offset + i);
+  }
+  auto bytes = bitmap + (offset + i) / 8;
+  for (; i + 64 <= length; i += 64, bytes += 8) {
+    uint64_t word;
+    std::memcpy(&word, bytes, sizeof(word));
+    count += arrow::BitUtil::PopCount(word);
+  }
+  for (; i + 8 <= length; i += 8, bytes++) {
+    count += selection_table.counts[*bytes];
+  }
+  for (; i < length; i++) {
+    count += is_selected(bitmap, offset + i);
+  }
+  return count;
+}
+
+int64_t find_first_selected(const uint8_t *bitmap, int64_t offset, int64_t length) {
+  auto end = offset + length;
+  auto row = offset;
+  for (; row < end && row % 8 != 0; row++) {
+    if (is_selected(bitmap, row)) {
+      return row;
+    }
+  }
+  // whole zero words are skipped at once
+  for (; row + 64 <= end; row += 64) {
+    uint64_t word;
+    std::memcpy(&word, bitmap + row / 8, sizeof(word));
+    if (word != 0) {
+      break;
+    }
+  }
+  for (; row + 8 <= end; row += 8) {
+    if (auto byte = bitmap[row / 8]) {
+      return row + selection_table.indices[byte][0];
+    }
+  }
+  for (; row < end; row++) {
+    if (is_selected(bitmap, row)) {
+      return row;
+    }
+  }
+  return end;
+}
+
+int64_t find_last_selected(const uint8_t *bitmap, int64_t offset, int64_t length) {
+  auto row = offset + length;
+  for (; row > offset && row % 8 != 0; row--) {
+    if (is_selected(bitmap, row - 1)) {
+      return row - 1;
+    }
+  }
+  for (; row - 64 >= offset; row -= 64) {
+    uint64_t word;
+    std::memcpy(&word, bitmap + (row - 64) / 8, sizeof(word));
+    if (word != 0) {
+      break;
+    }
+  }
+  for (; row - 8 >= offset; row -= 8) {
+    if (auto byte = bitmap[(row - 8) / 8]) {
+      return row - 8 + selection_table.indices[byte][selection_table.counts[byte] - 1];
+    }
+  }
+  for (; row > offset; row--) {
+    if (is_selected(bitmap, row - 1)) {
+      return row - 1;
+    }
+  }
+  return offset - 1;
+}
+
+int64_t compact_validity(const uint8_t *validity, int64_t validity_offset, const uint8_t *bitmap,
+                         int64_t offset, int64_t length, uint8_t *out, int64_t out_offset) {
+  int64_t count = 0;
+  int64_t i = 0;
+  auto append = [&](int64_t row) {
+    arrow::BitUtil::SetBitTo(out, out_offset + count,
+                             arrow::BitUtil::GetBit(validity, validity_offset + row));
+    count++;
+  };
+  for (; i < length && (offset + i) % 8 != 0; i++) {
+    if (is_selected(bitmap, offset + i)) {
+      append(i);
+    }
+  }
+  // validity is copied only for bitmap bytes, which select something
+  for (auto bytes = bitmap + (offset + i) / 8; i + 8 <= length; i += 8, bytes++) {
+    auto &indices = selection_table.indices[*bytes];
+    for (int lane = 0; lane < selection_table.counts[*bytes]; lane++) {
+      append(i + indices[lane]);
+    }
+  }
+  for (; i < length; i++) {
+    if (is_selected(bitmap, offset + i)) {
+      append(i);
+    }
+  }
+  return count;
+}
+} // namespace pefa::execution
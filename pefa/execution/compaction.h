@@ -0,0 +1,175 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+
+namespace pefa::execution {
+// Filter bitmap stores row i in bit (7 - i % 8) of byte i / 8
+
+// Positions of selected rows for every value of filter bitmap byte
+struct SelectionTable {
+  uint8_t indices[256][8]{};
+  uint8_t counts[256]{};
+
+  constexpr SelectionTable() {
+    for (int byte = 0; byte < 256; byte++) {
+      for (int row = 0; row < 8; row++) {
+        if (byte & (0x80 >> row)) {
+          indices[byte][counts[byte]++] = row;
+        }
+      }
+    }
+  }
+};
+
+inline constexpr SelectionTable selection_table{};
+
+[[nodiscard]] inline bool is_selected(const uint8_t *bitmap, int64_t row) {
+  return (bitmap[row / 8] >> (7 - row % 8)) & 1;
+}
+
+// number of rows in [offset, offset + length), selected by bitmap
+[[nodiscard]] int64_t count_selected(const uint8_t *bitmap, int64_t offset, int64_t length);
+
+// position of the first row in [offset, offset + length), selected by bitmap, or offset + length
+// if there is no such row
+[[nodiscard]] int64_t find_first_selected(const uint8_t *bitmap, int64_t offset, int64_t length);
+
+// position of the last row in [offset, offset + length), selected by bitmap, or offset - 1 if there
+// is no such row
+[[nodiscard]] int64_t find_last_selected(const uint8_t *bitmap, int64_t offset, int64_t length);
+
+// Appends validity bits of rows in [offset, offset + length), selected by bitmap, to out starting
+// from bit out_offset and returns number of appended bits. Validity bitmap is in arrow order and
+// its bit validity_offset corresponds to row offset
+int64_t compact_validity(const uint8_t *validity, int64_t validity_offset, const uint8_t *bitmap,
+                         int64_t offset, int64_t length, uint8_t *out, int64_t out_offset);
+
+// Copies values of rows in [offset, offset + length), selected by bitmap, to consecutive positions
+// of out and returns their number. values[0] corresponds to row offset.
+// Mixed bitmap bytes are copied with 8 stores, which may write after the last selected value, but
+// never at or after out[capacity], so neighbour ranges of output can be filled concurrently
+template <typename T>
+int64_t compact_values(const T *values, const uint8_t *bitmap, int64_t offset, int64_t length,
+                       T *out, int64_t capacity) {
+  int64_t count = 0;
+  int64_t i = 0;
+  // rows, which share bitmap byte with previous rows
+  for (; i < length && (offset + i) % 8 != 0; i++) {
+    if (is_selected(bitmap, offset + i)) {
+      out[count++] = values[i];
+    }
+  }
+
+  // every lane is written unconditionally and only selected ones are kept, so the loop has no
+  // branches and compiler is free to turn it into a gather or a shuffle
+  auto compact_byte = [&](const T *src, uint8_t byte) {
+    auto &indices = selection_table.indices[byte];
+    if (count + 8 <= capacity) {
+      for (int lane = 0; lane < 8; lane++) {
+        out[count + lane] = src[indices[lane]];
+      }
+    } else {
+      for (int lane = 0; lane < selection_table.counts[byte]; lane++) {
+        out[count + lane] = src[indices[lane]];
+      }
+    }
+    count += selection_table.counts[byte];
+  };
+
+  auto bytes = bitmap + (offset + i) / 8;
+  for (; i + 64 <= length; i += 64, bytes += 8) {
+    uint64_t word;
+    std::memcpy(&word, bytes, sizeof(word));
+    if (word == 0) {
+      continue;
+    }
+    if (word == ~uint64_t(0)) {
+      std::memcpy(out + count, values + i, 64 * sizeof(T));
+      count += 64;
+      continue;
+    }
+    for (int byte = 0; byte < 8; byte++) {
+      compact_byte(values + i + byte * 8, bytes[byte]);
+    }
+  }
+  for (; i + 8 <= length; i += 8, bytes++) {
+    compact_byte(values + i, *bytes);
+  }
+
+  for (; i < length; i++) {
+    if (is_selected(bitmap, offset + i)) {
+      out[count++] = values[i];
+    }
+  }
+  return count;
+}
+
+// Writes positions of rows in [offset, offset + length), selected by bitmap, to out in ascending
+// order and returns their number. out should have place for all selected rows
+template <typename IdType>
+int64_t selected_row_ids(const uint8_t *bitmap, int64_t offset, int64_t length, IdType *out) {
+  int64_t count = 0;
+  auto row = offset;
+  auto end = offset + length;
+  for (; row < end && row % 8 != 0; row++) {
+    if (is_selected(bitmap, row)) {
+      out[count++] = static_cast<IdType>(row);
+    }
+  }
+  for (; row + 64 <= end; row += 64) {
+    uint64_t word;
+    std::memcpy(&word, bitmap + row / 8, sizeof(word));
+    // selection vectors are built for very selective filters, so most words are zero
+    if (word == 0) {
+      continue;
+    }
+    for (int byte = 0; byte < 8; byte++) {
+      auto value = bitmap[row / 8 + byte];
+      for (int lane = 0; lane < selection_table.counts[value]; lane++) {
+        out[count++] = static_cast<IdType>(row + byte * 8 + selection_table.indices[value][lane]);
+      }
+    }
+  }
+  for (; row < end; row++) {
+    if (is_selected(bitmap, row)) {
+      out[count++] = static_cast<IdType>(row);
+    }
+  }
+  return count;
+}
+
+// Keeps ids[i] for which bit i of bitmap is set, moving them to the beginning of ids, and returns
+// their number
+template <typename IdType>
+int64_t retain_selected_ids(IdType *ids, int64_t count, const uint8_t *bitmap) {
+  int64_t kept = 0;
+  for (int64_t i = 0; i < count; i++) {
+    ids[kept] = ids[i];
+    kept += is_selected(bitmap, i);
+  }
+  return kept;
+}
+
+// Copies values of rows ids[0], ..., ids[count - 1] to consecutive positions of out. values[0]
+// corresponds to row first_row
+template <typename T, typename IdType>
+void gather_values(const T *values, int64_t first_row, const IdType *ids, int64_t count, T *out) {
+  for (int64_t i = 0; i < count; i++) {
+    out[i] = values[ids[i] - first_row];
+  }
+}
+
+// Same as gather_values, but for arrow validity bitmap, whose bit validity_offset corresponds to
+// row first_row. Bits are written to out starting from bit out_offset
+template <typename IdType>
+void gather_validity(const uint8_t *validity, int64_t validity_offset, int64_t first_row,
+                     const IdType *ids, int64_t count, uint8_t *out, int64_t out_offset) {
+  for (int64_t i = 0; i < count; i++) {
+    auto bit = validity_offset + ids[i] - first_row;
+    auto valid = (validity[bit / 8] >> (bit % 8)) & 1;
+    auto out_bit = out_offset + i;
+    out[out_bit / 8] = static_cast<uint8_t>((out[out_bit / 8] & ~(1u << (out_bit % 8))) |
+                                            (valid << (out_bit % 8)));
+  }
+}
+} // namespace pefa::execution
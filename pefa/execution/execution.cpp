@@ -1,10 +1,23 @@
 #include "execution.h"
 
+#include "compaction.h"
 #include "execution_context.h"
 #include "pefa/kernels/filter.h"
+#include "pefa/kernels/kernel_cache.h"
+#include "row_selection.h"
+#include "selectivity.h"
+#include "table_segments.h"
+#include "thread_pool.h"
+#include "zone_maps.h"
 
+#include <algorithm>
 #include <arrow/api.h>
+#include <arrow/util/bit_util.h>
+#include <cstring>
+#include <functional>
+#include <limits>
 #include <memory>
+#include <type_traits>
 #include <pefa/utils/exceptions.h>
 #include <pefa/utils/utils.h>
 #include <utility>
@@ -14,145 +27,705 @@ std::shared_ptr<ExecutionContext> project(const std::shared_ptr<ExecutionContext
                                           std::vector<std::string> column_names) {
   std::vector<std::shared_ptr<arrow::ChunkedArray>> columns(column_names.size());
   std::vector<std::shared_ptr<arrow::Field>> fields(column_names.size());
+  std::vector<std::shared_ptr<ColumnMetadata>> columns_metadata(column_names.size());
   for (int i = 0; i < column_names.size(); i++) {
-    auto col = ctx->table->GetColumnByName(column_names[i]);
+    auto index = ctx->table->schema()->GetFieldIndex(column_names[i]);
+    if (index < 0) {
+      throw ColumnNotFoundException(column_names[i]);
+    }
+    auto col = ctx->table->column(index);
     fields[i] = std::make_shared<arrow::Field>(column_names[i], col->type());
     columns[i] = col;
+    // projection does not change chunks, so already computed statistics are still valid
+    columns_metadata[i] = ctx->metadata->columns[index];
   }
-  return std::make_shared<ExecutionContext>(
-      arrow::Table::Make(std::make_shared<arrow::Schema>(fields), columns));
-}
-
-class FilterExprExecutor : public ExprVisitor {
-private:
-  std::shared_ptr<ExecutionContext> m_ctx;
-  std::shared_ptr<arrow::Buffer> m_buffer;
-
-public:
-  explicit FilterExprExecutor(std::shared_ptr<ExecutionContext> ctx)
-      : m_ctx(std::move(ctx)) {}
-  void visit(const PredicateExpr &expr) override {
-    expr.lhs->visit(*this);
-    auto lhs_buf = m_buffer;
-    expr.rhs->visit(*this);
-    auto rhs_buf = m_buffer;
-    if (expr.op == PredicateExpr::Op::AND) {
-      for (int i = 0; i < lhs_buf->size(); i++) {
-        lhs_buf->mutable_data()[i] &= rhs_buf->mutable_data()[i];
-      }
+  auto res = std::make_shared<ExecutionContext>(
+      arrow::Table::Make(std::make_shared<arrow::Schema>(fields), columns), ctx->config);
+  res->metadata->columns = std::move(columns_metadata);
+  // projection keeps rows, so filter is not materialized until it is needed
+  res->metadata->filter_bitmap = ctx->metadata->filter_bitmap;
+  res->metadata->selection_vector = ctx->metadata->selection_vector;
+  return res;
+}
+
+// validity of rows, where all columns are valid, or nullptr if none of columns has nulls
+std::shared_ptr<arrow::Buffer>
+combine_validity(const std::vector<std::shared_ptr<const arrow::Array>> &columns, int64_t length) {
+  std::shared_ptr<arrow::Buffer> validity;
+  for (auto &column : columns) {
+    if (column->null_count() == 0) {
+      continue;
+    }
+    if (!validity) {
+      validity = arrow::internal::CopyBitmap(arrow::default_memory_pool(),
+                                             column->null_bitmap_data(), column->offset(), length)
+                     .ValueOrDie();
     } else {
-      for (int i = 0; i < lhs_buf->size(); i++) {
-        lhs_buf->mutable_data()[i] |= rhs_buf->mutable_data()[i];
-      }
+      arrow::internal::BitmapAnd(validity->data(), 0, column->null_bitmap_data(),
+                                 column->offset(), length, 0, validity->mutable_data());
     }
-    m_buffer = lhs_buf;
-  }
-
-  void visit(const CompareExpr &expr) override {
-    // TODO: support expressions like a > b, 3 * a > 5 * b
-    // currently we support only expressions like a > <const>
-    auto buffer = arrow::AllocateBitmap(m_ctx->table->num_rows()).ValueOrDie();
-    std::memset(buffer->mutable_data(), 255, buffer->size());
-    // TODO: add check if column exists
-    auto field = m_ctx->table->schema()->GetFieldByName(expr.lhs->name);
-    auto column = m_ctx->table->GetColumnByName(expr.lhs->name);
-    auto kernel = kernels::FilterKernel::create_cpu(field, std::make_shared<CompareExpr>(expr));
-    kernel->compile();
-    // TODO: make that implementation parallel
-    for (int chunk_num = 0; chunk_num < column->num_chunks(); chunk_num++) {
-      size_t offset = 0;
-      for (int i = 0; i < chunk_num; i++) {
-        offset += column->chunk(i)->length();
+  }
+  return validity;
+}
+
+// evaluates expression for every row of table. Every segment of referenced columns is computed by
+// its own task into preallocated buffer, which becomes chunk of result
+std::shared_ptr<arrow::ChunkedArray> compute_column(const arrow::Table &table,
+                                                    const std::shared_ptr<const ValueExpr> &expr) {
+  std::vector<std::string> names;
+  referenced_columns(*expr, names);
+  std::vector<std::shared_ptr<const arrow::Field>> fields;
+  std::vector<std::shared_ptr<arrow::ChunkedArray>> columns;
+  for (auto &name : names) {
+    auto index = table.schema()->GetFieldIndex(name);
+    if (index < 0) {
+      throw ColumnNotFoundException(name);
+    }
+    fields.push_back(table.schema()->field(index));
+    columns.push_back(table.column(index));
+  }
+  auto kernel = kernels::get_kernel_cache()->get_projection_kernel(fields, expr);
+  auto type = kernel->output_type();
+  auto width = static_cast<const arrow::FixedWidthType &>(*type).bit_width() / 8;
+  auto segments = split_into_segments(columns);
+  arrow::ArrayVector chunks(segments.size());
+
+  tf::Taskflow taskflow;
+  taskflow.parallel_for(0, static_cast<int>(segments.size()), 1, [&](int segment_num) {
+    auto &segment = segments[segment_num];
+    std::shared_ptr<arrow::Buffer> values =
+        arrow::AllocateBuffer(width * segment.length).ValueOrDie();
+    kernel->execute(segment.columns, values->mutable_data());
+    auto validity = combine_validity(segment.columns, segment.length);
+    auto null_count = validity ? arrow::kUnknownNullCount : 0;
+    chunks[segment_num] = arrow::MakeArray(arrow::ArrayData::Make(
+        type, segment.length, {std::move(validity), std::move(values)}, null_count));
+  });
+  get_executor().run(taskflow).wait();
+  return std::make_shared<arrow::ChunkedArray>(std::move(chunks), type);
+}
+
+std::shared_ptr<ExecutionContext> select(const std::shared_ptr<ExecutionContext> &ctx,
+                                         const std::vector<Projection> &projections) {
+  std::vector<std::string> names;
+  bool computed = false;
+  for (auto &projection : projections) {
+    referenced_columns(*projection.expr, names);
+    computed |= dynamic_cast<const ColumnRef *>(projection.expr.get()) == nullptr;
+  }
+  // few selected rows are gathered first, so expressions are not evaluated for all rows
+  auto source = ctx;
+  if (computed && ctx->metadata->selection_vector) {
+    source = materialize_filter(project(ctx, names));
+  }
+
+  auto &table = *source->table;
+  std::vector<std::shared_ptr<arrow::ChunkedArray>> columns(projections.size());
+  std::vector<std::shared_ptr<arrow::Field>> fields(projections.size());
+  std::vector<std::shared_ptr<ColumnMetadata>> columns_metadata(projections.size());
+  for (size_t i = 0; i < projections.size(); i++) {
+    auto &projection = projections[i];
+    if (auto column = dynamic_cast<const ColumnRef *>(projection.expr.get())) {
+      auto index = table.schema()->GetFieldIndex(column->name);
+      if (index < 0) {
+        throw ColumnNotFoundException(column->name);
       }
-      // if some byte from bitmap is located between 2 chunks, we calculate how much bits from that
-      // byte belongs to previous chunk
-      auto prev_bits = offset % 8;
-      // this way we can calculate how much bits from that byte belons to current chunk
-      // we use % 8 to handle case, when byte completely lies in current chunk, then prev_bits would
-      // be equal to 0 and we don't need an offset
-      auto remaining_bits = (8 - prev_bits) % 8;
-      kernel->execute(column->chunk(chunk_num), buffer->mutable_data() + offset / 8,
-                      remaining_bits);
-    }
-    size_t offset = 0;
-    for (int chunk_num = 0; chunk_num < column->num_chunks(); chunk_num++) {
-      if (offset % 8 != 0) {
-        kernel->execute_remaining(column->chunk(chunk_num), buffer->mutable_data() + offset / 8, 0,
-                                  offset % 8);
+      columns[i] = table.column(index);
+      // column is not changed, so already computed statistics are still valid
+      columns_metadata[i] = source->metadata->columns[index];
+    } else {
+      columns[i] = compute_column(table, projection.expr);
+    }
+    fields[i] = arrow::field(projection.name, columns[i]->type());
+  }
+  auto res = std::make_shared<ExecutionContext>(
+      arrow::Table::Make(arrow::schema(fields), columns, table.num_rows()), source->config);
+  for (size_t i = 0; i < projections.size(); i++) {
+    if (columns_metadata[i]) {
+      res->metadata->columns[i] = columns_metadata[i];
+    }
+  }
+  // computed columns have a value for every row, so filter still selects the same rows
+  res->metadata->filter_bitmap = source->metadata->filter_bitmap;
+  res->metadata->selection_vector = source->metadata->selection_vector;
+  return res;
+}
+
+// clears bits [from, to) of bitmap
+void clear_bits(uint8_t *bitmap, int64_t from, int64_t to) {
+  for (auto i = from; i < to; i++) {
+    bitmap[i / 8] &= ~(1u << (7 - i % 8));
+  }
+}
+
+// evaluates whole expression with a single fused kernel and ANDs result into bitmap
+void evaluate_filter(const ExecutionContext &ctx, const std::shared_ptr<const BooleanExpr> &expr,
+                     uint8_t *bitmap, bool skip_zero_words) {
+  auto &table = *ctx.table;
+  std::vector<std::string> names;
+  referenced_columns(*expr, names);
+  // expression without column references is still evaluated by kernel, which needs some input
+  if (names.empty()) {
+    names.push_back(table.schema()->field(0)->name());
+  }
+
+  std::vector<std::shared_ptr<const arrow::Field>> fields;
+  std::vector<std::shared_ptr<arrow::ChunkedArray>> columns;
+  std::vector<std::shared_ptr<ColumnMetadata>> columns_metadata;
+  for (auto &name : names) {
+    auto index = table.schema()->GetFieldIndex(name);
+    if (index < 0) {
+      throw ColumnNotFoundException(name);
+    }
+    fields.push_back(table.schema()->field(index));
+    columns.push_back(table.column(index));
+    columns_metadata.push_back(ctx.metadata->columns[index]);
+  }
+  auto kernel = kernels::get_kernel_cache()->get_filter_kernel(fields, expr, skip_zero_words);
+  // cached kernel may be compiled for another expression, so inputs are taken from this one
+  kernels::FilterInputs inputs(*expr);
+  auto segments = split_into_segments(columns);
+  std::vector<ZoneMapResult> zone_maps(segments.size(), ZoneMapResult::SOME);
+
+  // each segment writes only bytes which completely belong to it, so segments can be processed
+  // independently
+  tf::Taskflow taskflow;
+  taskflow.parallel_for(0, static_cast<int>(segments.size()), 1, [&](int segment_num) {
+    auto &segment = segments[segment_num];
+    if (ctx.config->use_zone_maps) {
+      std::vector<const ChunkMetadata *> chunks;
+      for (size_t i = 0; i < columns.size(); i++) {
+        auto &chunk_metadata = *columns_metadata[i]->chunks[segment.chunks[i]];
+        chunk_metadata.ensure_computed(*columns[i]->chunk(segment.chunks[i]));
+        chunks.push_back(&chunk_metadata);
       }
-      offset += column->chunk(chunk_num)->length();
-      if (offset % 8 != 0) {
-        kernel->execute_remaining(column->chunk(chunk_num), buffer->mutable_data() + offset / 8,
-                                  column->chunk(chunk_num)->length() - (offset % 8), 0);
+      zone_maps[segment_num] = evaluate_zone_maps(*expr, fields, chunks);
+    }
+
+    // if some byte from bitmap is located between 2 segments, we calculate how much bits from that
+    // byte belongs to previous segment
+    auto prev_bits = segment.offset % 8;
+    // this way we can calculate how much bits from that byte belons to current segment
+    // we use % 8 to handle case, when byte completely lies in current segment, then prev_bits
+    // would be equal to 0 and we don't need an offset
+    auto remaining_bits = (8 - prev_bits) % 8;
+    if (zone_maps[segment_num] == ZoneMapResult::SOME) {
+      kernel->execute(segment.columns, bitmap + segment.offset / 8, remaining_bits, inputs);
+    } else if (zone_maps[segment_num] == ZoneMapResult::NONE) {
+      auto first_byte = (segment.offset + 7) / 8;
+      auto end_byte = (segment.offset + segment.length) / 8;
+      if (first_byte < end_byte) {
+        std::memset(bitmap + first_byte, 0, end_byte - first_byte);
       }
     }
-    m_buffer = buffer;
+  });
+  get_executor().run(taskflow).wait();
+
+  // bytes shared between neighbour segments are processed sequentially, as both segments modify
+  // them
+  for (size_t segment_num = 0; segment_num < segments.size(); segment_num++) {
+    auto &segment = segments[segment_num];
+    auto offset = segment.offset;
+    auto end = segment.offset + segment.length;
+    if (zone_maps[segment_num] == ZoneMapResult::ALL) {
+      continue;
+    }
+    if (zone_maps[segment_num] == ZoneMapResult::NONE) {
+      clear_bits(bitmap, offset, std::min(end, (offset + 7) / 8 * 8));
+      clear_bits(bitmap, std::max(offset, end / 8 * 8), end);
+      continue;
+    }
+    if (offset % 8 != 0) {
+      kernel->execute_remaining(segment.columns, bitmap + offset / 8, 0, offset % 8, inputs);
+    }
+    // segment, which lies inside a single byte, is already processed by the previous call
+    if (end % 8 != 0 && (offset % 8 == 0 || offset / 8 != end / 8)) {
+      kernel->execute_remaining(segment.columns, bitmap + end / 8, segment.length - (end % 8), 0,
+                                inputs);
+    }
   }
+}
 
-  [[nodiscard]] std::shared_ptr<arrow::Buffer> result() const {
-    return m_buffer;
+// applies op to each byte of dst and src, 64 bits at a time
+template <typename Op>
+void combine_bitmaps(uint8_t *dst, const uint8_t *src, int64_t size, Op op) {
+  int64_t i = 0;
+  for (; i + 8 <= size; i += 8) {
+    uint64_t dst_word, src_word;
+    std::memcpy(&dst_word, dst + i, 8);
+    std::memcpy(&src_word, src + i, 8);
+    dst_word = op(dst_word, src_word);
+    std::memcpy(dst + i, &dst_word, 8);
   }
-};
+  for (; i < size; i++) {
+    dst[i] = static_cast<uint8_t>(op(dst[i], src[i]));
+  }
+}
+
+// splits chain of operations of the same kind into operands, e.g. (a AND b) AND c -> [a, b, c]
+void flatten_predicate(const std::shared_ptr<const BooleanExpr> &expr, PredicateExpr::Op op,
+                       std::vector<std::shared_ptr<const BooleanExpr>> &operands) {
+  auto predicate = std::dynamic_pointer_cast<const PredicateExpr>(expr);
+  if (predicate && predicate->op == op) {
+    flatten_predicate(predicate->lhs, op, operands);
+    flatten_predicate(predicate->rhs, op, operands);
+  } else {
+    operands.push_back(expr);
+  }
+}
+
+// evaluates AND/OR operands one by one and ANDs result into bitmap. Every operand is evaluated
+// only for words, which are not decided yet, so operands which decide most rows for the lowest
+// cost go first
+void evaluate_filter_short_circuit(const ExecutionContext &ctx,
+                                   const std::shared_ptr<const BooleanExpr> &expr,
+                                   uint8_t *bitmap) {
+  auto predicate = std::dynamic_pointer_cast<const PredicateExpr>(expr);
+  if (!predicate) {
+    evaluate_filter(ctx, expr, bitmap, true);
+    return;
+  }
+
+  std::vector<std::shared_ptr<const BooleanExpr>> operands;
+  flatten_predicate(expr, predicate->op, operands);
+  std::vector<std::pair<double, std::shared_ptr<const BooleanExpr>>> ranked;
+  for (auto &operand : operands) {
+    auto selectivity = estimate_selectivity(*operand);
+    // AND operand decides rows, where it is false, OR operand - rows, where it is true
+    auto decided = predicate->op == PredicateExpr::Op::AND ? 1 - selectivity : selectivity;
+    ranked.emplace_back(estimate_cost(*ctx.table->schema(), *operand) / std::max(decided, 1e-6),
+                        operand);
+  }
+  std::stable_sort(ranked.begin(), ranked.end(),
+                   [](auto &lhs, auto &rhs) { return lhs.first < rhs.first; });
+
+  if (predicate->op == PredicateExpr::Op::AND) {
+    for (auto &[rank, operand] : ranked) {
+      evaluate_filter_short_circuit(ctx, operand, bitmap);
+    }
+    return;
+  }
+
+  // rows, which are still set in undecided, were not accepted by any of the previous operands
+  auto size = arrow::BitUtil::BytesForBits(ctx.table->num_rows());
+  std::vector<uint8_t> undecided(bitmap, bitmap + size);
+  std::vector<uint8_t> accepted(size, 0);
+  std::vector<uint8_t> current(size);
+  for (auto &[rank, operand] : ranked) {
+    current = undecided;
+    evaluate_filter_short_circuit(ctx, operand, current.data());
+    combine_bitmaps(accepted.data(), current.data(), size, std::bit_or<>());
+    combine_bitmaps(undecided.data(), current.data(), size,
+                    [](uint64_t lhs, uint64_t rhs) { return lhs & ~rhs; });
+  }
+  std::memcpy(bitmap, accepted.data(), size);
+}
+
+// evaluates expression with configured strategy and ANDs result into bitmap
+void apply_filter(const ExecutionContext &ctx, const std::shared_ptr<const BooleanExpr> &expr,
+                  uint8_t *bitmap, bool skip_zero_words) {
+  switch (ctx.config->filter_strategy) {
+    PEFA_CASE_BRK(case FilterStrategy::FUSED:, evaluate_filter(ctx, expr, bitmap, skip_zero_words))
+    PEFA_CASE_BRK(case FilterStrategy::SHORT_CIRCUIT:,
+                  evaluate_filter_short_circuit(ctx, expr, bitmap))
+  }
+}
+
+template <typename IdType>
+std::shared_ptr<arrow::Array> make_selection_vector(const uint8_t *bitmap, int64_t num_rows,
+                                                    int64_t selected) {
+  auto buffer = arrow::AllocateBuffer(sizeof(IdType) * selected).ValueOrDie();
+  selected_row_ids(bitmap, 0, num_rows, reinterpret_cast<IdType *>(buffer->mutable_data()));
+  auto type = std::is_same_v<IdType, uint32_t> ? arrow::uint32() : arrow::uint64();
+  return arrow::MakeArray(arrow::ArrayData::Make(
+      type, selected, {nullptr, std::shared_ptr<arrow::Buffer>(std::move(buffer))}, 0));
+}
+
+// converts bitmap of very selective filter into sorted row ids, which are 32-bit, when possible
+std::shared_ptr<arrow::Array> make_selection_vector(const uint8_t *bitmap, int64_t num_rows,
+                                                    int64_t selected) {
+  if (num_rows <= std::numeric_limits<uint32_t>::max()) {
+    return make_selection_vector<uint32_t>(bitmap, num_rows, selected);
+  }
+  return make_selection_vector<uint64_t>(bitmap, num_rows, selected);
+}
+
+std::shared_ptr<arrow::Table> gather_table(const arrow::Table &table,
+                                           const std::shared_ptr<arrow::Array> &selection_vector);
+
+// returns ids from selection vector, for which bit of their position in bitmap is set
+template <typename IdType>
+std::shared_ptr<arrow::Array> filter_ids(const arrow::Array &selection_vector,
+                                         const uint8_t *bitmap) {
+  auto count = selection_vector.length();
+  auto buffer = arrow::AllocateBuffer(sizeof(IdType) * count).ValueOrDie();
+  auto ids = reinterpret_cast<IdType *>(buffer->mutable_data());
+  std::memcpy(ids, selection_vector.data()->GetValues<IdType>(1), sizeof(IdType) * count);
+  auto kept = retain_selected_ids(ids, count, bitmap);
+  return arrow::MakeArray(arrow::ArrayData::Make(
+      selection_vector.type(), kept, {nullptr, std::shared_ptr<arrow::Buffer>(std::move(buffer))},
+      0));
+}
+
+// Filters rows of sparse selection. Columns, referenced by expression, are gathered at selected
+// rows, so kernel is executed over contiguous input of selected rows only, and ids of rows, which
+// pass the filter, are kept
+std::shared_ptr<arrow::Array> filter_selection_vector(const std::shared_ptr<ExecutionContext> &ctx,
+                                                      const std::shared_ptr<BooleanExpr> &expr) {
+  auto selection_vector = ctx->metadata->selection_vector;
+  if (selection_vector->length() == 0 || ctx->table->num_columns() == 0) {
+    return selection_vector;
+  }
+  std::vector<std::string> names;
+  referenced_columns(*expr, names);
+  if (names.empty()) {
+    names.push_back(ctx->table->schema()->field(0)->name());
+  }
+  auto gathered = std::make_shared<ExecutionContext>(
+      gather_table(*project(ctx, names)->table, selection_vector), ctx->config);
+  auto count = selection_vector->length();
+  auto bitmap = arrow::AllocateBitmap(count).ValueOrDie();
+  std::memset(bitmap->mutable_data(), 255, bitmap->size());
+  apply_filter(*gathered, expr, bitmap->mutable_data(), false);
+
+  switch (selection_vector->type_id()) {
+    PEFA_CASE_RET(PEFA_UINT32_CASE, filter_ids<uint32_t>(*selection_vector, bitmap->data()))
+    PEFA_CASE_RET(PEFA_UINT64_CASE, filter_ids<uint64_t>(*selection_vector, bitmap->data()))
+  default:
+    throw UnreachableException();
+  }
+}
 
 std::shared_ptr<ExecutionContext>
 generate_filter_bitmap(const std::shared_ptr<ExecutionContext> &ctx,
                        const std::shared_ptr<BooleanExpr> &expr) {
+  auto res = std::make_shared<ExecutionContext>(ctx->table, ctx->config);
+  res->metadata->columns = ctx->metadata->columns;
+  // sparse selection stays sparse, as filter only removes rows from it
+  if (ctx->metadata->selection_vector) {
+    res->metadata->selection_vector = filter_selection_vector(ctx, expr);
+    return res;
+  }
+
+  // rows, which are filtered out by previous filters, stay filtered out
+  auto num_rows = ctx->table->num_rows();
+  auto bitmap = arrow::AllocateBitmap(num_rows).ValueOrDie();
+  auto &prev_bitmap = ctx->metadata->filter_bitmap;
+  if (prev_bitmap) {
+    std::memcpy(bitmap->mutable_data(), prev_bitmap->data(), bitmap->size());
+  } else {
+    std::memset(bitmap->mutable_data(), 255, bitmap->size());
+  }
+  res->metadata->filter_bitmap = bitmap;
   // TODO: handle empty input
   if (ctx->table->num_columns() == 0 || ctx->table->column(0)->num_chunks() == 0) {
-    return std::make_shared<ExecutionContext>(ctx->table);
+    return res;
   }
-  FilterExprExecutor expr_executor(ctx);
-  expr->visit(expr_executor);
+  // words, which are already filtered out by previous filters, are not evaluated again
+  apply_filter(*ctx, expr, bitmap->mutable_data(), prev_bitmap != nullptr);
 
-  // TODO: create ExecutionContext from ctx and correctly join filter_bitmaps
-  auto res = std::make_shared<ExecutionContext>(ctx->table);
-  res->metadata->filter_bitmap = expr_executor.result();
+  auto &config = *ctx->config;
+  if (num_rows >= config.selection_vector_min_rows) {
+    auto selected = count_selected(bitmap->data(), 0, num_rows);
+    if (selected <= config.selection_vector_ratio * num_rows) {
+      res->metadata->filter_bitmap = nullptr;
+      res->metadata->selection_vector = make_selection_vector(bitmap->data(), num_rows, selected);
+    }
+  }
   return res;
 }
 
+// Rows of table are split into ranges, which are compacted independently. Position of the first
+// selected row of every range in output is known in advance from popcount of previous ranges
+struct MaterializeRanges {
+  const uint8_t *bitmap;
+  // multiple of 64, so ranges start at bitmap word boundary
+  int64_t range_rows;
+  // output offset of every range, followed by total number of selected rows
+  std::vector<int64_t> output_offsets;
+
+  // number of selected rows before the given one
+  [[nodiscard]] int64_t selected_before(int64_t row) const {
+    auto range = row / range_rows;
+    return output_offsets[range] + count_selected(bitmap, range * range_rows, row % range_rows);
+  }
+};
+
+MaterializeRanges split_into_ranges(const uint8_t *bitmap, int64_t num_rows) {
+  const int64_t range_rows = 1 << 16;
+  auto num_ranges = (num_rows + range_rows - 1) / range_rows;
+  std::vector<int64_t> counts(num_ranges);
+  tf::Taskflow taskflow;
+  taskflow.parallel_for(0, static_cast<int>(num_ranges), 1, [&](int range) {
+    auto begin = range * range_rows;
+    counts[range] = count_selected(bitmap, begin, std::min(range_rows, num_rows - begin));
+  });
+  get_executor().run(taskflow).wait();
+
+  MaterializeRanges ranges{bitmap, range_rows, {0}};
+  for (auto count : counts) {
+    ranges.output_offsets.push_back(ranges.output_offsets.back() + count);
+  }
+  return ranges;
+}
+
+// Allocates resulting column and adds tasks filling it to taskflow. Resulting column should not
+// be used before taskflow is executed.
+// Chunks, where all selected rows form a single run, are not copied, but sliced. Other chunks are
+// compacted into a single buffer range by range, so large chunks are compacted in parallel too
 template <typename T>
-std::shared_ptr<arrow::ChunkedArray> materialize_column(const arrow::ChunkedArray &column,
-                                                        const uint8_t *bitmap) {
-  // TODO: move chunk_size to executionContext config
-  const uint64_t chunk_size = 2 << 13;
+std::shared_ptr<arrow::ChunkedArray>
+materialize_column(const std::shared_ptr<arrow::ChunkedArray> &column,
+                   const MaterializeRanges &ranges, tf::Taskflow &taskflow) {
+  auto bitmap = ranges.bitmap;
 
-  auto type = column.type();
-  auto total_length = column.length();
+  // position of chunk in table, position of its rows in compacted buffer, or slice of the chunk
+  struct ChunkSelection {
+    int64_t offset;
+    int64_t compacted_offset;
+    int64_t selected;
+    std::shared_ptr<arrow::Array> slice;
+  };
+  std::vector<ChunkSelection> selections;
+  int64_t compacted = 0;
+  int64_t offset = 0;
+  for (auto &chunk : column->chunks()) {
+    auto selected =
+        ranges.selected_before(offset + chunk->length()) - ranges.selected_before(offset);
+    ChunkSelection selection{offset, compacted, selected, nullptr};
+    if (selected == chunk->length()) {
+      selection.slice = chunk;
+    } else if (selected != 0) {
+      auto first = find_first_selected(bitmap, offset, chunk->length());
+      auto last = find_last_selected(bitmap, offset, chunk->length());
+      if (last - first + 1 == selected) {
+        selection.slice = chunk->Slice(first - offset, selected);
+      } else {
+        compacted += selected;
+      }
+    }
+    selections.push_back(std::move(selection));
+    offset += chunk->length();
+  }
 
-  std::vector<std::shared_ptr<arrow::Array>> new_column;
-  int current_chunk = 0;
-  int current_chunk_pos = 0;
-  int total_elements_pos = 0;
-
-  do {
-    int new_chunk_pos = 0;
-    auto buffer = arrow::AllocateBuffer(sizeof(T) * chunk_size).ValueOrDie();
-    auto data_out = reinterpret_cast<T *>(buffer->mutable_data());
-    while (new_chunk_pos < chunk_size && total_elements_pos < total_length) {
-      auto &chunk = *column.chunk(current_chunk);
-      // TODO: process validity buffer too
-      auto chunk_data = reinterpret_cast<T *>(chunk.data()->buffers[1]->mutable_data());
-      for (; new_chunk_pos < chunk_size && current_chunk_pos < chunk.length();
-           current_chunk_pos++, total_elements_pos++) {
-        // TODO: this wouldn't vectorize with division.
-        // Need to rewrite it to for(int i=0; i<8; i++) or smth like that
-        data_out[new_chunk_pos] = chunk_data[current_chunk_pos];
-        new_chunk_pos += (bitmap[total_elements_pos / 8] >> (7 - (total_elements_pos % 8))) & 1;
+  auto buffer = arrow::AllocateBuffer(sizeof(T) * compacted).ValueOrDie();
+  auto data_out = reinterpret_cast<T *>(buffer->mutable_data());
+  // validity is compacted only for columns with nulls, others produce arrays without it
+  bool has_nulls = column->null_count() != 0;
+  std::shared_ptr<arrow::Buffer> validity_buffer;
+  if (has_nulls) {
+    validity_buffer = arrow::AllocateBitmap(compacted).ValueOrDie();
+  }
+
+  for (int chunk_num = 0; chunk_num < column->num_chunks(); chunk_num++) {
+    auto &selection = selections[chunk_num];
+    if (selection.slice || selection.selected == 0) {
+      continue;
+    }
+    auto &chunk = column->chunk(chunk_num);
+    auto values = chunk->data()->GetValues<T>(1);
+    auto chunk_end = selection.offset + chunk->length();
+    // chunk is split on range boundaries
+    for (auto from = selection.offset; from < chunk_end;
+         from = (from / ranges.range_rows + 1) * ranges.range_rows) {
+      auto to = std::min(chunk_end, (from / ranges.range_rows + 1) * ranges.range_rows);
+      auto out = data_out + selection.compacted_offset + ranges.selected_before(from) -
+                 ranges.selected_before(selection.offset);
+      auto capacity = ranges.selected_before(to) - ranges.selected_before(from);
+      if (capacity == 0) {
+        continue;
       }
-      if (current_chunk_pos == chunk.length()) {
-        current_chunk++;
-        current_chunk_pos = 0;
+      taskflow.emplace([values = values + (from - selection.offset), bitmap, from, to, out,
+                        capacity] {
+        compact_values(values, bitmap, from, to - from, out, capacity);
+      });
+    }
+  }
+  // neighbour ranges and chunks may share output validity bytes, so validity of column is
+  // compacted by a single task
+  if (has_nulls) {
+    taskflow.emplace([column, bitmap, selections, validity_out = validity_buffer->mutable_data()] {
+      for (int chunk_num = 0; chunk_num < column->num_chunks(); chunk_num++) {
+        auto &selection = selections[chunk_num];
+        if (selection.slice || selection.selected == 0) {
+          continue;
+        }
+        auto &chunk = column->chunk(chunk_num);
+        if (chunk->null_bitmap_data()) {
+          compact_validity(chunk->null_bitmap_data(), chunk->offset(), bitmap, selection.offset,
+                           chunk->length(), validity_out, selection.compacted_offset);
+        } else {
+          arrow::BitUtil::SetBitsTo(validity_out, selection.compacted_offset, selection.selected,
+                                    true);
+        }
       }
+    });
+  }
+
+  // compacted values are stored contiguously and sliced into chunks of chunk_size, so chunking
+  // does not depend on the order, in which ranges are processed
+  auto compacted_array = arrow::MakeArray(
+      arrow::ArrayData::Make(column->type(), compacted,
+                             {std::move(validity_buffer),
+                              std::shared_ptr<arrow::Buffer>(std::move(buffer))},
+                             has_nulls ? arrow::kUnknownNullCount : 0));
+  std::vector<std::shared_ptr<arrow::Array>> new_column;
+  auto flush_compacted = [&](int64_t begin, int64_t end) {
+    for (auto pos = begin; pos < end; pos += chunk_size) {
+      new_column.push_back(compacted_array->Slice(pos, std::min(chunk_size, end - pos)));
+    }
+  };
+  int64_t flushed = 0;
+  for (auto &selection : selections) {
+    if (selection.slice) {
+      flush_compacted(flushed, selection.compacted_offset);
+      flushed = selection.compacted_offset;
+      new_column.push_back(selection.slice);
     }
-    auto array_data = arrow::ArrayData::Make(
-        type, new_chunk_pos, {nullptr, std::shared_ptr<arrow::Buffer>(std::move(buffer))});
-    auto array = arrow::MakeArray(array_data);
-    new_column.push_back(array);
-  } while (total_elements_pos < total_length);
+  }
+  flush_compacted(flushed, compacted);
+  if (new_column.empty()) {
+    new_column.push_back(compacted_array);
+  }
   return std::make_shared<arrow::ChunkedArray>(new_column);
 }
 
+// Allocates resulting column, filled with values of rows from selection vector, and adds tasks
+// filling it to taskflow. Resulting column should not be used before taskflow is executed.
+template <typename T, typename IdType>
+std::shared_ptr<arrow::ChunkedArray>
+gather_column(const std::shared_ptr<arrow::ChunkedArray> &column,
+              const std::shared_ptr<arrow::Array> &selection_vector, tf::Taskflow &taskflow) {
+  // multiple of 8, so neighbour blocks do not share output validity bytes
+  const int64_t block_size = 1 << 16;
+  auto ids = selection_vector->data()->GetValues<IdType>(1);
+  auto count = selection_vector->length();
+  // chunk_offsets[i] is position of the first row of chunk i, followed by number of rows
+  auto chunk_offsets = std::make_shared<std::vector<int64_t>>(1, 0);
+  for (auto &chunk : column->chunks()) {
+    chunk_offsets->push_back(chunk_offsets->back() + chunk->length());
+  }
+
+  auto buffer = arrow::AllocateBuffer(sizeof(T) * count).ValueOrDie();
+  auto data_out = reinterpret_cast<T *>(buffer->mutable_data());
+  bool has_nulls = column->null_count() != 0;
+  std::shared_ptr<arrow::Buffer> validity_buffer;
+  if (has_nulls) {
+    validity_buffer = arrow::AllocateBitmap(count).ValueOrDie();
+  }
+  auto validity_out = has_nulls ? validity_buffer->mutable_data() : nullptr;
+
+  for (int64_t begin = 0; begin < count; begin += block_size) {
+    auto end = std::min(count, begin + block_size);
+    taskflow.emplace([column, selection_vector, chunk_offsets, ids, begin, end, data_out,
+                      validity_out] {
+      // ids are sorted, so every chunk holds a single run of them
+      for (auto pos = begin; pos < end;) {
+        auto chunk_num = std::upper_bound(chunk_offsets->begin(), chunk_offsets->end(),
+                                          static_cast<int64_t>(ids[pos])) -
+                         chunk_offsets->begin() - 1;
+        auto first_row = (*chunk_offsets)[chunk_num];
+        auto run_end =
+            std::lower_bound(ids + pos, ids + end, (*chunk_offsets)[chunk_num + 1]) - ids;
+        auto &chunk = column->chunk(chunk_num);
+        gather_values(chunk->data()->GetValues<T>(1), first_row, ids + pos,
+                      run_end - pos, data_out + pos);
+        if (validity_out && chunk->null_bitmap_data()) {
+          gather_validity(chunk->null_bitmap_data(), chunk->offset(), first_row, ids + pos,
+                          run_end - pos, validity_out, pos);
+        } else if (validity_out) {
+          arrow::BitUtil::SetBitsTo(validity_out, pos, run_end - pos, true);
+        }
+        pos = run_end;
+      }
+    });
+  }
+
+  auto gathered = arrow::MakeArray(
+      arrow::ArrayData::Make(column->type(), count,
+                             {std::move(validity_buffer),
+                              std::shared_ptr<arrow::Buffer>(std::move(buffer))},
+                             has_nulls ? arrow::kUnknownNullCount : 0));
+  std::vector<std::shared_ptr<arrow::Array>> new_column;
+  for (int64_t pos = 0; pos < count; pos += chunk_size) {
+    new_column.push_back(gathered->Slice(pos, std::min(chunk_size, count - pos)));
+  }
+  if (new_column.empty()) {
+    new_column.push_back(gathered);
+  }
+  return std::make_shared<arrow::ChunkedArray>(new_column);
+}
+
+// columns, which are not copied by ranges of fixed width values. Dictionary columns are taken
+// by codes, so they stay encoded
+bool is_taken_by_rows(const arrow::DataType &type) {
+  return arrow::is_binary_like(type.id()) || type.id() == arrow::Type::DICTIONARY;
+}
+
+template <typename IdType>
+std::shared_ptr<arrow::Table>
+gather_columns(const arrow::Table &table, const std::shared_ptr<arrow::Array> &selection_vector) {
+  std::vector<std::shared_ptr<arrow::ChunkedArray>> new_columns;
+  // utf8, binary and dictionary columns are taken by 64-bit row ids, which are converted only if
+  // needed
+  std::vector<int64_t> rows;
+  tf::Taskflow taskflow;
+  for (int col_num = 0; col_num < table.num_columns(); col_num++) {
+    auto &column = table.column(col_num);
+    if (is_taken_by_rows(*column->type())) {
+      if (rows.empty()) {
+        auto ids = selection_vector->data()->GetValues<IdType>(1);
+        rows.assign(ids, ids + selection_vector->length());
+      }
+      new_columns.push_back(take_rows(column, rows.data(), selection_vector->length(), taskflow));
+      continue;
+    }
+    switch (column->type()->id()) {
+      PEFA_CASE_BRK(PEFA_INT8_CASE, new_columns.push_back(gather_column<int8_t, IdType>(
+                                        column, selection_vector, taskflow)))
+      PEFA_CASE_BRK(PEFA_INT16_CASE, new_columns.push_back(gather_column<int16_t, IdType>(
+                                         column, selection_vector, taskflow)))
+      PEFA_CASE_BRK(PEFA_INT32_CASE, new_columns.push_back(gather_column<int32_t, IdType>(
+                                         column, selection_vector, taskflow)))
+      PEFA_CASE_BRK(PEFA_INT64_CASE, new_columns.push_back(gather_column<int64_t, IdType>(
+                                         column, selection_vector, taskflow)))
+      PEFA_CASE_BRK(PEFA_UINT8_CASE, new_columns.push_back(gather_column<uint8_t, IdType>(
+                                         column, selection_vector, taskflow)))
+      PEFA_CASE_BRK(PEFA_UINT16_CASE, new_columns.push_back(gather_column<uint16_t, IdType>(
+                                          column, selection_vector, taskflow)))
+      PEFA_CASE_BRK(PEFA_UINT32_CASE, new_columns.push_back(gather_column<uint32_t, IdType>(
+                                          column, selection_vector, taskflow)))
+      PEFA_CASE_BRK(PEFA_UINT64_CASE, new_columns.push_back(gather_column<uint64_t, IdType>(
+                                          column, selection_vector, taskflow)))
+      PEFA_CASE_BRK(PEFA_FLOAT32_CASE, new_columns.push_back(gather_column<float, IdType>(
+                                           column, selection_vector, taskflow)))
+      PEFA_CASE_BRK(PEFA_FLOAT64_CASE, new_columns.push_back(gather_column<double, IdType>(
+                                           column, selection_vector, taskflow)))
+    default:
+      throw NotImplementedException("Type " + column->type()->ToString() +
+                                    " is not supported yet");
+    }
+  }
+  get_executor().run(taskflow).wait();
+  return arrow::Table::Make(table.schema(), new_columns);
+}
+
+// materializes rows of table from selection vector
+std::shared_ptr<arrow::Table> gather_table(const arrow::Table &table,
+                                           const std::shared_ptr<arrow::Array> &selection_vector) {
+  switch (selection_vector->type_id()) {
+    PEFA_CASE_RET(PEFA_UINT32_CASE, gather_columns<uint32_t>(table, selection_vector))
+    PEFA_CASE_RET(PEFA_UINT64_CASE, gather_columns<uint64_t>(table, selection_vector))
+  default:
+    throw UnreachableException();
+  }
+}
+
 std::shared_ptr<ExecutionContext> materialize_filter(const std::shared_ptr<ExecutionContext> &ctx) {
+  if (ctx->metadata->selection_vector) {
+    return std::make_shared<ExecutionContext>(
+        gather_table(*ctx->table, ctx->metadata->selection_vector), ctx->config);
+  }
   auto bitmap = ctx->metadata->filter_bitmap;
   if (!bitmap) {
     throw UnreachableException();
@@ -160,33 +733,52 @@ std::shared_ptr<ExecutionContext> materialize_filter(const std::shared_ptr<Execu
 
   std::vector<std::shared_ptr<arrow::ChunkedArray>> new_columns;
   auto &table = *ctx->table;
+  auto ranges = split_into_ranges(bitmap->data(), table.num_rows());
+  // utf8, binary and dictionary columns are taken by ids of selected rows, which are decoded only
+  // if needed
+  std::vector<int64_t> rows;
+  bool rows_decoded = false;
+  // all columns are compacted at once, every column by several ranges
+  tf::Taskflow taskflow;
   for (int col_num = 0; col_num < ctx->table->num_columns(); col_num++) {
-    switch (table.column(col_num)->type()->id()) {
-      PEFA_CASE_BRK(PEFA_INT8_CASE, new_columns.push_back(materialize_column<int8_t>(
-                                        *table.column(col_num), bitmap->data())))
-      PEFA_CASE_BRK(PEFA_INT16_CASE, new_columns.push_back(materialize_column<int16_t>(
-                                         *table.column(col_num), bitmap->data())))
-      PEFA_CASE_BRK(PEFA_INT32_CASE, new_columns.push_back(materialize_column<int32_t>(
-                                         *table.column(col_num), bitmap->data())))
-      PEFA_CASE_BRK(PEFA_INT64_CASE, new_columns.push_back(materialize_column<int64_t>(
-                                         *table.column(col_num), bitmap->data())))
-      PEFA_CASE_BRK(PEFA_UINT8_CASE, new_columns.push_back(materialize_column<uint8_t>(
-                                         *table.column(col_num), bitmap->data())))
-      PEFA_CASE_BRK(PEFA_UINT16_CASE, new_columns.push_back(materialize_column<uint16_t>(
-                                          *table.column(col_num), bitmap->data())))
-      PEFA_CASE_BRK(PEFA_UINT32_CASE, new_columns.push_back(materialize_column<uint32_t>(
-                                          *table.column(col_num), bitmap->data())))
-      PEFA_CASE_BRK(PEFA_UINT64_CASE, new_columns.push_back(materialize_column<uint64_t>(
-                                          *table.column(col_num), bitmap->data())))
-      PEFA_CASE_BRK(PEFA_FLOAT32_CASE, new_columns.push_back(materialize_column<float>(
-                                           *table.column(col_num), bitmap->data())))
-      PEFA_CASE_BRK(PEFA_FLOAT64_CASE, new_columns.push_back(materialize_column<double>(
-                                           *table.column(col_num), bitmap->data())))
+    auto &column = table.column(col_num);
+    if (is_taken_by_rows(*column->type())) {
+      if (!rows_decoded) {
+        selected_rows(*ctx->metadata, 0, table.num_rows(), rows);
+        rows_decoded = true;
+      }
+      new_columns.push_back(
+          take_rows(column, rows.data(), static_cast<int64_t>(rows.size()), taskflow));
+      continue;
+    }
+    switch (column->type()->id()) {
+      PEFA_CASE_BRK(PEFA_INT8_CASE, new_columns.push_back(
+                                     materialize_column<int8_t>(column, ranges, taskflow)))
+      PEFA_CASE_BRK(PEFA_INT16_CASE, new_columns.push_back(
+                                     materialize_column<int16_t>(column, ranges, taskflow)))
+      PEFA_CASE_BRK(PEFA_INT32_CASE, new_columns.push_back(
+                                     materialize_column<int32_t>(column, ranges, taskflow)))
+      PEFA_CASE_BRK(PEFA_INT64_CASE, new_columns.push_back(
+                                     materialize_column<int64_t>(column, ranges, taskflow)))
+      PEFA_CASE_BRK(PEFA_UINT8_CASE, new_columns.push_back(
+                                     materialize_column<uint8_t>(column, ranges, taskflow)))
+      PEFA_CASE_BRK(PEFA_UINT16_CASE, new_columns.push_back(
+                                     materialize_column<uint16_t>(column, ranges, taskflow)))
+      PEFA_CASE_BRK(PEFA_UINT32_CASE, new_columns.push_back(
+                                     materialize_column<uint32_t>(column, ranges, taskflow)))
+      PEFA_CASE_BRK(PEFA_UINT64_CASE, new_columns.push_back(
+                                     materialize_column<uint64_t>(column, ranges, taskflow)))
+      PEFA_CASE_BRK(PEFA_FLOAT32_CASE, new_columns.push_back(
+                                     materialize_column<float>(column, ranges, taskflow)))
+      PEFA_CASE_BRK(PEFA_FLOAT64_CASE, new_columns.push_back(
+                                     materialize_column<double>(column, ranges, taskflow)))
     default:
-      throw NotImplementedException("Type " + table.column(col_num)->type()->ToString() +
+      throw NotImplementedException("Type " + column->type()->ToString() +
                                     " is not supported yet");
     }
   }
-  return std::make_shared<ExecutionContext>(arrow::Table::Make(ctx->table->schema(), new_columns));
+  get_executor().run(taskflow).wait();
+  return std::make_shared<ExecutionContext>(arrow::Table::Make(ctx->table->schema(), new_columns),
+                                            ctx->config);
 }
 } // namespace pefa::execution
@@ -1,16 +1,48 @@
 #pragma once
 #include "execution_context.h"
 #include "pefa/query_compiler/expressions.h"
+#include "pefa/query_compiler/logical_plan.h"
 
 namespace pefa::execution {
 using namespace query_compiler;
 [[nodiscard]] std::shared_ptr<ExecutionContext>
 project(const std::shared_ptr<ExecutionContext> &ctx, std::vector<std::string> columns);
 
+// Computes every projection over rows of ctx. Column references are taken as is, other expressions
+// are evaluated by projection kernels into new arrays, one per segment of referenced columns.
+// Filter is kept, except that sparse selection is materialized before expressions are evaluated
+[[nodiscard]] std::shared_ptr<ExecutionContext>
+select(const std::shared_ptr<ExecutionContext> &ctx, const std::vector<Projection> &projections);
+
 [[nodiscard]] std::shared_ptr<ExecutionContext>
 materialize_filter(const std::shared_ptr<ExecutionContext> &ctx);
 
 [[nodiscard]] std::shared_ptr<ExecutionContext>
 generate_filter_bitmap(const std::shared_ptr<ExecutionContext> &ctx,
                        const std::shared_ptr<BooleanExpr> &expr);
+
+// Hash aggregation of rows, selected by filter and predicate, so filter is never materialized.
+// Without keys predicate is evaluated together with aggregates, so filter bitmap is not created
+[[nodiscard]] std::shared_ptr<ExecutionContext>
+aggregate(const std::shared_ptr<ExecutionContext> &ctx, const std::vector<std::string> &keys,
+          const std::vector<Aggregate> &aggregates,
+          const std::shared_ptr<BooleanExpr> &predicate = nullptr);
+
+// Radix hash join of rows of left and right, selected by their filters, on integer keys. Inner join
+// returns matching pairs of rows, whose columns are gathered only after matches are found. Semi
+// join returns left with filter of rows, which have a match
+[[nodiscard]] std::shared_ptr<ExecutionContext>
+join(const std::shared_ptr<ExecutionContext> &left, const std::shared_ptr<ExecutionContext> &right,
+     const std::string &left_key, const std::string &right_key, JoinType type);
+
+// Rows, selected by filter, ordered by numeric key with nulls last, and cut to limit, if it is not
+// negative. Small limits are served by per-thread bounded heaps, other sorts by parallel radix sort
+// of keys, so only rows of result are gathered from columns
+[[nodiscard]] std::shared_ptr<ExecutionContext> sort(const std::shared_ptr<ExecutionContext> &ctx,
+                                                     const std::string &key, bool ascending,
+                                                     int64_t limit = -1);
+
+// fills filter with non-null keys of rows, selected by filter of ctx
+void build_bloom_filter(const std::shared_ptr<ExecutionContext> &ctx, const std::string &key,
+                        utils::BloomFilter &filter);
 } // namespace pefa::execution
@@ -23,13 +23,15 @@ std::unique_ptr<ChunkMetadata> create_empty_chunk_metadata(const arrow::DataType
   case arrow::Type::DOUBLE:
     return std::make_unique<TypedChunkMetadata<double>>();
   case arrow::Type::STRING:
+  case arrow::Type::BINARY:
     return std::make_unique<TypedChunkMetadata<std::string>>();
   case arrow::Type::BOOL:
     return std::make_unique<TypedChunkMetadata<bool>>();
+  case arrow::Type::DICTIONARY:
+    return std::make_unique<DictionaryChunkMetadata>();
   case arrow::Type::NA:
     return std::make_unique<NullChunkMetadata>();
   case arrow::Type::HALF_FLOAT:
-  case arrow::Type::BINARY:
   case arrow::Type::FIXED_SIZE_BINARY:
   case arrow::Type::DATE32:
   case arrow::Type::DATE64:
@@ -41,7 +43,6 @@ std::unique_ptr<ChunkMetadata> create_empty_chunk_metadata(const arrow::DataType
   case arrow::Type::LIST:
   case arrow::Type::STRUCT:
   case arrow::Type::UNION:
-  case arrow::Type::DICTIONARY:
   case arrow::Type::MAP:
   case arrow::Type::EXTENSION:
   case arrow::Type::FIXED_SIZE_LIST:
@@ -53,8 +54,17 @@ std::unique_ptr<ChunkMetadata> create_empty_chunk_metadata(const arrow::DataType
   }
   return nullptr; // unreachable
 }
-ExecutionContext::ExecutionContext(std::shared_ptr<arrow::Table> _table)
-    : table(std::move(_table)) {
+
+void DictionaryChunkMetadata::compute(const arrow::Array &chunk) {
+  auto &dictionary = *static_cast<const arrow::DictionaryArray &>(chunk).dictionary();
+  values = create_empty_chunk_metadata(*dictionary.type());
+  values->ensure_computed(dictionary);
+}
+
+ExecutionContext::ExecutionContext(std::shared_ptr<arrow::Table> _table,
+                                   std::shared_ptr<const ExecutionConfig> _config)
+    : table(std::move(_table))
+    , config(std::move(_config)) {
   metadata = std::make_shared<TableMetadata>();
   metadata->filter_bitmap = nullptr;
   for (int i = 0; i < table->num_columns(); i++) {
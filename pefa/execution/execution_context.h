@@ -2,19 +2,95 @@
 #include "pefa/utils/exceptions.h"
 #include "pefa/utils/utils.h"
 
+#include <arrow/array.h>
 #include <arrow/table.h>
+#include <arrow/type_traits.h>
+#include <cmath>
 #include <memory>
+#include <mutex>
+#include <string>
+#include <type_traits>
 namespace pefa::execution {
 struct ChunkMetadata {
+  int64_t length = 0;
+  int64_t null_count = 0;
+
+  // statistics are computed on the first call, so chunks, which are never filtered, cost nothing
+  // Safe to call from several threads at once
+  void ensure_computed(const arrow::Array &chunk) {
+    std::call_once(m_computed, [&] {
+      length = chunk.length();
+      null_count = chunk.null_count();
+      compute(chunk);
+    });
+  }
+
   virtual ~ChunkMetadata() = default;
+
+protected:
+  virtual void compute(const arrow::Array &chunk) = 0;
+
+private:
+  std::once_flag m_computed;
 };
 
-struct NullChunkMetadata : ChunkMetadata {};
+struct NullChunkMetadata : ChunkMetadata {
+protected:
+  void compute(const arrow::Array &chunk) override {}
+};
 
 template <typename T>
 struct TypedChunkMetadata : ChunkMetadata {
-  T min;
-  T max;
+  T min{};
+  T max{};
+  // number of values, accounted in min and max. Nulls and NaNs are not accounted, as no comparison
+  // is true for them
+  int64_t value_count = 0;
+
+protected:
+  void compute(const arrow::Array &chunk) override {
+    // utf8 and binary chunks share metadata, as both are compared bytewise
+    using ArrayType = std::conditional_t<std::is_same_v<T, std::string>, arrow::BinaryArray,
+                                         typename arrow::CTypeTraits<T>::ArrayType>;
+    auto &array = static_cast<const ArrayType &>(chunk);
+    for (int64_t i = 0; i < array.length(); i++) {
+      if (array.IsNull(i)) {
+        continue;
+      }
+      if constexpr (std::is_same_v<T, std::string>) {
+        auto value = array.GetView(i);
+        if (value_count == 0 || value < min) {
+          min = std::string(value);
+        }
+        if (value_count == 0 || max < value) {
+          max = std::string(value);
+        }
+      } else {
+        auto value = array.Value(i);
+        if constexpr (std::is_floating_point_v<T>) {
+          if (std::isnan(value)) {
+            continue;
+          }
+        }
+        if (value_count == 0 || value < min) {
+          min = value;
+        }
+        if (value_count == 0 || max < value) {
+          max = value;
+        }
+      }
+      value_count++;
+    }
+  }
+};
+
+// Statistics of dictionary-encoded chunk are statistics of its dictionary, which holds every value
+// of the chunk, but may hold unused values too. null_count of chunk itself counts null indices
+struct DictionaryChunkMetadata : ChunkMetadata {
+  std::unique_ptr<ChunkMetadata> values;
+
+protected:
+  void compute(const arrow::Array &chunk) override;
 };
 
 struct ColumnMetadata {
@@ -24,12 +100,40 @@ struct ColumnMetadata {
 
 struct TableMetadata {
   std::vector<std::shared_ptr<ColumnMetadata>> columns;
+  // Rows selected by filters, which are not materialized yet. At most one of them is set:
+  // filter_bitmap for dense selections, selection_vector (UInt32Array or UInt64Array of sorted row
+  // ids) for sparse ones
   std::shared_ptr<arrow::Buffer> filter_bitmap;
+  std::shared_ptr<arrow::Array> selection_vector;
+};
+
+enum class FilterStrategy {
+  // whole expression is evaluated by a single fused kernel in one pass over data
+  FUSED,
+  // AND/OR operands are evaluated one by one in order of their estimated selectivity and cost,
+  // skipping 64-row words, which are already decided by previous operands
+  SHORT_CIRCUIT,
+};
+
+struct ExecutionConfig {
+  FilterStrategy filter_strategy = FilterStrategy::FUSED;
+  // skip filter kernel for chunks, where expression is decided by min/max of chunk
+  bool use_zone_maps = true;
+  // selection is kept as sorted row ids instead of bitmap, when at most this fraction of rows is
+  // selected, so following filters and materialization touch only selected rows
+  double selection_vector_ratio = 1.0 / 64;
+  // bitmaps of smaller tables are cheap anyway and are always kept
+  int64_t selection_vector_min_rows = 1 << 16;
+  // join fills bloom filter over keys of right side, which filters its input before probing
+  bool use_runtime_filters = true;
 };
 
 struct ExecutionContext {
   std::shared_ptr<arrow::Table> table;
   std::shared_ptr<TableMetadata> metadata;
-  explicit ExecutionContext(std::shared_ptr<arrow::Table> table);
+  std::shared_ptr<const ExecutionConfig> config;
+  explicit ExecutionContext(std::shared_ptr<arrow::Table> table,
+                            std::shared_ptr<const ExecutionConfig> config =
+                                std::make_shared<const ExecutionConfig>());
 };
 } // namespace pefa::execution
\ No newline at end of file
@@ -0,0 +1,70 @@
+#include "hash_table.h"
+
+#include <cstring>
+#include <limits>
+#include <pefa/utils/exceptions.h>
+#include <utility>
+
+namespace pefa::execution {
+GroupHashTable::GroupHashTable(size_t key_width, size_t capacity)
+    : m_key_width(key_width) {
+  size_t slots = 16;
+  while (slots < capacity * 2) {
+    slots *= 2;
+  }
+  m_slots.assign(slots, Slot{0, -1});
+}
+
+int32_t GroupHashTable::find_or_insert(const uint64_t *key, uint64_t hash) {
+  auto tag = static_cast<uint32_t>(hash >> 32);
+  auto mask = m_slots.size() - 1;
+  for (auto pos = hash & mask;; pos = (pos + 1) & mask) {
+    auto &slot = m_slots[pos];
+    if (slot.group < 0) {
+      if (m_size >= static_cast<size_t>(std::numeric_limits<int32_t>::max())) {
+        throw NotImplementedException("Aggregation into more than 2^31 groups is not supported");
+      }
+      auto group = static_cast<int32_t>(m_size++);
+      slot = Slot{tag, group};
+      m_keys.insert(m_keys.end(), key, key + m_key_width);
+      // load factor is kept at most 1/2, so probe sequences stay short
+      if (m_size * 2 > m_slots.size()) {
+        grow();
+      }
+      return group;
+    }
+    if (slot.hash == tag &&
+        std::memcmp(this->key(slot.group), key, m_key_width * sizeof(uint64_t)) == 0) {
+      return slot.group;
+    }
+  }
+}
+
+uint64_t GroupHashTable::hash(const uint64_t *key, size_t width) {
+  // every word is mixed with multiply-xorshift, so keys, which differ only in high bits, still
+  // get different low bits, which select slot
+  uint64_t hash = 0x9e3779b97f4a7c15ULL;
+  for (size_t i = 0; i < width; i++) {
+    hash = (hash ^ key[i]) * 0xbf58476d1ce4e5b9ULL;
+    hash ^= hash >> 31;
+  }
+  hash *= 0x94d049bb133111ebULL;
+  return hash ^ (hash >> 29);
+}
+
+void GroupHashTable::grow() {
+  // slots are rebuilt from stored keys, whose hashes are recomputed, as only their upper halves
+  // are kept in slots
+  std::vector<Slot> slots(m_slots.size() * 2, Slot{0, -1});
+  auto mask = slots.size() - 1;
+  for (size_t group = 0; group < m_size; group++) {
+    auto hash = GroupHashTable::hash(key(static_cast<int32_t>(group)), m_key_width);
+    auto pos = hash & mask;
+    while (slots[pos].group >= 0) {
+      pos = (pos + 1) & mask;
+    }
+    slots[pos] = Slot{static_cast<uint32_t>(hash >> 32), static_cast<int32_t>(group)};
+  }
+  m_slots = std::move(slots);
+}
+} // namespace pefa::execution
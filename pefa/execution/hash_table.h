@@ -0,0 +1,46 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace pefa::execution {
+// Open addressing hash table with linear probing, which maps grouping keys to dense group ids in
+// order of their first appearance. Key is a fixed number of 64-bit words, so keys of any fixed
+// width types are compared word by word. Slots keep only the upper half of hash and group id,
+// so 8 slots share a cache line and most mismatches are rejected without touching keys
+class GroupHashTable {
+private:
+  struct Slot {
+    uint32_t hash;
+    int32_t group; // -1 for empty slot
+  };
+
+  size_t m_key_width;
+  std::vector<uint64_t> m_keys; // key of group g is stored in words [g * width, (g + 1) * width)
+  std::vector<Slot> m_slots;
+  size_t m_size = 0;
+
+public:
+  explicit GroupHashTable(size_t key_width, size_t capacity = 1024);
+
+  // returns group of key, inserting new group if there is no such key yet
+  [[nodiscard]] int32_t find_or_insert(const uint64_t *key, uint64_t hash);
+
+  [[nodiscard]] size_t size() const {
+    return m_size;
+  }
+
+  [[nodiscard]] size_t key_width() const {
+    return m_key_width;
+  }
+
+  [[nodiscard]] const uint64_t *key(int32_t group) const {
+    return m_keys.data() + group * m_key_width;
+  }
+
+  [[nodiscard]] static uint64_t hash(const uint64_t *key, size_t width);
+
+private:
+  void grow();
+};
+} // namespace pefa::execution
@@ -0,0 +1,305 @@
+#include "execution.h"
+#include "execution_context.h"
+#include "row_selection.h"
+#include "table_segments.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <arrow/api.h>
+#include <memory>
+#include <pefa/utils/bloom_filter.h>
+#include <pefa/utils/exceptions.h>
+#include <pefa/utils/utils.h>
+#include <utility>
+
+namespace pefa::execution {
+namespace {
+// rows are read by pieces of at most this length, so even a single chunk is split between threads
+constexpr int64_t piece_length = 1 << 16;
+// build side is split into partitions of about this number of rows, so hash table of every
+// partition stays in L2 cache while it is probed
+constexpr int64_t partition_rows = 1 << 13;
+constexpr int max_radix_bits = 12;
+
+uint64_t hash_key(int64_t key) {
+  auto hash = static_cast<uint64_t>(key) * 0x9e3779b97f4a7c15ULL;
+  return hash ^ (hash >> 32);
+}
+
+// partitions are selected by upper bits of hash, and buckets inside partition by lower ones
+size_t partition_of(uint64_t hash, int bits) {
+  return bits == 0 ? 0 : static_cast<size_t>(hash >> (64 - bits));
+}
+
+std::shared_ptr<arrow::ChunkedArray> key_column(const ExecutionContext &ctx,
+                                                const std::string &name) {
+  auto index = ctx.table->schema()->GetFieldIndex(name);
+  if (index < 0) {
+    throw ColumnNotFoundException(name);
+  }
+  auto column = ctx.table->column(index);
+  switch (column->type()->id()) {
+  PEFA_INTEGRAL_CASE
+    break;
+  default:
+    throw NotImplementedException("Join on keys of type " + column->type()->ToString() +
+                                  " is not supported yet");
+  }
+  return column;
+}
+
+// Keys and positions of rows of one side, which are selected by filter and have non-null keys.
+// Rows of partition p are located at [offsets[p], offsets[p + 1])
+struct PartitionedKeys {
+  std::vector<int64_t> keys;
+  std::vector<int64_t> rows;
+  std::vector<int64_t> offsets;
+};
+
+// Radix partitioning in two parallel passes over pieces of column: the first one collects keys
+// of selected rows and counts them per partition, the second one scatters them to positions,
+// which are known from counts of previous pieces, so no locks are needed
+PartitionedKeys partition(const ExecutionContext &ctx, const std::string &name, int bits) {
+  auto column = key_column(ctx, name);
+
+  struct Piece {
+    size_t segment;
+    int64_t offset; // relative to segment
+    int64_t length;
+  };
+  auto segments = split_into_segments({column});
+  std::vector<Piece> pieces;
+  for (size_t i = 0; i < segments.size(); i++) {
+    for (int64_t offset = 0; offset < segments[i].length; offset += piece_length) {
+      pieces.push_back({i, offset, std::min(piece_length, segments[i].length - offset)});
+    }
+  }
+
+  auto num_partitions = size_t{1} << bits;
+  std::vector<std::vector<int64_t>> piece_keys(pieces.size());
+  std::vector<std::vector<int64_t>> piece_rows(pieces.size());
+  std::vector<int64_t> counts(pieces.size() * num_partitions, 0);
+  tf::Taskflow count_taskflow;
+  count_taskflow.parallel_for(0, static_cast<int>(pieces.size()), 1, [&](int piece_num) {
+    auto &piece = pieces[piece_num];
+    auto &segment = segments[piece.segment];
+    auto &chunk = *segment.columns[0];
+    std::vector<int64_t> rows;
+    selected_rows(*ctx.metadata, segment.offset + piece.offset, piece.length, rows);
+    auto &keys = piece_keys[piece_num];
+    auto &ids = piece_rows[piece_num];
+    bool has_nulls = chunk.null_count() != 0;
+    visit_numeric_type(*chunk.type(), [&](auto tag) {
+      // unsigned keys above INT64_MAX are compared by their bits
+      auto values = chunk.data()->GetValues<decltype(tag)>(1);
+      for (auto row : rows) {
+        auto pos = piece.offset + row;
+        if (has_nulls && chunk.IsNull(pos)) {
+          continue;
+        }
+        keys.push_back(static_cast<int64_t>(values[pos]));
+        ids.push_back(segment.offset + pos);
+      }
+    });
+    auto piece_counts = counts.data() + piece_num * num_partitions;
+    for (auto key : keys) {
+      piece_counts[partition_of(hash_key(key), bits)]++;
+    }
+  });
+  get_executor().run(count_taskflow).wait();
+
+  // rows of every partition are ordered by pieces, so positions[piece][p] is the first position
+  // of rows of piece in partition p
+  PartitionedKeys result;
+  result.offsets.assign(num_partitions + 1, 0);
+  std::vector<int64_t> positions(counts.size());
+  for (size_t p = 0; p < num_partitions; p++) {
+    auto position = result.offsets[p];
+    for (size_t piece_num = 0; piece_num < pieces.size(); piece_num++) {
+      positions[piece_num * num_partitions + p] = position;
+      position += counts[piece_num * num_partitions + p];
+    }
+    result.offsets[p + 1] = position;
+  }
+  result.keys.resize(result.offsets.back());
+  result.rows.resize(result.offsets.back());
+
+  tf::Taskflow scatter_taskflow;
+  scatter_taskflow.parallel_for(0, static_cast<int>(pieces.size()), 1, [&](int piece_num) {
+    auto piece_positions = positions.data() + piece_num * num_partitions;
+    auto &keys = piece_keys[piece_num];
+    auto &ids = piece_rows[piece_num];
+    for (size_t i = 0; i < keys.size(); i++) {
+      auto position = piece_positions[partition_of(hash_key(keys[i]), bits)]++;
+      result.keys[position] = keys[i];
+      result.rows[position] = ids[i];
+    }
+  });
+  get_executor().run(scatter_taskflow).wait();
+  return result;
+}
+
+// left with filter, which selects rows marked in matched
+std::shared_ptr<ExecutionContext> semi_join_result(const ExecutionContext &left,
+                                                   const std::vector<uint8_t> &matched) {
+  auto num_rows = left.table->num_rows();
+  auto bitmap = arrow::AllocateBitmap(num_rows).ValueOrDie();
+  auto data = bitmap->mutable_data();
+  auto num_bytes = (num_rows + 7) / 8;
+  const int64_t block_bytes = 1 << 13;
+  auto num_blocks = (num_bytes + block_bytes - 1) / block_bytes;
+  tf::Taskflow taskflow;
+  taskflow.parallel_for(0, static_cast<int>(num_blocks), 1, [&](int block) {
+    auto end = std::min(num_bytes, (block + 1) * block_bytes);
+    for (auto byte = block * block_bytes; byte < end; byte++) {
+      uint8_t value = 0;
+      for (auto row = byte * 8; row < std::min(num_rows, byte * 8 + 8); row++) {
+        value |= static_cast<uint8_t>(matched[row] << (7 - row % 8));
+      }
+      data[byte] = value;
+    }
+  });
+  get_executor().run(taskflow).wait();
+
+  auto res = std::make_shared<ExecutionContext>(left.table, left.config);
+  res->metadata->columns = left.metadata->columns;
+  res->metadata->filter_bitmap = std::move(bitmap);
+  return res;
+}
+
+// Gathers columns of both sides at matching rows. Right key is skipped, if it has the same name as
+// left key, as their values are equal
+std::shared_ptr<ExecutionContext>
+inner_join_result(const ExecutionContext &left, const ExecutionContext &right,
+                  const std::string &left_key, const std::string &right_key,
+                  const std::vector<std::vector<int64_t>> &left_rows,
+                  const std::vector<std::vector<int64_t>> &right_rows) {
+  std::vector<int64_t> offsets(1, 0);
+  for (auto &rows : left_rows) {
+    offsets.push_back(offsets.back() + static_cast<int64_t>(rows.size()));
+  }
+  auto count = offsets.back();
+  std::vector<int64_t> left_ids(count);
+  std::vector<int64_t> right_ids(count);
+  tf::Taskflow copy_taskflow;
+  copy_taskflow.parallel_for(0, static_cast<int>(left_rows.size()), 1, [&](int p) {
+    std::copy(left_rows[p].begin(), left_rows[p].end(), left_ids.begin() + offsets[p]);
+    std::copy(right_rows[p].begin(), right_rows[p].end(), right_ids.begin() + offsets[p]);
+  });
+  get_executor().run(copy_taskflow).wait();
+
+  std::vector<std::shared_ptr<arrow::Field>> fields;
+  std::vector<std::shared_ptr<arrow::ChunkedArray>> columns;
+  tf::Taskflow taskflow;
+  auto take = [&](const arrow::Table &table, const std::vector<int64_t> &ids, bool is_right) {
+    for (int i = 0; i < table.num_columns(); i++) {
+      auto &field = table.schema()->field(i);
+      if (is_right && field->name() == right_key && right_key == left_key) {
+        continue;
+      }
+      if (is_right && left.table->schema()->GetFieldIndex(field->name()) >= 0) {
+        throw NotImplementedException("Column " + field->name() +
+                                      " is present in both inputs of join");
+      }
+      auto &column = table.column(i);
+      fields.push_back(field);
+      columns.push_back(take_rows(column, ids.data(), count, taskflow));
+    }
+  };
+  take(*left.table, left_ids, false);
+  take(*right.table, right_ids, true);
+  get_executor().run(taskflow).wait();
+  return std::make_shared<ExecutionContext>(
+      arrow::Table::Make(arrow::schema(fields), columns, count), left.config);
+}
+} // namespace
+
+std::shared_ptr<ExecutionContext> join(const std::shared_ptr<ExecutionContext> &left,
+                                       const std::shared_ptr<ExecutionContext> &right,
+                                       const std::string &left_key, const std::string &right_key,
+                                       JoinType type) {
+  // right side is built into hash tables, so its size defines number of partitions
+  auto &right_metadata = *right->metadata;
+  auto build_rows = right_metadata.selection_vector ? right_metadata.selection_vector->length()
+                                                    : right->table->num_rows();
+  int bits = 0;
+  while (bits < max_radix_bits && (build_rows >> bits) > partition_rows) {
+    bits++;
+  }
+  auto build = partition(*right, right_key, bits);
+  auto probe = partition(*left, left_key, bits);
+  auto num_partitions = size_t{1} << bits;
+
+  // partitions are joined independently. Inner join collects pairs of matching rows of every
+  // partition, semi join marks left rows, which are probed exactly once
+  std::vector<std::vector<int64_t>> left_rows(num_partitions);
+  std::vector<std::vector<int64_t>> right_rows(num_partitions);
+  std::vector<uint8_t> matched(type == JoinType::SEMI ? left->table->num_rows() : 0, 0);
+  tf::Taskflow taskflow;
+  taskflow.parallel_for(0, static_cast<int>(num_partitions), 1, [&](int p) {
+    auto build_begin = build.offsets[p];
+    auto build_size = build.offsets[p + 1] - build_begin;
+    if (build_size == 0 || probe.offsets[p] == probe.offsets[p + 1]) {
+      return;
+    }
+    // chained hash table over positions of build rows inside partition
+    size_t num_buckets = 1;
+    while (num_buckets < static_cast<size_t>(build_size) * 2) {
+      num_buckets *= 2;
+    }
+    auto mask = num_buckets - 1;
+    std::vector<int64_t> heads(num_buckets, -1);
+    std::vector<int64_t> next(build_size);
+    auto build_keys = build.keys.data() + build_begin;
+    for (int64_t i = 0; i < build_size; i++) {
+      auto bucket = hash_key(build_keys[i]) & mask;
+      next[i] = heads[bucket];
+      heads[bucket] = i;
+    }
+    for (auto j = probe.offsets[p]; j < probe.offsets[p + 1]; j++) {
+      auto key = probe.keys[j];
+      for (auto i = heads[hash_key(key) & mask]; i >= 0; i = next[i]) {
+        if (build_keys[i] != key) {
+          continue;
+        }
+        if (type == JoinType::SEMI) {
+          matched[probe.rows[j]] = 1;
+          break;
+        }
+        left_rows[p].push_back(probe.rows[j]);
+        right_rows[p].push_back(build.rows[build_begin + i]);
+      }
+    }
+  });
+  get_executor().run(taskflow).wait();
+
+  if (type == JoinType::SEMI) {
+    return semi_join_result(*left, matched);
+  }
+  return inner_join_result(*left, *right, left_key, right_key, left_rows, right_rows);
+}
+
+void build_bloom_filter(const std::shared_ptr<ExecutionContext> &ctx, const std::string &key,
+                        utils::BloomFilter &filter) {
+  auto column = key_column(*ctx, key);
+  auto &metadata = *ctx->metadata;
+  filter.reset(metadata.selection_vector ? metadata.selection_vector->length()
+                                         : ctx->table->num_rows());
+  // build side is smaller than probe side, and inserts are cheap compared to partitioning, so
+  // filter is filled by a single thread
+  std::vector<int64_t> rows;
+  for (auto &segment : split_into_segments({column})) {
+    auto &chunk = *segment.columns[0];
+    selected_rows(metadata, segment.offset, segment.length, rows);
+    bool has_nulls = chunk.null_count() != 0;
+    visit_numeric_type(*chunk.type(), [&](auto tag) {
+      auto values = chunk.data()->GetValues<decltype(tag)>(1);
+      for (auto row : rows) {
+        if (!has_nulls || !chunk.IsNull(row)) {
+          filter.insert(static_cast<int64_t>(values[row]));
+        }
+      }
+    });
+  }
+}
+} // namespace pefa::execution
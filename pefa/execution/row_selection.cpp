@@ -0,0 +1,341 @@
+#include "row_selection.h"
+
+#include "compaction.h"
+#include "table_segments.h"
+
+#include <algorithm>
+#include <arrow/util/bit_util.h>
+#include <cstring>
+#include <limits>
+#include <memory>
+
+namespace pefa::execution {
+namespace {
+template <typename IdType>
+void append_selected_ids(const arrow::Array &selection_vector, int64_t offset, int64_t length,
+                         std::vector<int64_t> &rows) {
+  auto ids = selection_vector.data()->GetValues<IdType>(1);
+  auto end = ids + selection_vector.length();
+  for (auto it = std::lower_bound(ids, end, static_cast<IdType>(offset));
+       it != end && static_cast<int64_t>(*it) < offset + length; it++) {
+    rows.push_back(static_cast<int64_t>(*it) - offset);
+  }
+}
+template <typename T>
+std::shared_ptr<arrow::ChunkedArray> take_column(const std::shared_ptr<arrow::ChunkedArray> &column,
+                                                 const int64_t *ids, int64_t count,
+                                                 tf::Taskflow &taskflow) {
+  // multiple of 8, so neighbour blocks do not share output validity bytes
+  const int64_t block_size = 1 << 16;
+  // chunk_offsets[i] is position of the first row of chunk i, followed by number of rows
+  auto chunk_offsets = std::make_shared<std::vector<int64_t>>(1, 0);
+  for (auto &chunk : column->chunks()) {
+    chunk_offsets->push_back(chunk_offsets->back() + chunk->length());
+  }
+
+  auto buffer = arrow::AllocateBuffer(sizeof(T) * count).ValueOrDie();
+  auto data_out = reinterpret_cast<T *>(buffer->mutable_data());
+  bool has_nulls = column->null_count() != 0;
+  std::shared_ptr<arrow::Buffer> validity_buffer;
+  if (has_nulls) {
+    validity_buffer = arrow::AllocateBitmap(count).ValueOrDie();
+  }
+  auto validity_out = has_nulls ? validity_buffer->mutable_data() : nullptr;
+
+  for (int64_t begin = 0; begin < count; begin += block_size) {
+    auto end = std::min(count, begin + block_size);
+    taskflow.emplace([column, chunk_offsets, ids, begin, end, data_out, validity_out] {
+      auto &offsets = *chunk_offsets;
+      size_t chunk_num = 0;
+      const arrow::Array *chunk = nullptr;
+      const T *values = nullptr;
+      for (auto pos = begin; pos < end; pos++) {
+        auto id = ids[pos];
+        // matches of neighbour rows are often located in the same chunk
+        if (!chunk || id < offsets[chunk_num] || id >= offsets[chunk_num + 1]) {
+          chunk_num = std::upper_bound(offsets.begin(), offsets.end(), id) - offsets.begin() - 1;
+          chunk = column->chunk(static_cast<int>(chunk_num)).get();
+          values = chunk->data()->GetValues<T>(1);
+        }
+        auto row = id - offsets[chunk_num];
+        data_out[pos] = values[row];
+        if (validity_out) {
+          arrow::BitUtil::SetBitTo(validity_out, pos, chunk->IsValid(row));
+        }
+      }
+    });
+  }
+
+  auto taken = arrow::MakeArray(
+      arrow::ArrayData::Make(column->type(), count,
+                             {std::move(validity_buffer),
+                              std::shared_ptr<arrow::Buffer>(std::move(buffer))},
+                             has_nulls ? arrow::kUnknownNullCount : 0));
+  std::vector<std::shared_ptr<arrow::Array>> new_column;
+  for (int64_t pos = 0; pos < count; pos += chunk_size) {
+    new_column.push_back(taken->Slice(pos, std::min(chunk_size, count - pos)));
+  }
+  if (new_column.empty()) {
+    new_column.push_back(taken);
+  }
+  return std::make_shared<arrow::ChunkedArray>(new_column);
+}
+
+// Utf8 and binary values are taken in two passes: offsets of taken values are computed right
+// away, as they give size of data buffer, and then tasks copy values and validity
+std::shared_ptr<arrow::ChunkedArray>
+take_binary_column(const std::shared_ptr<arrow::ChunkedArray> &column, const int64_t *ids,
+                   int64_t count, tf::Taskflow &taskflow) {
+  // multiple of 8, so neighbour blocks do not share output validity bytes
+  const int64_t block_size = 1 << 16;
+  auto chunk_offsets = std::make_shared<std::vector<int64_t>>(1, 0);
+  for (auto &chunk : column->chunks()) {
+    chunk_offsets->push_back(chunk_offsets->back() + chunk->length());
+  }
+  // chunk, containing row id, and position of row in it. Neighbour ids are often in the same chunk
+  auto locate = [chunk_offsets, column](int64_t id, size_t &chunk_num,
+                                        const arrow::BinaryArray *&chunk) {
+    auto &offsets = *chunk_offsets;
+    if (!chunk || id < offsets[chunk_num] || id >= offsets[chunk_num + 1]) {
+      chunk_num = std::upper_bound(offsets.begin(), offsets.end(), id) - offsets.begin() - 1;
+      chunk = static_cast<const arrow::BinaryArray *>(
+          column->chunk(static_cast<int>(chunk_num)).get());
+    }
+    return id - offsets[chunk_num];
+  };
+
+  auto offsets_buffer = arrow::AllocateBuffer(sizeof(int32_t) * (count + 1)).ValueOrDie();
+  auto offsets_out = reinterpret_cast<int32_t *>(offsets_buffer->mutable_data());
+  int64_t total_length = 0;
+  {
+    size_t chunk_num = 0;
+    const arrow::BinaryArray *chunk = nullptr;
+    offsets_out[0] = 0;
+    for (int64_t pos = 0; pos < count; pos++) {
+      auto row = locate(ids[pos], chunk_num, chunk);
+      total_length += chunk->value_length(row);
+      if (total_length > std::numeric_limits<int32_t>::max()) {
+        throw NotImplementedException("Taking more than 2GB of " + column->type()->ToString() +
+                                      " values is not supported");
+      }
+      offsets_out[pos + 1] = static_cast<int32_t>(total_length);
+    }
+  }
+
+  auto data_buffer = arrow::AllocateBuffer(total_length).ValueOrDie();
+  auto data_out = data_buffer->mutable_data();
+  bool has_nulls = column->null_count() != 0;
+  std::shared_ptr<arrow::Buffer> validity_buffer;
+  if (has_nulls) {
+    validity_buffer = arrow::AllocateBitmap(count).ValueOrDie();
+  }
+  auto validity_out = has_nulls ? validity_buffer->mutable_data() : nullptr;
+
+  for (int64_t begin = 0; begin < count; begin += block_size) {
+    auto end = std::min(count, begin + block_size);
+    taskflow.emplace([locate, ids, begin, end, offsets_out, data_out, validity_out] {
+      size_t chunk_num = 0;
+      const arrow::BinaryArray *chunk = nullptr;
+      for (auto pos = begin; pos < end; pos++) {
+        auto row = locate(ids[pos], chunk_num, chunk);
+        int32_t length = 0;
+        auto value = chunk->GetValue(row, &length);
+        std::memcpy(data_out + offsets_out[pos], value, length);
+        if (validity_out) {
+          arrow::BitUtil::SetBitTo(validity_out, pos, chunk->IsValid(row));
+        }
+      }
+    });
+  }
+
+  auto taken = arrow::MakeArray(arrow::ArrayData::Make(
+      column->type(), count,
+      {std::move(validity_buffer), std::shared_ptr<arrow::Buffer>(std::move(offsets_buffer)),
+       std::shared_ptr<arrow::Buffer>(std::move(data_buffer))},
+      has_nulls ? arrow::kUnknownNullCount : 0));
+  std::vector<std::shared_ptr<arrow::Array>> new_column;
+  for (int64_t pos = 0; pos < count; pos += chunk_size) {
+    new_column.push_back(taken->Slice(pos, std::min(chunk_size, count - pos)));
+  }
+  if (new_column.empty()) {
+    new_column.push_back(taken);
+  }
+  return std::make_shared<arrow::ChunkedArray>(new_column);
+}
+
+// codes of chunk, which refer to unified dictionary by transpose map of chunk dictionary. Rows,
+// whose code refers to null of chunk dictionary, are null, as unified dictionary has no nulls
+template <typename T>
+std::shared_ptr<arrow::Array> transpose_codes(const arrow::DictionaryArray &chunk,
+                                              const int32_t *transpose) {
+  auto length = chunk.length();
+  auto &indices = *chunk.indices();
+  auto &dictionary = *chunk.dictionary();
+  auto codes = indices.data()->GetValues<T>(1);
+  auto buffer = arrow::AllocateBuffer(sizeof(T) * length).ValueOrDie();
+  auto codes_out = reinterpret_cast<T *>(buffer->mutable_data());
+  bool has_nulls = indices.null_count() != 0 || dictionary.null_count() != 0;
+  std::shared_ptr<arrow::Buffer> validity_buffer;
+  if (has_nulls) {
+    validity_buffer = arrow::AllocateBitmap(length).ValueOrDie();
+  }
+  for (int64_t i = 0; i < length; i++) {
+    // codes of null rows may be arbitrary, so they are not looked up
+    bool valid = indices.IsValid(i) && dictionary.IsValid(static_cast<int64_t>(codes[i]));
+    codes_out[i] = valid ? static_cast<T>(transpose[static_cast<int64_t>(codes[i])]) : 0;
+    if (has_nulls) {
+      arrow::BitUtil::SetBitTo(validity_buffer->mutable_data(), i, valid);
+    }
+  }
+  return arrow::MakeArray(
+      arrow::ArrayData::Make(indices.type(), length,
+                             {std::move(validity_buffer),
+                              std::shared_ptr<arrow::Buffer>(std::move(buffer))},
+                             has_nulls ? arrow::kUnknownNullCount : 0));
+}
+
+// Dictionary values are taken by their codes, which keep dictionary of their chunk. If chunks do
+// not share dictionary, their codes can not be mixed. For ascending ids, as they are for filters,
+// every input chunk with taken rows gives output chunks with its dictionary. Other ids, as of sort
+// and join, take codes, which are remapped to dictionary unified from all chunks
+std::shared_ptr<arrow::ChunkedArray>
+take_dictionary_column(const std::shared_ptr<arrow::ChunkedArray> &column, const int64_t *ids,
+                       int64_t count, tf::Taskflow &taskflow) {
+  auto index_type = static_cast<const arrow::DictionaryType &>(*column->type()).index_type();
+  std::vector<std::shared_ptr<arrow::Array>> indices;
+  std::vector<std::shared_ptr<arrow::Array>> dictionaries;
+  for (auto &chunk : column->chunks()) {
+    auto &dictionary_chunk = static_cast<const arrow::DictionaryArray &>(*chunk);
+    indices.push_back(dictionary_chunk.indices());
+    dictionaries.push_back(dictionary_chunk.dictionary());
+  }
+  if (dictionaries.empty()) {
+    return std::make_shared<arrow::ChunkedArray>(arrow::ArrayVector{}, column->type());
+  }
+  auto indices_column = std::make_shared<arrow::ChunkedArray>(indices, index_type);
+  std::vector<std::shared_ptr<arrow::Array>> new_column;
+  auto take_codes = [&](const int64_t *range_ids, int64_t range_count,
+                        const std::shared_ptr<arrow::Array> &dictionary) {
+    auto codes = visit_numeric_type(*index_type, [&](auto tag) {
+      return take_column<decltype(tag)>(indices_column, range_ids, range_count, taskflow);
+    });
+    for (auto &chunk : codes->chunks()) {
+      new_column.push_back(
+          std::make_shared<arrow::DictionaryArray>(column->type(), chunk, dictionary));
+    }
+  };
+
+  auto &first = dictionaries.front();
+  bool shared = std::all_of(dictionaries.begin(), dictionaries.end(), [&](auto &dictionary) {
+    return dictionary->data() == first->data() || dictionary->Equals(*first);
+  });
+  if (shared) {
+    take_codes(ids, count, first);
+    return std::make_shared<arrow::ChunkedArray>(new_column);
+  }
+  if (!std::is_sorted(ids, ids + count)) {
+    auto value_type = static_cast<const arrow::DictionaryType &>(*column->type()).value_type();
+    std::unique_ptr<arrow::DictionaryUnifier> unifier;
+    auto status = arrow::DictionaryUnifier::Make(arrow::default_memory_pool(), value_type,
+                                                 &unifier);
+    std::vector<std::shared_ptr<arrow::Buffer>> transposes(dictionaries.size());
+    for (size_t i = 0; status.ok() && i < dictionaries.size(); i++) {
+      status = unifier->Unify(*dictionaries[i], &transposes[i]);
+    }
+    std::shared_ptr<arrow::DataType> unified_index_type;
+    std::shared_ptr<arrow::Array> unified;
+    if (status.ok()) {
+      status = unifier->GetResult(&unified_index_type, &unified);
+    }
+    if (!status.ok()) {
+      throw NotImplementedException("Unifying dictionaries of " + column->type()->ToString() +
+                                    " column failed: " + status.ToString());
+    }
+    std::vector<std::shared_ptr<arrow::Array>> unified_indices;
+    visit_numeric_type(*index_type, [&](auto tag) {
+      using T = decltype(tag);
+      if (unified->length() - 1 > static_cast<int64_t>(std::numeric_limits<T>::max())) {
+        throw NotImplementedException("Unified dictionary of " + column->type()->ToString() +
+                                      " column does not fit its index type");
+      }
+      for (size_t i = 0; i < indices.size(); i++) {
+        unified_indices.push_back(transpose_codes<T>(
+            static_cast<const arrow::DictionaryArray &>(*column->chunk(static_cast<int>(i))),
+            reinterpret_cast<const int32_t *>(transposes[i]->data())));
+      }
+    });
+    indices_column = std::make_shared<arrow::ChunkedArray>(unified_indices, index_type);
+    take_codes(ids, count, unified);
+    return std::make_shared<arrow::ChunkedArray>(new_column);
+  }
+  // ids of chunk form a range, and codes are still taken by ids of the whole column
+  int64_t chunk_end = 0;
+  auto range_begin = ids;
+  for (size_t chunk_num = 0; chunk_num < indices.size(); chunk_num++) {
+    chunk_end += indices[chunk_num]->length();
+    auto range_end = std::lower_bound(range_begin, ids + count, chunk_end);
+    if (range_end != range_begin) {
+      take_codes(range_begin, range_end - range_begin, dictionaries[chunk_num]);
+    }
+    range_begin = range_end;
+  }
+  if (new_column.empty()) {
+    take_codes(ids, 0, first);
+  }
+  return std::make_shared<arrow::ChunkedArray>(new_column);
+}
+} // namespace
+
+std::shared_ptr<arrow::ChunkedArray> take_rows(const std::shared_ptr<arrow::ChunkedArray> &column,
+                                               const int64_t *ids, int64_t count,
+                                               tf::Taskflow &taskflow) {
+  if (arrow::is_binary_like(column->type()->id())) {
+    return take_binary_column(column, ids, count, taskflow);
+  }
+  if (column->type()->id() == arrow::Type::DICTIONARY) {
+    return take_dictionary_column(column, ids, count, taskflow);
+  }
+  return visit_numeric_type(*column->type(), [&](auto tag) {
+    return take_column<decltype(tag)>(column, ids, count, taskflow);
+  });
+}
+
+void selected_rows(const TableMetadata &metadata, int64_t offset, int64_t length,
+                   std::vector<int64_t> &rows) {
+  rows.clear();
+  if (metadata.selection_vector) {
+    switch (metadata.selection_vector->type_id()) {
+      PEFA_CASE_BRK(PEFA_UINT32_CASE, append_selected_ids<uint32_t>(*metadata.selection_vector,
+                                                                    offset, length, rows))
+      PEFA_CASE_BRK(PEFA_UINT64_CASE, append_selected_ids<uint64_t>(*metadata.selection_vector,
+                                                                    offset, length, rows))
+    default:
+      throw UnreachableException();
+    }
+    return;
+  }
+  if (!metadata.filter_bitmap) {
+    for (int64_t i = 0; i < length; i++) {
+      rows.push_back(i);
+    }
+    return;
+  }
+  auto bitmap = metadata.filter_bitmap->data();
+  auto end = offset + length;
+  for (auto row = offset; row < end;) {
+    // whole bitmap bytes are decoded with lookup table, so zero bytes cost a single load
+    if (row % 8 == 0 && row + 8 <= end) {
+      auto byte = bitmap[row / 8];
+      for (int k = 0; k < selection_table.counts[byte]; k++) {
+        rows.push_back(row - offset + selection_table.indices[byte][k]);
+      }
+      row += 8;
+    } else {
+      if (is_selected(bitmap, row)) {
+        rows.push_back(row - offset);
+      }
+      row++;
+    }
+  }
+}
+} // namespace pefa::execution
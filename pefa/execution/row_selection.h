@@ -0,0 +1,41 @@
+#pragma once
+#include "execution_context.h"
+
+#include <arrow/api.h>
+#include <cstdint>
+#include <pefa/utils/exceptions.h>
+#include <pefa/utils/utils.h>
+#include <taskflow/taskflow.hpp>
+#include <vector>
+
+namespace pefa::execution {
+// calls fn with value of C type, which corresponds to fixed width numeric type
+template <typename Fn>
+auto visit_numeric_type(const arrow::DataType &type, Fn &&fn) {
+  switch (type.id()) {
+    PEFA_CASE_RET(PEFA_INT8_CASE, fn(int8_t{}))
+    PEFA_CASE_RET(PEFA_INT16_CASE, fn(int16_t{}))
+    PEFA_CASE_RET(PEFA_INT32_CASE, fn(int32_t{}))
+    PEFA_CASE_RET(PEFA_INT64_CASE, fn(int64_t{}))
+    PEFA_CASE_RET(PEFA_UINT8_CASE, fn(uint8_t{}))
+    PEFA_CASE_RET(PEFA_UINT16_CASE, fn(uint16_t{}))
+    PEFA_CASE_RET(PEFA_UINT32_CASE, fn(uint32_t{}))
+    PEFA_CASE_RET(PEFA_UINT64_CASE, fn(uint64_t{}))
+    PEFA_CASE_RET(PEFA_FLOAT32_CASE, fn(float{}))
+    PEFA_CASE_RET(PEFA_FLOAT64_CASE, fn(double{}))
+  default:
+    throw NotImplementedException("Type " + type.ToString() + " is not supported yet");
+  }
+}
+
+// positions of rows of [offset, offset + length), selected by filter, relative to offset
+void selected_rows(const TableMetadata &metadata, int64_t offset, int64_t length,
+                   std::vector<int64_t> &rows);
+
+// Allocates column, filled with values of rows ids[0], ..., ids[count - 1], which may go in any
+// order, and adds tasks filling it to taskflow. Resulting column should not be used before
+// taskflow is executed. Numeric, utf8, binary and dictionary columns are supported
+[[nodiscard]] std::shared_ptr<arrow::ChunkedArray>
+take_rows(const std::shared_ptr<arrow::ChunkedArray> &column, const int64_t *ids, int64_t count,
+          tf::Taskflow &taskflow);
+} // namespace pefa::execution
@@ -0,0 +1,94 @@
+#include "selectivity.h"
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+namespace pefa::execution {
+namespace {
+class SelectivityVisitor : public ExprVisitor {
+private:
+  double m_result = 1.0;
+
+public:
+  void visit(const PredicateExpr &expr) override {
+    expr.lhs->visit(*this);
+    auto lhs = m_result;
+    expr.rhs->visit(*this);
+    auto rhs = m_result;
+    if (expr.op == PredicateExpr::Op::AND) {
+      m_result = lhs * rhs;
+    } else {
+      m_result = lhs + rhs - lhs * rhs;
+    }
+  }
+
+  void visit(const CompareExpr &expr) override {
+    switch (expr.op) {
+    case CompareExpr::Op::EQ:
+      m_result = 0.1;
+      break;
+    case CompareExpr::Op::NEQ:
+      m_result = 0.9;
+      break;
+    case CompareExpr::Op::GT:
+    case CompareExpr::Op::LT:
+    case CompareExpr::Op::GE:
+    case CompareExpr::Op::LE:
+      m_result = 1.0 / 3;
+      break;
+    }
+  }
+
+  void visit(const BooleanConst &expr) override {
+    m_result = expr.value ? 1.0 : 0.0;
+  }
+
+  void visit(const BloomFilterExpr &expr) override {
+    m_result = 0.5;
+  }
+
+  void visit(const StringMatchExpr &expr) override {
+    m_result = 0.1;
+  }
+
+  // the same as OR of EQ comparisons, so list does not change its rank after rewrite
+  void visit(const InExpr &expr) override {
+    m_result = 1 - std::pow(0.9, static_cast<double>(expr.values.size()));
+  }
+
+  // range is bounded from both sides, so it is narrower than a single bound
+  void visit(const BetweenExpr &expr) override {
+    m_result = 0.25;
+  }
+
+  [[nodiscard]] double result() const {
+    return m_result;
+  }
+};
+} // namespace
+
+double estimate_selectivity(const BooleanExpr &expr) {
+  SelectivityVisitor visitor;
+  expr.visit(visitor);
+  return visitor.result();
+}
+
+double estimate_cost(const arrow::Schema &schema, const BooleanExpr &expr) {
+  std::vector<std::string> names;
+  referenced_columns(expr, names);
+  // every evaluation at least writes result bitmap
+  double cost = 1.0 / 8;
+  for (auto &name : names) {
+    auto field = schema.GetFieldByName(name);
+    if (auto type = field ? dynamic_cast<const arrow::FixedWidthType *>(field->type().get())
+                          : nullptr) {
+      cost += type->bit_width() / 8.0;
+    } else {
+      // variable length column, assume it is as expensive as several fixed width ones
+      cost += 32;
+    }
+  }
+  return cost;
+}
+} // namespace pefa::execution
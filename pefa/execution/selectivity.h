@@ -0,0 +1,15 @@
+#pragma once
+#include "pefa/query_compiler/expressions.h"
+
+#include <arrow/type.h>
+
+namespace pefa::execution {
+using namespace query_compiler;
+
+// Estimates fraction of rows, for which expression is true. Without statistics every comparison
+// gets fixed selectivity depending on its operator, and operands are assumed to be independent
+[[nodiscard]] double estimate_selectivity(const BooleanExpr &expr);
+
+// Estimates cost of evaluating expression as number of bytes, which should be read per row
+[[nodiscard]] double estimate_cost(const arrow::Schema &schema, const BooleanExpr &expr);
+} // namespace pefa::execution
@@ -0,0 +1,293 @@
+#include "execution.h"
+#include "execution_context.h"
+#include "row_selection.h"
+#include "table_segments.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <arrow/api.h>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <pefa/utils/exceptions.h>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace pefa::execution {
+namespace {
+// rows are read by pieces of at most this length, so even a single chunk is split between threads
+constexpr int64_t piece_length = 1 << 16;
+// heaps are cheaper than full sort only while they are much smaller than input
+constexpr int64_t max_heap_limit = 1 << 14;
+// radix sort splits keys into blocks of at least this length, one block per thread
+constexpr int64_t min_block_length = 1 << 14;
+constexpr int radix_bits = 8;
+constexpr int num_buckets = 1 << radix_bits;
+constexpr int num_digits = 64 / radix_bits;
+
+// maps value to unsigned key, so keys are ordered as values
+template <typename T>
+uint64_t order_key(T value) {
+  if constexpr (std::is_floating_point_v<T>) {
+    // bits of negative numbers are ordered in reverse
+    auto number = static_cast<double>(value);
+    uint64_t bits;
+    std::memcpy(&bits, &number, sizeof(bits));
+    return (bits >> 63) != 0 ? ~bits : bits | (uint64_t{1} << 63);
+  } else if constexpr (std::is_signed_v<T>) {
+    return static_cast<uint64_t>(static_cast<int64_t>(value)) ^ (uint64_t{1} << 63);
+  } else {
+    return static_cast<uint64_t>(value);
+  }
+}
+
+struct Piece {
+  size_t segment;
+  int64_t offset; // relative to segment
+  int64_t length;
+};
+
+std::vector<Piece> split_into_pieces(const std::vector<TableSegment> &segments) {
+  std::vector<Piece> pieces;
+  for (size_t i = 0; i < segments.size(); i++) {
+    for (int64_t offset = 0; offset < segments[i].length; offset += piece_length) {
+      pieces.push_back({i, offset, std::min(piece_length, segments[i].length - offset)});
+    }
+  }
+  return pieces;
+}
+
+// Calls on_key(key, row) for every selected row of piece with non-null key in order of rows.
+// Keys of descending sort are inverted, so rows are always ordered by ascending keys. Rows with
+// null keys are appended to null_rows, while it is shorter than max_nulls
+template <typename Fn>
+void visit_piece(const TableMetadata &metadata, const TableSegment &segment, const Piece &piece,
+                 bool ascending, std::vector<int64_t> &null_rows, size_t max_nulls, Fn &&on_key) {
+  auto &chunk = *segment.columns[0];
+  std::vector<int64_t> rows;
+  selected_rows(metadata, segment.offset + piece.offset, piece.length, rows);
+  bool has_nulls = chunk.null_count() != 0;
+  auto mask = ascending ? uint64_t{0} : ~uint64_t{0};
+  visit_numeric_type(*chunk.type(), [&](auto tag) {
+    auto values = chunk.data()->GetValues<decltype(tag)>(1);
+    for (auto row : rows) {
+      auto pos = piece.offset + row;
+      if (has_nulls && chunk.IsNull(pos)) {
+        if (null_rows.size() < max_nulls) {
+          null_rows.push_back(segment.offset + pos);
+        }
+        continue;
+      }
+      on_key(order_key(values[pos]) ^ mask, segment.offset + pos);
+    }
+  });
+}
+
+// Every thread keeps max-heap of the smallest (key, row) pairs of its pieces, so most of rows
+// are rejected by a single comparison with top of heap. Heaps are merged at the end
+std::vector<int64_t> top_rows(const TableMetadata &metadata,
+                              const std::vector<TableSegment> &segments, bool ascending,
+                              int64_t limit) {
+  if (limit == 0) {
+    return {};
+  }
+  auto pieces = split_into_pieces(segments);
+  auto num_tasks = std::min(pieces.size(), get_num_threads());
+  using Entry = std::pair<uint64_t, int64_t>;
+  std::vector<std::vector<Entry>> heaps(num_tasks);
+  std::vector<std::vector<int64_t>> null_rows(num_tasks);
+  auto max_size = static_cast<size_t>(limit);
+  tf::Taskflow taskflow;
+  taskflow.parallel_for(0, static_cast<int>(num_tasks), 1, [&](int task) {
+    auto &heap = heaps[task];
+    heap.reserve(max_size);
+    auto begin = pieces.size() * task / num_tasks;
+    auto end = pieces.size() * (task + 1) / num_tasks;
+    for (auto piece_num = begin; piece_num < end; piece_num++) {
+      auto &piece = pieces[piece_num];
+      visit_piece(metadata, segments[piece.segment], piece, ascending, null_rows[task], max_size,
+                  [&](uint64_t key, int64_t row) {
+                    Entry entry(key, row);
+                    if (heap.size() < max_size) {
+                      heap.push_back(entry);
+                      std::push_heap(heap.begin(), heap.end());
+                    } else if (entry < heap.front()) {
+                      std::pop_heap(heap.begin(), heap.end());
+                      heap.back() = entry;
+                      std::push_heap(heap.begin(), heap.end());
+                    }
+                  });
+    }
+  });
+  get_executor().run(taskflow).wait();
+
+  std::vector<Entry> entries;
+  for (auto &heap : heaps) {
+    entries.insert(entries.end(), heap.begin(), heap.end());
+  }
+  auto count = std::min(entries.size(), max_size);
+  std::partial_sort(entries.begin(), entries.begin() + count, entries.end());
+  std::vector<int64_t> rows;
+  for (size_t i = 0; i < count; i++) {
+    rows.push_back(entries[i].second);
+  }
+  for (auto &task_null_rows : null_rows) {
+    for (auto row : task_null_rows) {
+      if (rows.size() == max_size) {
+        return rows;
+      }
+      rows.push_back(row);
+    }
+  }
+  return rows;
+}
+
+// Stable LSD radix sort of rows by keys. Keys are split into blocks, one per thread, and every
+// pass scatters blocks in parallel to positions, which are known from counts of digits in
+// previous blocks. Digits, which are equal for all keys, are skipped
+void radix_sort(std::vector<uint64_t> &keys, std::vector<int64_t> &rows) {
+  auto length = static_cast<int64_t>(keys.size());
+  if (length < 2) {
+    return;
+  }
+  auto num_blocks = std::max<int64_t>(
+      1, std::min(static_cast<int64_t>(get_num_threads()), length / min_block_length));
+  auto block_begin = [&](int64_t block) { return length * block / num_blocks; };
+
+  std::vector<int64_t> digit_counts(num_blocks * num_digits * num_buckets, 0);
+  tf::Taskflow count_taskflow;
+  count_taskflow.parallel_for(0, static_cast<int>(num_blocks), 1, [&](int block) {
+    auto counts = digit_counts.data() + block * num_digits * num_buckets;
+    for (auto i = block_begin(block); i < block_begin(block + 1); i++) {
+      for (int digit = 0; digit < num_digits; digit++) {
+        counts[digit * num_buckets + ((keys[i] >> (digit * radix_bits)) & (num_buckets - 1))]++;
+      }
+    }
+  });
+  get_executor().run(count_taskflow).wait();
+
+  std::vector<uint64_t> keys_out(length);
+  std::vector<int64_t> rows_out(length);
+  std::vector<int64_t> positions(num_blocks * num_buckets);
+  bool reordered = false;
+  for (int digit = 0; digit < num_digits; digit++) {
+    auto shift = digit * radix_bits;
+    auto first_bucket = (keys[0] >> shift) & (num_buckets - 1);
+    int64_t first_bucket_count = 0;
+    for (int64_t block = 0; block < num_blocks; block++) {
+      first_bucket_count +=
+          digit_counts[(block * num_digits + digit) * num_buckets + first_bucket];
+    }
+    if (first_bucket_count == length) {
+      continue;
+    }
+
+    // counts of blocks are taken before the first pass, so they are recounted after it
+    if (reordered) {
+      tf::Taskflow recount_taskflow;
+      recount_taskflow.parallel_for(0, static_cast<int>(num_blocks), 1, [&](int block) {
+        auto counts = digit_counts.data() + (block * num_digits + digit) * num_buckets;
+        std::fill(counts, counts + num_buckets, 0);
+        for (auto i = block_begin(block); i < block_begin(block + 1); i++) {
+          counts[(keys[i] >> shift) & (num_buckets - 1)]++;
+        }
+      });
+      get_executor().run(recount_taskflow).wait();
+    }
+    int64_t position = 0;
+    for (int bucket = 0; bucket < num_buckets; bucket++) {
+      for (int64_t block = 0; block < num_blocks; block++) {
+        positions[block * num_buckets + bucket] = position;
+        position += digit_counts[(block * num_digits + digit) * num_buckets + bucket];
+      }
+    }
+
+    tf::Taskflow scatter_taskflow;
+    scatter_taskflow.parallel_for(0, static_cast<int>(num_blocks), 1, [&](int block) {
+      auto block_positions = positions.data() + block * num_buckets;
+      for (auto i = block_begin(block); i < block_begin(block + 1); i++) {
+        auto position = block_positions[(keys[i] >> shift) & (num_buckets - 1)]++;
+        keys_out[position] = keys[i];
+        rows_out[position] = rows[i];
+      }
+    });
+    get_executor().run(scatter_taskflow).wait();
+    keys.swap(keys_out);
+    rows.swap(rows_out);
+    reordered = true;
+  }
+}
+
+std::vector<int64_t> sorted_rows(const TableMetadata &metadata,
+                                 const std::vector<TableSegment> &segments, bool ascending,
+                                 int64_t limit) {
+  auto pieces = split_into_pieces(segments);
+  std::vector<std::vector<uint64_t>> piece_keys(pieces.size());
+  std::vector<std::vector<int64_t>> piece_rows(pieces.size());
+  std::vector<std::vector<int64_t>> piece_null_rows(pieces.size());
+  tf::Taskflow read_taskflow;
+  read_taskflow.parallel_for(0, static_cast<int>(pieces.size()), 1, [&](int piece_num) {
+    auto &piece = pieces[piece_num];
+    auto &keys = piece_keys[piece_num];
+    auto &rows = piece_rows[piece_num];
+    visit_piece(metadata, segments[piece.segment], piece, ascending, piece_null_rows[piece_num],
+                std::numeric_limits<size_t>::max(), [&](uint64_t key, int64_t row) {
+                  keys.push_back(key);
+                  rows.push_back(row);
+                });
+  });
+  get_executor().run(read_taskflow).wait();
+
+  std::vector<int64_t> offsets(1, 0);
+  for (auto &keys : piece_keys) {
+    offsets.push_back(offsets.back() + static_cast<int64_t>(keys.size()));
+  }
+  std::vector<uint64_t> keys(offsets.back());
+  std::vector<int64_t> rows(offsets.back());
+  tf::Taskflow copy_taskflow;
+  copy_taskflow.parallel_for(0, static_cast<int>(pieces.size()), 1, [&](int piece_num) {
+    std::copy(piece_keys[piece_num].begin(), piece_keys[piece_num].end(),
+              keys.begin() + offsets[piece_num]);
+    std::copy(piece_rows[piece_num].begin(), piece_rows[piece_num].end(),
+              rows.begin() + offsets[piece_num]);
+  });
+  get_executor().run(copy_taskflow).wait();
+
+  radix_sort(keys, rows);
+  for (auto &null_rows : piece_null_rows) {
+    rows.insert(rows.end(), null_rows.begin(), null_rows.end());
+  }
+  if (limit >= 0 && static_cast<int64_t>(rows.size()) > limit) {
+    rows.resize(limit);
+  }
+  return rows;
+}
+} // namespace
+
+std::shared_ptr<ExecutionContext> sort(const std::shared_ptr<ExecutionContext> &ctx,
+                                       const std::string &key, bool ascending, int64_t limit) {
+  auto index = ctx->table->schema()->GetFieldIndex(key);
+  if (index < 0) {
+    throw ColumnNotFoundException(key);
+  }
+  auto column = ctx->table->column(index);
+  // type is checked even if there are no rows
+  visit_numeric_type(*column->type(), [](auto tag) {});
+  auto segments = split_into_segments({column});
+  auto rows = limit >= 0 && limit <= max_heap_limit
+                  ? top_rows(*ctx->metadata, segments, ascending, limit)
+                  : sorted_rows(*ctx->metadata, segments, ascending, limit);
+
+  // only rows of result are gathered, in their final order
+  auto count = static_cast<int64_t>(rows.size());
+  std::vector<std::shared_ptr<arrow::ChunkedArray>> columns;
+  tf::Taskflow taskflow;
+  for (auto &table_column : ctx->table->columns()) {
+    columns.push_back(take_rows(table_column, rows.data(), count, taskflow));
+  }
+  get_executor().run(taskflow).wait();
+  return std::make_shared<ExecutionContext>(
+      arrow::Table::Make(ctx->table->schema(), columns, count), ctx->config);
+}
+} // namespace pefa::execution
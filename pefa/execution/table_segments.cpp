@@ -0,0 +1,44 @@
+#include "table_segments.h"
+
+#include <algorithm>
+
+namespace pefa::execution {
+std::vector<TableSegment>
+split_into_segments(const std::vector<std::shared_ptr<arrow::ChunkedArray>> &columns) {
+  std::vector<TableSegment> segments;
+  if (columns.empty()) {
+    return segments;
+  }
+  auto total_length = columns.front()->length();
+  // current chunk and position inside it for every column
+  std::vector<int> chunks(columns.size(), 0);
+  std::vector<int64_t> positions(columns.size(), 0);
+
+  int64_t offset = 0;
+  while (offset < total_length) {
+    auto length = total_length - offset;
+    for (size_t i = 0; i < columns.size(); i++) {
+      // skip empty chunks and chunks, which are already completely covered
+      while (positions[i] == columns[i]->chunk(chunks[i])->length()) {
+        chunks[i]++;
+        positions[i] = 0;
+      }
+      length = std::min(length, columns[i]->chunk(chunks[i])->length() - positions[i]);
+    }
+
+    TableSegment segment{offset, length, chunks, {}};
+    for (size_t i = 0; i < columns.size(); i++) {
+      auto &chunk = columns[i]->chunk(chunks[i]);
+      if (positions[i] == 0 && length == chunk->length()) {
+        segment.columns.push_back(chunk);
+      } else {
+        segment.columns.push_back(chunk->Slice(positions[i], length));
+      }
+      positions[i] += length;
+    }
+    segments.push_back(std::move(segment));
+    offset += length;
+  }
+  return segments;
+}
+} // namespace pefa::execution
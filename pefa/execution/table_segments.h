@@ -0,0 +1,22 @@
+#pragma once
+#include <arrow/api.h>
+#include <memory>
+#include <vector>
+
+namespace pefa::execution {
+// Length of chunks of materialized, gathered and taken columns
+// TODO: move chunk_size to executionContext config
+constexpr int64_t chunk_size = 2 << 13;
+
+// Range of table rows, where every column is represented by a single chunk, so kernels can
+// process all columns of segment at once, even if columns are chunked differently
+struct TableSegment {
+  int64_t offset; // position of the first row of segment in table
+  int64_t length;
+  std::vector<int> chunks; // index of chunk for every column
+  std::vector<std::shared_ptr<const arrow::Array>> columns; // chunk slices, covered by segment
+};
+
+[[nodiscard]] std::vector<TableSegment>
+split_into_segments(const std::vector<std::shared_ptr<arrow::ChunkedArray>> &columns);
+} // namespace pefa::execution
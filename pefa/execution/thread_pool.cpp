@@ -0,0 +1,33 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace pefa::execution {
+namespace {
+std::mutex executor_mutex;
+std::unique_ptr<tf::Executor> executor;
+size_t num_threads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+} // namespace
+
+void set_num_threads(size_t threads) {
+  std::lock_guard lock(executor_mutex);
+  num_threads = std::max<size_t>(threads, 1);
+  executor.reset();
+}
+
+size_t get_num_threads() {
+  std::lock_guard lock(executor_mutex);
+  return num_threads;
+}
+
+tf::Executor &get_executor() {
+  std::lock_guard lock(executor_mutex);
+  if (!executor) {
+    executor = std::make_unique<tf::Executor>(num_threads);
+  }
+  return *executor;
+}
+} // namespace pefa::execution
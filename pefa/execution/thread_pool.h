@@ -0,0 +1,13 @@
+#pragma once
+#include <cstddef>
+#include <taskflow/taskflow.hpp>
+
+namespace pefa::execution {
+// Shared executor is created lazily with std::thread::hardware_concurrency() workers.
+// Changing number of threads recreates executor, so it should not be done while queries are running
+void set_num_threads(size_t num_threads);
+
+[[nodiscard]] size_t get_num_threads();
+
+[[nodiscard]] tf::Executor &get_executor();
+} // namespace pefa::execution
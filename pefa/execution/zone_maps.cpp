@@ -0,0 +1,251 @@
+#include "zone_maps.h"
+
+#include "pefa/utils/bloom_filter.h"
+#include "pefa/utils/string_match.h"
+#include "pefa/utils/utils.h"
+
+#include <string>
+#include <variant>
+
+namespace pefa::execution {
+namespace {
+template <typename T>
+ZoneMapResult compare_zone_map(const TypedChunkMetadata<T> &chunk, CompareExpr::Op op,
+                               const T &value) {
+  if (chunk.value_count == 0) {
+    return ZoneMapResult::NONE;
+  }
+  bool none = false;
+  bool all = false;
+  switch (op) {
+  case CompareExpr::Op::GT:
+    none = chunk.max <= value;
+    all = value < chunk.min;
+    break;
+  case CompareExpr::Op::LT:
+    none = value <= chunk.min;
+    all = chunk.max < value;
+    break;
+  case CompareExpr::Op::GE:
+    none = chunk.max < value;
+    all = value <= chunk.min;
+    break;
+  case CompareExpr::Op::LE:
+    none = value < chunk.min;
+    all = chunk.max <= value;
+    break;
+  case CompareExpr::Op::EQ:
+    none = value < chunk.min || chunk.max < value;
+    all = chunk.min == value && chunk.max == value;
+    break;
+  case CompareExpr::Op::NEQ:
+    none = chunk.min == value && chunk.max == value;
+    all = value < chunk.min || chunk.max < value;
+    break;
+  }
+  if (none) {
+    return ZoneMapResult::NONE;
+  }
+  // nulls and NaNs do not satisfy any comparison
+  if (all && chunk.value_count == chunk.length) {
+    return ZoneMapResult::ALL;
+  }
+  return ZoneMapResult::SOME;
+}
+
+// strings with prefix form a contiguous range starting from prefix itself, so chunk misses it if
+// all values are below prefix or its min is above prefix, but does not start with it
+ZoneMapResult prefix_zone_map(const TypedChunkMetadata<std::string> &chunk,
+                              const std::string &prefix) {
+  if (chunk.value_count == 0) {
+    return ZoneMapResult::NONE;
+  }
+  auto starts_with_prefix = [&](const std::string &value) {
+    return value.compare(0, prefix.size(), prefix) == 0;
+  };
+  if (chunk.max < prefix || (prefix < chunk.min && !starts_with_prefix(chunk.min))) {
+    return ZoneMapResult::NONE;
+  }
+  if (starts_with_prefix(chunk.min) && starts_with_prefix(chunk.max) &&
+      chunk.value_count == chunk.length) {
+    return ZoneMapResult::ALL;
+  }
+  return ZoneMapResult::SOME;
+}
+
+class ZoneMapVisitor : public ExprVisitor {
+private:
+  const std::vector<std::shared_ptr<const arrow::Field>> &m_fields;
+  const std::vector<const ChunkMetadata *> &m_chunks;
+  ZoneMapResult m_result = ZoneMapResult::SOME;
+
+public:
+  ZoneMapVisitor(const std::vector<std::shared_ptr<const arrow::Field>> &fields,
+                 const std::vector<const ChunkMetadata *> &chunks)
+      : m_fields(fields)
+      , m_chunks(chunks) {}
+
+  void visit(const PredicateExpr &expr) override {
+    expr.lhs->visit(*this);
+    auto lhs = m_result;
+    expr.rhs->visit(*this);
+    m_result = combine(expr.op, lhs, m_result);
+  }
+
+  void visit(const CompareExpr &expr) override {
+    m_result = ZoneMapResult::SOME;
+    // statistics bound only comparisons of column with literal
+    if (auto column = expr.column()) {
+      m_result = with_column(column->name, [&](auto &type, auto &chunk) {
+        return compare(type, chunk, expr.op, expr.literal()->value);
+      });
+    }
+  }
+
+  void visit(const BooleanConst &expr) override {
+    m_result = expr.value ? ZoneMapResult::ALL : ZoneMapResult::NONE;
+  }
+
+  void visit(const BloomFilterExpr &expr) override {
+    m_result = expr.filter->is_built() ? ZoneMapResult::SOME : ZoneMapResult::ALL;
+  }
+
+  void visit(const StringMatchExpr &expr) override {
+    m_result = with_column(expr.column->name,
+                           [&](auto &type, auto &chunk) { return match(type, chunk, expr); });
+  }
+
+  // list matches chunk like OR of its EQ comparisons
+  void visit(const InExpr &expr) override {
+    m_result = with_column(expr.column->name, [&](auto &type, auto &chunk) {
+      auto result = ZoneMapResult::NONE;
+      for (auto &value : expr.values) {
+        result = combine(PredicateExpr::Op::OR, result,
+                         compare(type, chunk, CompareExpr::Op::EQ, value));
+      }
+      return result;
+    });
+  }
+
+  void visit(const BetweenExpr &expr) override {
+    m_result = with_column(expr.column->name, [&](auto &type, auto &chunk) {
+      return combine(PredicateExpr::Op::AND, compare(type, chunk, CompareExpr::Op::GE, expr.lower),
+                     compare(type, chunk, CompareExpr::Op::LE, expr.upper));
+    });
+  }
+
+  [[nodiscard]] ZoneMapResult result() const {
+    return m_result;
+  }
+
+private:
+  static ZoneMapResult combine(PredicateExpr::Op op, ZoneMapResult lhs, ZoneMapResult rhs) {
+    // result is decided by one operand: false for AND, true for OR
+    auto decisive = op == PredicateExpr::Op::AND ? ZoneMapResult::NONE : ZoneMapResult::ALL;
+    if (lhs == decisive || rhs == decisive) {
+      return decisive;
+    }
+    return lhs == rhs ? lhs : ZoneMapResult::SOME;
+  }
+
+  // evaluates fn over statistics of column, SOME if column is not among fields
+  template <typename Fn> ZoneMapResult with_column(const std::string &name, Fn &&fn) const {
+    for (size_t i = 0; i < m_fields.size(); i++) {
+      if (m_fields[i]->name() == name) {
+        return unwrap_dictionary(*m_fields[i]->type(), *m_chunks[i], fn);
+      }
+    }
+    return ZoneMapResult::SOME;
+  }
+
+  // Dictionary-encoded chunk is evaluated over statistics of its dictionary. Every row takes its
+  // value from dictionary, so NONE holds for chunk too, while ALL holds only without null indices
+  template <typename Fn>
+  static ZoneMapResult unwrap_dictionary(const arrow::DataType &type, const ChunkMetadata &chunk,
+                                         Fn &&fn) {
+    if (type.id() != arrow::Type::DICTIONARY) {
+      return fn(type, chunk);
+    }
+    auto &value_type = *static_cast<const arrow::DictionaryType &>(type).value_type();
+    auto result = fn(value_type, *static_cast<const DictionaryChunkMetadata &>(chunk).values);
+    if (result == ZoneMapResult::ALL && chunk.null_count != 0) {
+      return ZoneMapResult::SOME;
+    }
+    return result;
+  }
+
+  static ZoneMapResult match(const arrow::DataType &type, const ChunkMetadata &chunk,
+                             const StringMatchExpr &expr) {
+    if (type.id() != arrow::Type::STRING && type.id() != arrow::Type::BINARY) {
+      return ZoneMapResult::SOME;
+    }
+    auto &typed = static_cast<const TypedChunkMetadata<std::string> &>(chunk);
+    auto pattern = expr.op == StringMatchExpr::Op::LIKE
+                       ? utils::simplify_like(expr.pattern)
+                       : utils::LikePattern{utils::LikePattern::Kind::GENERAL, expr.pattern};
+    if (expr.op == StringMatchExpr::Op::STARTS_WITH ||
+        pattern.kind == utils::LikePattern::Kind::STARTS_WITH) {
+      return prefix_zone_map(typed, pattern.literal);
+    }
+    if (pattern.kind == utils::LikePattern::Kind::EQ) {
+      return compare_zone_map<std::string>(typed, CompareExpr::Op::EQ, pattern.literal);
+    }
+    return ZoneMapResult::SOME;
+  }
+
+  // literal is converted to column type the same way, as filter kernel does it
+  template <typename T>
+  static ZoneMapResult compare_typed(const ChunkMetadata &chunk, CompareExpr::Op op,
+                                     const std::variant<int, double, std::string, bool> &literal) {
+    auto &typed = static_cast<const TypedChunkMetadata<T> &>(chunk);
+    if constexpr (std::is_integral_v<T> && !std::is_same_v<T, bool>) {
+      if (auto value = std::get_if<int>(&literal)) {
+        return compare_zone_map<T>(typed, op, static_cast<T>(*value));
+      }
+    } else if constexpr (std::is_floating_point_v<T>) {
+      if (auto value = std::get_if<double>(&literal)) {
+        return compare_zone_map<T>(typed, op, static_cast<T>(*value));
+      }
+      if (auto value = std::get_if<int>(&literal)) {
+        return compare_zone_map<T>(typed, op, static_cast<T>(*value));
+      }
+    } else {
+      if (auto value = std::get_if<T>(&literal)) {
+        return compare_zone_map<T>(typed, op, *value);
+      }
+    }
+    return ZoneMapResult::SOME;
+  }
+
+  static ZoneMapResult compare(const arrow::DataType &type, const ChunkMetadata &chunk,
+                               CompareExpr::Op op,
+                               const std::variant<int, double, std::string, bool> &literal) {
+    switch (type.id()) {
+      PEFA_CASE_RET(PEFA_INT8_CASE, compare_typed<int8_t>(chunk, op, literal))
+      PEFA_CASE_RET(PEFA_INT16_CASE, compare_typed<int16_t>(chunk, op, literal))
+      PEFA_CASE_RET(PEFA_INT32_CASE, compare_typed<int32_t>(chunk, op, literal))
+      PEFA_CASE_RET(PEFA_INT64_CASE, compare_typed<int64_t>(chunk, op, literal))
+      PEFA_CASE_RET(PEFA_UINT8_CASE, compare_typed<uint8_t>(chunk, op, literal))
+      PEFA_CASE_RET(PEFA_UINT16_CASE, compare_typed<uint16_t>(chunk, op, literal))
+      PEFA_CASE_RET(PEFA_UINT32_CASE, compare_typed<uint32_t>(chunk, op, literal))
+      PEFA_CASE_RET(PEFA_UINT64_CASE, compare_typed<uint64_t>(chunk, op, literal))
+      PEFA_CASE_RET(PEFA_FLOAT32_CASE, compare_typed<float>(chunk, op, literal))
+      PEFA_CASE_RET(PEFA_FLOAT64_CASE, compare_typed<double>(chunk, op, literal))
+      PEFA_CASE_RET(case arrow::Type::STRING:, compare_typed<std::string>(chunk, op, literal))
+      PEFA_CASE_RET(case arrow::Type::BINARY:, compare_typed<std::string>(chunk, op, literal))
+      PEFA_CASE_RET(case arrow::Type::BOOL:, compare_typed<bool>(chunk, op, literal))
+    default:
+      return ZoneMapResult::SOME;
+    }
+  }
+};
+} // namespace
+
+ZoneMapResult evaluate_zone_maps(const BooleanExpr &expr,
+                                 const std::vector<std::shared_ptr<const arrow::Field>> &fields,
+                                 const std::vector<const ChunkMetadata *> &chunks) {
+  ZoneMapVisitor visitor(fields, chunks);
+  expr.visit(visitor);
+  return visitor.result();
+}
+} // namespace pefa::execution
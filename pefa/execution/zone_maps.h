@@ -0,0 +1,24 @@
+#pragma once
+#include "execution_context.h"
+#include "pefa/query_compiler/expressions.h"
+
+#include <arrow/type.h>
+#include <memory>
+#include <vector>
+
+namespace pefa::execution {
+using namespace query_compiler;
+
+enum class ZoneMapResult {
+  NONE, // expression is false for every row
+  ALL,  // expression is true for every row
+  SOME, // expression should be evaluated by kernel
+};
+
+// Evaluates expression over statistics of chunks, which contain rows of some range. chunks contain
+// one already computed metadata per field
+[[nodiscard]] ZoneMapResult
+evaluate_zone_maps(const BooleanExpr &expr,
+                   const std::vector<std::shared_ptr<const arrow::Field>> &fields,
+                   const std::vector<const ChunkMetadata *> &chunks);
+} // namespace pefa::execution
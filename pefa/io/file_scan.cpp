@@ -0,0 +1,190 @@
+#include "file_scan.h"
+
+#include "ipc_source.h"
+#include "pefa/execution/execution_context.h"
+#include "pefa/execution/zone_maps.h"
+#include "pefa/utils/exceptions.h"
+#include "pefa/utils/utils.h"
+
+#include <arrow/csv/api.h>
+#include <arrow/io/api.h>
+#include <parquet/arrow/reader.h>
+#include <parquet/file_reader.h>
+#include <parquet/metadata.h>
+#include <parquet/statistics.h>
+#include <type_traits>
+#include <utility>
+
+namespace pefa::io {
+using namespace query_compiler;
+namespace {
+template <typename T>
+T value_or_throw(arrow::Result<T> result) {
+  if (!result.ok()) {
+    throw IOException(result.status().ToString());
+  }
+  return std::move(result).ValueOrDie();
+}
+
+void check_status(const arrow::Status &status) {
+  if (!status.ok()) {
+    throw IOException(status.ToString());
+  }
+}
+
+std::shared_ptr<arrow::Table> read_csv(const std::string &path,
+                                       const std::vector<std::string> &columns) {
+  auto file = value_or_throw(arrow::io::ReadableFile::Open(path));
+  auto convert_options = arrow::csv::ConvertOptions::Defaults();
+  // columns, which are not included, are only tokenized, but not converted
+  convert_options.include_columns = columns;
+  auto reader = value_or_throw(arrow::csv::TableReader::Make(
+      arrow::default_memory_pool(), file, arrow::csv::ReadOptions::Defaults(),
+      arrow::csv::ParseOptions::Defaults(), convert_options));
+  return value_or_throw(reader->Read());
+}
+
+std::shared_ptr<arrow::Table> read_ipc(const std::string &path,
+                                       const std::vector<std::string> &columns) {
+  std::shared_ptr<arrow::Table> table;
+  check_status(IpcFileSource::open(path, columns)->ReadAll(&table));
+  return table;
+}
+
+// converts statistics of parquet column chunk into zone map of chunk, nullptr if they are unknown
+template <typename T, typename ParquetType>
+std::unique_ptr<execution::ChunkMetadata> make_chunk_metadata(const parquet::Statistics &stats,
+                                                              int64_t num_rows) {
+  if (stats.physical_type() != ParquetType::type_num) {
+    return nullptr;
+  }
+  auto &typed = static_cast<const parquet::TypedStatistics<ParquetType> &>(stats);
+  auto metadata = std::make_unique<execution::TypedChunkMetadata<T>>();
+  metadata->length = num_rows;
+  metadata->null_count = stats.null_count();
+  metadata->value_count = stats.num_values();
+  if constexpr (std::is_same_v<T, std::string>) {
+    metadata->min = std::string(reinterpret_cast<const char *>(typed.min().ptr), typed.min().len);
+    metadata->max = std::string(reinterpret_cast<const char *>(typed.max().ptr), typed.max().len);
+  } else {
+    metadata->min = static_cast<T>(typed.min());
+    metadata->max = static_cast<T>(typed.max());
+  }
+  return metadata;
+}
+
+std::unique_ptr<execution::ChunkMetadata> make_chunk_metadata(const arrow::DataType &type,
+                                                              const parquet::Statistics &stats,
+                                                              int64_t num_rows) {
+  switch (type.id()) {
+    PEFA_CASE_RET(PEFA_INT8_CASE,
+                  (make_chunk_metadata<int8_t, parquet::Int32Type>(stats, num_rows)))
+    PEFA_CASE_RET(PEFA_INT16_CASE,
+                  (make_chunk_metadata<int16_t, parquet::Int32Type>(stats, num_rows)))
+    PEFA_CASE_RET(PEFA_INT32_CASE,
+                  (make_chunk_metadata<int32_t, parquet::Int32Type>(stats, num_rows)))
+    PEFA_CASE_RET(PEFA_INT64_CASE,
+                  (make_chunk_metadata<int64_t, parquet::Int64Type>(stats, num_rows)))
+    PEFA_CASE_RET(PEFA_FLOAT32_CASE,
+                  (make_chunk_metadata<float, parquet::FloatType>(stats, num_rows)))
+    PEFA_CASE_RET(PEFA_FLOAT64_CASE,
+                  (make_chunk_metadata<double, parquet::DoubleType>(stats, num_rows)))
+  case arrow::Type::STRING:
+  case arrow::Type::BINARY:
+    return make_chunk_metadata<std::string, parquet::ByteArrayType>(stats, num_rows);
+  default:
+    // unsigned types are stored as signed, so their statistics are not used
+    return nullptr;
+  }
+}
+
+// row group is skipped, if all columns of predicate have statistics, which reject every row
+bool is_row_group_rejected(const parquet::RowGroupMetaData &row_group,
+                           const arrow::Schema &schema, const BooleanExpr &predicate) {
+  std::vector<std::string> names;
+  referenced_columns(predicate, names);
+  std::vector<std::shared_ptr<const arrow::Field>> fields;
+  std::vector<std::unique_ptr<execution::ChunkMetadata>> chunks;
+  for (auto &name : names) {
+    auto index = schema.GetFieldIndex(name);
+    if (index < 0) {
+      return false;
+    }
+    auto stats = row_group.ColumnChunk(index)->statistics();
+    if (!stats || !stats->HasMinMax()) {
+      return false;
+    }
+    auto metadata = make_chunk_metadata(*schema.field(index)->type(), *stats, row_group.num_rows());
+    if (!metadata) {
+      return false;
+    }
+    fields.push_back(schema.field(index));
+    chunks.push_back(std::move(metadata));
+  }
+  std::vector<const execution::ChunkMetadata *> chunk_pointers;
+  for (auto &chunk : chunks) {
+    chunk_pointers.push_back(chunk.get());
+  }
+  return execution::evaluate_zone_maps(predicate, fields, chunk_pointers) ==
+         execution::ZoneMapResult::NONE;
+}
+
+std::shared_ptr<arrow::Table> read_parquet(const std::string &path,
+                                           const std::vector<std::string> &columns,
+                                           const std::shared_ptr<const BooleanExpr> &predicate) {
+  auto file = value_or_throw(arrow::io::ReadableFile::Open(path));
+  std::unique_ptr<parquet::arrow::FileReader> reader;
+  check_status(parquet::arrow::OpenFile(file, arrow::default_memory_pool(), &reader));
+  std::shared_ptr<arrow::Schema> schema;
+  check_status(reader->GetSchema(&schema));
+
+  // only flat schemas are supported, so index of field is also index of parquet column
+  std::vector<int> indices;
+  std::vector<std::shared_ptr<arrow::Field>> fields;
+  for (int i = 0; i < schema->num_fields(); i++) {
+    if (columns.empty()) {
+      indices.push_back(i);
+      fields.push_back(schema->field(i));
+    }
+  }
+  for (auto &name : columns) {
+    auto index = schema->GetFieldIndex(name);
+    if (index < 0) {
+      throw ColumnNotFoundException(name);
+    }
+    indices.push_back(index);
+    fields.push_back(schema->field(index));
+  }
+
+  auto metadata = reader->parquet_reader()->metadata();
+  std::vector<int> row_groups;
+  for (int i = 0; i < metadata->num_row_groups(); i++) {
+    if (!predicate || !is_row_group_rejected(*metadata->RowGroup(i), *schema, *predicate)) {
+      row_groups.push_back(i);
+    }
+  }
+  if (row_groups.empty()) {
+    std::vector<std::shared_ptr<arrow::ChunkedArray>> empty_columns;
+    for (auto &field : fields) {
+      empty_columns.push_back(
+          std::make_shared<arrow::ChunkedArray>(arrow::ArrayVector{}, field->type()));
+    }
+    return arrow::Table::Make(arrow::schema(fields), empty_columns);
+  }
+  std::shared_ptr<arrow::Table> table;
+  check_status(reader->ReadRowGroups(row_groups, indices, &table));
+  return table;
+}
+} // namespace
+
+std::shared_ptr<arrow::Table> read_file(const std::string &path, FileFormat format,
+                                        const std::vector<std::string> &columns,
+                                        const std::shared_ptr<const BooleanExpr> &predicate) {
+  switch (format) {
+    PEFA_CASE_RET(case FileFormat::CSV:, read_csv(path, columns))
+    PEFA_CASE_RET(case FileFormat::IPC:, read_ipc(path, columns))
+    PEFA_CASE_RET(case FileFormat::PARQUET:, read_parquet(path, columns, predicate))
+  }
+  throw UnreachableException();
+}
+} // namespace pefa::io
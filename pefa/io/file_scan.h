@@ -0,0 +1,18 @@
+#pragma once
+#include "pefa/query_compiler/expressions.h"
+#include "pefa/query_compiler/logical_plan.h"
+
+#include <arrow/table.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace pefa::io {
+// Reads given columns of file in the given order, or all columns, if list is empty. Parts of file,
+// where predicate is false for every row, are skipped, when format stores statistics (Parquet row
+// groups). Remaining rows are returned as is, predicate should still be applied by filter
+[[nodiscard]] std::shared_ptr<arrow::Table>
+read_file(const std::string &path, query_compiler::FileFormat format,
+          const std::vector<std::string> &columns,
+          const std::shared_ptr<const query_compiler::BooleanExpr> &predicate = nullptr);
+} // namespace pefa::io
@@ -0,0 +1,75 @@
+#include "ipc_source.h"
+
+#include "pefa/utils/exceptions.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace pefa::io {
+IpcFileSource::IpcFileSource(std::shared_ptr<arrow::io::MemoryMappedFile> file,
+                             std::shared_ptr<arrow::ipc::RecordBatchFileReader> reader,
+                             std::shared_ptr<arrow::Schema> schema)
+    : m_file(std::move(file))
+    , m_reader(std::move(reader))
+    , m_schema(std::move(schema)) {}
+
+std::shared_ptr<arrow::Schema> IpcFileSource::schema() const {
+  return m_schema;
+}
+
+arrow::Status IpcFileSource::ReadNext(std::shared_ptr<arrow::RecordBatch> *batch) {
+  if (m_next_batch == m_reader->num_record_batches()) {
+    *batch = nullptr;
+    return arrow::Status::OK();
+  }
+  ARROW_ASSIGN_OR_RAISE(auto read, m_reader->ReadRecordBatch(m_next_batch++));
+  // reader may keep excluded fields in schema of batch, so columns are looked up by name
+  std::vector<std::shared_ptr<arrow::Array>> columns;
+  for (auto &field : m_schema->fields()) {
+    auto column = read->GetColumnByName(field->name());
+    if (!column) {
+      return arrow::Status::Invalid("Column ", field->name(), " is missing in record batch");
+    }
+    columns.push_back(std::move(column));
+  }
+  *batch = arrow::RecordBatch::Make(m_schema, read->num_rows(), std::move(columns));
+  return arrow::Status::OK();
+}
+
+std::shared_ptr<IpcFileSource> IpcFileSource::open(const std::string &path,
+                                                   const std::vector<std::string> &columns) {
+  auto file = arrow::io::MemoryMappedFile::Open(path, arrow::io::FileMode::READ);
+  if (!file.ok()) {
+    throw IOException(file.status().ToString());
+  }
+  // schema is read first to find indices of requested columns
+  auto full_reader = arrow::ipc::RecordBatchFileReader::Open(file.ValueOrDie().get());
+  if (!full_reader.ok()) {
+    throw IOException(full_reader.status().ToString());
+  }
+  auto full_schema = full_reader.ValueOrDie()->schema();
+  if (columns.empty()) {
+    return std::make_shared<IpcFileSource>(file.ValueOrDie(), full_reader.ValueOrDie(),
+                                           full_schema);
+  }
+
+  auto options = arrow::ipc::IpcReadOptions::Defaults();
+  std::vector<std::shared_ptr<arrow::Field>> fields;
+  for (auto &name : columns) {
+    auto index = full_schema->GetFieldIndex(name);
+    if (index < 0) {
+      throw ColumnNotFoundException(name);
+    }
+    options.included_fields.push_back(index);
+    fields.push_back(full_schema->field(index));
+  }
+  // reader expects indices in order of fields of file
+  std::sort(options.included_fields.begin(), options.included_fields.end());
+  auto reader = arrow::ipc::RecordBatchFileReader::Open(file.ValueOrDie().get(), options);
+  if (!reader.ok()) {
+    throw IOException(reader.status().ToString());
+  }
+  return std::make_shared<IpcFileSource>(file.ValueOrDie(), reader.ValueOrDie(),
+                                         arrow::schema(fields));
+}
+} // namespace pefa::io
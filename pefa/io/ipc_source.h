@@ -0,0 +1,34 @@
+#pragma once
+#include <arrow/io/file.h>
+#include <arrow/ipc/reader.h>
+#include <arrow/record_batch.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace pefa::io {
+// Reads record batches of Arrow IPC file (Feather V2 files have the same format) from memory
+// mapped file. Buffers of batches point into mapped pages, so nothing is copied, and pages of a
+// column are read from disk only when kernels touch them. Columns, which are not requested, are
+// not read at all
+class IpcFileSource : public arrow::RecordBatchReader {
+private:
+  std::shared_ptr<arrow::io::MemoryMappedFile> m_file;
+  std::shared_ptr<arrow::ipc::RecordBatchFileReader> m_reader;
+  std::shared_ptr<arrow::Schema> m_schema;
+  int m_next_batch = 0;
+
+public:
+  IpcFileSource(std::shared_ptr<arrow::io::MemoryMappedFile> file,
+                std::shared_ptr<arrow::ipc::RecordBatchFileReader> reader,
+                std::shared_ptr<arrow::Schema> schema);
+
+  [[nodiscard]] std::shared_ptr<arrow::Schema> schema() const override;
+
+  arrow::Status ReadNext(std::shared_ptr<arrow::RecordBatch> *batch) override;
+
+  // columns are returned in the given order, empty list means all columns of file
+  [[nodiscard]] static std::shared_ptr<IpcFileSource>
+  open(const std::string &path, const std::vector<std::string> &columns = {});
+};
+} // namespace pefa::io
@@ -50,6 +50,7 @@ TargetMachine &JIT::getTargetMachine() {
   return *m_target_machine;
 }
 VModuleKey JIT::addModule(std::unique_ptr<Module> M) {
+  std::lock_guard lock(m_mutex);
   VModuleKey K = m_session.allocateVModule();
   m_resolvers[K] = createLegacyLookupResolver(
       m_session,
@@ -68,12 +69,21 @@ VModuleKey JIT::addModule(std::unique_ptr<Module> M) {
   return K;
 }
 JITSymbol JIT::findSymbol(const std::string &Name) {
+  std::lock_guard lock(m_mutex);
   std::string MangledName;
   raw_string_ostream MangledNameStream(MangledName);
   Mangler::getNameWithPrefix(MangledNameStream, Name, m_data_layout);
   return m_optimize_layer.findSymbol(MangledNameStream.str(), true);
 }
+JITTargetAddress JIT::getSymbolAddress(VModuleKey K, const std::string &Name) {
+  std::lock_guard lock(m_mutex);
+  std::string MangledName;
+  raw_string_ostream MangledNameStream(MangledName);
+  Mangler::getNameWithPrefix(MangledNameStream, Name, m_data_layout);
+  return cantFail(m_optimize_layer.findSymbolIn(K, MangledNameStream.str(), true).getAddress());
+}
 void JIT::removeModule(VModuleKey K) {
+  std::lock_guard lock(m_mutex);
   cantFail(m_optimize_layer.removeModule(K));
 }
 
@@ -123,15 +133,13 @@ std::unique_ptr<Module> JIT::optimizeModule(std::unique_ptr<Module> module) {
 }
 
 std::shared_ptr<JIT> get_JIT() {
-  static std::shared_ptr<JIT> jit;
-  if (jit) {
-    return jit;
-  } else {
+  // static initialization is thread safe, so JIT may be requested from several threads
+  static std::shared_ptr<JIT> jit = [] {
     llvm::InitializeNativeTarget();
     llvm::InitializeNativeTargetAsmParser();
     llvm::InitializeNativeTargetAsmPrinter();
-    jit = std::make_shared<JIT>();
-    return jit;
-  }
+    return std::make_shared<JIT>();
+  }();
+  return jit;
 }
 } // namespace pefa::jit
@@ -10,6 +10,7 @@
 #include <llvm/IR/DataLayout.h>
 #include <llvm/IR/Module.h>
 #include <llvm/Target/TargetMachine.h>
+#include <mutex>
 
 // TODO: Current jit implementation is copy paste of llvm::KaleidoscopeJIT
 // it is legacy and should be refactored in future
@@ -36,6 +37,9 @@ private:
 
   LegacyIRTransformLayer<decltype(m_compile_layer), OptimizeFunction> m_optimize_layer;
 
+  // orc layers are not thread safe, so all operations with modules are serialized
+  std::mutex m_mutex;
+
 public:
   JIT();
 
@@ -45,6 +49,9 @@ public:
 
   JITSymbol findSymbol(const std::string &Name);
 
+  // looks up symbol only in module with key K, so modules may define functions with same names
+  JITTargetAddress getSymbolAddress(VModuleKey K, const std::string &Name);
+
   void removeModule(VModuleKey K);
 
 private:
@@ -0,0 +1,233 @@
+#include "aggregate.h"
+
+#include "pefa/jit/jit.h"
+#include "pefa/utils/exceptions.h"
+#include "pefa/utils/llvm_helpers.h"
+#include "pefa/utils/utils.h"
+
+#include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Support/Host.h>
+#include <utility>
+
+namespace pefa::kernels {
+class AggregateKernelImpl : public AggregateKernel, private utils::LLVMTypesHelper {
+private:
+  std::shared_ptr<arrow::DataType> m_type;
+  Aggregate::Op m_op;
+  std::shared_ptr<arrow::DataType> m_accumulator_type;
+  llvm::LLVMContext m_context;
+  llvm::orc::VModuleKey m_moduleKey{};
+  bool m_is_compiled = false;
+  std::shared_ptr<pefa::jit::JIT> m_jit;
+  // both functions have the same signature, update ignores validity
+  using UpdateFunc = void (*)(const uint8_t *, const uint8_t *, int64_t, const int32_t *,
+                              uint8_t *, int64_t *, int64_t);
+  UpdateFunc m_update_func{};
+  UpdateFunc m_update_nullable_func{};
+
+public:
+  AggregateKernelImpl(std::shared_ptr<arrow::DataType> type, Aggregate::Op op)
+      : m_type(std::move(type))
+      , m_op(op)
+      , m_accumulator_type(accumulator_type(m_type, m_op))
+      , m_context(llvm::LLVMContext())
+      , m_jit(jit::get_JIT())
+      , utils::LLVMTypesHelper(m_context) {}
+
+  void execute(const arrow::Array &values, const int32_t *group_ids, uint8_t *accumulators,
+               int64_t *counts) override {
+    if (!m_is_compiled) {
+      throw KernelNotCompiledException();
+    }
+    if (!values.type()->Equals(*m_type)) {
+      throw UnreachableException();
+    }
+    auto width = static_cast<const arrow::FixedWidthType &>(*m_type).bit_width() / 8;
+    auto input = values.data()->buffers[1]->data() + values.offset() * width;
+    if (values.null_count() != 0) {
+      m_update_nullable_func(input, values.null_bitmap_data(), values.offset(), group_ids,
+                             accumulators, counts, values.length());
+    } else {
+      m_update_func(input, nullptr, 0, group_ids, accumulators, counts, values.length());
+    }
+  }
+
+  ~AggregateKernelImpl() override {
+    if (m_is_compiled) {
+      m_jit->removeModule(m_moduleKey);
+    }
+  }
+
+  void compile() override {
+    auto module = std::make_unique<llvm::Module>("aggregate_mod", m_context);
+    module->setTargetTriple(llvm::sys::getProcessTriple());
+    gen_update_func(*module, false);
+    gen_update_func(*module, true);
+    auto &machine = m_jit->getTargetMachine();
+    module->setDataLayout(machine.createDataLayout());
+    m_moduleKey = m_jit->addModule(std::move(module));
+    m_update_func = reinterpret_cast<UpdateFunc>(m_jit->getSymbolAddress(m_moduleKey, "update"));
+    m_update_nullable_func =
+        reinterpret_cast<UpdateFunc>(m_jit->getSymbolAddress(m_moduleKey, "update_nullable"));
+    m_is_compiled = true;
+  }
+
+private:
+  // converts value to accumulator type of SUM and AVG
+  llvm::Value *gen_widen(llvm::IRBuilder<> &builder, llvm::Value *value) {
+    auto *typ = from_arrow(*m_accumulator_type);
+    switch (m_type->id()) {
+      PEFA_CASE_RET(PEFA_SIGNED_INTEGRAL_CASE, builder.CreateSExtOrTrunc(value, typ))
+      PEFA_CASE_RET(PEFA_UNSIGNED_INTEGRAL_CASE, builder.CreateZExtOrTrunc(value, typ))
+      PEFA_CASE_RET(PEFA_FLOATING_CASE, builder.CreateFPCast(value, typ))
+    default:
+      throw UnreachableException();
+    }
+  }
+
+  // if nullable is set, generates update_nullable function, which skips values with zero bit in
+  // validity bitmap
+  void gen_update_func(llvm::Module &module, bool nullable) {
+    // void update(uint8_t *in, uint8_t *validity, int64_t validity_offset, int32_t *group_ids,
+    //             uint8_t *accumulators, int64_t *counts, int64_t len) {
+    //     TYPE *values = (TYPE *)in;
+    //     ACC_TYPE *acc = (ACC_TYPE *)accumulators;
+    //     for(int64_t i = 0; i < len; i++) {
+    //         int32_t g = group_ids[i];
+    //         if (g < 0 || !valid(validity, validity_offset + i)) continue;
+    //         acc[g] = op(acc[g], values[i], counts[g]);
+    //         counts[g]++;
+    //     }
+    // }
+    std::vector<llvm::Type *> param_type{
+        llvm::Type::getInt8PtrTy(m_context), llvm::Type::getInt8PtrTy(m_context),
+        i64_typ(),                           llvm::Type::getInt32PtrTy(m_context),
+        llvm::Type::getInt8PtrTy(m_context), llvm::Type::getInt64PtrTy(m_context),
+        i64_typ()};
+    llvm::FunctionType *prototype =
+        llvm::FunctionType::get(llvm::Type::getVoidTy(m_context), param_type, false);
+    llvm::Function *func = llvm::Function::Create(prototype, llvm::Function::ExternalLinkage,
+                                                  nullable ? "update_nullable" : "update", module);
+    llvm::BasicBlock *body = llvm::BasicBlock::Create(m_context, "body", func);
+    llvm::BasicBlock *cond = llvm::BasicBlock::Create(m_context, "loop.cond", func);
+    llvm::BasicBlock *loop = llvm::BasicBlock::Create(m_context, "loop.body", func);
+    llvm::BasicBlock *valid = llvm::BasicBlock::Create(m_context, "loop.valid", func);
+    llvm::BasicBlock *update = llvm::BasicBlock::Create(m_context, "loop.update", func);
+    llvm::BasicBlock *inc = llvm::BasicBlock::Create(m_context, "loop.inc", func);
+    llvm::BasicBlock *end = llvm::BasicBlock::Create(m_context, "end", func);
+
+    llvm::Value *arg_validity = func->getArg(1);
+    llvm::Value *arg_validity_offset = func->getArg(2);
+    llvm::Value *arg_group_ids = func->getArg(3);
+    llvm::Value *arg_counts = func->getArg(5);
+    llvm::Value *arg_len = func->getArg(6);
+
+    llvm::IRBuilder builder(m_context);
+    builder.SetInsertPoint(body);
+    auto *i = builder.CreateAlloca(i64_typ(), nullptr, "i");
+    builder.CreateStore(i64val(0), i);
+    auto *values = builder.CreatePointerCast(func->getArg(0), ptr_from_arrow(*m_type));
+    auto *acc = builder.CreatePointerCast(func->getArg(4), ptr_from_arrow(*m_accumulator_type));
+    builder.CreateBr(cond);
+
+    builder.SetInsertPoint(cond);
+    builder.CreateCondBr(builder.CreateICmpSLT(builder.CreateLoad(i), arg_len), loop, end);
+
+    builder.SetInsertPoint(loop);
+    auto *group =
+        builder.CreateLoad(builder.CreateInBoundsGEP(arg_group_ids, builder.CreateLoad(i)));
+    builder.CreateCondBr(builder.CreateICmpSLT(group, i32val(0)), inc, valid);
+
+    builder.SetInsertPoint(valid);
+    if (nullable) {
+      // (validity[pos / 8] >> (pos % 8)) & 1
+      auto *pos = builder.CreateAdd(arg_validity_offset, builder.CreateLoad(i));
+      auto *byte = builder.CreateLoad(
+          builder.CreateInBoundsGEP(arg_validity, builder.CreateLShr(pos, i64val(3))));
+      auto *bit = builder.CreateLShr(byte, builder.CreateTrunc(builder.CreateAnd(pos, i64val(7)),
+                                                               i8_typ()));
+      builder.CreateCondBr(builder.CreateTrunc(bit, bool_typ()), update, inc);
+    } else {
+      builder.CreateBr(update);
+    }
+
+    builder.SetInsertPoint(update);
+    auto *group_pos = builder.CreateSExt(group, i64_typ());
+    auto *value = builder.CreateLoad(builder.CreateInBoundsGEP(values, builder.CreateLoad(i)));
+    auto *count_ptr = builder.CreateInBoundsGEP(arg_counts, group_pos);
+    auto *count = builder.CreateLoad(count_ptr);
+    auto *acc_ptr = builder.CreateInBoundsGEP(acc, group_pos);
+    switch (m_op) {
+    case Aggregate::Op::SUM:
+    case Aggregate::Op::AVG: {
+      auto *current = builder.CreateLoad(acc_ptr);
+      auto *widened = gen_widen(builder, value);
+      builder.CreateStore(current->getType()->isFloatingPointTy()
+                              ? builder.CreateFAdd(current, widened)
+                              : builder.CreateAdd(current, widened),
+                          acc_ptr);
+      break;
+    }
+    case Aggregate::Op::MIN:
+    case Aggregate::Op::MAX: {
+      // the first value of group is taken as is, as accumulator is not initialized yet
+      auto *current = builder.CreateLoad(acc_ptr);
+      auto *better = m_op == Aggregate::Op::MIN
+                         ? create_cmp_lt(*m_type, builder, value, current)
+                         : create_cmp_gt(*m_type, builder, value, current);
+      auto *take = builder.CreateOr(builder.CreateICmpEQ(count, i64val(0)), better);
+      builder.CreateStore(builder.CreateSelect(take, value, current), acc_ptr);
+      break;
+    }
+    case Aggregate::Op::COUNT:
+      break;
+    }
+    builder.CreateStore(builder.CreateAdd(count, i64val(1)), count_ptr);
+    builder.CreateBr(inc);
+
+    builder.SetInsertPoint(inc);
+    builder.CreateStore(builder.CreateAdd(builder.CreateLoad(i), i64val(1)), i);
+    builder.CreateBr(cond);
+
+    builder.SetInsertPoint(end);
+    builder.CreateRetVoid();
+  }
+};
+
+std::shared_ptr<arrow::DataType>
+AggregateKernel::accumulator_type(const std::shared_ptr<arrow::DataType> &type, Aggregate::Op op) {
+  // half floats have no C++ type to return results in
+  switch (type->id()) {
+  PEFA_INTEGRAL_CASE
+  PEFA_FLOAT32_CASE
+  PEFA_FLOAT64_CASE
+    break;
+  default:
+    throw NotImplementedException("Aggregation of type " + type->ToString() +
+                                  " is not supported yet");
+  }
+  switch (op) {
+  case Aggregate::Op::SUM:
+  case Aggregate::Op::AVG:
+    switch (type->id()) {
+      PEFA_CASE_RET(PEFA_SIGNED_INTEGRAL_CASE, arrow::int64())
+      PEFA_CASE_RET(PEFA_UNSIGNED_INTEGRAL_CASE, arrow::uint64())
+    default:
+      return arrow::float64();
+    }
+  case Aggregate::Op::MIN:
+  case Aggregate::Op::MAX:
+    return type;
+  case Aggregate::Op::COUNT:
+    return arrow::int64();
+  }
+  throw UnreachableException();
+}
+
+std::unique_ptr<AggregateKernel> AggregateKernel::create_cpu(std::shared_ptr<arrow::DataType> type,
+                                                             Aggregate::Op op) {
+  return std::make_unique<AggregateKernelImpl>(std::move(type), op);
+}
+} // namespace pefa::kernels
@@ -0,0 +1,28 @@
+#pragma once
+#include "pefa/query_compiler/logical_plan.h"
+
+#include <arrow/api.h>
+#include <memory>
+
+namespace pefa::kernels {
+using namespace query_compiler;
+class AggregateKernel {
+public:
+  // Aggregate kernel adds values of array to accumulators of their groups. Value i is added to
+  // accumulators[group_ids[i]] and counted in counts[group_ids[i]], which is the number of values
+  // accounted in the accumulator. Rows with negative group id and null values are skipped.
+  // Accumulators are arrays of accumulator_type, COUNT does not use them at all
+  virtual void execute(const arrow::Array &values, const int32_t *group_ids,
+                       uint8_t *accumulators, int64_t *counts) = 0;
+  virtual void compile() = 0;
+
+  // SUM and AVG are accumulated in int64, uint64 or double, MIN and MAX in type of values
+  [[nodiscard]] static std::shared_ptr<arrow::DataType>
+  accumulator_type(const std::shared_ptr<arrow::DataType> &type, Aggregate::Op op);
+
+  [[nodiscard]] static std::unique_ptr<AggregateKernel>
+  create_cpu(std::shared_ptr<arrow::DataType> type, Aggregate::Op op);
+
+  virtual ~AggregateKernel() = default;
+};
+} // namespace pefa::kernels
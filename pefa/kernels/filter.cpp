@@ -1,12 +1,16 @@
 #include "filter.h"
 
+#include "ir_emit_visitor.h"
 #include "pefa/jit/jit.h"
 #include "pefa/query_compiler/expressions.h"
+#include "pefa/utils/bloom_filter.h"
 #include "pefa/utils/exceptions.h"
 #include "pefa/utils/llvm_helpers.h"
 #include "pefa/utils/utils.h"
 
 #include <algorithm>
+#include <cstring>
+#include <llvm/Analysis/TargetTransformInfo.h>
 #include <llvm/IR/IRBuilder.h>
 #include <llvm/IR/LLVMContext.h>
 #include <llvm/IR/Module.h>
@@ -14,125 +18,200 @@
 #include <utility>
 
 namespace pefa::kernels {
-class IrEmitVisitor : public ExprVisitor, private utils::LLVMTypesHelper {
-private:
-  llvm::Value *m_result;
-  llvm::IRBuilder<> *m_builder;
-  llvm::LLVMContext *m_context;
-  std::shared_ptr<const arrow::Field> m_field;
-  llvm::Value *m_input;
+namespace {
+// collects bloom filter expressions in order of their appearance
+class BloomFiltersVisitor : public ExprVisitor {
+public:
+  std::vector<const BloomFilterExpr *> filters;
 
-  // we need to keep last op to generate proper constant (true/false)
-  // if expr does not operate with referenced column
-  PredicateExpr::Op m_last_op{PredicateExpr::Op::AND};
+  void visit(const BloomFilterExpr &expr) override {
+    filters.push_back(&expr);
+  }
+};
 
-public:
-  IrEmitVisitor(llvm::LLVMContext *context, llvm::IRBuilder<> *builder,
-                std::shared_ptr<const arrow::Field> field, llvm::Value *input)
-      : utils::LLVMTypesHelper(*context)
-      , m_result(nullptr)
-      , m_builder(builder)
-      , m_context(context)
-      , m_field(std::move(field))
-      , m_input(input) {}
-
-  void visit(const PredicateExpr &expr) override {
-    m_last_op = expr.op;
-    expr.lhs->visit(*this);
-    auto lhs = m_result;
-    m_last_op = expr.op;
-    expr.rhs->visit(*this);
-    auto rhs = m_result;
-    switch (expr.op) {
-      PEFA_CASE_BRK(case PredicateExpr::Op::OR:, m_result = m_builder->CreateOr(lhs, rhs))
-      PEFA_CASE_BRK(case PredicateExpr::Op::AND:, m_result = m_builder->CreateAnd(lhs, rhs))
-    }
+// block with all bits set, which is probed instead of filter, which is not built yet, so every key
+// is accepted
+alignas(32) const uint32_t accept_all_block[utils::BloomFilter::block_words] = {
+    ~0u, ~0u, ~0u, ~0u, ~0u, ~0u, ~0u, ~0u};
+} // namespace
+
+FilterInputs::FilterInputs(const Expr &expr) {
+  static_assert(sizeof(BloomProbe) == 2 * sizeof(int64_t), "kernel reads probe as two int64");
+  BloomFiltersVisitor visitor;
+  expr.visit(visitor);
+  for (auto filter_expr : visitor.filters) {
+    auto &filter = *filter_expr->filter;
+    m_bloom_probes.push_back(filter.is_built() ? BloomProbe{filter.data(), filter.num_blocks() - 1}
+                                               : BloomProbe{accept_all_block, 0});
+  }
+}
+
+std::shared_ptr<const std::vector<uint8_t>>
+FilterInputs::truth_table(size_t leaf, const std::shared_ptr<arrow::ArrayData> &dictionary,
+                          const std::function<std::vector<uint8_t>()> &build) const {
+  std::lock_guard lock(m_tables_mutex);
+  auto &entry = m_tables[{leaf, dictionary.get()}];
+  if (!entry.second) {
+    entry = {dictionary, std::make_shared<const std::vector<uint8_t>>(build())};
   }
+  return entry.second;
+}
+
+// Comparison, match, list or range check of dictionary field. It is evaluated once per dictionary
+// by kernel over dictionary values, which gives truth table with one byte per code, and filter
+// kernel looks up code of every row in it
+struct DictionaryLeaf {
+  const Expr *expr;
+  size_t field;
+  std::unique_ptr<FilterKernel> kernel;
+};
+
+class DictionaryLeavesVisitor : public ExprVisitor {
+private:
+  const std::vector<std::shared_ptr<const arrow::Field>> &m_fields;
+
+public:
+  std::vector<std::unique_ptr<DictionaryLeaf>> leaves;
+
+  explicit DictionaryLeavesVisitor(const std::vector<std::shared_ptr<const arrow::Field>> &fields)
+      : m_fields(fields) {}
 
   void visit(const CompareExpr &expr) override {
-    if (expr.lhs->name == m_field->name()) {
-      auto &typ = *(m_field->type());
-      auto constant = const_from_variant(typ, expr.rhs->value);
-      switch (expr.op) {
-        PEFA_CASE_BRK(case CompareExpr::Op::GT:,
-                      m_result = create_cmp_gt(typ, *m_builder, m_input, constant))
-        PEFA_CASE_BRK(case CompareExpr::Op::LT:,
-                      m_result = create_cmp_lt(typ, *m_builder, m_input, constant))
-        PEFA_CASE_BRK(case CompareExpr::Op::GE:,
-                      m_result = create_cmp_ge(typ, *m_builder, m_input, constant))
-        PEFA_CASE_BRK(case CompareExpr::Op::LE:,
-                      m_result = create_cmp_le(typ, *m_builder, m_input, constant))
-        PEFA_CASE_BRK(case CompareExpr::Op::EQ:,
-                      m_result = create_cmp_eq(typ, *m_builder, m_input, constant))
-        PEFA_CASE_BRK(case CompareExpr::Op::NEQ:,
-                      m_result = create_cmp_ne(typ, *m_builder, m_input, constant))
-      }
-    } else {
-      // TODO: implement more informative assert
-      assert(false);
+    if (auto column = expr.column()) {
+      add(expr, column->name);
     }
   }
 
-  llvm::Value *result() {
-    return m_result;
+  void visit(const StringMatchExpr &expr) override {
+    add(expr, expr.column->name);
+  }
+
+  void visit(const InExpr &expr) override {
+    add(expr, expr.column->name);
+  }
+
+  void visit(const BetweenExpr &expr) override {
+    add(expr, expr.column->name);
+  }
+
+private:
+  void add(const Expr &expr, const std::string &name) {
+    for (size_t i = 0; i < m_fields.size(); i++) {
+      auto &type = *m_fields[i]->type();
+      if (m_fields[i]->name() != name || type.id() != arrow::Type::DICTIONARY) {
+        continue;
+      }
+      auto leaf = std::make_unique<DictionaryLeaf>();
+      leaf->expr = &expr;
+      leaf->field = i;
+      leaf->kernel = FilterKernel::create_cpu(
+          arrow::field(name, static_cast<const arrow::DictionaryType &>(type).value_type()),
+          expr.shared_from_this());
+      leaves.push_back(std::move(leaf));
+      return;
+    }
   }
 };
 
 class FitlerKernelImpl : public FilterKernel, private utils::LLVMTypesHelper {
 private:
-  std::shared_ptr<const arrow::Field> m_field;
+  std::vector<std::shared_ptr<const arrow::Field>> m_fields;
+  // indices of utf8 and binary fields, whose data buffers follow field inputs
+  std::vector<size_t> m_string_fields;
+  // comparisons and matches of dictionary fields, whose truth tables follow data buffers
+  std::vector<std::unique_ptr<DictionaryLeaf>> m_dictionary_leaves;
+  // bloom filters, whose probes follow truth tables
+  std::vector<const BloomFilterExpr *> m_bloom_filters;
   std::shared_ptr<const Expr> m_expr;
+  bool m_skip_zero_words;
   llvm::LLVMContext m_context;
   llvm::orc::VModuleKey m_moduleKey{};
   bool m_is_compiled = false;
   std::shared_ptr<pefa::jit::JIT> m_jit;
-  void (*m_filter_func)(const uint8_t *, uint8_t *, int64_t){};
-  void (*m_filter_remaining_func)(const uint8_t *, uint8_t *, uint8_t, uint8_t){};
+  void (*m_filter_func)(const uint8_t **, uint8_t *, int64_t){};
+  void (*m_filter_remaining_func)(const uint8_t **, uint8_t *, uint8_t, uint8_t){};
+  // variants, which take validity bitmap and its bit offset for every column
+  void (*m_filter_nullable_func)(const uint8_t **, const uint8_t **, const int64_t *, uint8_t *,
+                                 int64_t){};
+  void (*m_filter_remaining_nullable_func)(const uint8_t **, const uint8_t **, const int64_t *,
+                                           uint8_t *, uint8_t, uint8_t){};
 
 public:
-  FitlerKernelImpl(std::shared_ptr<const arrow::Field> field, std::shared_ptr<const Expr> expr)
-      : m_field(std::move(field))
+  FitlerKernelImpl(std::vector<std::shared_ptr<const arrow::Field>> fields,
+                   std::shared_ptr<const Expr> expr, bool skip_zero_words)
+      : m_fields(std::move(fields))
       , m_expr(std::move(expr))
+      , m_skip_zero_words(skip_zero_words)
       , m_context(llvm::LLVMContext())
       , m_jit(jit::get_JIT())
-      , utils::LLVMTypesHelper(m_context) {}
+      , utils::LLVMTypesHelper(m_context) {
+    for (size_t i = 0; i < m_fields.size(); i++) {
+      if (arrow::is_binary_like(m_fields[i]->type()->id())) {
+        m_string_fields.push_back(i);
+      }
+    }
+    DictionaryLeavesVisitor leaves(m_fields);
+    m_expr->visit(leaves);
+    m_dictionary_leaves = std::move(leaves.leaves);
+    BloomFiltersVisitor bloom_filters;
+    m_expr->visit(bloom_filters);
+    m_bloom_filters = std::move(bloom_filters.filters);
+  }
 
-  void execute(std::shared_ptr<const arrow::Array> column, uint8_t *bitmap,
-               size_t offset) override {
+  using FilterKernel::execute;
+  using FilterKernel::execute_remaining;
+
+  void execute(const std::vector<std::shared_ptr<const arrow::Array>> &columns, uint8_t *bitmap,
+               size_t offset, const FilterInputs &filter_inputs) override {
     if (!m_is_compiled) {
       throw KernelNotCompiledException();
     }
-    if (auto type = dynamic_cast<arrow::FixedWidthType *>(column->type().get())) {
-      m_filter_func(column->data()->buffers[1]->data() + (type->bit_width() * offset / 8),
-                    bitmap + (offset != 0), column->length() - offset);
+    std::vector<std::shared_ptr<const std::vector<uint8_t>>> tables;
+    auto inputs = input_pointers(columns, offset, filter_inputs, tables);
+    auto length = columns.front()->length() - offset;
+    std::vector<const uint8_t *> validity;
+    std::vector<int64_t> validity_offsets;
+    std::shared_ptr<arrow::Buffer> all_valid;
+    if (validity_pointers(columns, offset, validity, validity_offsets, all_valid)) {
+      m_filter_nullable_func(inputs.data(), validity.data(), validity_offsets.data(),
+                             bitmap + (offset != 0), length);
     } else {
-      throw NotImplementedException("Variable length type filtering does not implemented yet");
+      m_filter_func(inputs.data(), bitmap + (offset != 0), length);
     }
   }
 
-  void execute_remaining(std::shared_ptr<const arrow::Array> column, uint8_t *bitmap,
-                         size_t array_offset, uint8_t bit_offset) override {
+  void execute_remaining(const std::vector<std::shared_ptr<const arrow::Array>> &columns,
+                         uint8_t *bitmap, size_t array_offset, uint8_t bit_offset,
+                         const FilterInputs &filter_inputs) override {
     if (!m_is_compiled) {
       throw KernelNotCompiledException();
     }
-    if (auto type = dynamic_cast<arrow::FixedWidthType *>(column->type().get())) {
-      uint8_t len = 0;
-      // begining of chunk
-      if (array_offset == 0) {
-        len = std::min(static_cast<uint8_t>(8 - bit_offset),
-                       static_cast<uint8_t>(column->length() - array_offset));
-      } else {
-        // end of chunk
-        len = static_cast<uint8_t>(column->length() - array_offset);
-      }
-      m_filter_remaining_func(column->data()->buffers[1]->data() +
-                                  (type->bit_width() * array_offset / 8),
-                              bitmap, len, bit_offset);
+    auto length = columns.front()->length();
+    uint8_t len = 0;
+    // begining of chunk
+    if (array_offset == 0) {
+      len = static_cast<uint8_t>(std::min<int64_t>(8 - bit_offset, length));
+    } else {
+      // end of chunk
+      len = static_cast<uint8_t>(length - array_offset);
+    }
+    std::vector<std::shared_ptr<const std::vector<uint8_t>>> tables;
+    auto inputs = input_pointers(columns, array_offset, filter_inputs, tables);
+    std::vector<const uint8_t *> validity;
+    std::vector<int64_t> validity_offsets;
+    std::shared_ptr<arrow::Buffer> all_valid;
+    if (validity_pointers(columns, array_offset, validity, validity_offsets, all_valid)) {
+      m_filter_remaining_nullable_func(inputs.data(), validity.data(), validity_offsets.data(),
+                                       bitmap, len, bit_offset);
     } else {
-      throw NotImplementedException("Variable length type filtering does not implemented yet");
+      m_filter_remaining_func(inputs.data(), bitmap, len, bit_offset);
     }
   }
 
+  [[nodiscard]] const Expr &expr() const override {
+    return *m_expr;
+  }
+
   ~FitlerKernelImpl() override {
     if (m_is_compiled) {
       m_jit->removeModule(m_moduleKey);
@@ -140,168 +219,503 @@ public:
   }
 
   void compile() override {
-    // TODO: use VMModuleKey to resolve collision with another module when finding function
-    auto module = std::make_unique<llvm::Module>(m_field->name() + "_filter_mod", m_context);
+    for (auto &leaf : m_dictionary_leaves) {
+      leaf->kernel->compile();
+    }
+    auto module = std::make_unique<llvm::Module>("filter_mod", m_context);
     module->setTargetTriple(llvm::sys::getProcessTriple());
     gen_predicate_func(*module);
-    gen_filter_func(*module);
-    gen_filter_remaining_func(*module);
+    gen_filter_func(*module, false);
+    gen_filter_func(*module, true);
+    gen_filter_remaining_func(*module, false);
+    gen_filter_remaining_func(*module, true);
     auto &machine = m_jit->getTargetMachine();
     auto layout = machine.createDataLayout();
     module->setDataLayout(layout);
     m_moduleKey = m_jit->addModule(std::move(module));
-    m_filter_func = reinterpret_cast<void (*)(const uint8_t *, uint8_t *, int64_t)>(
-        m_jit->findSymbol(m_field->name() + "_filter").getAddress().get());
+    m_filter_func = reinterpret_cast<void (*)(const uint8_t **, uint8_t *, int64_t)>(
+        m_jit->getSymbolAddress(m_moduleKey, "filter"));
     m_filter_remaining_func =
-        reinterpret_cast<void (*)(const uint8_t *, uint8_t *, uint8_t, uint8_t)>(
-            m_jit->findSymbol(m_field->name() + "_filter_remaining").getAddress().get());
+        reinterpret_cast<void (*)(const uint8_t **, uint8_t *, uint8_t, uint8_t)>(
+            m_jit->getSymbolAddress(m_moduleKey, "filter_remaining"));
+    m_filter_nullable_func =
+        reinterpret_cast<void (*)(const uint8_t **, const uint8_t **, const int64_t *, uint8_t *,
+                                  int64_t)>(
+            m_jit->getSymbolAddress(m_moduleKey, "filter_nullable"));
+    m_filter_remaining_nullable_func =
+        reinterpret_cast<void (*)(const uint8_t **, const uint8_t **, const int64_t *, uint8_t *,
+                                  uint8_t, uint8_t)>(
+            m_jit->getSymbolAddress(m_moduleKey, "filter_remaining_nullable"));
     m_is_compiled = true;
   }
 
 private:
+  // pointers to element <offset> of every column, followed by data buffers of string columns,
+  // truth tables of dictionary leaves, which are kept alive by tables, and probes of bloom filters.
+  // Element of utf8 or binary column is its offset, so kernel reads start and end of the value.
+  // Element of dictionary column is its code
+  std::vector<const uint8_t *>
+  input_pointers(const std::vector<std::shared_ptr<const arrow::Array>> &columns, size_t offset,
+                 const FilterInputs &filter_inputs,
+                 std::vector<std::shared_ptr<const std::vector<uint8_t>>> &tables) {
+    if (columns.size() != m_fields.size() ||
+        filter_inputs.bloom_probes().size() != m_bloom_filters.size()) {
+      throw UnreachableException();
+    }
+    std::vector<const uint8_t *> inputs(columns.size());
+    for (size_t i = 0; i < columns.size(); i++) {
+      auto &column = *columns[i];
+      if (auto type = dynamic_cast<arrow::FixedWidthType *>(column.type().get())) {
+        inputs[i] = column.data()->buffers[1]->data() +
+                    (type->bit_width() * (column.offset() + offset) / 8);
+      } else if (arrow::is_binary_like(column.type_id())) {
+        inputs[i] =
+            reinterpret_cast<const uint8_t *>(column.data()->GetValues<int32_t>(1) + offset);
+      } else {
+        throw NotImplementedException("Filtering of type " + column.type()->ToString() +
+                                      " is not implemented yet");
+      }
+    }
+    for (auto i : m_string_fields) {
+      auto &data = columns[i]->data()->buffers[2];
+      inputs.push_back(data ? data->data() : nullptr);
+    }
+    for (size_t i = 0; i < m_dictionary_leaves.size(); i++) {
+      auto &leaf = *m_dictionary_leaves[i];
+      auto dictionary =
+          static_cast<const arrow::DictionaryArray &>(*columns[leaf.field]).dictionary();
+      tables.push_back(filter_inputs.truth_table(i, dictionary->data(),
+                                                 [&] { return truth_table(leaf, dictionary); }));
+      inputs.push_back(tables.back()->data());
+    }
+    for (auto &probe : filter_inputs.bloom_probes()) {
+      inputs.push_back(reinterpret_cast<const uint8_t *>(&probe));
+    }
+    return inputs;
+  }
+
+  // byte per dictionary code, which is 1 if leaf is true for its value. Table of empty dictionary
+  // has one zero byte, which is read for null rows
+  static std::vector<uint8_t> truth_table(DictionaryLeaf &leaf,
+                                          const std::shared_ptr<arrow::Array> &dictionary) {
+    auto length = dictionary->length();
+    std::vector<uint8_t> table(std::max<int64_t>(length, 1), 0);
+    if (length != 0) {
+      std::vector<uint8_t> bitmap(length / 8 + 1, 255);
+      leaf.kernel->execute(dictionary, bitmap.data(), 0);
+      leaf.kernel->execute_remaining(dictionary, bitmap.data() + length / 8, length / 8 * 8, 0);
+      for (int64_t i = 0; i < length; i++) {
+        table[i] = (bitmap[i / 8] >> (7 - i % 8)) & 1;
+      }
+    }
+    return table;
+  }
+
+  // validity bitmap and bit offset of element <offset> of every column. Returns false if none of
+  // columns has nulls, so kernel without null checks can be used. Columns without validity bitmap
+  // share all_valid bitmap
+  bool validity_pointers(const std::vector<std::shared_ptr<const arrow::Array>> &columns,
+                         size_t offset, std::vector<const uint8_t *> &validity,
+                         std::vector<int64_t> &validity_offsets,
+                         std::shared_ptr<arrow::Buffer> &all_valid) const {
+    bool has_nulls = std::any_of(columns.begin(), columns.end(),
+                                 [](auto &column) { return column->null_count() != 0; });
+    if (!has_nulls) {
+      return false;
+    }
+    for (auto &column : columns) {
+      auto &buffer = column->data()->buffers[0];
+      if (buffer) {
+        validity.push_back(buffer->data());
+        validity_offsets.push_back(column->offset() + offset);
+        continue;
+      }
+      if (!all_valid) {
+        // kernel reads validity bytes, which contain rows, so one byte is enough for the row
+        // after the last one
+        all_valid = arrow::AllocateBitmap(column->length() + 8).ValueOrDie();
+        std::memset(all_valid->mutable_data(), 255, all_valid->size());
+      }
+      validity.push_back(all_valid->data());
+      validity_offsets.push_back(offset);
+    }
+    return true;
+  }
+
+  // type of kernel input of field: value itself, offset of value start for utf8 and binary or
+  // code for dictionary
+  [[nodiscard]] llvm::Type *input_typ(const arrow::DataType &type) const {
+    if (type.id() == arrow::Type::DICTIONARY) {
+      return from_arrow(*static_cast<const arrow::DictionaryType &>(type).index_type());
+    }
+    return arrow::is_binary_like(type.id()) ? i32_typ() : from_arrow(type);
+  }
+
+  // loads i-th input pointer and casts it to pointer to field type
+  std::vector<llvm::Value *> gen_sources(llvm::IRBuilder<> &builder, llvm::Value *inputs) {
+    std::vector<llvm::Value *> sources(m_fields.size());
+    for (size_t i = 0; i < m_fields.size(); i++) {
+      auto input = builder.CreateLoad(builder.CreateInBoundsGEP(inputs, i64val(i)));
+      sources[i] =
+          builder.CreatePointerCast(input, input_typ(*m_fields[i]->type())->getPointerTo());
+    }
+    return sources;
+  }
+
+  // loads data buffers of string fields, which follow field inputs. Other fields have no data
+  std::vector<llvm::Value *> gen_string_data(llvm::IRBuilder<> &builder, llvm::Value *inputs) {
+    std::vector<llvm::Value *> data(m_fields.size(), nullptr);
+    for (size_t i = 0; i < m_string_fields.size(); i++) {
+      data[m_string_fields[i]] = builder.CreateLoad(
+          builder.CreateInBoundsGEP(inputs, i64val(m_fields.size() + i)));
+    }
+    return data;
+  }
+
+  // loads truth tables of dictionary leaves, which follow data buffers
+  std::vector<std::pair<const Expr *, llvm::Value *>> gen_tables(llvm::IRBuilder<> &builder,
+                                                                 llvm::Value *inputs) {
+    std::vector<std::pair<const Expr *, llvm::Value *>> tables;
+    auto first = m_fields.size() + m_string_fields.size();
+    for (size_t i = 0; i < m_dictionary_leaves.size(); i++) {
+      tables.emplace_back(m_dictionary_leaves[i]->expr,
+                          builder.CreateLoad(builder.CreateInBoundsGEP(inputs, i64val(first + i))));
+    }
+    return tables;
+  }
+
+  // loads blocks and block masks of bloom filters from probes, which follow truth tables
+  std::vector<std::pair<const Expr *, BloomInput>> gen_bloom_inputs(llvm::IRBuilder<> &builder,
+                                                                    llvm::Value *inputs) {
+    std::vector<std::pair<const Expr *, BloomInput>> blooms;
+    auto first = m_fields.size() + m_string_fields.size() + m_dictionary_leaves.size();
+    for (size_t i = 0; i < m_bloom_filters.size(); i++) {
+      auto probe = builder.CreatePointerCast(
+          builder.CreateLoad(builder.CreateInBoundsGEP(inputs, i64val(first + i))),
+          i64_typ()->getPointerTo());
+      auto block_mask = builder.CreateLoad(builder.CreateInBoundsGEP(probe, i64val(1)));
+      blooms.emplace_back(m_bloom_filters[i], BloomInput{builder.CreateLoad(probe), block_mask});
+    }
+    return blooms;
+  }
+
+  // bool predicate(TYPE_0 value_0, ..., bool valid_0, ..., int32_t end_k, uint8_t *data_k, ...,
+  //                uint8_t *table_0, ..., int64_t blocks_0, int64_t block_mask_0, ...), where k
+  // are string fields, tables are truth tables of dictionary leaves and blocks are addresses of
+  // bloom filter blocks
   void gen_predicate_func(llvm::Module &module) {
-    std::vector<llvm::Type *> param_type{from_arrow(*m_field->type())};
+    std::vector<llvm::Type *> param_type;
+    for (auto &field : m_fields) {
+      param_type.push_back(input_typ(*field->type()));
+    }
+    param_type.insert(param_type.end(), m_fields.size(), bool_typ());
+    for (size_t i = 0; i < m_string_fields.size(); i++) {
+      param_type.insert(param_type.end(), {i32_typ(), i8_typ()->getPointerTo()});
+    }
+    param_type.insert(param_type.end(), m_dictionary_leaves.size(), i8_typ()->getPointerTo());
+    param_type.insert(param_type.end(), 2 * m_bloom_filters.size(), i64_typ());
     llvm::FunctionType *prototype =
         llvm::FunctionType::get(llvm::Type::getInt1Ty(m_context), param_type, false);
     llvm::Function *func = llvm::Function::Create(prototype, llvm::Function::InternalLinkage,
-                                                  m_field->name() + "_predicate", module);
+                                                  "predicate", module);
     llvm::BasicBlock *body = llvm::BasicBlock::Create(m_context, "body", func);
-    llvm::Value *val = func->getArg(0);
+    std::vector<llvm::Value *> values;
+    std::vector<llvm::Value *> valid;
+    for (size_t i = 0; i < m_fields.size(); i++) {
+      values.push_back(func->getArg(i));
+      valid.push_back(func->getArg(m_fields.size() + i));
+    }
+    std::vector<StringInput> strings(m_fields.size());
+    for (size_t i = 0; i < m_string_fields.size(); i++) {
+      strings[m_string_fields[i]] = {func->getArg(2 * m_fields.size() + 2 * i),
+                                     func->getArg(2 * m_fields.size() + 2 * i + 1)};
+    }
+    std::vector<std::pair<const Expr *, llvm::Value *>> tables;
+    auto first_table = 2 * m_fields.size() + 2 * m_string_fields.size();
+    for (size_t i = 0; i < m_dictionary_leaves.size(); i++) {
+      tables.emplace_back(m_dictionary_leaves[i]->expr, func->getArg(first_table + i));
+    }
+    std::vector<std::pair<const Expr *, BloomInput>> blooms;
+    auto first_bloom = first_table + m_dictionary_leaves.size();
+    for (size_t i = 0; i < m_bloom_filters.size(); i++) {
+      blooms.emplace_back(m_bloom_filters[i], BloomInput{func->getArg(first_bloom + 2 * i),
+                                                         func->getArg(first_bloom + 2 * i + 1)});
+    }
     llvm::IRBuilder builder(m_context);
     builder.SetInsertPoint(body);
 
-    IrEmitVisitor visitor(&m_context, &builder, m_field, val);
+    IrEmitVisitor visitor(&m_context, &builder, m_fields, values, valid, strings, tables, blooms);
     m_expr->visit(visitor);
     builder.CreateRet(visitor.result());
   }
 
-  void gen_filter_func(llvm::Module &module) {
-    // void filter(uint8_t *in, uint8_t *out, uint64_t len) {
-    //     TYPE *source = (TYPE *)in;
-    //     for(int i=0; i<len / 8; i++) {
-    //         int *src = source + i * 8;
-    //         uint8_t tmp_bitmap = 0;
-    //         for(int j=0; j<8; j++) {
-    //            tmp_bitmap |= predicate(src[j]) << (7 - j);
-    //         }
-    //         out[i] &= tmp_bitmap;
+  // if nullable is set, generates filter_nullable function, which additionally takes validity
+  // bitmaps and bit offset of the first element in them
+  void gen_filter_func(llvm::Module &module, bool nullable) {
+    // void filter(uint8_t **in, uint8_t *out, uint64_t len) {
+    //     TYPE_0 *source_0 = (TYPE_0 *)in[0];
+    //     ...
+    //     int64_t i = 0;
+    //     for(; i + LANES <= len; i += LANES) {
+    //         <LANES x i1> mask = predicate(<LANES x TYPE_0> source_0[i:i + LANES], ...);
+    //         *(iLANES *)(out + i / 8) &= pack(mask);
+    //     }
+    //     for(; i + 8 <= len; i += 8) {
+    //         <8 x i1> mask = predicate(<8 x TYPE_0> source_0[i:i + 8], ...);
+    //         out[i / 8] &= pack(mask);
     //     }
     // }
-    std::vector<llvm::Type *> param_type{llvm::Type::getInt8PtrTy(m_context),
+    std::vector<llvm::Type *> param_type{llvm::Type::getInt8PtrTy(m_context)->getPointerTo(),
                                          llvm::Type::getInt8PtrTy(m_context),
                                          llvm::Type::getInt64Ty(m_context)};
+    if (nullable) {
+      param_type.insert(param_type.begin() + 1,
+                        {llvm::Type::getInt8PtrTy(m_context)->getPointerTo(),
+                         llvm::Type::getInt64PtrTy(m_context)});
+    }
 
     llvm::FunctionType *prototype =
         llvm::FunctionType::get(llvm::Type::getVoidTy(m_context), param_type, false);
     llvm::Function *func = llvm::Function::Create(prototype, llvm::Function::ExternalLinkage,
-                                                  m_field->name() + "_filter", module);
+                                                  nullable ? "filter_nullable" : "filter", module);
     llvm::BasicBlock *body = llvm::BasicBlock::Create(m_context, "body", func);
-    llvm::BasicBlock *cond_1 = llvm::BasicBlock::Create(m_context, "outerloop.cond", func);
-    llvm::BasicBlock *for_1 = llvm::BasicBlock::Create(m_context, "outerloop.body", func);
-    llvm::BasicBlock *cond_2 = llvm::BasicBlock::Create(m_context, "innerloop.cond", func);
-    llvm::BasicBlock *for_2 = llvm::BasicBlock::Create(m_context, "innedloop.body", func);
-    llvm::BasicBlock *end_for1 = llvm::BasicBlock::Create(m_context, "outerloop.end", func);
-    llvm::BasicBlock *end_for2 = llvm::BasicBlock::Create(m_context, "innerloop.end", func);
+    llvm::BasicBlock *vec_cond = llvm::BasicBlock::Create(m_context, "vecloop.cond", func);
+    llvm::BasicBlock *vec_body = llvm::BasicBlock::Create(m_context, "vecloop.body", func);
+    llvm::BasicBlock *tail_cond = llvm::BasicBlock::Create(m_context, "tailloop.cond", func);
+    llvm::BasicBlock *tail_body = llvm::BasicBlock::Create(m_context, "tailloop.body", func);
+    llvm::BasicBlock *end = llvm::BasicBlock::Create(m_context, "end", func);
+
+    llvm::Value *arg_inputs = func->getArg(0);
+    llvm::Value *arg_dest = func->getArg(nullable ? 3 : 1);
+    llvm::Value *arg_len = func->getArg(nullable ? 4 : 2);
 
-    llvm::Value *arg_source = func->getArg(0);
-    llvm::Value *arg_dest = func->getArg(1);
-    llvm::Value *arg_len = func->getArg(2);
+    const unsigned lanes = get_vector_lanes(*func);
 
     llvm::IRBuilder builder(m_context);
     builder.SetInsertPoint(body);
     auto *i = builder.CreateAlloca(i64_typ(), nullptr, "i");
-    auto *j = builder.CreateAlloca(i8_typ(), nullptr, "j");
-    auto *tmp_bitmap = builder.CreateAlloca(i8_typ(), nullptr, "tmp_bitmap");
     builder.CreateStore(i64val(0), i);
 
-    // as filter function takes uint8_t array as input, we need to cast it to field type
-    auto *source = builder.CreatePointerCast(arg_source, ptr_from_arrow(*m_field->type()));
-    builder.CreateBr(cond_1);
-
-    builder.SetInsertPoint(cond_1);
-    // for(int i=0; i<arg_len / 8; i++)
-    auto condition =
-        builder.CreateICmpSLT(builder.CreateLoad(i), builder.CreateUDiv(arg_len, i64val(8)));
-    builder.CreateCondBr(condition, for_1, end_for1);
-
-    builder.SetInsertPoint(for_1);
-    auto li = builder.CreateLoad(i);
-    // src = source + i * 8
-    auto src = builder.CreateInBoundsGEP(source, builder.CreateMul(li, i64val(8)), "src");
-    builder.CreateStore(i8val(0), tmp_bitmap);
+    // as filter function takes uint8_t arrays as input, we need to cast them to field types
+    auto sources = gen_sources(builder, arg_inputs);
+    auto data = gen_string_data(builder, arg_inputs);
+    auto tables = gen_tables(builder, arg_inputs);
+    auto blooms = gen_bloom_inputs(builder, arg_inputs);
+    std::vector<ValiditySource> validity;
+    if (nullable) {
+      validity = gen_validity_sources(builder, func->getArg(1), func->getArg(2));
+    }
+    builder.CreateBr(vec_cond);
+
+    // for(; i + LANES <= len; i += LANES)
+    builder.SetInsertPoint(vec_cond);
+    auto vec_condition =
+        builder.CreateICmpSLE(builder.CreateAdd(builder.CreateLoad(i), i64val(lanes)), arg_len);
+    builder.CreateCondBr(vec_condition, vec_body, tail_cond);
+
+    builder.SetInsertPoint(vec_body);
+    gen_filter_block(builder, sources, data, tables, blooms, validity, arg_dest,
+                     builder.CreateLoad(i), lanes);
+    builder.CreateStore(builder.CreateAdd(builder.CreateLoad(i), i64val(lanes)), i);
+    builder.CreateBr(vec_cond);
+
+    // for(; i + 8 <= len; i += 8)
+    builder.SetInsertPoint(tail_cond);
+    auto tail_condition =
+        builder.CreateICmpSLE(builder.CreateAdd(builder.CreateLoad(i), i64val(8)), arg_len);
+    builder.CreateCondBr(tail_condition, tail_body, end);
+
+    builder.SetInsertPoint(tail_body);
+    gen_filter_block(builder, sources, data, tables, blooms, validity, arg_dest,
+                     builder.CreateLoad(i), 8);
+    builder.CreateStore(builder.CreateAdd(builder.CreateLoad(i), i64val(8)), i);
+    builder.CreateBr(tail_cond);
+
+    builder.SetInsertPoint(end);
+    builder.CreateRetVoid();
+  }
 
-    builder.CreateStore(i8val(0), j);
-    builder.CreateBr(cond_2);
+  // validity bitmap of a column, which starts from the byte containing the first element, and
+  // position of that element inside the byte
+  struct ValiditySource {
+    llvm::Value *bitmap;
+    llvm::Value *shift;
+  };
+
+  std::vector<ValiditySource> gen_validity_sources(llvm::IRBuilder<> &builder,
+                                                   llvm::Value *validity,
+                                                   llvm::Value *validity_offsets) {
+    std::vector<ValiditySource> sources(m_fields.size());
+    for (size_t i = 0; i < m_fields.size(); i++) {
+      auto bitmap = builder.CreateLoad(builder.CreateInBoundsGEP(validity, i64val(i)));
+      auto offset = builder.CreateLoad(builder.CreateInBoundsGEP(validity_offsets, i64val(i)));
+      sources[i].bitmap = builder.CreateInBoundsGEP(bitmap, builder.CreateLShr(offset, i64val(3)));
+      sources[i].shift = builder.CreateAnd(offset, i64val(7));
+    }
+    return sources;
+  }
 
-    // for(int j=0; j<8; j++)
-    builder.SetInsertPoint(cond_2);
-    builder.CreateCondBr(builder.CreateICmpSLT(builder.CreateLoad(j), i8val(8)), for_2, end_for2);
+  // loads validity of <lanes> elements starting from pos as <lanes x i1>. Arrow bitmaps store
+  // first element in the least significant bit, which matches lanes order of bitcast
+  llvm::Value *gen_validity_mask(llvm::IRBuilder<> &builder, const ValiditySource &source,
+                                 llvm::Value *pos, unsigned lanes) {
+    auto *packed_typ = llvm::IntegerType::get(m_context, lanes);
+    auto *wide_typ = llvm::IntegerType::get(m_context, lanes + 8);
+    auto *ptr = builder.CreateInBoundsGEP(source.bitmap, builder.CreateLShr(pos, i64val(3)));
+    auto *low = builder.CreateAlignedLoad(
+        builder.CreatePointerCast(ptr, packed_typ->getPointerTo()), llvm::MaybeAlign(1));
+    // byte after the word is needed only if elements are not aligned to bytes. Otherwise it may
+    // lie outside of the bitmap, so the last byte of the word is loaded again instead
+    auto *is_aligned = builder.CreateICmpEQ(source.shift, i64val(0));
+    auto *high_ptr = builder.CreateInBoundsGEP(
+        ptr, builder.CreateSelect(is_aligned, i64val(lanes / 8 - 1), i64val(lanes / 8)));
+    auto *high = builder.CreateLoad(high_ptr);
+    // (low | high << lanes) >> shift
+    auto *word = builder.CreateOr(builder.CreateZExt(low, wide_typ),
+                                  builder.CreateShl(builder.CreateZExt(high, wide_typ),
+                                                    llvm::ConstantInt::get(wide_typ, lanes)));
+    auto *shifted = builder.CreateLShr(word, builder.CreateZExtOrTrunc(source.shift, wide_typ));
+    return builder.CreateBitCast(builder.CreateTrunc(shifted, packed_typ),
+                                 llvm::VectorType::get(bool_typ(), lanes));
+  }
 
-    builder.SetInsertPoint(for_2);
+  // evaluates predicate for <lanes> elements starting from sources[pos] and ANDs packed result
+  // into <lanes / 8> bytes of dest starting from dest[pos / 8]
+  void gen_filter_block(llvm::IRBuilder<> &builder, const std::vector<llvm::Value *> &sources,
+                        const std::vector<llvm::Value *> &data,
+                        const std::vector<std::pair<const Expr *, llvm::Value *>> &tables,
+                        const std::vector<std::pair<const Expr *, BloomInput>> &blooms,
+                        const std::vector<ValiditySource> &validity, llvm::Value *dest,
+                        llvm::Value *pos, unsigned lanes) {
+    auto *packed_typ = llvm::IntegerType::get(m_context, lanes);
+    auto *out = builder.CreatePointerCast(
+        builder.CreateInBoundsGEP(dest, builder.CreateLShr(pos, i64val(3))),
+        packed_typ->getPointerTo());
+    auto *current = builder.CreateAlignedLoad(out, llvm::MaybeAlign(1));
+
+    llvm::BasicBlock *block_end = nullptr;
+    if (m_skip_zero_words) {
+      // if (current == 0) skip; rows of that word are already filtered out, so even their data
+      // is not loaded
+      auto *func = builder.GetInsertBlock()->getParent();
+      auto *block_eval = llvm::BasicBlock::Create(m_context, "block.eval", func);
+      block_end = llvm::BasicBlock::Create(m_context, "block.end", func);
+      auto *is_zero = builder.CreateICmpEQ(current, llvm::ConstantInt::get(packed_typ, 0));
+      builder.CreateCondBr(is_zero, block_end, block_eval);
+      builder.SetInsertPoint(block_eval);
+    }
 
-    // bit = predicate(src[j]);
-    auto bit = builder.CreateIntCast(
-        builder.CreateCall(
-            module.getFunction(m_field->name() + "_predicate"),
-            {builder.CreateLoad(builder.CreateInBoundsGEP(src, builder.CreateLoad(j)))}),
-        i8_typ(), false);
+    std::vector<llvm::Value *> values(m_fields.size());
+    std::vector<StringInput> strings(m_fields.size());
+    for (size_t i = 0; i < m_fields.size(); i++) {
+      auto &typ = *m_fields[i]->type();
+      auto elem_align = llvm::MaybeAlign(type_bit_width(typ) / 8);
+      auto *vec_ptr_typ = llvm::VectorType::get(input_typ(typ), lanes)->getPointerTo();
+      auto load = [&](llvm::Value *at) {
+        return builder.CreateAlignedLoad(
+            builder.CreatePointerCast(builder.CreateInBoundsGEP(sources[i], at), vec_ptr_typ),
+            elem_align);
+      };
+      values[i] = load(pos);
+      if (data[i]) {
+        // end of value is start of the next one, offsets buffer has one more element for the last
+        strings[i] = {load(builder.CreateAdd(pos, i64val(1))), data[i]};
+      }
+    }
 
-    // bit_with_shift = bit << (7 - j)
-    auto bit_with_shift =
-        builder.CreateShl(bit, builder.CreateSub(i8val(7), builder.CreateLoad(j)));
+    std::vector<llvm::Value *> valid;
+    for (auto &source : validity) {
+      valid.push_back(gen_validity_mask(builder, source, pos, lanes));
+    }
 
-    // tmp_bitmap |= bit_with_shift
-    auto updated_tmp_bitmap = builder.CreateOr(builder.CreateLoad(tmp_bitmap), bit_with_shift);
-    builder.CreateStore(updated_tmp_bitmap, tmp_bitmap);
+    IrEmitVisitor visitor(&m_context, &builder, m_fields, values, valid, strings, tables, blooms);
+    m_expr->visit(visitor);
 
-    // j++
-    builder.CreateStore(builder.CreateAdd(builder.CreateLoad(j), i8val(1)), j);
-    builder.CreateBr(cond_2);
+    // bitmap is filled starting from the most significant bit of each byte, while bitcast of
+    // <N x i1> places first lane into the least significant bit, so lanes are reversed per byte
+    std::vector<uint32_t> reversed(lanes);
+    for (unsigned lane = 0; lane < lanes; lane++) {
+      reversed[lane] = (lane / 8) * 8 + 7 - lane % 8;
+    }
+    auto *mask = builder.CreateShuffleVector(
+        visitor.result(), llvm::UndefValue::get(visitor.result()->getType()), reversed);
+    auto *packed = builder.CreateBitCast(mask, packed_typ);
 
-    // end inner loop
-    builder.SetInsertPoint(end_for2);
+    // out[pos / 8] &= packed
+    builder.CreateAlignedStore(builder.CreateAnd(current, packed), out, llvm::MaybeAlign(1));
 
-    // dst[i] &= tmp_bitmap
-    auto dest_val = builder.CreateLoad(builder.CreateInBoundsGEP(arg_dest, builder.CreateLoad(i)));
-    auto updated_bitmap = builder.CreateAnd(dest_val, builder.CreateLoad(tmp_bitmap));
-    builder.CreateStore(updated_bitmap, builder.CreateInBoundsGEP(arg_dest, builder.CreateLoad(i)));
+    if (block_end) {
+      builder.CreateBr(block_end);
+      builder.SetInsertPoint(block_end);
+    }
+  }
 
-    // i++
-    builder.CreateStore(builder.CreateAdd(builder.CreateLoad(i), i64val(1)), i);
-    builder.CreateBr(cond_1);
+  // number of elements processed by one iteration of vectorized loop. It is chosen to fill
+  // the widest vector register of the host with the narrowest field, but it is at least 8
+  // (one bitmap byte) and at most 64. Kernels, which skip decided words, always process 64-row
+  // words, so that skipping check is done once per word
+  unsigned get_vector_lanes(const llvm::Function &func) {
+    if (m_skip_zero_words) {
+      return 64;
+    }
+    // string fields are accounted by their 32-bit offsets and dictionary fields by their codes
+    auto tti = m_jit->getTargetMachine().getTargetTransformInfo(func);
+    auto register_width = std::max(tti.getRegisterBitWidth(true), 128u);
+    unsigned min_type_width = 64;
+    for (auto &field : m_fields) {
+      min_type_width = std::min(min_type_width, type_bit_width(*field->type()));
+    }
+    auto lanes = register_width / min_type_width;
+    return std::clamp((lanes + 7) / 8 * 8, 8u, 64u);
+  }
 
-    // end outer loop
-    builder.SetInsertPoint(end_for1);
-    builder.CreateRetVoid();
+  [[nodiscard]] static unsigned type_bit_width(const arrow::DataType &type) {
+    if (arrow::is_binary_like(type.id())) {
+      return 32;
+    }
+    return static_cast<const arrow::FixedWidthType &>(type).bit_width();
   }
 
   // filters remaining first/last elements
-  void gen_filter_remaining_func(llvm::Module &module) {
+  void gen_filter_remaining_func(llvm::Module &module, bool nullable) {
     std::vector<llvm::Type *> param_type{
-        llvm::Type::getInt8PtrTy(m_context), llvm::Type::getInt8PtrTy(m_context),
+        llvm::Type::getInt8PtrTy(m_context)->getPointerTo(), llvm::Type::getInt8PtrTy(m_context),
         llvm::Type::getInt8Ty(m_context), llvm::Type::getInt8Ty(m_context)};
+    if (nullable) {
+      param_type.insert(param_type.begin() + 1,
+                        {llvm::Type::getInt8PtrTy(m_context)->getPointerTo(),
+                         llvm::Type::getInt64PtrTy(m_context)});
+    }
 
     llvm::FunctionType *prototype =
         llvm::FunctionType::get(llvm::Type::getVoidTy(m_context), param_type, false);
 
-    llvm::Function *func = llvm::Function::Create(prototype, llvm::Function::ExternalLinkage,
-                                                  m_field->name() + "_filter_remaining", module);
+    llvm::Function *func = llvm::Function::Create(
+        prototype, llvm::Function::ExternalLinkage,
+        nullable ? "filter_remaining_nullable" : "filter_remaining", module);
 
     llvm::BasicBlock *body = llvm::BasicBlock::Create(m_context, "body", func);
     llvm::BasicBlock *cond = llvm::BasicBlock::Create(m_context, "loop.cond", func);
     llvm::BasicBlock *loop = llvm::BasicBlock::Create(m_context, "loop.body", func);
     llvm::BasicBlock *end_loop = llvm::BasicBlock::Create(m_context, "loop.end", func);
 
-    llvm::Value *arg_source = func->getArg(0);
-    llvm::Value *arg_dest = func->getArg(1);
-    llvm::Value *arg_len = func->getArg(2);
-    llvm::Value *arg_bit_offset = func->getArg(3);
+    llvm::Value *arg_inputs = func->getArg(0);
+    llvm::Value *arg_dest = func->getArg(nullable ? 3 : 1);
+    llvm::Value *arg_len = func->getArg(nullable ? 4 : 2);
+    llvm::Value *arg_bit_offset = func->getArg(nullable ? 5 : 3);
 
     llvm::IRBuilder builder(m_context);
     builder.SetInsertPoint(body);
     auto *i = builder.CreateAlloca(i8_typ(), nullptr, "i");
     builder.CreateStore(i8val(0), i);
-    auto *source = builder.CreatePointerCast(arg_source, ptr_from_arrow(*m_field->type()));
+    auto sources = gen_sources(builder, arg_inputs);
+    auto data = gen_string_data(builder, arg_inputs);
+    auto tables = gen_tables(builder, arg_inputs);
+    auto blooms = gen_bloom_inputs(builder, arg_inputs);
+    std::vector<ValiditySource> validity;
+    if (nullable) {
+      validity = gen_validity_sources(builder, func->getArg(1), func->getArg(2));
+    }
     builder.CreateBr(cond);
 
     builder.SetInsertPoint(cond);
@@ -310,12 +724,41 @@ private:
 
     builder.SetInsertPoint(loop);
 
+    std::vector<llvm::Value *> values;
+    for (auto source : sources) {
+      auto elem_ptr = builder.CreateInBoundsGEP(source, builder.CreateLoad(i));
+      values.push_back(builder.CreateLoad(elem_ptr));
+    }
+    for (size_t field = 0; field < m_fields.size(); field++) {
+      if (!nullable) {
+        values.push_back(boolval(true));
+        continue;
+      }
+      // (bitmap[(shift + i) / 8] >> ((shift + i) % 8)) & 1
+      auto pos = builder.CreateAdd(validity[field].shift,
+                                   builder.CreateZExt(builder.CreateLoad(i), i64_typ()));
+      auto byte = builder.CreateLoad(
+          builder.CreateInBoundsGEP(validity[field].bitmap, builder.CreateLShr(pos, i64val(3))));
+      auto bit = builder.CreateLShr(byte, builder.CreateTrunc(builder.CreateAnd(pos, i64val(7)),
+                                                              i8_typ()));
+      values.push_back(builder.CreateTrunc(bit, bool_typ()));
+    }
+    for (auto field : m_string_fields) {
+      auto next = builder.CreateAdd(builder.CreateLoad(i), i8val(1));
+      values.push_back(builder.CreateLoad(builder.CreateInBoundsGEP(sources[field], next)));
+      values.push_back(data[field]);
+    }
+    for (auto &table : tables) {
+      values.push_back(table.second);
+    }
+    for (auto &bloom : blooms) {
+      values.insert(values.end(), {bloom.second.blocks, bloom.second.block_mask});
+    }
+
     // TODO: understand where it is necessary to use signed operations in filter kernel
-    auto bit = builder.CreateIntCast(
-        builder.CreateCall(
-            module.getFunction(m_field->name() + "_predicate"),
-            {builder.CreateLoad(builder.CreateInBoundsGEP(source, builder.CreateLoad(i)))}),
-        i8_typ(), false);
+    auto bit =
+        builder.CreateIntCast(builder.CreateCall(module.getFunction("predicate"), values),
+                              i8_typ(), false);
 
     // ~(((~bit) & 1) << (7 - i - offset)
     auto masked_bit = builder.CreateNot(builder.CreateShl(
@@ -333,8 +776,37 @@ private:
   }
 };
 
+void FilterKernel::execute(const std::vector<std::shared_ptr<const arrow::Array>> &columns,
+                           uint8_t *bitmap, size_t offset) {
+  execute(columns, bitmap, offset, FilterInputs(expr()));
+}
+
+void FilterKernel::execute_remaining(
+    const std::vector<std::shared_ptr<const arrow::Array>> &columns, uint8_t *bitmap,
+    size_t array_offset, uint8_t bit_offset) {
+  execute_remaining(columns, bitmap, array_offset, bit_offset, FilterInputs(expr()));
+}
+
+void FilterKernel::execute(std::shared_ptr<const arrow::Array> column, uint8_t *bitmap,
+                           size_t offset) {
+  execute(std::vector<std::shared_ptr<const arrow::Array>>{std::move(column)}, bitmap, offset);
+}
+
+void FilterKernel::execute_remaining(std::shared_ptr<const arrow::Array> column, uint8_t *bitmap,
+                                     size_t array_offset, uint8_t bit_offset) {
+  execute_remaining(std::vector<std::shared_ptr<const arrow::Array>>{std::move(column)}, bitmap,
+                    array_offset, bit_offset);
+}
+
 std::unique_ptr<FilterKernel> FilterKernel::create_cpu(std::shared_ptr<const arrow::Field> field,
                                                        std::shared_ptr<const Expr> expr) {
-  return std::make_unique<FitlerKernelImpl>(std::move(field), std::move(expr));
+  return create_cpu(std::vector<std::shared_ptr<const arrow::Field>>{std::move(field)},
+                    std::move(expr));
+}
+
+std::unique_ptr<FilterKernel>
+FilterKernel::create_cpu(std::vector<std::shared_ptr<const arrow::Field>> fields,
+                         std::shared_ptr<const Expr> expr, bool skip_zero_words) {
+  return std::make_unique<FitlerKernelImpl>(std::move(fields), std::move(expr), skip_zero_words);
 }
-} // namespace pefa::kernels
\ No newline at end of file
+} // namespace pefa::kernels
@@ -2,23 +2,90 @@
 #include "pefa/query_compiler/expressions.h"
 
 #include <arrow/api.h>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <utility>
+#include <vector>
 
 namespace pefa::kernels {
 using namespace query_compiler;
+
+// Inputs of kernel, which are not compiled into it, so kernels are shared by all expressions with
+// the same fingerprint. They are collected from expression, which is evaluated, and are valid while
+// it is alive. Inputs are created per evaluation, so data, which is built for it, is released with
+// them rather than kept by cached kernel
+class FilterInputs {
+public:
+  // blocks of bloom filter and mask, which selects block index from hash, as kernel reads them
+  struct BloomProbe {
+    const uint32_t *blocks;
+    int64_t block_mask;
+  };
+
+  explicit FilterInputs(const Expr &expr);
+
+  // one per bloom filter of expression in order of their appearance
+  [[nodiscard]] const std::vector<BloomProbe> &bloom_probes() const {
+    return m_bloom_probes;
+  }
+
+  // truth table of leaf-th dictionary leaf of kernel over dictionary, which is built by build on
+  // the first request, so chunks with shared dictionary reuse it. Safe to call from several
+  // threads at once
+  [[nodiscard]] std::shared_ptr<const std::vector<uint8_t>>
+  truth_table(size_t leaf, const std::shared_ptr<arrow::ArrayData> &dictionary,
+              const std::function<std::vector<uint8_t>()> &build) const;
+
+private:
+  std::vector<BloomProbe> m_bloom_probes;
+  mutable std::mutex m_tables_mutex;
+  // dictionaries are kept alive by entries, so their addresses are not reused while inputs live
+  mutable std::map<std::pair<size_t, const arrow::ArrayData *>,
+                   std::pair<std::shared_ptr<arrow::ArrayData>,
+                             std::shared_ptr<const std::vector<uint8_t>>>>
+      m_tables;
+};
+
 class FilterKernel {
 public:
   // Filter kernel generates validity bitmap for array with ones on posiotions, where expr is true
   // It does not takes into account last <(size - offset) % 8> elements, and first <offset> elements
   // which should be processed separately to avoid data dependency between chunks
 
-  virtual void execute(std::shared_ptr<const arrow::Array>, uint8_t *bitmap, size_t offset) = 0;
-  virtual void execute_remaining(std::shared_ptr<const arrow::Array> column, uint8_t *bitmap,
-                                 size_t array_offset, uint8_t bit_offset) = 0;
+  // Kernel may evaluate expression over several fields at once. In that case columns contain one
+  // array per field (in order of fields passed to create_cpu) and all of them have same length.
+  // Inputs are collected from evaluated expression, which may differ from expression, kernel is
+  // created for, only in data, which is not compiled
+  virtual void execute(const std::vector<std::shared_ptr<const arrow::Array>> &columns,
+                       uint8_t *bitmap, size_t offset, const FilterInputs &inputs) = 0;
+  virtual void execute_remaining(const std::vector<std::shared_ptr<const arrow::Array>> &columns,
+                                 uint8_t *bitmap, size_t array_offset, uint8_t bit_offset,
+                                 const FilterInputs &inputs) = 0;
   virtual void compile() = 0;
 
+  // expression, which kernel is created for
+  [[nodiscard]] virtual const Expr &expr() const = 0;
+
+  // evaluate expression, which kernel is created for
+  void execute(const std::vector<std::shared_ptr<const arrow::Array>> &columns, uint8_t *bitmap,
+               size_t offset);
+  void execute_remaining(const std::vector<std::shared_ptr<const arrow::Array>> &columns,
+                         uint8_t *bitmap, size_t array_offset, uint8_t bit_offset);
+  void execute(std::shared_ptr<const arrow::Array> column, uint8_t *bitmap, size_t offset);
+  void execute_remaining(std::shared_ptr<const arrow::Array> column, uint8_t *bitmap,
+                         size_t array_offset, uint8_t bit_offset);
+
   [[nodiscard]] static std::unique_ptr<FilterKernel>
   create_cpu(std::shared_ptr<const arrow::Field> field, std::shared_ptr<const Expr> expr);
 
+  // if skip_zero_words is set, kernel does not evaluate expression for 64-row words, which are
+  // already zero in bitmap
+  [[nodiscard]] static std::unique_ptr<FilterKernel>
+  create_cpu(std::vector<std::shared_ptr<const arrow::Field>> fields,
+             std::shared_ptr<const Expr> expr, bool skip_zero_words = false);
+
   virtual ~FilterKernel() = default;
 };
-} // namespace pefa::kernels
\ No newline at end of file
+} // namespace pefa::kernels
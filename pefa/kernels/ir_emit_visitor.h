@@ -0,0 +1,850 @@
+#pragma once
+#include "value_types.h"
+
+#include "pefa/query_compiler/expressions.h"
+#include "pefa/utils/bloom_filter.h"
+#include "pefa/utils/exceptions.h"
+#include "pefa/utils/llvm_helpers.h"
+#include "pefa/utils/string_match.h"
+#include "pefa/utils/utils.h"
+
+#include <algorithm>
+#include <arrow/api.h>
+#include <arrow/type_traits.h>
+#include <cstring>
+#include <functional>
+#include <cmath>
+#include <llvm/IR/Constants.h>
+#include <llvm/IR/GlobalVariable.h>
+#include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace pefa::kernels {
+using namespace query_compiler;
+
+// Input of utf8 or binary field. Input value of such field is offset of value start, while end
+// offset and data buffer, which offsets point into, are passed separately
+struct StringInput {
+  llvm::Value *ends = nullptr;
+  llvm::Value *data = nullptr;
+};
+
+// Input of bloom filter probe: address of filter blocks and mask, which selects block index from
+// hash, both as int64. They are passed at runtime, so kernel is shared by filters of all sizes
+struct BloomInput {
+  llvm::Value *blocks = nullptr;
+  llvm::Value *block_mask = nullptr;
+};
+
+// Emits IR, which evaluates boolean expression over inputs, or value expression by emit_value.
+// Inputs are either scalars or vectors of lanes, then expression is evaluated for every lane.
+// Value expressions inside of comparisons are evaluated in type, which is requested by their parent
+class IrEmitVisitor : public ExprVisitor, private utils::LLVMTypesHelper {
+private:
+  llvm::Value *m_result;
+  llvm::IRBuilder<> *m_builder;
+  llvm::LLVMContext *m_context;
+  const std::vector<std::shared_ptr<const arrow::Field>> &m_fields;
+  // one value per field, either scalar or vector of lanes
+  std::vector<llvm::Value *> m_inputs;
+  // validity of every input of the same shape as inputs, or empty if inputs have no nulls
+  std::vector<llvm::Value *> m_valid;
+  // one per field, set only for utf8 and binary fields
+  std::vector<StringInput> m_strings;
+  // truth tables of dictionary field predicates, whose inputs are codes
+  std::vector<std::pair<const Expr *, llvm::Value *>> m_tables;
+  std::vector<std::pair<const Expr *, BloomInput>> m_blooms;
+  // type, to which currently visited value expression is converted
+  const arrow::DataType *m_value_type = nullptr;
+
+public:
+  IrEmitVisitor(llvm::LLVMContext *context, llvm::IRBuilder<> *builder,
+                const std::vector<std::shared_ptr<const arrow::Field>> &fields,
+                std::vector<llvm::Value *> inputs, std::vector<llvm::Value *> valid = {},
+                std::vector<StringInput> strings = {},
+                std::vector<std::pair<const Expr *, llvm::Value *>> tables = {},
+                std::vector<std::pair<const Expr *, BloomInput>> blooms = {})
+      : utils::LLVMTypesHelper(*context)
+      , m_result(nullptr)
+      , m_builder(builder)
+      , m_context(context)
+      , m_fields(fields)
+      , m_inputs(std::move(inputs))
+      , m_valid(std::move(valid))
+      , m_strings(std::move(strings))
+      , m_tables(std::move(tables))
+      , m_blooms(std::move(blooms)) {
+    m_strings.resize(m_fields.size());
+  }
+
+  void visit(const PredicateExpr &expr) override {
+    expr.lhs->visit(*this);
+    auto lhs = m_result;
+    expr.rhs->visit(*this);
+    auto rhs = m_result;
+    switch (expr.op) {
+      PEFA_CASE_BRK(case PredicateExpr::Op::OR:, m_result = m_builder->CreateOr(lhs, rhs))
+      PEFA_CASE_BRK(case PredicateExpr::Op::AND:, m_result = m_builder->CreateAnd(lhs, rhs))
+    }
+  }
+
+  void visit(const CompareExpr &expr) override {
+    auto column = expr.column();
+    if (!column) {
+      emit_value_compare(expr);
+      return;
+    }
+    auto idx = field_index(column->name);
+    auto &typ = *(m_fields[idx]->type());
+    auto &literal = expr.literal()->value;
+    if (typ.id() == arrow::Type::DICTIONARY || arrow::is_binary_like(typ.id())) {
+      m_result = typ.id() == arrow::Type::DICTIONARY ? emit_table_lookup(expr, idx)
+                                                     : emit_string_compare(idx, expr.op, literal);
+      if (!m_valid.empty()) {
+        m_result = m_builder->CreateAnd(m_result, m_valid[idx]);
+      }
+      return;
+    }
+    // fractional literal is not truncated to integer column, but both are compared as float64
+    if (std::holds_alternative<double>(literal) && is_integral(typ)) {
+      emit_value_compare(expr);
+      return;
+    }
+    m_result = emit_compare(typ, expr.op, m_inputs[idx], splat(const_from_variant(typ, literal)));
+    // comparison with null is unknown, which is the same as false, as there is no negation of
+    // boolean expressions, and unknown result of the whole expression filters row out
+    if (!m_valid.empty()) {
+      m_result = m_builder->CreateAnd(m_result, m_valid[idx]);
+    }
+  }
+
+  void visit(const ColumnRef &expr) override {
+    auto idx = field_index(expr.name);
+    m_result = convert(m_inputs[idx], *m_fields[idx]->type(), *m_value_type);
+  }
+
+  void visit(const LiteralExpr &expr) override {
+    auto &value = expr.value;
+    if (!std::holds_alternative<int>(value) && !std::holds_alternative<double>(value)) {
+      throw NotImplementedException("Only numeric literals are supported in arithmetic");
+    }
+    // fractional literal is converted like values of float64 type, e.g. when it is cast to integer
+    auto float64 = arrow::float64();
+    auto &literal_typ = std::holds_alternative<double>(value) ? *float64 : *m_value_type;
+    m_result = convert(splat(const_from_variant(literal_typ, value)), literal_typ, *m_value_type);
+  }
+
+  void visit(const ArithmeticExpr &expr) override {
+    auto &target = *m_value_type;
+    auto typ = value_type(expr, m_fields);
+    auto lhs = emit_value(*expr.lhs, *typ);
+    auto rhs = emit_value(*expr.rhs, *typ);
+    bool floating = is_floating(*typ);
+    llvm::Value *result = nullptr;
+    switch (expr.op) {
+    case ArithmeticExpr::Op::ADD:
+      result = floating ? m_builder->CreateFAdd(lhs, rhs) : m_builder->CreateAdd(lhs, rhs);
+      break;
+    case ArithmeticExpr::Op::SUB:
+      result = floating ? m_builder->CreateFSub(lhs, rhs) : m_builder->CreateSub(lhs, rhs);
+      break;
+    case ArithmeticExpr::Op::MUL:
+      result = floating ? m_builder->CreateFMul(lhs, rhs) : m_builder->CreateMul(lhs, rhs);
+      break;
+    case ArithmeticExpr::Op::DIV:
+      // operands are float64, see ArithmeticExpr
+      result = m_builder->CreateFDiv(lhs, rhs);
+      break;
+    }
+    m_result = convert(result, *typ, target);
+  }
+
+  void visit(const CastExpr &expr) override {
+    auto &target = *m_value_type;
+    // literal has no type of its own, so it is taken right in type of cast
+    auto source = value_type(*expr.operand, m_fields);
+    auto &source_typ = source ? *source : *expr.type;
+    auto value = convert(emit_value(*expr.operand, source_typ), source_typ, *expr.type);
+    m_result = convert(value, *expr.type, target);
+  }
+
+  void visit(const BooleanConst &expr) override {
+    m_result = splat(boolval(expr.value));
+  }
+
+  void visit(const BloomFilterExpr &expr) override {
+    auto idx = field_index(expr.column->name);
+    auto found = std::find_if(m_blooms.begin(), m_blooms.end(),
+                              [&](auto &bloom) { return bloom.first == &expr; });
+    if (found == m_blooms.end()) {
+      throw UnreachableException();
+    }
+    m_result = emit_bloom_probe(found->second, *(m_fields[idx]->type()), m_inputs[idx]);
+    if (!m_valid.empty()) {
+      m_result = m_builder->CreateAnd(m_result, m_valid[idx]);
+    }
+  }
+
+  void visit(const StringMatchExpr &expr) override {
+    auto idx = field_index(expr.column->name);
+    auto &typ = *(m_fields[idx]->type());
+    if (typ.id() == arrow::Type::DICTIONARY) {
+      m_result = emit_table_lookup(expr, idx);
+      if (!m_valid.empty()) {
+        m_result = m_builder->CreateAnd(m_result, m_valid[idx]);
+      }
+      return;
+    }
+    if (!arrow::is_binary_like(typ.id())) {
+      throw NotImplementedException("Pattern matching of column of type " + typ.ToString() +
+                                    " is not supported");
+    }
+    using Kind = utils::LikePattern::Kind;
+    utils::LikePattern pattern;
+    switch (expr.op) {
+      PEFA_CASE_BRK(case StringMatchExpr::Op::STARTS_WITH:,
+                    pattern = {Kind::STARTS_WITH, expr.pattern})
+      PEFA_CASE_BRK(case StringMatchExpr::Op::ENDS_WITH:, pattern = {Kind::ENDS_WITH, expr.pattern})
+      PEFA_CASE_BRK(case StringMatchExpr::Op::CONTAINS:, pattern = {Kind::CONTAINS, expr.pattern})
+      PEFA_CASE_BRK(case StringMatchExpr::Op::LIKE:, pattern = utils::simplify_like(expr.pattern))
+    }
+    m_result = emit_string_match(idx, pattern);
+    if (!m_valid.empty()) {
+      m_result = m_builder->CreateAnd(m_result, m_valid[idx]);
+    }
+  }
+
+  void visit(const InExpr &expr) override {
+    auto idx = field_index(expr.column->name);
+    auto &typ = *(m_fields[idx]->type());
+    if (typ.id() == arrow::Type::DICTIONARY) {
+      m_result = emit_table_lookup(expr, idx);
+    } else if (arrow::is_binary_like(typ.id())) {
+      m_result = splat(boolval(false));
+      for (auto &value : expr.values) {
+        m_result = m_builder->CreateOr(m_result,
+                                       emit_string_compare(idx, CompareExpr::Op::EQ, value));
+      }
+    } else {
+      switch (typ.id()) {
+        PEFA_CASE_BRK(PEFA_INT8_CASE, m_result = emit_in_list<int8_t>(expr, idx))
+        PEFA_CASE_BRK(PEFA_INT16_CASE, m_result = emit_in_list<int16_t>(expr, idx))
+        PEFA_CASE_BRK(PEFA_INT32_CASE, m_result = emit_in_list<int32_t>(expr, idx))
+        PEFA_CASE_BRK(PEFA_INT64_CASE, m_result = emit_in_list<int64_t>(expr, idx))
+        PEFA_CASE_BRK(PEFA_UINT8_CASE, m_result = emit_in_list<uint8_t>(expr, idx))
+        PEFA_CASE_BRK(PEFA_UINT16_CASE, m_result = emit_in_list<uint16_t>(expr, idx))
+        PEFA_CASE_BRK(PEFA_UINT32_CASE, m_result = emit_in_list<uint32_t>(expr, idx))
+        PEFA_CASE_BRK(PEFA_UINT64_CASE, m_result = emit_in_list<uint64_t>(expr, idx))
+        PEFA_CASE_BRK(PEFA_FLOAT32_CASE, m_result = emit_in_list<float>(expr, idx))
+        PEFA_CASE_BRK(PEFA_FLOAT64_CASE, m_result = emit_in_list<double>(expr, idx))
+      default:
+        throw NotImplementedException("IN list over column of type " + typ.ToString() +
+                                      " is not supported");
+      }
+    }
+    if (!m_valid.empty()) {
+      m_result = m_builder->CreateAnd(m_result, m_valid[idx]);
+    }
+  }
+
+  void visit(const BetweenExpr &expr) override {
+    auto idx = field_index(expr.column->name);
+    auto &typ = *(m_fields[idx]->type());
+    auto lower = std::get_if<int>(&expr.lower);
+    auto upper = std::get_if<int>(&expr.upper);
+    if (typ.id() == arrow::Type::DICTIONARY) {
+      m_result = emit_table_lookup(expr, idx);
+    } else if (arrow::is_binary_like(typ.id())) {
+      m_result = m_builder->CreateAnd(emit_string_compare(idx, CompareExpr::Op::GE, expr.lower),
+                                      emit_string_compare(idx, CompareExpr::Op::LE, expr.upper));
+    } else if (is_integral(typ) && lower && upper) {
+      switch (typ.id()) {
+        PEFA_CASE_BRK(PEFA_INT8_CASE, m_result = emit_range_check<int8_t>(idx, *lower, *upper))
+        PEFA_CASE_BRK(PEFA_INT16_CASE, m_result = emit_range_check<int16_t>(idx, *lower, *upper))
+        PEFA_CASE_BRK(PEFA_INT32_CASE, m_result = emit_range_check<int32_t>(idx, *lower, *upper))
+        PEFA_CASE_BRK(PEFA_INT64_CASE, m_result = emit_range_check<int64_t>(idx, *lower, *upper))
+        PEFA_CASE_BRK(PEFA_UINT8_CASE, m_result = emit_range_check<uint8_t>(idx, *lower, *upper))
+        PEFA_CASE_BRK(PEFA_UINT16_CASE,
+                      m_result = emit_range_check<uint16_t>(idx, *lower, *upper))
+        PEFA_CASE_BRK(PEFA_UINT32_CASE,
+                      m_result = emit_range_check<uint32_t>(idx, *lower, *upper))
+        PEFA_CASE_BRK(PEFA_UINT64_CASE,
+                      m_result = emit_range_check<uint64_t>(idx, *lower, *upper))
+      default:
+        throw UnreachableException();
+      }
+    } else {
+      // floating columns and fractional bounds are compared as two bounds
+      CompareExpr::create(expr.column, lit(expr.lower), CompareExpr::Op::GE)->visit(*this);
+      auto lower_ok = m_result;
+      CompareExpr::create(expr.column, lit(expr.upper), CompareExpr::Op::LE)->visit(*this);
+      m_result = m_builder->CreateAnd(lower_ok, m_result);
+    }
+    if (!m_valid.empty()) {
+      m_result = m_builder->CreateAnd(m_result, m_valid[idx]);
+    }
+  }
+
+  llvm::Value *result() {
+    return m_result;
+  }
+
+  // evaluates value expression, converted to typ
+  llvm::Value *emit_value(const Expr &expr, const arrow::DataType &typ) {
+    auto outer = m_value_type;
+    m_value_type = &typ;
+    expr.visit(*this);
+    m_value_type = outer;
+    return m_result;
+  }
+
+private:
+
+  // Comparison of arbitrary values, which are converted to their common type. Result is false if
+  // any column, referenced by them, is null
+  void emit_value_compare(const CompareExpr &expr) {
+    auto typ = operands_type(*expr.lhs, *expr.rhs, m_fields);
+    auto lhs = emit_value(*expr.lhs, *typ);
+    auto rhs = emit_value(*expr.rhs, *typ);
+    m_result = emit_compare(*typ, expr.op, lhs, rhs);
+    if (!m_valid.empty()) {
+      std::vector<std::string> names;
+      referenced_columns(expr, names);
+      for (auto &name : names) {
+        m_result = m_builder->CreateAnd(m_result, m_valid[field_index(name)]);
+      }
+    }
+  }
+
+  llvm::Value *emit_compare(const arrow::DataType &typ, CompareExpr::Op op, llvm::Value *lhs,
+                            llvm::Value *rhs) {
+    switch (op) {
+      PEFA_CASE_RET(case CompareExpr::Op::GT:, create_cmp_gt(typ, *m_builder, lhs, rhs))
+      PEFA_CASE_RET(case CompareExpr::Op::LT:, create_cmp_lt(typ, *m_builder, lhs, rhs))
+      PEFA_CASE_RET(case CompareExpr::Op::GE:, create_cmp_ge(typ, *m_builder, lhs, rhs))
+      PEFA_CASE_RET(case CompareExpr::Op::LE:, create_cmp_le(typ, *m_builder, lhs, rhs))
+      PEFA_CASE_RET(case CompareExpr::Op::EQ:, create_cmp_eq(typ, *m_builder, lhs, rhs))
+      PEFA_CASE_RET(case CompareExpr::Op::NEQ:, create_cmp_ne(typ, *m_builder, lhs, rhs))
+    }
+    throw UnreachableException();
+  }
+
+  // Converts numeric value between types like C does: integers are extended by their own
+  // signedness or truncated, floating values are truncated towards zero
+  llvm::Value *convert(llvm::Value *value, const arrow::DataType &from, const arrow::DataType &to) {
+    if (from.Equals(to)) {
+      return value;
+    }
+    if (!is_numeric(from) || !is_numeric(to)) {
+      throw NotImplementedException("Conversion of " + from.ToString() + " to " + to.ToString() +
+                                    " is not supported");
+    }
+    llvm::Type *typ = from_arrow(to);
+    if (auto vec_typ = llvm::dyn_cast<llvm::VectorType>(value->getType())) {
+      typ = llvm::VectorType::get(typ, lanes(vec_typ));
+    }
+    if (is_floating(from) && is_floating(to)) {
+      return m_builder->CreateFPCast(value, typ);
+    }
+    if (is_floating(from)) {
+      return is_signed(to) ? m_builder->CreateFPToSI(value, typ)
+                           : m_builder->CreateFPToUI(value, typ);
+    }
+    if (is_floating(to)) {
+      return is_signed(from) ? m_builder->CreateSIToFP(value, typ)
+                             : m_builder->CreateUIToFP(value, typ);
+    }
+    return is_signed(from) ? m_builder->CreateSExtOrTrunc(value, typ)
+                           : m_builder->CreateZExtOrTrunc(value, typ);
+  }
+
+  static bool is_signed(const arrow::DataType &typ) {
+    switch (typ.id()) {
+      PEFA_CASE_RET(PEFA_SIGNED_INTEGRAL_CASE, true)
+    default:
+      return false;
+    }
+  }
+
+  static bool is_integral(const arrow::DataType &typ) {
+    switch (typ.id()) {
+      PEFA_CASE_RET(PEFA_INTEGRAL_CASE, true)
+    default:
+      return false;
+    }
+  }
+
+  static bool is_floating(const arrow::DataType &typ) {
+    switch (typ.id()) {
+      PEFA_CASE_RET(PEFA_FLOATING_CASE, true)
+    default:
+      return false;
+    }
+  }
+
+  static bool is_numeric(const arrow::DataType &typ) {
+    return is_integral(typ) || is_floating(typ);
+  }
+
+  // Lists up to this size are compared with every value, which is broadcast to all lanes
+  static constexpr size_t in_list_compare_limit = 8;
+  // lists of integers, whose values span less than this, are looked up in bitset
+  static constexpr uint64_t in_list_bitset_bits = 1 << 16;
+
+  // Values of list are converted to column type like literals of EQ comparisons. Long lists are
+  // embedded into module either as bitset or as sorted array, which is binary searched
+  template <typename T> llvm::Value *emit_in_list(const InExpr &expr, size_t idx) {
+    auto &typ = *(m_fields[idx]->type());
+    auto input = m_inputs[idx];
+    llvm::Value *result = splat(boolval(false));
+    std::vector<T> values;
+    for (auto &value : expr.values) {
+      auto integer = std::get_if<int>(&value);
+      auto floating = std::get_if<double>(&value);
+      if (integer) {
+        values.push_back(static_cast<T>(*integer));
+      } else if (floating && std::is_floating_point_v<T>) {
+        values.push_back(static_cast<T>(*floating));
+      } else if (floating) {
+        // fractional literal is compared with integer column as float64, which rarely happens
+        CompareExpr::create(expr.column, lit(*floating), CompareExpr::Op::EQ)->visit(*this);
+        result = m_builder->CreateOr(result, m_result);
+      } else {
+        throw NotImplementedException("Column " + m_fields[idx]->name() +
+                                      " can be compared only with numeric literals");
+      }
+    }
+    if constexpr (std::is_floating_point_v<T>) {
+      // NaN is not equal to any value
+      values.erase(std::remove_if(values.begin(), values.end(), [](T v) { return std::isnan(v); }),
+                   values.end());
+    }
+    std::sort(values.begin(), values.end());
+    values.erase(std::unique(values.begin(), values.end()), values.end());
+    if (values.empty()) {
+      return result;
+    }
+    if (values.size() <= in_list_compare_limit) {
+      for (auto value : values) {
+        result = m_builder->CreateOr(
+            result, create_cmp_eq(typ, *m_builder, input, splat(typed_const(typ, value))));
+      }
+      return result;
+    }
+    if constexpr (std::is_integral_v<T>) {
+      using U = std::make_unsigned_t<T>;
+      if (static_cast<U>(static_cast<U>(values.back()) - static_cast<U>(values.front())) <
+          in_list_bitset_bits) {
+        return m_builder->CreateOr(result, emit_bitset_lookup(typ, input, values));
+      }
+    }
+    return m_builder->CreateOr(result, emit_sorted_search(typ, input, values));
+  }
+
+  // Bit (value - min) of bitset is set for every value of sorted list. Offsets are compared as
+  // unsigned, so values below min wrap above the last bit
+  template <typename T>
+  llvm::Value *emit_bitset_lookup(const arrow::DataType &typ, llvm::Value *input,
+                                  const std::vector<T> &values) {
+    using U = std::make_unsigned_t<T>;
+    auto min = static_cast<U>(values.front());
+    auto span = static_cast<U>(static_cast<U>(values.back()) - min);
+    std::vector<llvm::Constant *> bytes(span / 8 + 1);
+    std::vector<uint8_t> bits(bytes.size(), 0);
+    for (auto value : values) {
+      auto offset = static_cast<U>(static_cast<U>(value) - min);
+      bits[offset / 8] |= 1u << (offset % 8);
+    }
+    for (size_t i = 0; i < bits.size(); i++) {
+      bytes[i] = llvm::ConstantInt::get(i8_typ(), bits[i]);
+    }
+    auto bitset = embed_array(i8_typ(), bytes);
+    auto offsets = m_builder->CreateSub(input, splat(typed_const(typ, values.front())));
+    auto in_range =
+        m_builder->CreateICmpULE(offsets, splat(llvm::ConstantInt::get(from_arrow(typ), span)));
+    // offsets out of range are replaced with zero, so loads stay inside bitset
+    offsets = m_builder->CreateSelect(in_range, offsets,
+                                      llvm::Constant::getNullValue(offsets->getType()));
+    auto found = map_lanes(offsets, [&](llvm::Value *offset) {
+      auto wide = m_builder->CreateZExt(offset, i64_typ());
+      auto byte_ptr = m_builder->CreateInBoundsGEP(bitset, m_builder->CreateLShr(wide, 3));
+      auto byte = m_builder->CreateLoad(byte_ptr);
+      auto shift = m_builder->CreateTrunc(m_builder->CreateAnd(wide, 7), i8_typ());
+      return m_builder->CreateICmpNE(m_builder->CreateAnd(m_builder->CreateLShr(byte, shift), 1),
+                                     i8val(0));
+    });
+    return m_builder->CreateAnd(in_range, found);
+  }
+
+  // Branchless binary search in sorted list: every step moves base to the middle of the remaining
+  // range, if value there is not greater than input, so base ends at the greatest such value
+  template <typename T>
+  llvm::Value *emit_sorted_search(const arrow::DataType &typ, llvm::Value *input,
+                                  const std::vector<T> &values) {
+    std::vector<llvm::Constant *> elements;
+    for (auto value : values) {
+      elements.push_back(typed_const(typ, value));
+    }
+    auto array = embed_array(from_arrow(typ), elements);
+    return map_lanes(input, [&](llvm::Value *value) {
+      llvm::Value *base = i64val(0);
+      for (auto length = values.size(); length > 1; length -= length / 2) {
+        auto middle = m_builder->CreateAdd(base, i64val(static_cast<long>(length / 2)));
+        auto probe = m_builder->CreateLoad(m_builder->CreateInBoundsGEP(array, middle));
+        base = m_builder->CreateSelect(create_cmp_le(typ, *m_builder, probe, value), middle, base);
+      }
+      auto found = m_builder->CreateLoad(m_builder->CreateInBoundsGEP(array, base));
+      return create_cmp_eq(typ, *m_builder, found, value);
+    });
+  }
+
+  // Bounds are converted to column type like literals of comparisons, and lower <= value <= upper
+  // is checked by single unsigned comparison of value - lower with upper - lower, as values below
+  // lower wrap above the range
+  template <typename T> llvm::Value *emit_range_check(size_t idx, int lower, int upper) {
+    using U = std::make_unsigned_t<T>;
+    auto &typ = *(m_fields[idx]->type());
+    auto low = static_cast<T>(lower);
+    auto high = static_cast<T>(upper);
+    if (high < low) {
+      return splat(boolval(false));
+    }
+    auto width = static_cast<U>(static_cast<U>(high) - static_cast<U>(low));
+    auto offsets = m_builder->CreateSub(m_inputs[idx], splat(typed_const(typ, low)));
+    return m_builder->CreateICmpULE(offsets,
+                                    splat(llvm::ConstantInt::get(from_arrow(typ), width)));
+  }
+
+  template <typename T> llvm::Constant *typed_const(const arrow::DataType &typ, T value) {
+    if constexpr (std::is_floating_point_v<T>) {
+      return llvm::ConstantFP::get(from_arrow(typ), value);
+    } else {
+      return llvm::ConstantInt::get(from_arrow(typ), static_cast<uint64_t>(value),
+                                    std::is_signed_v<T>);
+    }
+  }
+
+  // pointer to the first element of constant array, which is embedded into module of kernel
+  llvm::Value *embed_array(llvm::Type *element_typ, const std::vector<llvm::Constant *> &elements) {
+    auto *array_typ = llvm::ArrayType::get(element_typ, elements.size());
+    auto *module = m_builder->GetInsertBlock()->getModule();
+    auto *global =
+        new llvm::GlobalVariable(*module, array_typ, true, llvm::GlobalValue::PrivateLinkage,
+                                 llvm::ConstantArray::get(array_typ, elements));
+    return m_builder->CreateConstInBoundsGEP2_64(global, 0, 0);
+  }
+
+  // applies func to every lane of vector value or to scalar value itself and gathers its i1 results
+  llvm::Value *map_lanes(llvm::Value *values,
+                         const std::function<llvm::Value *(llvm::Value *)> &func) {
+    auto vec_typ = llvm::dyn_cast<llvm::VectorType>(values->getType());
+    if (!vec_typ) {
+      return func(values);
+    }
+    llvm::Value *result = llvm::UndefValue::get(llvm::VectorType::get(bool_typ(), lanes(vec_typ)));
+    for (unsigned lane = 0; lane < lanes(vec_typ); lane++) {
+      result = m_builder->CreateInsertElement(
+          result, func(m_builder->CreateExtractElement(values, lane)), lane);
+    }
+    return result;
+  }
+
+  // Comparisons of string values. Equality and prefix/suffix checks are inlined: length is checked
+  // first, and then bytes of value are compared with literal by the widest loads, that fit it.
+  // Ordering and substring searches call utils functions by their addresses
+  using LaneFunc = std::function<llvm::Value *(llvm::Value *start, llvm::Value *end)>;
+
+  llvm::Value *emit_string_compare(size_t idx, CompareExpr::Op op,
+                                   const std::variant<int, double, std::string, bool> &value) {
+    auto literal = std::get_if<std::string>(&value);
+    if (!literal) {
+      throw NotImplementedException("Column " + m_fields[idx]->name() +
+                                    " can be compared only with string literal");
+    }
+    switch (op) {
+    case CompareExpr::Op::EQ:
+      return emit_string_match(idx, {utils::LikePattern::Kind::EQ, *literal});
+    case CompareExpr::Op::NEQ:
+      return m_builder->CreateNot(emit_string_match(idx, {utils::LikePattern::Kind::EQ, *literal}));
+    default:
+      break;
+    }
+    auto literal_ptr = m_builder->CreateGlobalStringPtr(*literal);
+    auto literal_len = i32val(static_cast<int32_t>(literal->size()));
+    return for_each_lane(idx, [&](llvm::Value *start, llvm::Value *end) -> llvm::Value * {
+      auto order = call_bytes_func(utils::compare_bytes, value_ptr(idx, start),
+                                   m_builder->CreateSub(end, start), literal_ptr, literal_len);
+      switch (op) {
+        PEFA_CASE_RET(case CompareExpr::Op::GT:, m_builder->CreateICmpSGT(order, i32val(0)))
+        PEFA_CASE_RET(case CompareExpr::Op::LT:, m_builder->CreateICmpSLT(order, i32val(0)))
+        PEFA_CASE_RET(case CompareExpr::Op::GE:, m_builder->CreateICmpSGE(order, i32val(0)))
+        PEFA_CASE_RET(case CompareExpr::Op::LE:, m_builder->CreateICmpSLE(order, i32val(0)))
+      default:
+        throw UnreachableException();
+      }
+    });
+  }
+
+  llvm::Value *emit_string_match(size_t idx, const utils::LikePattern &pattern) {
+    using Kind = utils::LikePattern::Kind;
+    auto &literal = pattern.literal;
+    auto literal_ptr = m_builder->CreateGlobalStringPtr(literal);
+    auto literal_len = i32val(static_cast<int32_t>(literal.size()));
+    auto lengths = m_builder->CreateSub(m_strings[idx].ends, m_inputs[idx]);
+    switch (pattern.kind) {
+    case Kind::EQ:
+    case Kind::STARTS_WITH:
+    case Kind::ENDS_WITH: {
+      auto length_ok = pattern.kind == Kind::EQ
+                           ? m_builder->CreateICmpEQ(lengths, splat(literal_len))
+                           : m_builder->CreateICmpSGE(lengths, splat(literal_len));
+      if (literal.empty()) {
+        return length_ok;
+      }
+      // suffix is compared with the last bytes of value
+      auto position = [&](llvm::Value *start, llvm::Value *end) {
+        return pattern.kind == Kind::ENDS_WITH ? m_builder->CreateSub(end, literal_len) : start;
+      };
+      return for_checked_lanes(idx, length_ok, position, literal, literal_ptr);
+    }
+    case Kind::CONTAINS:
+      if (literal.empty()) {
+        return splat(boolval(true));
+      }
+      return for_each_lane(idx, [&](llvm::Value *start, llvm::Value *end) {
+        auto found = call_bytes_func(utils::contains_bytes, value_ptr(idx, start),
+                                     m_builder->CreateSub(end, start), literal_ptr, literal_len);
+        return m_builder->CreateICmpNE(found, i32val(0));
+      });
+    case Kind::GENERAL:
+      return for_each_lane(idx, [&](llvm::Value *start, llvm::Value *end) {
+        auto matched = call_bytes_func(utils::match_like, value_ptr(idx, start),
+                                       m_builder->CreateSub(end, start), literal_ptr, literal_len);
+        return m_builder->CreateICmpNE(matched, i32val(0));
+      });
+    }
+    throw UnreachableException();
+  }
+
+  // applies func to start and end offsets of every lane and gathers its i1 results
+  llvm::Value *for_each_lane(size_t idx, const LaneFunc &func) {
+    auto starts = m_inputs[idx];
+    auto ends = m_strings[idx].ends;
+    auto vec_typ = llvm::dyn_cast<llvm::VectorType>(starts->getType());
+    if (!vec_typ) {
+      return func(starts, ends);
+    }
+    llvm::Value *result = llvm::UndefValue::get(llvm::VectorType::get(bool_typ(), lanes(vec_typ)));
+    for (unsigned lane = 0; lane < lanes(vec_typ); lane++) {
+      auto lane_result = func(m_builder->CreateExtractElement(starts, lane),
+                              m_builder->CreateExtractElement(ends, lane));
+      result = m_builder->CreateInsertElement(result, lane_result, lane);
+    }
+    return result;
+  }
+
+  // Compares literal with bytes of lanes, which pass length check, starting from offset returned by
+  // position. Lanes, which fail the check, read literal itself instead of their data, so loads
+  // stay inside buffers without branches, and block, where all lanes fail it, is skipped
+  template <typename PositionFunc>
+  llvm::Value *for_checked_lanes(size_t idx, llvm::Value *length_ok, PositionFunc position,
+                                 const std::string &literal, llvm::Value *literal_ptr) {
+    auto compare_lane = [&](llvm::Value *start, llvm::Value *end, llvm::Value *ok) {
+      auto ptr = m_builder->CreateSelect(ok, value_ptr(idx, position(start, end)), literal_ptr);
+      return m_builder->CreateAnd(ok, emit_bytes_equal(ptr, literal));
+    };
+    auto vec_typ = llvm::dyn_cast<llvm::VectorType>(length_ok->getType());
+    if (!vec_typ) {
+      return compare_lane(m_inputs[idx], m_strings[idx].ends, length_ok);
+    }
+    auto *func = m_builder->GetInsertBlock()->getParent();
+    auto *entry = m_builder->GetInsertBlock();
+    auto *compare_block = llvm::BasicBlock::Create(*m_context, "strcmp.body", func);
+    auto *end_block = llvm::BasicBlock::Create(*m_context, "strcmp.end", func);
+    auto *packed_typ = llvm::IntegerType::get(*m_context, lanes(vec_typ));
+    auto *any_ok = m_builder->CreateICmpNE(m_builder->CreateBitCast(length_ok, packed_typ),
+                                           llvm::ConstantInt::get(packed_typ, 0));
+    m_builder->CreateCondBr(any_ok, compare_block, end_block);
+
+    m_builder->SetInsertPoint(compare_block);
+    llvm::Value *matched = llvm::UndefValue::get(vec_typ);
+    for (unsigned lane = 0; lane < lanes(vec_typ); lane++) {
+      auto lane_matched = compare_lane(m_builder->CreateExtractElement(m_inputs[idx], lane),
+                                       m_builder->CreateExtractElement(m_strings[idx].ends, lane),
+                                       m_builder->CreateExtractElement(length_ok, lane));
+      matched = m_builder->CreateInsertElement(matched, lane_matched, lane);
+    }
+    auto *compare_end = m_builder->GetInsertBlock();
+    m_builder->CreateBr(end_block);
+
+    m_builder->SetInsertPoint(end_block);
+    auto *result = m_builder->CreatePHI(vec_typ, 2);
+    result->addIncoming(llvm::ConstantAggregateZero::get(vec_typ), entry);
+    result->addIncoming(matched, compare_end);
+    return result;
+  }
+
+  // true if literal.size() bytes at ptr are equal to literal. Literal is covered by 16-byte vector
+  // loads or, if it is shorter, by two overlapping integer loads of the largest fitting width
+  llvm::Value *emit_bytes_equal(llvm::Value *ptr, const std::string &literal) {
+    const auto size = static_cast<int64_t>(literal.size());
+    std::vector<std::pair<int64_t, int64_t>> chunks;
+    int64_t width = size >= 16 ? 16 : size >= 8 ? 8 : size >= 4 ? 4 : size >= 2 ? 2 : 1;
+    for (int64_t offset = 0; offset + width <= size; offset += width) {
+      chunks.emplace_back(offset, width);
+    }
+    if (size % width != 0) {
+      chunks.emplace_back(size - width, width);
+    }
+    llvm::Value *equal = boolval(true);
+    for (auto [offset, chunk_width] : chunks) {
+      auto chunk_ptr = m_builder->CreateInBoundsGEP(ptr, i64val(offset));
+      llvm::Value *chunk_equal;
+      if (chunk_width == 16) {
+        auto *vec_typ = llvm::VectorType::get(i8_typ(), 16);
+        auto bytes = m_builder->CreateAlignedLoad(
+            m_builder->CreatePointerCast(chunk_ptr, vec_typ->getPointerTo()), llvm::MaybeAlign(1));
+        auto expected = llvm::ConstantDataVector::get(
+            *m_context, llvm::ArrayRef<uint8_t>(
+                            reinterpret_cast<const uint8_t *>(literal.data() + offset), 16));
+        auto lanes_equal = m_builder->CreateBitCast(m_builder->CreateICmpEQ(bytes, expected),
+                                                    i16_typ());
+        chunk_equal = m_builder->CreateICmpEQ(lanes_equal, i16val(0xFFFF));
+      } else {
+        // literal bytes are read as integer in host byte order, as they are loaded by kernel
+        uint64_t expected = 0;
+        std::memcpy(&expected, literal.data() + offset, chunk_width);
+        auto *int_typ = llvm::IntegerType::get(*m_context, chunk_width * 8);
+        auto word = m_builder->CreateAlignedLoad(
+            m_builder->CreatePointerCast(chunk_ptr, int_typ->getPointerTo()), llvm::MaybeAlign(1));
+        chunk_equal = m_builder->CreateICmpEQ(word, llvm::ConstantInt::get(int_typ, expected));
+      }
+      equal = m_builder->CreateAnd(equal, chunk_equal);
+    }
+    return equal;
+  }
+
+  // pointer to byte at offset of data buffer of string field
+  llvm::Value *value_ptr(size_t idx, llvm::Value *offset) {
+    // data of empty column may be null, so pointer is not marked as inbounds
+    return m_builder->CreateGEP(m_strings[idx].data, m_builder->CreateSExt(offset, i64_typ()));
+  }
+
+  // int32_t func(const uint8_t *data, int32_t len, const uint8_t *literal, int32_t literal_len)
+  llvm::Value *call_bytes_func(int32_t (*func)(const uint8_t *, int32_t, const uint8_t *, int32_t),
+                               llvm::Value *data, llvm::Value *len, llvm::Value *literal,
+                               llvm::Value *literal_len) {
+    auto *i8_ptr_typ = i8_typ()->getPointerTo();
+    auto *func_typ =
+        llvm::FunctionType::get(i32_typ(), {i8_ptr_typ, i32_typ(), i8_ptr_typ, i32_typ()}, false);
+    auto callee = m_builder->CreateIntToPtr(
+        llvm::ConstantInt::get(i64_typ(), reinterpret_cast<uintptr_t>(func)),
+        func_typ->getPointerTo());
+    return m_builder->CreateCall(func_typ, callee, {data, len, literal, literal_len});
+  }
+
+  // Looks up truth table of expression by code of every lane. Codes of null rows are arbitrary, so
+  // they are replaced with zero, which is inside of every table
+  llvm::Value *emit_table_lookup(const Expr &expr, size_t idx) {
+    auto found = std::find_if(m_tables.begin(), m_tables.end(),
+                              [&](auto &table) { return table.first == &expr; });
+    if (found == m_tables.end()) {
+      throw UnreachableException();
+    }
+    auto table = found->second;
+    auto codes = m_inputs[idx];
+    if (!m_valid.empty()) {
+      codes = m_builder->CreateSelect(m_valid[idx], codes,
+                                      llvm::Constant::getNullValue(codes->getType()));
+    }
+    return map_lanes(codes, [&](llvm::Value *code) {
+      auto entry = m_builder->CreateLoad(
+          m_builder->CreateInBoundsGEP(table, m_builder->CreateZExt(code, i64_typ())));
+      return m_builder->CreateICmpNE(entry, i8val(0));
+    });
+  }
+
+  static unsigned lanes(llvm::VectorType *typ) {
+    return typ->getNumElements();
+  }
+
+  // Probes blocked bloom filter. Hashing repeats utils::BloomFilter, block of every lane is checked
+  // by single vector compare
+  llvm::Value *emit_bloom_probe(const BloomInput &filter, const arrow::DataType &typ,
+                                llvm::Value *input) {
+    auto vec_typ = llvm::dyn_cast<llvm::VectorType>(input->getType());
+    auto lanes = vec_typ ? vec_typ->getNumElements() : 0;
+    auto key_typ = vec_typ ? llvm::VectorType::get(i64_typ(), lanes) : i64_typ();
+    llvm::Value *key;
+    switch (typ.id()) {
+      PEFA_CASE_BRK(PEFA_SIGNED_INTEGRAL_CASE, key = m_builder->CreateSExtOrTrunc(input, key_typ))
+      PEFA_CASE_BRK(PEFA_UNSIGNED_INTEGRAL_CASE,
+                    key = m_builder->CreateZExtOrTrunc(input, key_typ))
+    default:
+      throw NotImplementedException("Bloom filter over keys of type " + typ.ToString() +
+                                    " is not supported yet");
+    }
+    auto multiplier = llvm::ConstantInt::get(i64_typ(), utils::BloomFilter::hash_multiplier);
+    auto hash = m_builder->CreateMul(key, splat(multiplier));
+    hash = m_builder->CreateXor(hash, m_builder->CreateLShr(hash, splat(i64val(32))));
+    auto block_index = m_builder->CreateAnd(m_builder->CreateLShr(hash, splat(i64val(32))),
+                                            splat(filter.block_mask));
+    auto low = m_builder->CreateTrunc(hash, vec_typ ? llvm::VectorType::get(i32_typ(), lanes)
+                                                    : i32_typ());
+
+    auto block_typ = llvm::VectorType::get(i32_typ(), utils::BloomFilter::block_words);
+    auto blocks = m_builder->CreateIntToPtr(filter.blocks, llvm::PointerType::get(block_typ, 0));
+    std::vector<llvm::Constant *> salt;
+    for (auto word_salt : utils::BloomFilter::salt) {
+      salt.push_back(llvm::ConstantInt::get(i32_typ(), word_salt));
+    }
+    auto salt_vec = llvm::ConstantVector::get(salt);
+    auto probe = [&](llvm::Value *lane_index, llvm::Value *lane_low) {
+      auto block = m_builder->CreateLoad(m_builder->CreateInBoundsGEP(blocks, lane_index));
+      auto shift = m_builder->CreateLShr(
+          m_builder->CreateMul(
+              m_builder->CreateVectorSplat(utils::BloomFilter::block_words, lane_low), salt_vec),
+          m_builder->CreateVectorSplat(utils::BloomFilter::block_words, i32val(27)));
+      auto mask = m_builder->CreateShl(
+          m_builder->CreateVectorSplat(utils::BloomFilter::block_words, i32val(1)), shift);
+      auto hits = m_builder->CreateICmpEQ(m_builder->CreateAnd(block, mask), mask);
+      return m_builder->CreateICmpEQ(m_builder->CreateBitCast(hits, i8_typ()), i8val(-1));
+    };
+    if (!vec_typ) {
+      return probe(block_index, low);
+    }
+    llvm::Value *contained = llvm::UndefValue::get(llvm::VectorType::get(bool_typ(), lanes));
+    for (unsigned lane = 0; lane < lanes; lane++) {
+      auto contains = probe(m_builder->CreateExtractElement(block_index, lane),
+                            m_builder->CreateExtractElement(low, lane));
+      contained = m_builder->CreateInsertElement(contained, contains, lane);
+    }
+    return contained;
+  }
+
+  size_t field_index(const std::string &name) const {
+    for (size_t i = 0; i < m_fields.size(); i++) {
+      if (m_fields[i]->name() == name) {
+        return i;
+      }
+    }
+    throw ColumnNotFoundException(name);
+  }
+
+  // vectorized filter evaluates predicate for several elements at once, so constants should be
+  // broadcasted to all lanes
+  llvm::Value *splat(llvm::Value *constant) {
+    if (auto vec_typ = llvm::dyn_cast<llvm::VectorType>(m_inputs.front()->getType())) {
+      return m_builder->CreateVectorSplat(vec_typ->getNumElements(), constant);
+    }
+    return constant;
+  }
+};
+} // namespace pefa::kernels
@@ -0,0 +1,310 @@
+#include "kernel_cache.h"
+
+#include "pefa/jit/jit.h"
+#include "pefa/utils/utils.h"
+
+#include <iomanip>
+#include <sstream>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+namespace pefa::kernels {
+namespace {
+// Builds canonical textual representation of expression. Literals are printed together with their
+// variant kind and doubles are printed exactly, so different constants never produce same string
+class FingerprintVisitor : public ExprVisitor {
+private:
+  const std::vector<std::shared_ptr<const arrow::Field>> &m_fields;
+  std::ostringstream m_out;
+
+public:
+  explicit FingerprintVisitor(const std::vector<std::shared_ptr<const arrow::Field>> &fields)
+      : m_fields(fields) {
+    m_out << std::hexfloat;
+  }
+
+  void visit(const ColumnRef &expr) override {
+    // kernel accesses fields by their positions, so names do not affect generated code
+    for (size_t i = 0; i < m_fields.size(); i++) {
+      if (m_fields[i]->name() == expr.name) {
+        m_out << "$" << i;
+        return;
+      }
+    }
+    m_out << "col(" << expr.name.size() << ":" << expr.name << ")";
+  }
+
+  void visit(const PredicateExpr &expr) override {
+    m_out << "(";
+    expr.lhs->visit(*this);
+    m_out << (expr.op == PredicateExpr::Op::AND ? " AND " : " OR ");
+    expr.rhs->visit(*this);
+    m_out << ")";
+  }
+
+  void visit(const CompareExpr &expr) override {
+    m_out << "(";
+    expr.lhs->visit(*this);
+    switch (expr.op) {
+      PEFA_CASE_BRK(case CompareExpr::Op::GT:, m_out << " > ")
+      PEFA_CASE_BRK(case CompareExpr::Op::LT:, m_out << " < ")
+      PEFA_CASE_BRK(case CompareExpr::Op::GE:, m_out << " >= ")
+      PEFA_CASE_BRK(case CompareExpr::Op::LE:, m_out << " <= ")
+      PEFA_CASE_BRK(case CompareExpr::Op::EQ:, m_out << " == ")
+      PEFA_CASE_BRK(case CompareExpr::Op::NEQ:, m_out << " != ")
+    }
+    expr.rhs->visit(*this);
+    m_out << ")";
+  }
+
+  void visit(const LiteralExpr &expr) override {
+    print(expr.value);
+  }
+
+  void visit(const BooleanConst &expr) override {
+    m_out << (expr.value ? "true" : "false");
+  }
+
+  void visit(const BloomFilterExpr &expr) override {
+    // blocks of filter are passed to kernel at runtime, so all filters over a column share kernel
+    m_out << "bloom(";
+    expr.column->visit(*this);
+    m_out << ")";
+  }
+
+  void visit(const StringMatchExpr &expr) override {
+    switch (expr.op) {
+      PEFA_CASE_BRK(case StringMatchExpr::Op::STARTS_WITH:, m_out << "starts_with(")
+      PEFA_CASE_BRK(case StringMatchExpr::Op::ENDS_WITH:, m_out << "ends_with(")
+      PEFA_CASE_BRK(case StringMatchExpr::Op::CONTAINS:, m_out << "contains(")
+      PEFA_CASE_BRK(case StringMatchExpr::Op::LIKE:, m_out << "like(")
+    }
+    expr.column->visit(*this);
+    m_out << ", s" << expr.pattern.size() << ":" << expr.pattern << ")";
+  }
+
+  void visit(const InExpr &expr) override {
+    m_out << "in(";
+    expr.column->visit(*this);
+    for (auto &value : expr.values) {
+      m_out << ", ";
+      print(value);
+    }
+    m_out << ")";
+  }
+
+  void visit(const BetweenExpr &expr) override {
+    m_out << "between(";
+    expr.column->visit(*this);
+    m_out << ", ";
+    print(expr.lower);
+    m_out << ", ";
+    print(expr.upper);
+    m_out << ")";
+  }
+
+  void visit(const ArithmeticExpr &expr) override {
+    m_out << "(";
+    expr.lhs->visit(*this);
+    switch (expr.op) {
+      PEFA_CASE_BRK(case ArithmeticExpr::Op::ADD:, m_out << " + ")
+      PEFA_CASE_BRK(case ArithmeticExpr::Op::SUB:, m_out << " - ")
+      PEFA_CASE_BRK(case ArithmeticExpr::Op::MUL:, m_out << " * ")
+      PEFA_CASE_BRK(case ArithmeticExpr::Op::DIV:, m_out << " / ")
+    }
+    expr.rhs->visit(*this);
+    m_out << ")";
+  }
+
+  void visit(const CastExpr &expr) override {
+    m_out << "cast(";
+    expr.operand->visit(*this);
+    m_out << ", " << expr.type->ToString() << ")";
+  }
+
+  [[nodiscard]] std::string result() const {
+    return m_out.str();
+  }
+
+private:
+  void print(const std::variant<int, double, std::string, bool> &literal) {
+    std::visit(
+        [this](auto &&value) {
+          using T = std::decay_t<decltype(value)>;
+          if constexpr (std::is_same_v<T, int>) {
+            m_out << "i:" << value;
+          } else if constexpr (std::is_same_v<T, double>) {
+            m_out << "d:" << value;
+          } else if constexpr (std::is_same_v<T, std::string>) {
+            m_out << "s" << value.size() << ":" << value;
+          } else {
+            m_out << "b:" << value;
+          }
+        },
+        literal);
+  }
+};
+} // namespace
+
+KernelCache::KernelCache(size_t capacity)
+    : m_capacity(capacity) {}
+
+std::shared_ptr<FilterKernel>
+KernelCache::get_filter_kernel(const std::shared_ptr<const arrow::Field> &field,
+                               const std::shared_ptr<const Expr> &expr) {
+  return get_filter_kernel(std::vector<std::shared_ptr<const arrow::Field>>{field}, expr);
+}
+
+std::shared_ptr<FilterKernel>
+KernelCache::get_filter_kernel(const std::vector<std::shared_ptr<const arrow::Field>> &fields,
+                               const std::shared_ptr<const Expr> &expr, bool skip_zero_words) {
+  auto key = "filter;" + fingerprint(fields, *expr) + (skip_zero_words ? ";skip_zero_words" : "");
+  return std::static_pointer_cast<FilterKernel>(get_or_compile(key, [&] {
+    std::shared_ptr<FilterKernel> kernel = FilterKernel::create_cpu(fields, expr, skip_zero_words);
+    kernel->compile();
+    return kernel;
+  }));
+}
+
+std::shared_ptr<ReductionKernel>
+KernelCache::get_reduction_kernel(const std::vector<std::shared_ptr<const arrow::Field>> &fields,
+                                  const std::shared_ptr<const BooleanExpr> &expr,
+                                  const std::vector<Aggregate> &aggregates) {
+  auto key = "reduction;" + fingerprint(fields, *expr);
+  for (auto &aggregate : aggregates) {
+    // aggregates are identified by op and position of their field, COUNT of rows has no field
+    key += ";" + std::to_string(static_cast<int>(aggregate.op)) + ":";
+    for (size_t i = 0; i < fields.size(); i++) {
+      if (fields[i]->name() == aggregate.column) {
+        key += std::to_string(i);
+      }
+    }
+  }
+  return std::static_pointer_cast<ReductionKernel>(get_or_compile(key, [&] {
+    std::shared_ptr<ReductionKernel> kernel =
+        ReductionKernel::create_cpu(fields, expr, aggregates);
+    kernel->compile();
+    return kernel;
+  }));
+}
+
+std::shared_ptr<ProjectionKernel>
+KernelCache::get_projection_kernel(const std::vector<std::shared_ptr<const arrow::Field>> &fields,
+                                   const std::shared_ptr<const ValueExpr> &expr) {
+  auto key = "projection;" + fingerprint(fields, *expr);
+  return std::static_pointer_cast<ProjectionKernel>(get_or_compile(key, [&] {
+    std::shared_ptr<ProjectionKernel> kernel = ProjectionKernel::create_cpu(fields, expr);
+    kernel->compile();
+    return kernel;
+  }));
+}
+
+std::shared_ptr<void>
+KernelCache::get_or_compile(const std::string &key,
+                            const std::function<std::shared_ptr<void>()> &create) {
+  {
+    std::lock_guard lock(m_mutex);
+    auto it = m_index.find(key);
+    if (it != m_index.end()) {
+      m_hits++;
+      m_entries.splice(m_entries.begin(), m_entries, it->second);
+      return it->second->second;
+    }
+  }
+  m_misses++;
+
+  // compilation is done without lock, so it does not block lookups of other kernels
+  auto kernel = create();
+
+  std::lock_guard lock(m_mutex);
+  auto it = m_index.find(key);
+  if (it != m_index.end()) {
+    // same kernel was compiled concurrently by another thread
+    m_entries.splice(m_entries.begin(), m_entries, it->second);
+    return it->second->second;
+  }
+  m_entries.emplace_front(key, kernel);
+  m_index[key] = m_entries.begin();
+  evict();
+  return kernel;
+}
+
+std::shared_ptr<AggregateKernel>
+KernelCache::get_aggregate_kernel(const std::shared_ptr<arrow::DataType> &type, Aggregate::Op op) {
+  auto key = type->ToString() + ";" + std::to_string(static_cast<int>(op));
+  {
+    std::lock_guard lock(m_mutex);
+    auto it = m_aggregate_kernels.find(key);
+    if (it != m_aggregate_kernels.end()) {
+      return it->second;
+    }
+  }
+
+  std::shared_ptr<AggregateKernel> kernel = AggregateKernel::create_cpu(type, op);
+  kernel->compile();
+
+  std::lock_guard lock(m_mutex);
+  // kernel may be compiled concurrently by another thread, then the first one is kept
+  return m_aggregate_kernels.emplace(key, kernel).first->second;
+}
+
+void KernelCache::set_capacity(size_t capacity) {
+  std::lock_guard lock(m_mutex);
+  m_capacity = capacity;
+  evict();
+}
+
+void KernelCache::clear() {
+  std::lock_guard lock(m_mutex);
+  m_index.clear();
+  m_entries.clear();
+  m_aggregate_kernels.clear();
+  m_hits = 0;
+  m_misses = 0;
+}
+
+size_t KernelCache::capacity() {
+  std::lock_guard lock(m_mutex);
+  return m_capacity;
+}
+
+size_t KernelCache::size() {
+  std::lock_guard lock(m_mutex);
+  return m_entries.size();
+}
+
+size_t KernelCache::hits() const {
+  return m_hits;
+}
+
+size_t KernelCache::misses() const {
+  return m_misses;
+}
+
+std::string
+KernelCache::fingerprint(const std::vector<std::shared_ptr<const arrow::Field>> &fields,
+                         const Expr &expr) {
+  FingerprintVisitor visitor(fields);
+  expr.visit(visitor);
+  std::string types;
+  for (auto &field : fields) {
+    types += field->type()->ToString() + ",";
+  }
+  auto cpu = jit::get_JIT()->getTargetMachine().getTargetCPU().str();
+  return types + ";" + cpu + ";" + visitor.result();
+}
+
+void KernelCache::evict() {
+  // kernels which are still used by running queries are kept alive by their shared pointers
+  while (m_entries.size() > m_capacity) {
+    m_index.erase(m_entries.back().first);
+    m_entries.pop_back();
+  }
+}
+
+std::shared_ptr<KernelCache> get_kernel_cache() {
+  static auto cache = std::make_shared<KernelCache>(256);
+  return cache;
+}
+} // namespace pefa::kernels
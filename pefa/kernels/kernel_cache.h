@@ -0,0 +1,87 @@
+#pragma once
+#include "aggregate.h"
+#include "filter.h"
+#include "projection.h"
+#include "reduction.h"
+#include "pefa/query_compiler/expressions.h"
+
+#include <arrow/type.h>
+#include <atomic>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace pefa::kernels {
+// Process-wide LRU cache of compiled kernels. Kernels are keyed by canonical fingerprint of
+// (arrow types, expression tree, target cpu), where column references are replaced with
+// their positions, so equal predicates over different columns of the same types share a kernel.
+// Filter, reduction and projection kernels share capacity of the cache
+class KernelCache {
+private:
+  // key of every kind of kernels starts with its own prefix, so entry type is known from the key
+  using Entry = std::pair<std::string, std::shared_ptr<void>>;
+
+  size_t m_capacity;
+  std::list<Entry> m_entries; // most recently used entries are at the front
+  std::unordered_map<std::string, std::list<Entry>::iterator> m_index;
+  std::mutex m_mutex;
+  std::atomic<size_t> m_hits{0};
+  std::atomic<size_t> m_misses{0};
+  // there is at most one aggregate kernel per (type, op) pair, so they are never evicted and are
+  // not accounted in size and hit/miss counters
+  std::unordered_map<std::string, std::shared_ptr<AggregateKernel>> m_aggregate_kernels;
+
+public:
+  explicit KernelCache(size_t capacity);
+
+  // returns compiled kernel, compiling it if there is no such kernel in cache
+  [[nodiscard]] std::shared_ptr<FilterKernel>
+  get_filter_kernel(const std::vector<std::shared_ptr<const arrow::Field>> &fields,
+                    const std::shared_ptr<const Expr> &expr, bool skip_zero_words = false);
+
+  [[nodiscard]] std::shared_ptr<FilterKernel>
+  get_filter_kernel(const std::shared_ptr<const arrow::Field> &field,
+                    const std::shared_ptr<const Expr> &expr);
+
+  // reduction kernel for predicate and aggregates over fields, which compute SUM, MIN, MAX and AVG
+  // of fields and COUNT of fields or rows
+  [[nodiscard]] std::shared_ptr<ReductionKernel>
+  get_reduction_kernel(const std::vector<std::shared_ptr<const arrow::Field>> &fields,
+                       const std::shared_ptr<const BooleanExpr> &expr,
+                       const std::vector<Aggregate> &aggregates);
+
+  // kernel, which computes value of expr over fields for every row
+  [[nodiscard]] std::shared_ptr<ProjectionKernel>
+  get_projection_kernel(const std::vector<std::shared_ptr<const arrow::Field>> &fields,
+                        const std::shared_ptr<const ValueExpr> &expr);
+
+  [[nodiscard]] std::shared_ptr<AggregateKernel>
+  get_aggregate_kernel(const std::shared_ptr<arrow::DataType> &type, Aggregate::Op op);
+
+  void set_capacity(size_t capacity);
+
+  // removes all cached kernels and resets hit/miss counters
+  void clear();
+
+  [[nodiscard]] size_t capacity();
+  [[nodiscard]] size_t size();
+  [[nodiscard]] size_t hits() const;
+  [[nodiscard]] size_t misses() const;
+
+  [[nodiscard]] static std::string
+  fingerprint(const std::vector<std::shared_ptr<const arrow::Field>> &fields, const Expr &expr);
+
+private:
+  // returns cached kernel, compiling kernel created by create if there is no such key in cache
+  [[nodiscard]] std::shared_ptr<void>
+  get_or_compile(const std::string &key, const std::function<std::shared_ptr<void>()> &create);
+
+  void evict();
+};
+
+std::shared_ptr<KernelCache> get_kernel_cache();
+} // namespace pefa::kernels
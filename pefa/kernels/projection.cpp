@@ -0,0 +1,211 @@
+#include "projection.h"
+
+#include "ir_emit_visitor.h"
+#include "pefa/jit/jit.h"
+#include "pefa/utils/exceptions.h"
+#include "pefa/utils/llvm_helpers.h"
+#include "pefa/utils/utils.h"
+
+#include <algorithm>
+#include <llvm/Analysis/TargetTransformInfo.h>
+#include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Support/Host.h>
+#include <utility>
+
+namespace pefa::kernels {
+class ProjectionKernelImpl : public ProjectionKernel, private utils::LLVMTypesHelper {
+private:
+  std::vector<std::shared_ptr<const arrow::Field>> m_fields;
+  std::shared_ptr<const ValueExpr> m_expr;
+  std::shared_ptr<arrow::DataType> m_output_type;
+  llvm::LLVMContext m_context;
+  llvm::orc::VModuleKey m_moduleKey{};
+  bool m_is_compiled = false;
+  std::shared_ptr<pefa::jit::JIT> m_jit;
+  void (*m_project_func)(const uint8_t **, uint8_t *, int64_t){};
+
+public:
+  ProjectionKernelImpl(std::vector<std::shared_ptr<const arrow::Field>> fields,
+                       std::shared_ptr<const ValueExpr> expr)
+      : m_fields(std::move(fields))
+      , m_expr(std::move(expr))
+      , m_context(llvm::LLVMContext())
+      , m_jit(jit::get_JIT())
+      , utils::LLVMTypesHelper(m_context) {
+    if (m_fields.empty()) {
+      throw NotImplementedException("Projection of expression without columns is not supported");
+    }
+    for (auto &field : m_fields) {
+      if (!is_numeric(*field->type())) {
+        throw NotImplementedException("Projection of " + field->type()->ToString() +
+                                      " columns is not implemented yet");
+      }
+    }
+    m_output_type = value_type(*m_expr, m_fields);
+    if (!m_output_type || !is_numeric(*m_output_type)) {
+      throw NotImplementedException("Only numeric expressions over columns can be projected");
+    }
+  }
+
+  void execute(const std::vector<std::shared_ptr<const arrow::Array>> &columns,
+               uint8_t *out) override {
+    if (!m_is_compiled) {
+      throw KernelNotCompiledException();
+    }
+    if (columns.size() != m_fields.size()) {
+      throw UnreachableException();
+    }
+    // pointers to the first element of every column
+    std::vector<const uint8_t *> inputs(columns.size());
+    for (size_t i = 0; i < columns.size(); i++) {
+      auto &column = *columns[i];
+      auto width = static_cast<const arrow::FixedWidthType &>(*column.type()).bit_width() / 8;
+      inputs[i] = column.data()->buffers[1]->data() + column.offset() * width;
+    }
+    m_project_func(inputs.data(), out, columns.front()->length());
+  }
+
+  [[nodiscard]] std::shared_ptr<arrow::DataType> output_type() const override {
+    return m_output_type;
+  }
+
+  ~ProjectionKernelImpl() override {
+    if (m_is_compiled) {
+      m_jit->removeModule(m_moduleKey);
+    }
+  }
+
+  void compile() override {
+    auto module = std::make_unique<llvm::Module>("projection_mod", m_context);
+    module->setTargetTriple(llvm::sys::getProcessTriple());
+    gen_project_func(*module);
+    auto &machine = m_jit->getTargetMachine();
+    module->setDataLayout(machine.createDataLayout());
+    m_moduleKey = m_jit->addModule(std::move(module));
+    m_project_func = reinterpret_cast<void (*)(const uint8_t **, uint8_t *, int64_t)>(
+        m_jit->getSymbolAddress(m_moduleKey, "project"));
+    m_is_compiled = true;
+  }
+
+private:
+  static bool is_numeric(const arrow::DataType &type) {
+    switch (type.id()) {
+      PEFA_CASE_RET(PEFA_NUMERIC_CASE, true)
+    default:
+      return false;
+    }
+  }
+
+  void gen_project_func(llvm::Module &module) {
+    // void project(uint8_t **in, uint8_t *out, int64_t len) {
+    //     TYPE_0 *source_0 = (TYPE_0 *)in[0];
+    //     ...
+    //     OUT_TYPE *dest = (OUT_TYPE *)out;
+    //     int64_t i = 0;
+    //     for(; i + LANES <= len; i += LANES) {
+    //         dest[i:i + LANES] = expr(<LANES x TYPE_0> source_0[i:i + LANES], ...);
+    //     }
+    //     for(; i < len; i++) {
+    //         dest[i] = expr(source_0[i], ...);
+    //     }
+    // }
+    std::vector<llvm::Type *> param_type{llvm::Type::getInt8PtrTy(m_context)->getPointerTo(),
+                                         llvm::Type::getInt8PtrTy(m_context), i64_typ()};
+    llvm::FunctionType *prototype =
+        llvm::FunctionType::get(llvm::Type::getVoidTy(m_context), param_type, false);
+    llvm::Function *func =
+        llvm::Function::Create(prototype, llvm::Function::ExternalLinkage, "project", module);
+    llvm::BasicBlock *body = llvm::BasicBlock::Create(m_context, "body", func);
+    llvm::BasicBlock *vec_cond = llvm::BasicBlock::Create(m_context, "vecloop.cond", func);
+    llvm::BasicBlock *vec_body = llvm::BasicBlock::Create(m_context, "vecloop.body", func);
+    llvm::BasicBlock *tail_cond = llvm::BasicBlock::Create(m_context, "tailloop.cond", func);
+    llvm::BasicBlock *tail_body = llvm::BasicBlock::Create(m_context, "tailloop.body", func);
+    llvm::BasicBlock *end = llvm::BasicBlock::Create(m_context, "end", func);
+
+    llvm::Value *arg_inputs = func->getArg(0);
+    llvm::Value *arg_len = func->getArg(2);
+
+    const unsigned lanes = get_vector_lanes(*func);
+
+    llvm::IRBuilder builder(m_context);
+    builder.SetInsertPoint(body);
+    auto *i = builder.CreateAlloca(i64_typ(), nullptr, "i");
+    builder.CreateStore(i64val(0), i);
+    std::vector<llvm::Value *> sources(m_fields.size());
+    for (size_t field = 0; field < m_fields.size(); field++) {
+      auto input = builder.CreateLoad(builder.CreateInBoundsGEP(arg_inputs, i64val(field)));
+      sources[field] = builder.CreatePointerCast(input, ptr_from_arrow(*m_fields[field]->type()));
+    }
+    auto *dest = builder.CreatePointerCast(func->getArg(1), ptr_from_arrow(*m_output_type));
+    builder.CreateBr(vec_cond);
+
+    // for(; i + LANES <= len; i += LANES)
+    builder.SetInsertPoint(vec_cond);
+    auto vec_condition =
+        builder.CreateICmpSLE(builder.CreateAdd(builder.CreateLoad(i), i64val(lanes)), arg_len);
+    builder.CreateCondBr(vec_condition, vec_body, tail_cond);
+
+    builder.SetInsertPoint(vec_body);
+    gen_project_block(builder, sources, dest, builder.CreateLoad(i), lanes);
+    builder.CreateStore(builder.CreateAdd(builder.CreateLoad(i), i64val(lanes)), i);
+    builder.CreateBr(vec_cond);
+
+    // for(; i < len; i++)
+    builder.SetInsertPoint(tail_cond);
+    builder.CreateCondBr(builder.CreateICmpSLT(builder.CreateLoad(i), arg_len), tail_body, end);
+
+    builder.SetInsertPoint(tail_body);
+    gen_project_block(builder, sources, dest, builder.CreateLoad(i), 1);
+    builder.CreateStore(builder.CreateAdd(builder.CreateLoad(i), i64val(1)), i);
+    builder.CreateBr(tail_cond);
+
+    builder.SetInsertPoint(end);
+    builder.CreateRetVoid();
+  }
+
+  // evaluates expression for <lanes> elements starting from sources[pos] and stores results into
+  // dest[pos:pos + lanes]. Single lane is evaluated on scalars
+  void gen_project_block(llvm::IRBuilder<> &builder, const std::vector<llvm::Value *> &sources,
+                         llvm::Value *dest, llvm::Value *pos, unsigned lanes) {
+    // pointer to <lanes> elements of typ starting from ptr[pos]
+    auto at = [&](llvm::Value *ptr, const arrow::DataType &typ) {
+      auto *elem = builder.CreateInBoundsGEP(ptr, pos);
+      return lanes == 1 ? elem
+                        : builder.CreatePointerCast(
+                              elem, llvm::VectorType::get(from_arrow(typ), lanes)->getPointerTo());
+    };
+    auto align = [](const arrow::DataType &typ) {
+      return llvm::MaybeAlign(static_cast<const arrow::FixedWidthType &>(typ).bit_width() / 8);
+    };
+    std::vector<llvm::Value *> values(m_fields.size());
+    for (size_t i = 0; i < m_fields.size(); i++) {
+      auto &typ = *m_fields[i]->type();
+      values[i] = builder.CreateAlignedLoad(at(sources[i], typ), align(typ));
+    }
+    IrEmitVisitor visitor(&m_context, &builder, m_fields, values);
+    auto *result = visitor.emit_value(*m_expr, *m_output_type);
+    builder.CreateAlignedStore(result, at(dest, *m_output_type), align(*m_output_type));
+  }
+
+  // number of elements processed by one iteration of vectorized loop, which fills the widest
+  // vector register of the host with the narrowest of fields and result
+  unsigned get_vector_lanes(const llvm::Function &func) {
+    auto tti = m_jit->getTargetMachine().getTargetTransformInfo(func);
+    auto register_width = std::max(tti.getRegisterBitWidth(true), 128u);
+    auto min_type_width = static_cast<const arrow::FixedWidthType &>(*m_output_type).bit_width();
+    for (auto &field : m_fields) {
+      min_type_width = std::min(
+          min_type_width, static_cast<const arrow::FixedWidthType &>(*field->type()).bit_width());
+    }
+    return std::clamp(register_width / static_cast<unsigned>(min_type_width), 4u, 64u);
+  }
+};
+
+std::unique_ptr<ProjectionKernel>
+ProjectionKernel::create_cpu(std::vector<std::shared_ptr<const arrow::Field>> fields,
+                             std::shared_ptr<const ValueExpr> expr) {
+  return std::make_unique<ProjectionKernelImpl>(std::move(fields), std::move(expr));
+}
+} // namespace pefa::kernels
@@ -0,0 +1,29 @@
+#pragma once
+#include "pefa/query_compiler/expressions.h"
+
+#include <arrow/api.h>
+#include <memory>
+#include <vector>
+
+namespace pefa::kernels {
+using namespace query_compiler;
+class ProjectionKernel {
+public:
+  // Projection kernel evaluates value expression for every row and writes results of output_type
+  // into out, which has room for all rows. Columns contain one array per field (in order of fields
+  // passed to create_cpu) and all of them have same length. Values of rows, where any field is
+  // null, are unspecified, as validity of result is computed separately
+  virtual void execute(const std::vector<std::shared_ptr<const arrow::Array>> &columns,
+                       uint8_t *out) = 0;
+  virtual void compile() = 0;
+
+  [[nodiscard]] virtual std::shared_ptr<arrow::DataType> output_type() const = 0;
+
+  // Fields and result must be numeric. Throws NotImplementedException otherwise
+  [[nodiscard]] static std::unique_ptr<ProjectionKernel>
+  create_cpu(std::vector<std::shared_ptr<const arrow::Field>> fields,
+             std::shared_ptr<const ValueExpr> expr);
+
+  virtual ~ProjectionKernel() = default;
+};
+} // namespace pefa::kernels
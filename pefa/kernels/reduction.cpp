@@ -0,0 +1,504 @@
+#include "reduction.h"
+
+#include "aggregate.h"
+#include "ir_emit_visitor.h"
+#include "pefa/jit/jit.h"
+#include "pefa/utils/exceptions.h"
+#include "pefa/utils/llvm_helpers.h"
+#include "pefa/utils/utils.h"
+
+#include <algorithm>
+#include <cstring>
+#include <llvm/ADT/APInt.h>
+#include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Support/Host.h>
+#include <utility>
+
+namespace pefa::kernels {
+class ReductionKernelImpl : public ReductionKernel, private utils::LLVMTypesHelper {
+private:
+  // accumulators are 64-bit, so 8 lanes of every accumulator fill an AVX-512 register or two AVX2
+  // registers
+  static constexpr unsigned lanes = 8;
+
+  std::vector<std::shared_ptr<const arrow::Field>> m_fields;
+  std::shared_ptr<const BooleanExpr> m_expr;
+  std::vector<Aggregate> m_aggregates;
+  // position of field of every aggregate, or -1 for COUNT of rows
+  std::vector<int> m_columns;
+  std::vector<std::shared_ptr<arrow::DataType>> m_accumulator_types;
+  llvm::LLVMContext m_context;
+  llvm::orc::VModuleKey m_moduleKey{};
+  bool m_is_compiled = false;
+  std::shared_ptr<pefa::jit::JIT> m_jit;
+  // both functions have the same signature, reduce ignores validity
+  using ReduceFunc = void (*)(const uint8_t **, const uint8_t **, const int64_t *, int64_t *,
+                              int64_t);
+  ReduceFunc m_reduce_func{};
+  ReduceFunc m_reduce_nullable_func{};
+  void (*m_init_func)(int64_t *){};
+  void (*m_merge_func)(int64_t *, const int64_t *){};
+
+public:
+  ReductionKernelImpl(std::vector<std::shared_ptr<const arrow::Field>> fields,
+                      std::shared_ptr<const BooleanExpr> expr, std::vector<Aggregate> aggregates)
+      : ReductionKernel(aggregates.size())
+      , m_fields(std::move(fields))
+      , m_expr(std::move(expr))
+      , m_aggregates(std::move(aggregates))
+      , m_context(llvm::LLVMContext())
+      , m_jit(jit::get_JIT())
+      , utils::LLVMTypesHelper(m_context) {
+    if (m_fields.empty()) {
+      throw UnreachableException();
+    }
+    for (auto &aggregate : m_aggregates) {
+      if (aggregate.op == Aggregate::Op::COUNT && aggregate.column.empty()) {
+        m_columns.push_back(-1);
+        m_accumulator_types.push_back(arrow::int64());
+        continue;
+      }
+      auto it = std::find_if(m_fields.begin(), m_fields.end(),
+                             [&](auto &field) { return field->name() == aggregate.column; });
+      if (it == m_fields.end()) {
+        throw ColumnNotFoundException(aggregate.column);
+      }
+      m_columns.push_back(static_cast<int>(it - m_fields.begin()));
+      m_accumulator_types.push_back(
+          AggregateKernel::accumulator_type((*it)->type(), aggregate.op));
+    }
+  }
+
+  void execute(const std::vector<std::shared_ptr<const arrow::Array>> &columns,
+               int64_t *state) override {
+    if (!m_is_compiled) {
+      throw KernelNotCompiledException();
+    }
+    if (columns.size() != m_fields.size()) {
+      throw UnreachableException();
+    }
+    std::vector<const uint8_t *> inputs(columns.size());
+    for (size_t i = 0; i < columns.size(); i++) {
+      auto &column = *columns[i];
+      auto &type = static_cast<const arrow::FixedWidthType &>(*column.type());
+      inputs[i] = column.data()->buffers[1]->data() + type.bit_width() * column.offset() / 8;
+    }
+    auto length = columns.front()->length();
+
+    bool has_nulls = std::any_of(columns.begin(), columns.end(),
+                                 [](auto &column) { return column->null_count() != 0; });
+    if (!has_nulls) {
+      m_reduce_func(inputs.data(), nullptr, nullptr, state, length);
+      return;
+    }
+    // columns without validity bitmap share all_valid bitmap. Kernel reads validity bytes, which
+    // contain rows, so one byte is enough for the row after the last one
+    std::vector<const uint8_t *> validity;
+    std::vector<int64_t> validity_offsets;
+    std::shared_ptr<arrow::Buffer> all_valid;
+    for (auto &column : columns) {
+      if (column->null_bitmap_data()) {
+        validity.push_back(column->null_bitmap_data());
+        validity_offsets.push_back(column->offset());
+        continue;
+      }
+      if (!all_valid) {
+        all_valid = arrow::AllocateBitmap(length + 8).ValueOrDie();
+        std::memset(all_valid->mutable_data(), 255, all_valid->size());
+      }
+      validity.push_back(all_valid->data());
+      validity_offsets.push_back(0);
+    }
+    m_reduce_nullable_func(inputs.data(), validity.data(), validity_offsets.data(), state, length);
+  }
+
+  void init(int64_t *state) override {
+    if (!m_is_compiled) {
+      throw KernelNotCompiledException();
+    }
+    m_init_func(state);
+  }
+
+  void merge(int64_t *dst, const int64_t *src) override {
+    if (!m_is_compiled) {
+      throw KernelNotCompiledException();
+    }
+    m_merge_func(dst, src);
+  }
+
+  ~ReductionKernelImpl() override {
+    if (m_is_compiled) {
+      m_jit->removeModule(m_moduleKey);
+    }
+  }
+
+  void compile() override {
+    auto module = std::make_unique<llvm::Module>("reduction_mod", m_context);
+    module->setTargetTriple(llvm::sys::getProcessTriple());
+    gen_reduce_func(*module, false);
+    gen_reduce_func(*module, true);
+    gen_init_func(*module);
+    gen_merge_func(*module);
+    auto &machine = m_jit->getTargetMachine();
+    module->setDataLayout(machine.createDataLayout());
+    m_moduleKey = m_jit->addModule(std::move(module));
+    m_reduce_func = reinterpret_cast<ReduceFunc>(m_jit->getSymbolAddress(m_moduleKey, "reduce"));
+    m_reduce_nullable_func =
+        reinterpret_cast<ReduceFunc>(m_jit->getSymbolAddress(m_moduleKey, "reduce_nullable"));
+    m_init_func =
+        reinterpret_cast<void (*)(int64_t *)>(m_jit->getSymbolAddress(m_moduleKey, "init"));
+    m_merge_func = reinterpret_cast<void (*)(int64_t *, const int64_t *)>(
+        m_jit->getSymbolAddress(m_moduleKey, "merge"));
+    m_is_compiled = true;
+  }
+
+private:
+  // accumulator and count of aggregate inside state
+  struct StatePointers {
+    llvm::Value *value;
+    llvm::Value *count;
+  };
+
+  StatePointers gen_state_pointers(llvm::IRBuilder<> &builder, llvm::Value *state, size_t agg) {
+    auto *value = builder.CreateInBoundsGEP(state, i64val(2 * agg));
+    return {builder.CreatePointerCast(value, ptr_from_arrow(*m_accumulator_types[agg])),
+            builder.CreateInBoundsGEP(state, i64val(2 * agg + 1))};
+  }
+
+  // accumulator value, which does not account any rows
+  llvm::Constant *identity(size_t agg) {
+    auto *typ = from_arrow(*m_accumulator_types[agg]);
+    auto op = m_aggregates[agg].op;
+    if (op != Aggregate::Op::MIN && op != Aggregate::Op::MAX) {
+      return llvm::Constant::getNullValue(typ);
+    }
+    bool is_min = op == Aggregate::Op::MIN;
+    switch (m_accumulator_types[agg]->id()) {
+      PEFA_CASE_RET(PEFA_FLOATING_CASE, llvm::ConstantFP::getInfinity(typ, !is_min))
+      PEFA_CASE_RET(PEFA_SIGNED_INTEGRAL_CASE,
+                    llvm::ConstantInt::get(
+                        typ, is_min ? llvm::APInt::getSignedMaxValue(typ->getIntegerBitWidth())
+                                    : llvm::APInt::getSignedMinValue(typ->getIntegerBitWidth())))
+      PEFA_CASE_RET(PEFA_UNSIGNED_INTEGRAL_CASE,
+                    llvm::ConstantInt::get(
+                        typ, is_min ? llvm::APInt::getMaxValue(typ->getIntegerBitWidth())
+                                    : llvm::APInt::getMinValue(typ->getIntegerBitWidth())))
+    default:
+      throw UnreachableException();
+    }
+  }
+
+  // combines two accumulators of aggregate, either scalars or vectors
+  llvm::Value *gen_combine(llvm::IRBuilder<> &builder, size_t agg, llvm::Value *lhs,
+                           llvm::Value *rhs) {
+    auto &typ = *m_accumulator_types[agg];
+    switch (m_aggregates[agg].op) {
+    case Aggregate::Op::SUM:
+    case Aggregate::Op::AVG:
+      return lhs->getType()->isFPOrFPVectorTy() ? builder.CreateFAdd(lhs, rhs)
+                                                : builder.CreateAdd(lhs, rhs);
+    case Aggregate::Op::MIN:
+      return builder.CreateSelect(create_cmp_lt(typ, builder, rhs, lhs), rhs, lhs);
+    case Aggregate::Op::MAX:
+      return builder.CreateSelect(create_cmp_gt(typ, builder, rhs, lhs), rhs, lhs);
+    case Aggregate::Op::COUNT:
+      return lhs;
+    }
+    throw UnreachableException();
+  }
+
+  // accounts value of rows, where mask is true, in accumulator and count of aggregate. Value is
+  // nullptr for COUNT of rows. All arguments are either scalars or vectors
+  void gen_update(llvm::IRBuilder<> &builder, size_t agg, llvm::Value *value, llvm::Value *mask,
+                  llvm::Value *&acc, llvm::Value *&count) {
+    count = builder.CreateAdd(count, builder.CreateZExt(mask, count->getType()));
+    switch (m_aggregates[agg].op) {
+    case Aggregate::Op::SUM:
+    case Aggregate::Op::AVG: {
+      auto *typ = acc->getType();
+      llvm::Value *widened;
+      switch (m_fields[m_columns[agg]]->type()->id()) {
+        PEFA_CASE_BRK(PEFA_SIGNED_INTEGRAL_CASE, widened = builder.CreateSExtOrTrunc(value, typ))
+        PEFA_CASE_BRK(PEFA_UNSIGNED_INTEGRAL_CASE,
+                      widened = builder.CreateZExtOrTrunc(value, typ))
+        PEFA_CASE_BRK(PEFA_FLOATING_CASE, widened = builder.CreateFPCast(value, typ))
+      default:
+        throw UnreachableException();
+      }
+      acc = gen_combine(builder, agg, acc,
+                        builder.CreateSelect(mask, widened, llvm::Constant::getNullValue(typ)));
+      break;
+    }
+    case Aggregate::Op::MIN:
+    case Aggregate::Op::MAX:
+      // rows, which are filtered out, are replaced with current accumulator
+      acc = gen_combine(builder, agg, acc, builder.CreateSelect(mask, value, acc));
+      break;
+    case Aggregate::Op::COUNT:
+      break;
+    }
+  }
+
+  // validity bitmap of a column, which starts from the byte containing the first element, and
+  // position of that element inside the byte
+  struct ValiditySource {
+    llvm::Value *bitmap;
+    llvm::Value *shift;
+  };
+
+  // loads validity of 8 elements starting from pos, which is multiple of 8, as <8 x i1>
+  llvm::Value *gen_validity_mask(llvm::IRBuilder<> &builder, const ValiditySource &source,
+                                 llvm::Value *pos) {
+    auto *ptr = builder.CreateInBoundsGEP(source.bitmap, builder.CreateLShr(pos, i64val(3)));
+    // byte after the current one is needed only if elements are not aligned to bytes. Otherwise it
+    // may lie outside of the bitmap, so the current byte is loaded again instead
+    auto *is_aligned = builder.CreateICmpEQ(source.shift, i64val(0));
+    auto *high_ptr =
+        builder.CreateInBoundsGEP(ptr, builder.CreateSelect(is_aligned, i64val(0), i64val(1)));
+    // (low | high << 8) >> shift
+    auto *word = builder.CreateOr(
+        builder.CreateZExt(builder.CreateLoad(ptr), i16_typ()),
+        builder.CreateShl(builder.CreateZExt(builder.CreateLoad(high_ptr), i16_typ()), i16val(8)));
+    auto *shifted = builder.CreateLShr(word, builder.CreateTrunc(source.shift, i16_typ()));
+    return builder.CreateBitCast(builder.CreateTrunc(shifted, i8_typ()),
+                                 llvm::VectorType::get(bool_typ(), lanes));
+  }
+
+  // (bitmap[(shift + pos) / 8] >> ((shift + pos) % 8)) & 1
+  llvm::Value *gen_validity_bit(llvm::IRBuilder<> &builder, const ValiditySource &source,
+                                llvm::Value *pos) {
+    auto *bit_pos = builder.CreateAdd(source.shift, pos);
+    auto *byte = builder.CreateLoad(
+        builder.CreateInBoundsGEP(source.bitmap, builder.CreateLShr(bit_pos, i64val(3))));
+    auto *bit = builder.CreateLShr(
+        byte, builder.CreateTrunc(builder.CreateAnd(bit_pos, i64val(7)), i8_typ()));
+    return builder.CreateTrunc(bit, bool_typ());
+  }
+
+  // evaluates predicate over values and accounts rows, where it is true, in accumulators
+  void gen_block(llvm::IRBuilder<> &builder, const std::vector<llvm::Value *> &values,
+                 const std::vector<llvm::Value *> &valid, std::vector<llvm::Value *> &accs,
+                 std::vector<llvm::Value *> &counts) {
+    IrEmitVisitor visitor(&m_context, &builder, m_fields, values, valid);
+    m_expr->visit(visitor);
+    auto *mask = visitor.result();
+    for (size_t agg = 0; agg < m_aggregates.size(); agg++) {
+      auto column = m_columns[agg];
+      llvm::Value *value = column < 0 ? nullptr : values[column];
+      auto *agg_mask = column < 0 || valid.empty() ? mask : builder.CreateAnd(mask, valid[column]);
+      gen_update(builder, agg, value, agg_mask, accs[agg], counts[agg]);
+    }
+  }
+
+  // if nullable is set, generates reduce_nullable function, which additionally takes validity
+  // bitmaps and bit offset of the first element in them
+  void gen_reduce_func(llvm::Module &module, bool nullable) {
+    // void reduce(uint8_t **in, uint8_t **validity, int64_t *validity_offsets, int64_t *state,
+    //             int64_t len) {
+    //     <LANES x ACC_TYPE> acc = splat(identity); <LANES x int64_t> count = 0;
+    //     int64_t i = 0;
+    //     for(; i + LANES <= len; i += LANES) {
+    //         <LANES x i1> mask = predicate(<LANES x TYPE_0> source_0[i:i + LANES], ...);
+    //         acc = combine(acc, mask ? value[i:i + LANES] : identity); count += mask;
+    //     }
+    //     state = combine(state, acc[0], ..., acc[LANES - 1]);
+    //     for(; i < len; i++) {
+    //         state = combine(state, predicate(source_0[i], ...) ? value[i] : identity);
+    //     }
+    // }
+    std::vector<llvm::Type *> param_type{llvm::Type::getInt8PtrTy(m_context)->getPointerTo(),
+                                         llvm::Type::getInt8PtrTy(m_context)->getPointerTo(),
+                                         llvm::Type::getInt64PtrTy(m_context),
+                                         llvm::Type::getInt64PtrTy(m_context), i64_typ()};
+    llvm::FunctionType *prototype =
+        llvm::FunctionType::get(llvm::Type::getVoidTy(m_context), param_type, false);
+    llvm::Function *func = llvm::Function::Create(prototype, llvm::Function::ExternalLinkage,
+                                                  nullable ? "reduce_nullable" : "reduce", module);
+    llvm::BasicBlock *body = llvm::BasicBlock::Create(m_context, "body", func);
+    llvm::BasicBlock *vec_cond = llvm::BasicBlock::Create(m_context, "vecloop.cond", func);
+    llvm::BasicBlock *vec_body = llvm::BasicBlock::Create(m_context, "vecloop.body", func);
+    llvm::BasicBlock *vec_end = llvm::BasicBlock::Create(m_context, "vecloop.end", func);
+    llvm::BasicBlock *tail_cond = llvm::BasicBlock::Create(m_context, "tailloop.cond", func);
+    llvm::BasicBlock *tail_body = llvm::BasicBlock::Create(m_context, "tailloop.body", func);
+    llvm::BasicBlock *end = llvm::BasicBlock::Create(m_context, "end", func);
+
+    llvm::Value *arg_inputs = func->getArg(0);
+    llvm::Value *arg_state = func->getArg(3);
+    llvm::Value *arg_len = func->getArg(4);
+
+    llvm::IRBuilder builder(m_context);
+    builder.SetInsertPoint(body);
+    auto *i = builder.CreateAlloca(i64_typ(), nullptr, "i");
+    builder.CreateStore(i64val(0), i);
+
+    std::vector<llvm::Value *> sources(m_fields.size());
+    std::vector<ValiditySource> validity(nullable ? m_fields.size() : 0);
+    for (size_t field = 0; field < m_fields.size(); field++) {
+      auto *input = builder.CreateLoad(builder.CreateInBoundsGEP(arg_inputs, i64val(field)));
+      sources[field] = builder.CreatePointerCast(input, ptr_from_arrow(*m_fields[field]->type()));
+      if (nullable) {
+        auto *bitmap =
+            builder.CreateLoad(builder.CreateInBoundsGEP(func->getArg(1), i64val(field)));
+        auto *offset =
+            builder.CreateLoad(builder.CreateInBoundsGEP(func->getArg(2), i64val(field)));
+        validity[field].bitmap =
+            builder.CreateInBoundsGEP(bitmap, builder.CreateLShr(offset, i64val(3)));
+        validity[field].shift = builder.CreateAnd(offset, i64val(7));
+      }
+    }
+
+    // vector accumulators are kept in allocas, which are promoted to registers by optimizer
+    std::vector<llvm::Value *> vec_accs(m_aggregates.size());
+    std::vector<llvm::Value *> vec_counts(m_aggregates.size());
+    auto *vec_count_typ = llvm::VectorType::get(i64_typ(), lanes);
+    for (size_t agg = 0; agg < m_aggregates.size(); agg++) {
+      auto *acc_typ = llvm::VectorType::get(from_arrow(*m_accumulator_types[agg]), lanes);
+      vec_accs[agg] = builder.CreateAlloca(acc_typ);
+      builder.CreateStore(builder.CreateVectorSplat(lanes, identity(agg)), vec_accs[agg]);
+      vec_counts[agg] = builder.CreateAlloca(vec_count_typ);
+      builder.CreateStore(llvm::Constant::getNullValue(vec_count_typ), vec_counts[agg]);
+    }
+    builder.CreateBr(vec_cond);
+
+    // for(; i + LANES <= len; i += LANES)
+    builder.SetInsertPoint(vec_cond);
+    auto *vec_condition =
+        builder.CreateICmpSLE(builder.CreateAdd(builder.CreateLoad(i), i64val(lanes)), arg_len);
+    builder.CreateCondBr(vec_condition, vec_body, vec_end);
+
+    builder.SetInsertPoint(vec_body);
+    {
+      auto *pos = builder.CreateLoad(i);
+      std::vector<llvm::Value *> values(m_fields.size());
+      for (size_t field = 0; field < m_fields.size(); field++) {
+        auto &typ = *m_fields[field]->type();
+        auto elem_align =
+            llvm::MaybeAlign(static_cast<const arrow::FixedWidthType &>(typ).bit_width() / 8);
+        auto *vec_ptr_typ = llvm::VectorType::get(from_arrow(typ), lanes)->getPointerTo();
+        values[field] = builder.CreateAlignedLoad(
+            builder.CreatePointerCast(builder.CreateInBoundsGEP(sources[field], pos), vec_ptr_typ),
+            elem_align);
+      }
+      std::vector<llvm::Value *> valid;
+      for (auto &source : validity) {
+        valid.push_back(gen_validity_mask(builder, source, pos));
+      }
+      std::vector<llvm::Value *> accs;
+      std::vector<llvm::Value *> counts;
+      for (size_t agg = 0; agg < m_aggregates.size(); agg++) {
+        accs.push_back(builder.CreateLoad(vec_accs[agg]));
+        counts.push_back(builder.CreateLoad(vec_counts[agg]));
+      }
+      gen_block(builder, values, valid, accs, counts);
+      for (size_t agg = 0; agg < m_aggregates.size(); agg++) {
+        builder.CreateStore(accs[agg], vec_accs[agg]);
+        builder.CreateStore(counts[agg], vec_counts[agg]);
+      }
+      builder.CreateStore(builder.CreateAdd(pos, i64val(lanes)), i);
+      builder.CreateBr(vec_cond);
+    }
+
+    // lanes of vector accumulators are combined into state once per call
+    builder.SetInsertPoint(vec_end);
+    for (size_t agg = 0; agg < m_aggregates.size(); agg++) {
+      auto state = gen_state_pointers(builder, arg_state, agg);
+      auto *acc = builder.CreateLoad(vec_accs[agg]);
+      auto *count = builder.CreateLoad(vec_counts[agg]);
+      llvm::Value *value = builder.CreateLoad(state.value);
+      llvm::Value *total = builder.CreateLoad(state.count);
+      for (unsigned lane = 0; lane < lanes; lane++) {
+        value = gen_combine(builder, agg, value, builder.CreateExtractElement(acc, lane));
+        total = builder.CreateAdd(total, builder.CreateExtractElement(count, lane));
+      }
+      builder.CreateStore(value, state.value);
+      builder.CreateStore(total, state.count);
+    }
+    builder.CreateBr(tail_cond);
+
+    // for(; i < len; i++)
+    builder.SetInsertPoint(tail_cond);
+    builder.CreateCondBr(builder.CreateICmpSLT(builder.CreateLoad(i), arg_len), tail_body, end);
+
+    builder.SetInsertPoint(tail_body);
+    {
+      auto *pos = builder.CreateLoad(i);
+      std::vector<llvm::Value *> values;
+      for (auto *source : sources) {
+        values.push_back(builder.CreateLoad(builder.CreateInBoundsGEP(source, pos)));
+      }
+      std::vector<llvm::Value *> valid;
+      for (auto &source : validity) {
+        valid.push_back(gen_validity_bit(builder, source, pos));
+      }
+      std::vector<StatePointers> state;
+      std::vector<llvm::Value *> accs;
+      std::vector<llvm::Value *> counts;
+      for (size_t agg = 0; agg < m_aggregates.size(); agg++) {
+        state.push_back(gen_state_pointers(builder, arg_state, agg));
+        accs.push_back(builder.CreateLoad(state.back().value));
+        counts.push_back(builder.CreateLoad(state.back().count));
+      }
+      gen_block(builder, values, valid, accs, counts);
+      for (size_t agg = 0; agg < m_aggregates.size(); agg++) {
+        builder.CreateStore(accs[agg], state[agg].value);
+        builder.CreateStore(counts[agg], state[agg].count);
+      }
+      builder.CreateStore(builder.CreateAdd(pos, i64val(1)), i);
+      builder.CreateBr(tail_cond);
+    }
+
+    builder.SetInsertPoint(end);
+    builder.CreateRetVoid();
+  }
+
+  // void init(int64_t *state)
+  void gen_init_func(llvm::Module &module) {
+    llvm::FunctionType *prototype = llvm::FunctionType::get(
+        llvm::Type::getVoidTy(m_context), {llvm::Type::getInt64PtrTy(m_context)}, false);
+    llvm::Function *func =
+        llvm::Function::Create(prototype, llvm::Function::ExternalLinkage, "init", module);
+    llvm::IRBuilder builder(m_context);
+    builder.SetInsertPoint(llvm::BasicBlock::Create(m_context, "body", func));
+    for (size_t agg = 0; agg < m_aggregates.size(); agg++) {
+      // the whole word is cleared first, so states of narrow accumulators are fully defined
+      builder.CreateStore(i64val(0), builder.CreateInBoundsGEP(func->getArg(0), i64val(2 * agg)));
+      auto state = gen_state_pointers(builder, func->getArg(0), agg);
+      builder.CreateStore(identity(agg), state.value);
+      builder.CreateStore(i64val(0), state.count);
+    }
+    builder.CreateRetVoid();
+  }
+
+  // void merge(int64_t *dst, const int64_t *src)
+  void gen_merge_func(llvm::Module &module) {
+    llvm::FunctionType *prototype = llvm::FunctionType::get(
+        llvm::Type::getVoidTy(m_context),
+        {llvm::Type::getInt64PtrTy(m_context), llvm::Type::getInt64PtrTy(m_context)}, false);
+    llvm::Function *func =
+        llvm::Function::Create(prototype, llvm::Function::ExternalLinkage, "merge", module);
+    llvm::IRBuilder builder(m_context);
+    builder.SetInsertPoint(llvm::BasicBlock::Create(m_context, "body", func));
+    for (size_t agg = 0; agg < m_aggregates.size(); agg++) {
+      auto dst = gen_state_pointers(builder, func->getArg(0), agg);
+      auto src = gen_state_pointers(builder, func->getArg(1), agg);
+      builder.CreateStore(gen_combine(builder, agg, builder.CreateLoad(dst.value),
+                                      builder.CreateLoad(src.value)),
+                          dst.value);
+      builder.CreateStore(
+          builder.CreateAdd(builder.CreateLoad(dst.count), builder.CreateLoad(src.count)),
+          dst.count);
+    }
+    builder.CreateRetVoid();
+  }
+};
+
+std::unique_ptr<ReductionKernel>
+ReductionKernel::create_cpu(std::vector<std::shared_ptr<const arrow::Field>> fields,
+                            std::shared_ptr<const BooleanExpr> expr,
+                            std::vector<Aggregate> aggregates) {
+  return std::make_unique<ReductionKernelImpl>(std::move(fields), std::move(expr),
+                                               std::move(aggregates));
+}
+} // namespace pefa::kernels
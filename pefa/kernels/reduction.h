@@ -0,0 +1,46 @@
+#pragma once
+#include "pefa/query_compiler/expressions.h"
+#include "pefa/query_compiler/logical_plan.h"
+
+#include <arrow/api.h>
+#include <memory>
+#include <vector>
+
+namespace pefa::kernels {
+using namespace query_compiler;
+class ReductionKernel {
+public:
+  // Reduction kernel evaluates predicate and accumulates aggregates of rows, where it is true, in
+  // a single pass, so filter bitmap is never written. Columns contain one array per field (in order
+  // of fields passed to create_cpu) and all of them have same length.
+
+  // State holds two 64-bit words per aggregate: accumulator (of AggregateKernel::accumulator_type,
+  // stored at the beginning of the word) and number of accounted values. Rows are accumulated into
+  // state, so one state may be passed to several calls
+  virtual void execute(const std::vector<std::shared_ptr<const arrow::Array>> &columns,
+                       int64_t *state) = 0;
+  // fills state, which does not account any rows
+  virtual void init(int64_t *state) = 0;
+  // accumulates src state into dst, so partial states of several threads can be combined
+  virtual void merge(int64_t *dst, const int64_t *src) = 0;
+  virtual void compile() = 0;
+
+  [[nodiscard]] size_t state_size() const {
+    return 2 * m_num_aggregates;
+  }
+
+  // Aggregates reference fields by names. COUNT with empty column name counts rows
+  [[nodiscard]] static std::unique_ptr<ReductionKernel>
+  create_cpu(std::vector<std::shared_ptr<const arrow::Field>> fields,
+             std::shared_ptr<const BooleanExpr> expr, std::vector<Aggregate> aggregates);
+
+  virtual ~ReductionKernel() = default;
+
+protected:
+  explicit ReductionKernel(size_t num_aggregates)
+      : m_num_aggregates(num_aggregates) {}
+
+private:
+  size_t m_num_aggregates;
+};
+} // namespace pefa::kernels
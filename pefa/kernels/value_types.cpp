@@ -0,0 +1,134 @@
+#include "value_types.h"
+
+#include "pefa/utils/exceptions.h"
+#include "pefa/utils/utils.h"
+
+#include <algorithm>
+#include <string>
+
+namespace pefa::kernels {
+namespace {
+class ValueTypeVisitor : public ExprVisitor {
+private:
+  const std::vector<std::shared_ptr<const arrow::Field>> &m_fields;
+  std::shared_ptr<arrow::DataType> m_result;
+
+public:
+  explicit ValueTypeVisitor(const std::vector<std::shared_ptr<const arrow::Field>> &fields)
+      : m_fields(fields) {}
+
+  void visit(const ColumnRef &expr) override {
+    for (auto &field : m_fields) {
+      if (field->name() == expr.name) {
+        m_result = field->type();
+        return;
+      }
+    }
+    throw ColumnNotFoundException(expr.name);
+  }
+
+  void visit(const LiteralExpr &expr) override {
+    m_result = nullptr;
+  }
+
+  void visit(const ArithmeticExpr &expr) override {
+    m_result = expr.op == ArithmeticExpr::Op::DIV ? arrow::float64()
+                                                  : operands_type(*expr.lhs, *expr.rhs, m_fields);
+  }
+
+  void visit(const CastExpr &expr) override {
+    m_result = expr.type;
+  }
+
+  [[nodiscard]] std::shared_ptr<arrow::DataType> result() const {
+    return m_result;
+  }
+};
+
+enum class Kind {
+  SIGNED,
+  UNSIGNED,
+  FLOATING,
+};
+
+Kind numeric_kind(const arrow::DataType &type) {
+  switch (type.id()) {
+    PEFA_CASE_RET(PEFA_SIGNED_INTEGRAL_CASE, Kind::SIGNED)
+    PEFA_CASE_RET(PEFA_UNSIGNED_INTEGRAL_CASE, Kind::UNSIGNED)
+    PEFA_CASE_RET(PEFA_FLOAT32_CASE PEFA_FLOAT64_CASE, Kind::FLOATING)
+  default:
+    throw NotImplementedException("Arithmetic over " + type.ToString() + " is not supported");
+  }
+}
+
+// type of literal, which meets another literal
+std::shared_ptr<arrow::DataType> literal_type(const LiteralExpr &literal) {
+  switch (literal.value.index()) {
+    PEFA_CASE_RET(case 0:, arrow::int32())
+    PEFA_CASE_RET(case 1:, arrow::float64())
+  default:
+    throw NotImplementedException("Only numeric literals are supported in arithmetic");
+  }
+}
+
+std::shared_ptr<arrow::DataType> integer_type(bool is_signed, int bit_width) {
+  switch (bit_width) {
+    PEFA_CASE_RET(case 8:, is_signed ? arrow::int8() : arrow::uint8())
+    PEFA_CASE_RET(case 16:, is_signed ? arrow::int16() : arrow::uint16())
+    PEFA_CASE_RET(case 32:, is_signed ? arrow::int32() : arrow::uint32())
+  default:
+    return is_signed ? arrow::int64() : arrow::uint64();
+  }
+}
+
+// Floating operand makes both float64, unless both are float32. Mix of signed and unsigned
+// integers is signed and wide enough for unsigned one, but int64 is the widest
+std::shared_ptr<arrow::DataType> promote(const std::shared_ptr<arrow::DataType> &lhs,
+                                         const std::shared_ptr<arrow::DataType> &rhs) {
+  auto lhs_kind = numeric_kind(*lhs);
+  auto rhs_kind = numeric_kind(*rhs);
+  if (lhs_kind == Kind::FLOATING || rhs_kind == Kind::FLOATING) {
+    bool both_float32 = lhs->id() == arrow::Type::FLOAT && rhs->id() == arrow::Type::FLOAT;
+    return both_float32 ? arrow::float32() : arrow::float64();
+  }
+  auto lhs_width = static_cast<const arrow::FixedWidthType &>(*lhs).bit_width();
+  auto rhs_width = static_cast<const arrow::FixedWidthType &>(*rhs).bit_width();
+  if (lhs_kind == rhs_kind) {
+    return integer_type(lhs_kind == Kind::SIGNED, std::max(lhs_width, rhs_width));
+  }
+  auto unsigned_width = lhs_kind == Kind::UNSIGNED ? lhs_width : rhs_width;
+  auto signed_width = lhs_kind == Kind::SIGNED ? lhs_width : rhs_width;
+  return integer_type(true, signed_width > unsigned_width ? signed_width : unsigned_width * 2);
+}
+} // namespace
+
+std::shared_ptr<arrow::DataType>
+value_type(const Expr &expr, const std::vector<std::shared_ptr<const arrow::Field>> &fields) {
+  ValueTypeVisitor visitor(fields);
+  expr.visit(visitor);
+  return visitor.result();
+}
+
+std::shared_ptr<arrow::DataType>
+operands_type(const Expr &lhs, const Expr &rhs,
+              const std::vector<std::shared_ptr<const arrow::Field>> &fields) {
+  auto lhs_type = value_type(lhs, fields);
+  auto rhs_type = value_type(rhs, fields);
+  auto lhs_literal = dynamic_cast<const LiteralExpr *>(&lhs);
+  auto rhs_literal = dynamic_cast<const LiteralExpr *>(&rhs);
+  if (lhs_literal && rhs_literal) {
+    return promote(literal_type(*lhs_literal), literal_type(*rhs_literal));
+  }
+  // literal takes type of the other operand, but fractional literal makes integer one float64
+  if (lhs_literal || rhs_literal) {
+    auto &type = lhs_literal ? rhs_type : lhs_type;
+    auto &literal = lhs_literal ? *lhs_literal : *rhs_literal;
+    auto is_fractional = literal_type(literal)->id() == arrow::Type::DOUBLE;
+    if (numeric_kind(*type) != Kind::FLOATING && is_fractional) {
+      return arrow::float64();
+    }
+    return type;
+  }
+  return promote(lhs_type, rhs_type);
+}
+} // namespace pefa::kernels
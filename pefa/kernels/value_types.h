@@ -0,0 +1,21 @@
+#pragma once
+#include "pefa/query_compiler/expressions.h"
+
+#include <arrow/api.h>
+#include <memory>
+#include <vector>
+
+namespace pefa::kernels {
+using namespace query_compiler;
+
+// Type of value expression over fields. Literal has no type of its own, as it takes type of the
+// other operand, so nullptr is returned for it
+[[nodiscard]] std::shared_ptr<arrow::DataType>
+value_type(const Expr &expr, const std::vector<std::shared_ptr<const arrow::Field>> &fields);
+
+// Common type, to which operands of arithmetic or comparison are converted. Throws
+// NotImplementedException if any of them is not numeric
+[[nodiscard]] std::shared_ptr<arrow::DataType>
+operands_type(const Expr &lhs, const Expr &rhs,
+              const std::vector<std::shared_ptr<const arrow::Field>> &fields);
+} // namespace pefa::kernels
@@ -1,5 +1,6 @@
 #include "expressions.h"
 
+#include <algorithm>
 #include <utility>
 namespace pefa::query_compiler {
 
@@ -48,8 +49,8 @@ void PredicateExpr::visit(ExprVisitor &visitor) const {
   visitor.visit(*this);
 }
 
-CompareExpr::CompareExpr(std::shared_ptr<const ColumnRef> lhs,
-                         std::shared_ptr<const LiteralExpr> rhs, Op op)
+CompareExpr::CompareExpr(std::shared_ptr<const ValueExpr> lhs,
+                         std::shared_ptr<const ValueExpr> rhs, Op op)
     : lhs(std::move(lhs))
     , rhs(std::move(rhs))
     , op(op) {}
@@ -58,35 +59,91 @@ void CompareExpr::visit(ExprVisitor &visitor) const {
   visitor.visit(*this);
 }
 
-std::shared_ptr<CompareExpr> CompareExpr::create(std::shared_ptr<const ColumnRef> lhs,
-                                                 std::shared_ptr<const LiteralExpr> rhs, Op op) {
+std::shared_ptr<CompareExpr> CompareExpr::create(std::shared_ptr<const ValueExpr> lhs,
+                                                 std::shared_ptr<const ValueExpr> rhs, Op op) {
   return std::make_shared<CompareExpr>(std::move(lhs), std::move(rhs), op);
 }
 
-std::shared_ptr<CompareExpr> ColumnRef::EQ(std::shared_ptr<const LiteralExpr> rhs) const {
-  return CompareExpr::create(std::static_pointer_cast<const ColumnRef>(shared_from_this()),
+const ColumnRef *CompareExpr::column() const {
+  auto column = dynamic_cast<const ColumnRef *>(lhs.get());
+  return column && dynamic_cast<const LiteralExpr *>(rhs.get()) ? column : nullptr;
+}
+
+const LiteralExpr *CompareExpr::literal() const {
+  return column() ? static_cast<const LiteralExpr *>(rhs.get()) : nullptr;
+}
+
+std::shared_ptr<CompareExpr> ValueExpr::EQ(std::shared_ptr<const ValueExpr> rhs) const {
+  return CompareExpr::create(std::static_pointer_cast<const ValueExpr>(shared_from_this()),
                              std::move(rhs), CompareExpr::Op::EQ);
 }
-std::shared_ptr<CompareExpr> ColumnRef::LE(std::shared_ptr<const LiteralExpr> rhs) const {
-  return CompareExpr::create(std::static_pointer_cast<const ColumnRef>(shared_from_this()),
+std::shared_ptr<CompareExpr> ValueExpr::LE(std::shared_ptr<const ValueExpr> rhs) const {
+  return CompareExpr::create(std::static_pointer_cast<const ValueExpr>(shared_from_this()),
                              std::move(rhs), CompareExpr::Op::LE);
 }
-std::shared_ptr<CompareExpr> ColumnRef::GE(std::shared_ptr<const LiteralExpr> rhs) const {
-  return CompareExpr::create(std::static_pointer_cast<const ColumnRef>(shared_from_this()),
+std::shared_ptr<CompareExpr> ValueExpr::GE(std::shared_ptr<const ValueExpr> rhs) const {
+  return CompareExpr::create(std::static_pointer_cast<const ValueExpr>(shared_from_this()),
                              std::move(rhs), CompareExpr::Op::GE);
 }
-std::shared_ptr<CompareExpr> ColumnRef::NEQ(std::shared_ptr<const LiteralExpr> rhs) const {
-  return CompareExpr::create(std::static_pointer_cast<const ColumnRef>(shared_from_this()),
+std::shared_ptr<CompareExpr> ValueExpr::NEQ(std::shared_ptr<const ValueExpr> rhs) const {
+  return CompareExpr::create(std::static_pointer_cast<const ValueExpr>(shared_from_this()),
                              std::move(rhs), CompareExpr::Op::NEQ);
 }
-std::shared_ptr<CompareExpr> ColumnRef::LT(std::shared_ptr<const LiteralExpr> rhs) const {
-  return CompareExpr::create(std::static_pointer_cast<const ColumnRef>(shared_from_this()),
+std::shared_ptr<CompareExpr> ValueExpr::LT(std::shared_ptr<const ValueExpr> rhs) const {
+  return CompareExpr::create(std::static_pointer_cast<const ValueExpr>(shared_from_this()),
                              std::move(rhs), CompareExpr::Op::LT);
 }
-std::shared_ptr<CompareExpr> ColumnRef::GT(std::shared_ptr<const LiteralExpr> rhs) const {
-  return CompareExpr::create(std::static_pointer_cast<const ColumnRef>(shared_from_this()),
+std::shared_ptr<CompareExpr> ValueExpr::GT(std::shared_ptr<const ValueExpr> rhs) const {
+  return CompareExpr::create(std::static_pointer_cast<const ValueExpr>(shared_from_this()),
                              std::move(rhs), CompareExpr::Op::GT);
 }
+std::shared_ptr<ArithmeticExpr> ValueExpr::ADD(std::shared_ptr<const ValueExpr> rhs) const {
+  return ArithmeticExpr::create(std::static_pointer_cast<const ValueExpr>(shared_from_this()),
+                                std::move(rhs), ArithmeticExpr::Op::ADD);
+}
+std::shared_ptr<ArithmeticExpr> ValueExpr::SUB(std::shared_ptr<const ValueExpr> rhs) const {
+  return ArithmeticExpr::create(std::static_pointer_cast<const ValueExpr>(shared_from_this()),
+                                std::move(rhs), ArithmeticExpr::Op::SUB);
+}
+std::shared_ptr<ArithmeticExpr> ValueExpr::MUL(std::shared_ptr<const ValueExpr> rhs) const {
+  return ArithmeticExpr::create(std::static_pointer_cast<const ValueExpr>(shared_from_this()),
+                                std::move(rhs), ArithmeticExpr::Op::MUL);
+}
+std::shared_ptr<ArithmeticExpr> ValueExpr::DIV(std::shared_ptr<const ValueExpr> rhs) const {
+  return ArithmeticExpr::create(std::static_pointer_cast<const ValueExpr>(shared_from_this()),
+                                std::move(rhs), ArithmeticExpr::Op::DIV);
+}
+std::shared_ptr<CastExpr> ValueExpr::CAST(std::shared_ptr<arrow::DataType> type) const {
+  return CastExpr::create(std::static_pointer_cast<const ValueExpr>(shared_from_this()),
+                          std::move(type));
+}
+std::shared_ptr<StringMatchExpr> ColumnRef::STARTS_WITH(std::string prefix) const {
+  return StringMatchExpr::create(std::static_pointer_cast<const ColumnRef>(shared_from_this()),
+                                 std::move(prefix), StringMatchExpr::Op::STARTS_WITH);
+}
+std::shared_ptr<StringMatchExpr> ColumnRef::ENDS_WITH(std::string suffix) const {
+  return StringMatchExpr::create(std::static_pointer_cast<const ColumnRef>(shared_from_this()),
+                                 std::move(suffix), StringMatchExpr::Op::ENDS_WITH);
+}
+std::shared_ptr<StringMatchExpr> ColumnRef::CONTAINS(std::string substring) const {
+  return StringMatchExpr::create(std::static_pointer_cast<const ColumnRef>(shared_from_this()),
+                                 std::move(substring), StringMatchExpr::Op::CONTAINS);
+}
+std::shared_ptr<StringMatchExpr> ColumnRef::LIKE(std::string pattern) const {
+  return StringMatchExpr::create(std::static_pointer_cast<const ColumnRef>(shared_from_this()),
+                                 std::move(pattern), StringMatchExpr::Op::LIKE);
+}
+std::shared_ptr<InExpr>
+ColumnRef::IN(std::vector<std::variant<int, double, std::string, bool>> values) const {
+  return InExpr::create(std::static_pointer_cast<const ColumnRef>(shared_from_this()),
+                        std::move(values));
+}
+std::shared_ptr<BetweenExpr>
+ColumnRef::BETWEEN(std::variant<int, double, std::string, bool> lower,
+                   std::variant<int, double, std::string, bool> upper) const {
+  return BetweenExpr::create(std::static_pointer_cast<const ColumnRef>(shared_from_this()),
+                             std::move(lower), std::move(upper));
+}
 LiteralExpr::LiteralExpr(std::variant<int, double, std::string, bool> val)
     : value(std::move(val)) {}
 
@@ -98,6 +155,98 @@ LiteralExpr::create(const std::variant<int, double, std::string, bool> &val) {
   return std::make_shared<LiteralExpr>(val);
 }
 
+BloomFilterExpr::BloomFilterExpr(std::shared_ptr<const ColumnRef> column,
+                                 std::shared_ptr<const utils::BloomFilter> filter)
+    : column(std::move(column))
+    , filter(std::move(filter)) {}
+
+std::shared_ptr<BloomFilterExpr>
+BloomFilterExpr::create(std::shared_ptr<const ColumnRef> column,
+                        std::shared_ptr<const utils::BloomFilter> filter) {
+  return std::make_shared<BloomFilterExpr>(std::move(column), std::move(filter));
+}
+
+void BloomFilterExpr::visit(ExprVisitor &visitor) const {
+  visitor.visit(*this);
+}
+
+StringMatchExpr::StringMatchExpr(std::shared_ptr<const ColumnRef> column, std::string pattern,
+                                 Op op)
+    : column(std::move(column))
+    , pattern(std::move(pattern))
+    , op(op) {}
+
+std::shared_ptr<StringMatchExpr> StringMatchExpr::create(std::shared_ptr<const ColumnRef> column,
+                                                         std::string pattern, Op op) {
+  return std::make_shared<StringMatchExpr>(std::move(column), std::move(pattern), op);
+}
+
+void StringMatchExpr::visit(ExprVisitor &visitor) const {
+  visitor.visit(*this);
+}
+
+InExpr::InExpr(std::shared_ptr<const ColumnRef> column,
+               std::vector<std::variant<int, double, std::string, bool>> values)
+    : column(std::move(column))
+    , values(std::move(values)) {}
+
+std::shared_ptr<InExpr>
+InExpr::create(std::shared_ptr<const ColumnRef> column,
+               std::vector<std::variant<int, double, std::string, bool>> values) {
+  return std::make_shared<InExpr>(std::move(column), std::move(values));
+}
+
+void InExpr::visit(ExprVisitor &visitor) const {
+  visitor.visit(*this);
+}
+
+BetweenExpr::BetweenExpr(std::shared_ptr<const ColumnRef> column,
+                         std::variant<int, double, std::string, bool> lower,
+                         std::variant<int, double, std::string, bool> upper)
+    : column(std::move(column))
+    , lower(std::move(lower))
+    , upper(std::move(upper)) {}
+
+std::shared_ptr<BetweenExpr>
+BetweenExpr::create(std::shared_ptr<const ColumnRef> column,
+                    std::variant<int, double, std::string, bool> lower,
+                    std::variant<int, double, std::string, bool> upper) {
+  return std::make_shared<BetweenExpr>(std::move(column), std::move(lower), std::move(upper));
+}
+
+void BetweenExpr::visit(ExprVisitor &visitor) const {
+  visitor.visit(*this);
+}
+
+ArithmeticExpr::ArithmeticExpr(std::shared_ptr<const ValueExpr> lhs,
+                               std::shared_ptr<const ValueExpr> rhs, Op op)
+    : lhs(std::move(lhs))
+    , rhs(std::move(rhs))
+    , op(op) {}
+
+std::shared_ptr<ArithmeticExpr> ArithmeticExpr::create(std::shared_ptr<const ValueExpr> lhs,
+                                                       std::shared_ptr<const ValueExpr> rhs,
+                                                       Op op) {
+  return std::make_shared<ArithmeticExpr>(std::move(lhs), std::move(rhs), op);
+}
+
+void ArithmeticExpr::visit(ExprVisitor &visitor) const {
+  visitor.visit(*this);
+}
+
+CastExpr::CastExpr(std::shared_ptr<const ValueExpr> operand, std::shared_ptr<arrow::DataType> type)
+    : operand(std::move(operand))
+    , type(std::move(type)) {}
+
+std::shared_ptr<CastExpr> CastExpr::create(std::shared_ptr<const ValueExpr> operand,
+                                           std::shared_ptr<arrow::DataType> type) {
+  return std::make_shared<CastExpr>(std::move(operand), std::move(type));
+}
+
+void CastExpr::visit(ExprVisitor &visitor) const {
+  visitor.visit(*this);
+}
+
 void ExprVisitor::visit(const ColumnRef &expr) {}
 
 void ExprVisitor::visit(const PredicateExpr &expr) {
@@ -114,6 +263,47 @@ void ExprVisitor::visit(const LiteralExpr &expr) {}
 
 void ExprVisitor::visit(const BooleanConst &expr) {}
 
+void ExprVisitor::visit(const BloomFilterExpr &expr) {
+  expr.column->visit(*this);
+}
+
+void ExprVisitor::visit(const StringMatchExpr &expr) {
+  expr.column->visit(*this);
+}
+
+void ExprVisitor::visit(const InExpr &expr) {
+  expr.column->visit(*this);
+}
+
+void ExprVisitor::visit(const BetweenExpr &expr) {
+  expr.column->visit(*this);
+}
+
+void ExprVisitor::visit(const ArithmeticExpr &expr) {
+  expr.lhs->visit(*this);
+  expr.rhs->visit(*this);
+}
+
+void ExprVisitor::visit(const CastExpr &expr) {
+  expr.operand->visit(*this);
+}
+
+void referenced_columns(const Expr &expr, std::vector<std::string> &names) {
+  struct ColumnNamesVisitor : ExprVisitor {
+    std::vector<std::string> &names;
+
+    explicit ColumnNamesVisitor(std::vector<std::string> &names)
+        : names(names) {}
+
+    void visit(const ColumnRef &expr) override {
+      if (std::find(names.begin(), names.end(), expr.name) == names.end()) {
+        names.push_back(expr.name);
+      }
+    }
+  } visitor(names);
+  expr.visit(visitor);
+}
+
 std::shared_ptr<ColumnRef> col(std::string name) {
   return ColumnRef::create(std::move(name));
 }
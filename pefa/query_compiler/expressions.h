@@ -3,6 +3,15 @@
 #include <string>
 #include <utility>
 #include <variant>
+#include <vector>
+
+namespace arrow {
+class DataType;
+} // namespace arrow
+
+namespace pefa::utils {
+class BloomFilter;
+} // namespace pefa::utils
 
 namespace pefa::query_compiler {
 
@@ -43,7 +52,32 @@ struct PredicateExpr : BooleanExpr {
 
 struct LiteralExpr;
 struct ColumnRef;
+struct StringMatchExpr;
+struct InExpr;
+struct BetweenExpr;
+struct CompareExpr;
+struct ArithmeticExpr;
+struct CastExpr;
+
+// Expression, which has a value for every row: column, literal or arithmetic over them
+struct ValueExpr : Expr {
+  [[nodiscard]] std::shared_ptr<CompareExpr> EQ(std::shared_ptr<const ValueExpr> rhs) const;
+  [[nodiscard]] std::shared_ptr<CompareExpr> LE(std::shared_ptr<const ValueExpr> rhs) const;
+  [[nodiscard]] std::shared_ptr<CompareExpr> GE(std::shared_ptr<const ValueExpr> rhs) const;
+  [[nodiscard]] std::shared_ptr<CompareExpr> NEQ(std::shared_ptr<const ValueExpr> rhs) const;
+  [[nodiscard]] std::shared_ptr<CompareExpr> LT(std::shared_ptr<const ValueExpr> rhs) const;
+  [[nodiscard]] std::shared_ptr<CompareExpr> GT(std::shared_ptr<const ValueExpr> rhs) const;
+
+  [[nodiscard]] std::shared_ptr<ArithmeticExpr> ADD(std::shared_ptr<const ValueExpr> rhs) const;
+  [[nodiscard]] std::shared_ptr<ArithmeticExpr> SUB(std::shared_ptr<const ValueExpr> rhs) const;
+  [[nodiscard]] std::shared_ptr<ArithmeticExpr> MUL(std::shared_ptr<const ValueExpr> rhs) const;
+  [[nodiscard]] std::shared_ptr<ArithmeticExpr> DIV(std::shared_ptr<const ValueExpr> rhs) const;
+  [[nodiscard]] std::shared_ptr<CastExpr> CAST(std::shared_ptr<arrow::DataType> type) const;
+};
 
+// Comparison of two values of the same row. Operands are converted to common type like operands of
+// arithmetic, except for <column op literal>, where literal takes type of column. Only that form
+// is supported for utf8, binary and dictionary columns
 struct CompareExpr : BooleanExpr {
   enum class Op {
     GT,
@@ -53,33 +87,42 @@ struct CompareExpr : BooleanExpr {
     EQ,
     NEQ,
   };
-  std::shared_ptr<const ColumnRef> lhs;
-  std::shared_ptr<const LiteralExpr> rhs;
+  std::shared_ptr<const ValueExpr> lhs;
+  std::shared_ptr<const ValueExpr> rhs;
   const Op op;
 
-  CompareExpr(std::shared_ptr<const ColumnRef> lhs, std::shared_ptr<const LiteralExpr> rhs, Op op);
+  CompareExpr(std::shared_ptr<const ValueExpr> lhs, std::shared_ptr<const ValueExpr> rhs, Op op);
 
   [[nodiscard]] static std::shared_ptr<CompareExpr>
-  create(std::shared_ptr<const ColumnRef> lhs, std::shared_ptr<const LiteralExpr> rhs, Op op);
+  create(std::shared_ptr<const ValueExpr> lhs, std::shared_ptr<const ValueExpr> rhs, Op op);
   void visit(ExprVisitor &visitor) const override;
+
+  // column and literal of comparison <column op literal>, which zone maps and specialized kernels
+  // handle. Both are null for other comparisons
+  [[nodiscard]] const ColumnRef *column() const;
+  [[nodiscard]] const LiteralExpr *literal() const;
 };
 
-struct ColumnRef : Expr {
+struct ColumnRef : ValueExpr {
   const std::string name;
 
   explicit ColumnRef(std::string name);
   static std::shared_ptr<ColumnRef> create(std::string name);
   void visit(ExprVisitor &visitor) const override;
 
-  [[nodiscard]] std::shared_ptr<CompareExpr> EQ(std::shared_ptr<const LiteralExpr> rhs) const;
-  [[nodiscard]] std::shared_ptr<CompareExpr> LE(std::shared_ptr<const LiteralExpr> rhs) const;
-  [[nodiscard]] std::shared_ptr<CompareExpr> GE(std::shared_ptr<const LiteralExpr> rhs) const;
-  [[nodiscard]] std::shared_ptr<CompareExpr> NEQ(std::shared_ptr<const LiteralExpr> rhs) const;
-  [[nodiscard]] std::shared_ptr<CompareExpr> LT(std::shared_ptr<const LiteralExpr> rhs) const;
-  [[nodiscard]] std::shared_ptr<CompareExpr> GT(std::shared_ptr<const LiteralExpr> rhs) const;
+  [[nodiscard]] std::shared_ptr<StringMatchExpr> STARTS_WITH(std::string prefix) const;
+  [[nodiscard]] std::shared_ptr<StringMatchExpr> ENDS_WITH(std::string suffix) const;
+  [[nodiscard]] std::shared_ptr<StringMatchExpr> CONTAINS(std::string substring) const;
+  [[nodiscard]] std::shared_ptr<StringMatchExpr> LIKE(std::string pattern) const;
+
+  [[nodiscard]] std::shared_ptr<InExpr>
+  IN(std::vector<std::variant<int, double, std::string, bool>> values) const;
+  [[nodiscard]] std::shared_ptr<BetweenExpr>
+  BETWEEN(std::variant<int, double, std::string, bool> lower,
+          std::variant<int, double, std::string, bool> upper) const;
 };
 
-struct LiteralExpr : Expr {
+struct LiteralExpr : ValueExpr {
   const std::variant<int, double, std::string, bool> value;
 
   explicit LiteralExpr(std::variant<int, double, std::string, bool> val);
@@ -88,14 +131,119 @@ struct LiteralExpr : Expr {
   void visit(ExprVisitor &visitor) const override;
 };
 
+// Arithmetic over numeric values of the same row. Operands are converted to common type: literal
+// takes type of the other operand, integers are widened to the widest of them, and any floating
+// operand makes both floating. Integer overflow wraps. Division is done in float64, so division by
+// zero gives inf or NaN instead of trap. Result is null if any operand is null
+struct ArithmeticExpr : ValueExpr {
+  enum class Op {
+    ADD,
+    SUB,
+    MUL,
+    DIV,
+  };
+  std::shared_ptr<const ValueExpr> lhs;
+  std::shared_ptr<const ValueExpr> rhs;
+  const Op op;
+
+  ArithmeticExpr(std::shared_ptr<const ValueExpr> lhs, std::shared_ptr<const ValueExpr> rhs,
+                 Op op);
+  [[nodiscard]] static std::shared_ptr<ArithmeticExpr>
+  create(std::shared_ptr<const ValueExpr> lhs, std::shared_ptr<const ValueExpr> rhs, Op op);
+  void visit(ExprVisitor &visitor) const override;
+};
+
+// Conversion of numeric value to numeric type. Floating values are truncated towards zero when
+// converted to integers
+struct CastExpr : ValueExpr {
+  std::shared_ptr<const ValueExpr> operand;
+  std::shared_ptr<arrow::DataType> type;
+
+  CastExpr(std::shared_ptr<const ValueExpr> operand, std::shared_ptr<arrow::DataType> type);
+  [[nodiscard]] static std::shared_ptr<CastExpr> create(std::shared_ptr<const ValueExpr> operand,
+                                                        std::shared_ptr<arrow::DataType> type);
+  void visit(ExprVisitor &visitor) const override;
+};
+
+// Match of string or binary column against pattern. LIKE pattern uses '%' for any sequence of
+// bytes and '_' for any single byte. Like comparisons, it is false for nulls
+struct StringMatchExpr : BooleanExpr {
+  enum class Op {
+    STARTS_WITH,
+    ENDS_WITH,
+    CONTAINS,
+    LIKE,
+  };
+  std::shared_ptr<const ColumnRef> column;
+  const std::string pattern;
+  const Op op;
+
+  StringMatchExpr(std::shared_ptr<const ColumnRef> column, std::string pattern, Op op);
+  [[nodiscard]] static std::shared_ptr<StringMatchExpr>
+  create(std::shared_ptr<const ColumnRef> column, std::string pattern, Op op);
+  void visit(ExprVisitor &visitor) const override;
+};
+
+// Membership of column value in list of literals. It is the same as OR of EQ comparisons of column
+// with every literal, including conversion of literals to column type
+struct InExpr : BooleanExpr {
+  std::shared_ptr<const ColumnRef> column;
+  const std::vector<std::variant<int, double, std::string, bool>> values;
+
+  InExpr(std::shared_ptr<const ColumnRef> column,
+         std::vector<std::variant<int, double, std::string, bool>> values);
+  [[nodiscard]] static std::shared_ptr<InExpr>
+  create(std::shared_ptr<const ColumnRef> column,
+         std::vector<std::variant<int, double, std::string, bool>> values);
+  void visit(ExprVisitor &visitor) const override;
+};
+
+// Inclusive range check of column value, the same as GE lower AND LE upper
+struct BetweenExpr : BooleanExpr {
+  std::shared_ptr<const ColumnRef> column;
+  const std::variant<int, double, std::string, bool> lower;
+  const std::variant<int, double, std::string, bool> upper;
+
+  BetweenExpr(std::shared_ptr<const ColumnRef> column,
+              std::variant<int, double, std::string, bool> lower,
+              std::variant<int, double, std::string, bool> upper);
+  [[nodiscard]] static std::shared_ptr<BetweenExpr>
+  create(std::shared_ptr<const ColumnRef> column,
+         std::variant<int, double, std::string, bool> lower,
+         std::variant<int, double, std::string, bool> upper);
+  void visit(ExprVisitor &visitor) const override;
+};
+
+// True for rows, whose integer key may be contained in bloom filter, and false for null keys.
+// Filter is filled during execution, e.g. by build side of join, and accepts every key before that
+struct BloomFilterExpr : BooleanExpr {
+  std::shared_ptr<const ColumnRef> column;
+  std::shared_ptr<const utils::BloomFilter> filter;
+
+  BloomFilterExpr(std::shared_ptr<const ColumnRef> column,
+                  std::shared_ptr<const utils::BloomFilter> filter);
+  [[nodiscard]] static std::shared_ptr<BloomFilterExpr>
+  create(std::shared_ptr<const ColumnRef> column, std::shared_ptr<const utils::BloomFilter> filter);
+  void visit(ExprVisitor &visitor) const override;
+};
+
 struct ExprVisitor {
   virtual void visit(const ColumnRef &expr);
   virtual void visit(const PredicateExpr &expr);
   virtual void visit(const CompareExpr &expr);
   virtual void visit(const LiteralExpr &expr);
   virtual void visit(const BooleanConst &expr);
+  virtual void visit(const BloomFilterExpr &expr);
+  virtual void visit(const StringMatchExpr &expr);
+  virtual void visit(const InExpr &expr);
+  virtual void visit(const BetweenExpr &expr);
+  virtual void visit(const ArithmeticExpr &expr);
+  virtual void visit(const CastExpr &expr);
 };
 
+// appends names of columns, referenced by expression, which are not in names yet
+void referenced_columns(const Expr &expr, std::vector<std::string> &names);
+
 [[nodiscard]] std::shared_ptr<ColumnRef> col(std::string name);
 
 [[nodiscard]] std::shared_ptr<LiteralExpr>
@@ -1,5 +1,7 @@
 #include "logical_plan.h"
 
+#include <algorithm>
+
 namespace pefa::query_compiler {
 void ProjectionNode::visit(PlanVisitor &visitor) const {
   visitor.visit(*this);
@@ -7,9 +9,26 @@ void ProjectionNode::visit(PlanVisitor &visitor) const {
 void FilterNode::visit(PlanVisitor &visitor) const {
   visitor.visit(*this);
 }
-ProjectionNode::ProjectionNode(std::shared_ptr<LogicalPlan> input, std::vector<std::string> fields)
+ProjectionNode::ProjectionNode(std::shared_ptr<LogicalPlan> input,
+                               const std::vector<std::string> &fields)
+    : input(std::move(input)) {
+  for (auto &field : fields) {
+    projections.push_back({col(field), field});
+  }
+}
+
+ProjectionNode::ProjectionNode(std::shared_ptr<LogicalPlan> input,
+                               std::vector<Projection> projections)
     : input(std::move(input))
-    , fields(std::move(fields)) {}
+    , projections(std::move(projections)) {}
+
+std::vector<std::string> ProjectionNode::input_columns() const {
+  std::vector<std::string> names;
+  for (auto &projection : projections) {
+    referenced_columns(*projection.expr, names);
+  }
+  return names;
+}
 
 FilterNode::FilterNode(std::shared_ptr<LogicalPlan> input, std::shared_ptr<BooleanExpr> expr)
     : input(std::move(input))
@@ -34,10 +53,137 @@ void PlanVisitor::visit(const MaterializeFilterNode &node) {
   on_visit(node);
 }
 
+void PlanVisitor::visit(const ScanNode &node) {
+  on_visit(node);
+}
+
+void PlanVisitor::visit(const AggregateNode &node) {
+  if (node.input) {
+    node.input->visit(*this);
+  }
+  on_visit(node);
+}
+
 void MaterializeFilterNode::visit(PlanVisitor &visitor) const {
   visitor.visit(*this);
 }
 
 MaterializeFilterNode::MaterializeFilterNode(std::shared_ptr<LogicalPlan> input)
     : input(std::move(input)) {}
-} // namespace pefa::query_compiler
\ No newline at end of file
+
+void ScanNode::visit(PlanVisitor &visitor) const {
+  visitor.visit(*this);
+}
+
+ScanNode::ScanNode(std::string path, FileFormat format)
+    : path(std::move(path))
+    , format(format) {}
+
+void AggregateNode::visit(PlanVisitor &visitor) const {
+  visitor.visit(*this);
+}
+
+AggregateNode::AggregateNode(std::shared_ptr<LogicalPlan> input, std::vector<std::string> keys,
+                             std::vector<Aggregate> aggregates,
+                             std::shared_ptr<BooleanExpr> predicate)
+    : input(std::move(input))
+    , keys(std::move(keys))
+    , aggregates(std::move(aggregates))
+    , predicate(std::move(predicate)) {}
+
+void PlanVisitor::visit(const JoinNode &node) {
+  on_enter(node);
+  if (node.input) {
+    node.input->visit(*this);
+  }
+  on_visit(node);
+}
+
+void JoinNode::visit(PlanVisitor &visitor) const {
+  visitor.visit(*this);
+}
+
+JoinNode::JoinNode(std::shared_ptr<LogicalPlan> input, std::shared_ptr<LogicalPlan> right,
+                   std::shared_ptr<arrow::Table> right_table, std::string left_key,
+                   std::string right_key, JoinType type,
+                   std::shared_ptr<utils::BloomFilter> bloom_filter)
+    : input(std::move(input))
+    , right(std::move(right))
+    , right_table(std::move(right_table))
+    , left_key(std::move(left_key))
+    , right_key(std::move(right_key))
+    , type(type)
+    , bloom_filter(std::move(bloom_filter)) {}
+
+void PlanVisitor::visit(const SortNode &node) {
+  if (node.input) {
+    node.input->visit(*this);
+  }
+  on_visit(node);
+}
+
+void SortNode::visit(PlanVisitor &visitor) const {
+  visitor.visit(*this);
+}
+
+SortNode::SortNode(std::shared_ptr<LogicalPlan> input, std::string key, bool ascending,
+                   int64_t limit)
+    : input(std::move(input))
+    , key(std::move(key))
+    , ascending(ascending)
+    , limit(limit) {}
+
+void InputColumns::add_column(const std::string &name) {
+  if (!m_projected && std::find(m_columns.begin(), m_columns.end(), name) == m_columns.end()) {
+    m_columns.push_back(name);
+  }
+}
+
+void InputColumns::project(const std::vector<std::string> &names) {
+  for (auto &name : names) {
+    add_column(name);
+  }
+  m_projected = true;
+}
+
+void InputColumns::add(const FilterNode &node) {
+  if (!m_projected) {
+    referenced_columns(*node.expr, m_columns);
+  }
+}
+
+void InputColumns::add(const ProjectionNode &node) {
+  project(node.input_columns());
+}
+
+void InputColumns::add(const AggregateNode &node) {
+  std::vector<std::string> names = node.keys;
+  if (node.predicate) {
+    referenced_columns(*node.predicate, names);
+  }
+  for (auto &aggregate : node.aggregates) {
+    // COUNT of rows does not reference any column
+    if (!aggregate.column.empty()) {
+      names.push_back(aggregate.column);
+    }
+  }
+  project(names);
+}
+
+void InputColumns::add(const JoinNode &node) {
+  // semi join keeps rows and columns of input, so only its key is added
+  if (node.type == JoinType::SEMI) {
+    add_column(node.left_key);
+    return;
+  }
+  if (!m_projected) {
+    m_columns.clear();
+    m_projected = true;
+  }
+}
+
+void InputColumns::add(const SortNode &node) {
+  // sort keeps columns of input, so only its key is added
+  add_column(node.key);
+}
+} // namespace pefa::query_compiler
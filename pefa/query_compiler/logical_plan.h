@@ -1,7 +1,9 @@
 #pragma once
 #include "expressions.h"
 
+#include <arrow/table.h>
 #include <memory>
+#include <string>
 #include <vector>
 
 namespace pefa::query_compiler {
@@ -11,11 +13,24 @@ struct LogicalPlan : std::enable_shared_from_this<LogicalPlan> {
   virtual void visit(PlanVisitor &visitor) const = 0;
 };
 
+// Column of projection result, which holds value of expr for every row. Column reference keeps
+// column as is, other expressions are computed
+struct Projection {
+  std::shared_ptr<const ValueExpr> expr;
+  // name of resulting column
+  std::string name;
+};
+
 struct ProjectionNode : LogicalPlan {
   std::shared_ptr<LogicalPlan> input;
-  std::vector<std::string> fields;
+  std::vector<Projection> projections;
   void visit(PlanVisitor &visitor) const override;
-  ProjectionNode(std::shared_ptr<LogicalPlan> input, std::vector<std::string> fields);
+  // selects columns of input by their names
+  ProjectionNode(std::shared_ptr<LogicalPlan> input, const std::vector<std::string> &fields);
+  ProjectionNode(std::shared_ptr<LogicalPlan> input, std::vector<Projection> projections);
+
+  // names of input columns, which are referenced by projections
+  [[nodiscard]] std::vector<std::string> input_columns() const;
 };
 
 struct MaterializeFilterNode : LogicalPlan {
@@ -31,16 +46,143 @@ struct FilterNode : LogicalPlan {
   FilterNode(std::shared_ptr<LogicalPlan> input, std::shared_ptr<BooleanExpr> expr);
 };
 
+enum class FileFormat {
+  CSV,
+  IPC, // Arrow IPC file format, also used by Feather V2
+  PARQUET,
+};
+
+// Source of rows, which reads file. Optimizer pushes columns and predicates of plan into scan
+struct ScanNode : LogicalPlan {
+  std::string path;
+  FileFormat format;
+  // columns, which are read from file. Empty list means all columns
+  std::vector<std::string> columns;
+  // parts of file, where predicate is false for every row, may be skipped by scan. Predicate does
+  // not filter rows itself, so filters are kept in plan. nullptr means nothing can be skipped
+  std::shared_ptr<BooleanExpr> predicate;
+  void visit(PlanVisitor &visitor) const override;
+  ScanNode(std::string path, FileFormat format);
+};
+
+struct Aggregate {
+  enum class Op {
+    SUM,
+    COUNT, // number of non-null values, or number of rows if column is empty
+    MIN,
+    MAX,
+    AVG,
+  };
+  Op op;
+  std::string column;
+  // name of resulting column
+  std::string name;
+};
+
+// Groups rows by values of keys and computes aggregates of every group. Result has one column per
+// key followed by one column per aggregate. Without keys all rows form a single group
+struct AggregateNode : LogicalPlan {
+  std::shared_ptr<LogicalPlan> input;
+  std::vector<std::string> keys;
+  std::vector<Aggregate> aggregates;
+  // rows, where predicate is false, are not aggregated. nullptr means all rows are aggregated
+  std::shared_ptr<BooleanExpr> predicate;
+  void visit(PlanVisitor &visitor) const override;
+  AggregateNode(std::shared_ptr<LogicalPlan> input, std::vector<std::string> keys,
+                std::vector<Aggregate> aggregates,
+                std::shared_ptr<BooleanExpr> predicate = nullptr);
+};
+
+enum class JoinType {
+  INNER, // every pair of rows with equal keys
+  SEMI,  // rows of input, which have at least one match in right table
+};
+
+// Equi-join of input with rows of right table, which are produced by right plan. Keys are integer
+// columns and null keys never match. INNER join returns columns of input followed by columns of
+// right table, except for right key, if it has the same name as left key. Order of rows is
+// unspecified
+struct JoinNode : LogicalPlan {
+  std::shared_ptr<LogicalPlan> input;
+  // right plan is nullptr, if right table is joined as is, and right table is nullptr, if right
+  // plan starts with scan
+  std::shared_ptr<LogicalPlan> right;
+  std::shared_ptr<arrow::Table> right_table;
+  std::string left_key;
+  std::string right_key;
+  JoinType type;
+  // filled with keys of right side before input is executed, so input may be filtered by it.
+  // nullptr, if join has no runtime filter
+  std::shared_ptr<utils::BloomFilter> bloom_filter;
+  void visit(PlanVisitor &visitor) const override;
+  JoinNode(std::shared_ptr<LogicalPlan> input, std::shared_ptr<LogicalPlan> right,
+           std::shared_ptr<arrow::Table> right_table, std::string left_key, std::string right_key,
+           JoinType type, std::shared_ptr<utils::BloomFilter> bloom_filter = nullptr);
+};
+
+// Orders rows of input by numeric key, nulls go last. Rows with equal keys keep their order in
+// input. With non-negative limit only that many first rows are returned
+struct SortNode : LogicalPlan {
+  std::shared_ptr<LogicalPlan> input;
+  std::string key;
+  bool ascending;
+  int64_t limit;
+  void visit(PlanVisitor &visitor) const override;
+  SortNode(std::shared_ptr<LogicalPlan> input, std::string key, bool ascending,
+           int64_t limit = -1);
+};
+
 class PlanVisitor {
 public:
   void visit(const ProjectionNode &node);
   void visit(const FilterNode &node);
   void visit(const MaterializeFilterNode &node);
+  void visit(const ScanNode &node);
+  void visit(const AggregateNode &node);
+  void visit(const JoinNode &node);
+  void visit(const SortNode &node);
 
 protected:
   virtual void on_visit(const ProjectionNode &node) = 0;
   virtual void on_visit(const FilterNode &node) = 0;
   virtual void on_visit(const MaterializeFilterNode &node) = 0;
+  virtual void on_visit(const ScanNode &node) = 0;
+  virtual void on_visit(const AggregateNode &node) = 0;
+  // right plan is not visited, as it is executed separately over right table
+  virtual void on_visit(const JoinNode &node) = 0;
+  virtual void on_visit(const SortNode &node) = 0;
+  // called before input of join is visited
+  virtual void on_enter(const JoinNode &node) {}
+};
+
+// Collects columns of plan input, which are referenced by the plan, from nodes passed in order of
+// execution. Filters before the first projection, aggregation or inner join and that node itself
+// reference columns of input, while later nodes reference only columns of its result
+class InputColumns {
+private:
+  std::vector<std::string> m_columns;
+  bool m_projected = false;
+
+  void add_column(const std::string &name);
+  void project(const std::vector<std::string> &names);
+
+public:
+  void add(const FilterNode &node);
+  void add(const ProjectionNode &node);
+  void add(const AggregateNode &node);
+  void add(const JoinNode &node);
+  void add(const SortNode &node);
+
+  // false, if all columns of input reach the result
+  [[nodiscard]] bool projected() const {
+    return m_projected;
+  }
+  // referenced columns in order of their first reference. Empty list of projected input means all
+  // columns, as columns of input, referenced after inner join, can not be told from columns of
+  // right table
+  [[nodiscard]] const std::vector<std::string> &columns() const {
+    return m_columns;
+  }
 };
 
 } // namespace pefa::query_compiler
\ No newline at end of file
@@ -0,0 +1,24 @@
+#include "fused_reduction_pass.h"
+namespace pefa::query_compiler {
+
+void FusedReductionPass::on_visit(const AggregateNode &node) {
+  auto filter = std::dynamic_pointer_cast<FilterNode>(m_result);
+  if (!node.keys.empty() || !filter) {
+    OptimizerPass::on_visit(node);
+    return;
+  }
+  // chain of filters is folded as a whole, so none of them produces bitmap
+  auto predicate = node.predicate;
+  std::shared_ptr<LogicalPlan> input = filter;
+  while (filter) {
+    predicate = predicate ? filter->expr->AND(predicate) : filter->expr;
+    input = filter->input;
+    filter = std::dynamic_pointer_cast<FilterNode>(input);
+  }
+  m_result = std::make_shared<AggregateNode>(input, node.keys, node.aggregates, predicate);
+}
+
+std::unique_ptr<FusedReductionPass> FusedReductionPass::create() {
+  return std::make_unique<FusedReductionPass>();
+}
+} // namespace pefa::query_compiler
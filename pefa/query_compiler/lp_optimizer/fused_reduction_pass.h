@@ -0,0 +1,17 @@
+#pragma once
+#include "pefa/query_compiler/logical_plan.h"
+#include "plan_optimizer.h"
+
+namespace pefa::query_compiler {
+// Moves filter, which directly precedes aggregation without keys, into predicate of aggregation,
+// so predicate is evaluated by reduction kernel together with aggregates and filter bitmap is
+// never allocated
+class FusedReductionPass : public OptimizerPass {
+public:
+  FusedReductionPass() = default;
+
+  void on_visit(const AggregateNode &node) override;
+
+  [[nodiscard]] static std::unique_ptr<FusedReductionPass> create();
+};
+} // namespace pefa::query_compiler
@@ -0,0 +1,107 @@
+#include "in_list_pass.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace pefa::query_compiler {
+namespace {
+// splits OR chain into operands, e.g. (a OR b) OR c -> [a, b, c]
+void flatten_or(const std::shared_ptr<const BooleanExpr> &expr,
+                std::vector<std::shared_ptr<const BooleanExpr>> &operands) {
+  auto predicate = std::dynamic_pointer_cast<const PredicateExpr>(expr);
+  if (predicate && predicate->op == PredicateExpr::Op::OR) {
+    flatten_or(predicate->lhs, operands);
+    flatten_or(predicate->rhs, operands);
+  } else {
+    operands.push_back(expr);
+  }
+}
+
+// values of EQ comparisons and IN lists of one column, merged at position of the first of them
+struct InListGroup {
+  std::shared_ptr<const ColumnRef> column;
+  std::vector<std::variant<int, double, std::string, bool>> values;
+  size_t position;
+  size_t count = 0;
+};
+
+std::shared_ptr<const BooleanExpr>
+rewrite_in_lists(const std::shared_ptr<const BooleanExpr> &expr) {
+  auto predicate = std::dynamic_pointer_cast<const PredicateExpr>(expr);
+  if (!predicate) {
+    return expr;
+  }
+  if (predicate->op == PredicateExpr::Op::AND) {
+    auto lhs = rewrite_in_lists(predicate->lhs);
+    auto rhs = rewrite_in_lists(predicate->rhs);
+    if (lhs == predicate->lhs && rhs == predicate->rhs) {
+      return expr;
+    }
+    return PredicateExpr::create(lhs, rhs, PredicateExpr::Op::AND);
+  }
+
+  std::vector<std::shared_ptr<const BooleanExpr>> operands;
+  flatten_or(expr, operands);
+  std::vector<InListGroup> groups;
+  auto group_of = [&](const std::shared_ptr<const ColumnRef> &column,
+                      size_t position) -> InListGroup & {
+    for (auto &group : groups) {
+      if (group.column->name == column->name) {
+        return group;
+      }
+    }
+    return groups.emplace_back(InListGroup{column, {}, position});
+  };
+  std::vector<std::shared_ptr<const BooleanExpr>> merged;
+  bool changed = false;
+  for (auto &original : operands) {
+    // operands are rewritten first, so lists inside of AND operands are merged too
+    auto operand = rewrite_in_lists(original);
+    changed = changed || operand != original;
+    std::shared_ptr<const ColumnRef> column;
+    if (auto compare = std::dynamic_pointer_cast<const CompareExpr>(operand);
+        compare && compare->op == CompareExpr::Op::EQ && compare->column()) {
+      column = std::static_pointer_cast<const ColumnRef>(compare->lhs);
+      auto &group = group_of(column, merged.size());
+      group.values.push_back(compare->literal()->value);
+      group.count++;
+    } else if (auto in = std::dynamic_pointer_cast<const InExpr>(operand)) {
+      column = in->column;
+      auto &group = group_of(column, merged.size());
+      group.values.insert(group.values.end(), in->values.begin(), in->values.end());
+      group.count++;
+    }
+    // the first operand of group keeps its position, and it is replaced by merged list later
+    if (!column || group_of(column, merged.size()).position == merged.size()) {
+      merged.push_back(operand);
+    }
+  }
+
+  for (auto &group : groups) {
+    if (group.count > 1) {
+      merged[group.position] = InExpr::create(group.column, std::move(group.values));
+      changed = true;
+    }
+  }
+  if (!changed) {
+    return expr;
+  }
+  auto result = merged.front();
+  for (size_t i = 1; i < merged.size(); i++) {
+    result = PredicateExpr::create(result, merged[i], PredicateExpr::Op::OR);
+  }
+  return result;
+}
+} // namespace
+
+void InListPass::on_visit(const FilterNode &node) {
+  // expressions are immutable, so rewritten one is shared with the original plan
+  m_result = std::make_shared<FilterNode>(
+      m_result, std::const_pointer_cast<BooleanExpr>(rewrite_in_lists(node.expr)));
+}
+
+std::unique_ptr<InListPass> InListPass::create() {
+  return std::make_unique<InListPass>();
+}
+} // namespace pefa::query_compiler
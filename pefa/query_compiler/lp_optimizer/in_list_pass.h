@@ -0,0 +1,17 @@
+#pragma once
+#include "pefa/query_compiler/logical_plan.h"
+#include "plan_optimizer.h"
+
+namespace pefa::query_compiler {
+// Rewrites OR of EQ comparisons of the same column with literals into IN list, so generated
+// x = 1 OR x = 2 OR ... is evaluated by single lookup instead of comparison per value, and
+// short circuit evaluation does not produce bitmap per value
+class InListPass : public OptimizerPass {
+public:
+  InListPass() = default;
+
+  void on_visit(const FilterNode &node) override;
+
+  [[nodiscard]] static std::unique_ptr<InListPass> create();
+};
+} // namespace pefa::query_compiler
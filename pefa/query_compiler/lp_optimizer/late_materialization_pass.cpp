@@ -0,0 +1,41 @@
+#include "late_materialization_pass.h"
+namespace pefa::query_compiler {
+
+std::shared_ptr<LogicalPlan>
+LateMaterializationPass::execute(const std::shared_ptr<LogicalPlan> &input) {
+  m_result = nullptr;
+  m_materialize = false;
+  input->visit(*this);
+  if (m_materialize) {
+    m_result = std::make_shared<MaterializeFilterNode>(m_result);
+  }
+  return m_result;
+}
+
+void LateMaterializationPass::on_visit(const MaterializeFilterNode &node) {
+  m_materialize = true;
+}
+
+void LateMaterializationPass::on_visit(const AggregateNode &node) {
+  OptimizerPass::on_visit(node);
+  m_materialize = false;
+}
+
+void LateMaterializationPass::on_visit(const JoinNode &node) {
+  OptimizerPass::on_visit(node);
+  // semi join only narrows filter of its input, which is materialized later
+  if (node.type == JoinType::INNER) {
+    m_materialize = false;
+  }
+}
+
+void LateMaterializationPass::on_visit(const SortNode &node) {
+  OptimizerPass::on_visit(node);
+  // sort gathers only selected rows
+  m_materialize = false;
+}
+
+std::unique_ptr<LateMaterializationPass> LateMaterializationPass::create() {
+  return std::make_unique<LateMaterializationPass>();
+}
+} // namespace pefa::query_compiler
@@ -0,0 +1,27 @@
+#pragma once
+#include "pefa/query_compiler/logical_plan.h"
+#include "plan_optimizer.h"
+
+namespace pefa::query_compiler {
+// Removes materialization after every filter and materializes once on top of the plan, so
+// filters and projections in between pass filter bitmap instead of copying tables. Aggregation,
+// inner join and sort consume filter bitmap themselves, so filters below them are never
+// materialized
+class LateMaterializationPass : public OptimizerPass {
+private:
+  bool m_materialize = false;
+
+public:
+  LateMaterializationPass() = default;
+
+  [[nodiscard]] std::shared_ptr<LogicalPlan>
+  execute(const std::shared_ptr<LogicalPlan> &input) override;
+
+  void on_visit(const MaterializeFilterNode &node) override;
+  void on_visit(const AggregateNode &node) override;
+  void on_visit(const JoinNode &node) override;
+  void on_visit(const SortNode &node) override;
+
+  [[nodiscard]] static std::unique_ptr<LateMaterializationPass> create();
+};
+} // namespace pefa::query_compiler
@@ -20,7 +20,24 @@ void OptimizerPass::on_visit(const MaterializeFilterNode &node) {
 }
 
 void OptimizerPass::on_visit(const ProjectionNode &node) {
-  m_result = std::make_shared<ProjectionNode>(m_result, node.fields);
+  m_result = std::make_shared<ProjectionNode>(m_result, node.projections);
+}
+
+void OptimizerPass::on_visit(const ScanNode &node) {
+  m_result = std::make_shared<ScanNode>(node);
+}
+
+void OptimizerPass::on_visit(const AggregateNode &node) {
+  m_result = std::make_shared<AggregateNode>(m_result, node.keys, node.aggregates, node.predicate);
+}
+
+void OptimizerPass::on_visit(const JoinNode &node) {
+  m_result = std::make_shared<JoinNode>(m_result, node.right, node.right_table, node.left_key,
+                                        node.right_key, node.type, node.bloom_filter);
+}
+
+void OptimizerPass::on_visit(const SortNode &node) {
+  m_result = std::make_shared<SortNode>(m_result, node.key, node.ascending, node.limit);
 }
 
 std::shared_ptr<LogicalPlan> OptimizerPass::execute(const std::shared_ptr<LogicalPlan> &input) {
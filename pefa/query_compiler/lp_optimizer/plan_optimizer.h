@@ -19,6 +19,10 @@ public:
   void on_visit(const FilterNode &node) override;
   void on_visit(const MaterializeFilterNode &node) override;
   void on_visit(const ProjectionNode &node) override;
+  void on_visit(const ScanNode &node) override;
+  void on_visit(const AggregateNode &node) override;
+  void on_visit(const JoinNode &node) override;
+  void on_visit(const SortNode &node) override;
 };
 
 class PlanOptimizer {
@@ -0,0 +1,22 @@
+#include "runtime_filter_pass.h"
+
+#include "pefa/utils/bloom_filter.h"
+
+namespace pefa::query_compiler {
+
+void RuntimeFilterPass::on_visit(const JoinNode &node) {
+  if (node.bloom_filter) {
+    OptimizerPass::on_visit(node);
+    return;
+  }
+  auto bloom_filter = std::make_shared<utils::BloomFilter>();
+  auto filter = std::make_shared<FilterNode>(
+      m_result, BloomFilterExpr::create(col(node.left_key), bloom_filter));
+  m_result = std::make_shared<JoinNode>(filter, node.right, node.right_table, node.left_key,
+                                        node.right_key, node.type, bloom_filter);
+}
+
+std::unique_ptr<RuntimeFilterPass> RuntimeFilterPass::create() {
+  return std::make_unique<RuntimeFilterPass>();
+}
+} // namespace pefa::query_compiler
@@ -0,0 +1,17 @@
+#pragma once
+#include "pefa/query_compiler/logical_plan.h"
+#include "plan_optimizer.h"
+
+namespace pefa::query_compiler {
+// Adds bloom filter over keys of right side to every join and filters input of join by it, so
+// rows without match are dropped by filter kernel before they are partitioned and probed. Filter
+// is ANDed with preceding filters, when they are joined into a single one
+class RuntimeFilterPass : public OptimizerPass {
+public:
+  RuntimeFilterPass() = default;
+
+  void on_visit(const JoinNode &node) override;
+
+  [[nodiscard]] static std::unique_ptr<RuntimeFilterPass> create();
+};
+} // namespace pefa::query_compiler
@@ -0,0 +1,73 @@
+#include "scan_pushdown_pass.h"
+
+namespace pefa::query_compiler {
+
+std::shared_ptr<LogicalPlan> ScanPushdownPass::execute(const std::shared_ptr<LogicalPlan> &input) {
+  m_result = nullptr;
+  m_scan = nullptr;
+  m_columns = InputColumns();
+  m_input_replaced = false;
+  input->visit(*this);
+  // without projection all columns of file reach the result
+  if (m_scan && m_columns.projected()) {
+    m_scan->columns = m_columns.columns();
+  }
+  return m_result;
+}
+
+void ScanPushdownPass::on_visit(const ScanNode &node) {
+  m_scan = std::make_shared<ScanNode>(node);
+  m_result = m_scan;
+}
+
+void ScanPushdownPass::on_visit(const FilterNode &node) {
+  OptimizerPass::on_visit(node);
+  m_columns.add(node);
+  if (!m_scan || m_input_replaced) {
+    return;
+  }
+  m_scan->predicate = m_scan->predicate ? m_scan->predicate->AND(node.expr) : node.expr;
+}
+
+void ScanPushdownPass::on_visit(const ProjectionNode &node) {
+  OptimizerPass::on_visit(node);
+  m_columns.add(node);
+  // statistics of file column describe only projection, which takes it under the same name
+  for (auto &projection : node.projections) {
+    auto column = dynamic_cast<const ColumnRef *>(projection.expr.get());
+    if (!column || column->name != projection.name) {
+      m_input_replaced = true;
+    }
+  }
+}
+
+void ScanPushdownPass::on_visit(const AggregateNode &node) {
+  OptimizerPass::on_visit(node);
+  if (m_scan && !m_input_replaced && node.predicate) {
+    m_scan->predicate = m_scan->predicate ? m_scan->predicate->AND(node.predicate) : node.predicate;
+  }
+  m_columns.add(node);
+  m_input_replaced = true;
+}
+
+void ScanPushdownPass::on_visit(const JoinNode &node) {
+  OptimizerPass::on_visit(node);
+  m_columns.add(node);
+  // following nodes of inner join reference columns of right table too
+  if (node.type != JoinType::SEMI) {
+    m_input_replaced = true;
+  }
+}
+
+void ScanPushdownPass::on_visit(const SortNode &node) {
+  OptimizerPass::on_visit(node);
+  m_columns.add(node);
+  if (node.limit >= 0) {
+    m_input_replaced = true;
+  }
+}
+
+std::unique_ptr<ScanPushdownPass> ScanPushdownPass::create() {
+  return std::make_unique<ScanPushdownPass>();
+}
+} // namespace pefa::query_compiler
@@ -0,0 +1,34 @@
+#pragma once
+#include "pefa/query_compiler/logical_plan.h"
+#include "plan_optimizer.h"
+
+#include <string>
+#include <vector>
+
+namespace pefa::query_compiler {
+// Pushes columns, which are needed by the plan, and conjunction of all filters into scan, so scan
+// does not read other columns and skips parts of file, which are rejected by filters
+class ScanPushdownPass : public OptimizerPass {
+private:
+  std::shared_ptr<ScanNode> m_scan;
+  InputColumns m_columns;
+  // filters after aggregation, join or projection, which computes or renames columns, reference
+  // columns, which are not in file, and filters after limit would change rows, which reach it
+  bool m_input_replaced = false;
+
+public:
+  ScanPushdownPass() = default;
+
+  [[nodiscard]] std::shared_ptr<LogicalPlan>
+  execute(const std::shared_ptr<LogicalPlan> &input) override;
+
+  void on_visit(const ScanNode &node) override;
+  void on_visit(const FilterNode &node) override;
+  void on_visit(const ProjectionNode &node) override;
+  void on_visit(const AggregateNode &node) override;
+  void on_visit(const JoinNode &node) override;
+  void on_visit(const SortNode &node) override;
+
+  [[nodiscard]] static std::unique_ptr<ScanPushdownPass> create();
+};
+} // namespace pefa::query_compiler
@@ -2,10 +2,19 @@
 
 #include "pefa/execution/execution.h"
 #include "pefa/execution/execution_context.h"
+#include "pefa/io/file_scan.h"
+#include "pefa/query_compiler/lp_optimizer/fused_reduction_pass.h"
+#include "pefa/query_compiler/lp_optimizer/in_list_pass.h"
 #include "pefa/query_compiler/lp_optimizer/join_filter_pass.h"
+#include "pefa/query_compiler/lp_optimizer/late_materialization_pass.h"
 #include "pefa/query_compiler/lp_optimizer/plan_optimizer.h"
+#include "pefa/query_compiler/lp_optimizer/runtime_filter_pass.h"
+#include "pefa/query_compiler/lp_optimizer/scan_pushdown_pass.h"
+#include "pefa/utils/exceptions.h"
 
+#include <arrow/api.h>
 #include <utility>
+#include <vector>
 
 namespace pefa::query_compiler {
 
@@ -15,23 +24,115 @@ QueryCompiler::QueryCompiler()
 QueryCompiler::QueryCompiler(std::shared_ptr<LogicalPlan> plan)
     : m_plan(std::move(plan)) {}
 
+QueryCompiler QueryCompiler::scan(std::string path, FileFormat format) {
+  return QueryCompiler(std::make_shared<ScanNode>(std::move(path), format));
+}
+
 QueryCompiler QueryCompiler::project(const std::vector<std::string> &columns) const {
   return QueryCompiler(std::make_shared<ProjectionNode>(m_plan, columns));
 }
 
+QueryCompiler QueryCompiler::select(const std::vector<Projection> &projections) const {
+  return QueryCompiler(std::make_shared<ProjectionNode>(m_plan, projections));
+}
+
 QueryCompiler QueryCompiler::filter(std::shared_ptr<BooleanExpr> expr) const {
   return QueryCompiler(std::make_shared<MaterializeFilterNode>(
       std::make_shared<FilterNode>(m_plan, std::move(expr))));
 }
 
+QueryCompiler QueryCompiler::aggregate(const std::vector<std::string> &keys,
+                                       const std::vector<Aggregate> &aggregates) const {
+  return QueryCompiler(std::make_shared<AggregateNode>(m_plan, keys, aggregates));
+}
+
+QueryCompiler QueryCompiler::join(const QueryCompiler &right,
+                                  std::shared_ptr<arrow::Table> right_table,
+                                  const std::string &left_key, const std::string &right_key,
+                                  JoinType type) const {
+  auto node = std::make_shared<JoinNode>(m_plan, right.m_plan, std::move(right_table), left_key,
+                                         right_key, type);
+  // semi join only filters rows of input, so they are materialized like after filter
+  if (type == JoinType::SEMI) {
+    return QueryCompiler(std::make_shared<MaterializeFilterNode>(node));
+  }
+  return QueryCompiler(node);
+}
+
+QueryCompiler QueryCompiler::join(std::shared_ptr<arrow::Table> right_table,
+                                  const std::string &left_key, const std::string &right_key,
+                                  JoinType type) const {
+  return join(QueryCompiler(), std::move(right_table), left_key, right_key, type);
+}
+
+QueryCompiler QueryCompiler::sort(const std::string &key, bool ascending) const {
+  return QueryCompiler(std::make_shared<SortNode>(m_plan, key, ascending));
+}
+
+QueryCompiler QueryCompiler::top_n(const std::string &key, int64_t n, bool ascending) const {
+  return QueryCompiler(std::make_shared<SortNode>(m_plan, key, ascending, n));
+}
+
+struct InputColumnsVisitor : PlanVisitor {
+  InputColumns columns;
+
+  void on_visit(const ProjectionNode &node) override {
+    columns.add(node);
+  }
+
+  void on_visit(const FilterNode &node) override {
+    columns.add(node);
+  }
+
+  void on_visit(const MaterializeFilterNode &node) override {}
+
+  void on_visit(const ScanNode &node) override {}
+
+  void on_visit(const AggregateNode &node) override {
+    columns.add(node);
+  }
+
+  void on_visit(const JoinNode &node) override {
+    columns.add(node);
+  }
+
+  void on_visit(const SortNode &node) override {
+    columns.add(node);
+  }
+};
+
+std::vector<std::string> QueryCompiler::input_columns() const {
+  InputColumnsVisitor visitor;
+  if (m_plan) {
+    m_plan->visit(visitor);
+  }
+  return visitor.columns.projected() ? visitor.columns.columns() : std::vector<std::string>{};
+}
+
+std::shared_ptr<LogicalPlan> optimize_plan(std::shared_ptr<LogicalPlan> plan) {
+  PlanOptimizer optimizer;
+  optimizer.add_pass(LateMaterializationPass::create());
+  optimizer.add_pass(RuntimeFilterPass::create());
+  optimizer.add_pass(JoinFilterPass::create());
+  optimizer.add_pass(InListPass::create());
+  optimizer.add_pass(ScanPushdownPass::create());
+  optimizer.add_pass(FusedReductionPass::create());
+  return optimizer.run(std::move(plan));
+}
+
 struct ExecutePlanVisitor : PlanVisitor {
   std::shared_ptr<execution::ExecutionContext> ctx;
+  std::shared_ptr<const execution::ExecutionConfig> config;
+  // right sides of joins, whose inputs are being executed
+  std::vector<std::shared_ptr<execution::ExecutionContext>> right_sides;
 
-  explicit ExecutePlanVisitor(std::shared_ptr<execution::ExecutionContext> ctx)
-      : ctx(std::move(ctx)) {}
+  ExecutePlanVisitor(std::shared_ptr<execution::ExecutionContext> ctx,
+                     std::shared_ptr<const execution::ExecutionConfig> config)
+      : ctx(std::move(ctx))
+      , config(std::move(config)) {}
 
   void on_visit(const ProjectionNode &node) override {
-    ctx = execution::project(ctx, node.fields);
+    ctx = execution::select(ctx, node.projections);
   }
 
   void on_visit(const FilterNode &node) override {
@@ -41,18 +142,185 @@ struct ExecutePlanVisitor : PlanVisitor {
   void on_visit(const MaterializeFilterNode &node) override {
     ctx = execution::materialize_filter(ctx);
   }
+
+  void on_visit(const ScanNode &node) override {
+    ctx = std::make_shared<execution::ExecutionContext>(
+        io::read_file(node.path, node.format, node.columns, node.predicate), config);
+  }
+
+  void on_visit(const AggregateNode &node) override {
+    ctx = execution::aggregate(ctx, node.keys, node.aggregates, node.predicate);
+  }
+
+  // right side is executed before input, so runtime filter of input is built by then
+  void on_enter(const JoinNode &node) override {
+    std::shared_ptr<execution::ExecutionContext> right;
+    if (node.right_table) {
+      right = std::make_shared<execution::ExecutionContext>(node.right_table, config);
+    }
+    if (node.right) {
+      auto plan = optimize_plan(node.right);
+      // join consumes filter of right side itself, so it is not materialized
+      if (auto materialize = std::dynamic_pointer_cast<MaterializeFilterNode>(plan)) {
+        plan = materialize->input;
+      }
+      ExecutePlanVisitor visitor(right, config);
+      plan->visit(visitor);
+      right = visitor.ctx;
+    }
+    if (!right) {
+      throw NotImplementedException("Query without scan should be executed over table");
+    }
+    if (node.bloom_filter && (!config || config->use_runtime_filters)) {
+      execution::build_bloom_filter(right, node.right_key, *node.bloom_filter);
+    }
+    right_sides.push_back(right);
+  }
+
+  void on_visit(const JoinNode &node) override {
+    auto right = std::move(right_sides.back());
+    right_sides.pop_back();
+    if (!ctx) {
+      throw NotImplementedException("Query without scan should be executed over table");
+    }
+    ctx = execution::join(ctx, right, node.left_key, node.right_key, node.type);
+  }
+
+  void on_visit(const SortNode &node) override {
+    ctx = execution::sort(ctx, node.key, node.ascending, node.limit);
+  }
 };
 
-std::shared_ptr<arrow::Table>
-QueryCompiler::execute(const std::shared_ptr<arrow::Table> &table) const {
-  PlanOptimizer optimizer;
-  optimizer.add_pass(JoinFilterPass::create());
-  auto plan = optimizer.run(m_plan);
+// finds nodes, whose result depends on all rows of input
+struct BlockingNodeVisitor : PlanVisitor {
+  bool found = false;
 
-  auto ctx = std::make_shared<execution::ExecutionContext>(table);
+  void on_visit(const ProjectionNode &node) override {}
+  void on_visit(const FilterNode &node) override {}
+  void on_visit(const MaterializeFilterNode &node) override {}
+  void on_visit(const ScanNode &node) override {}
 
-  auto visitor = ExecutePlanVisitor(ctx);
-  plan->visit(visitor);
+  void on_visit(const AggregateNode &node) override {
+    found = true;
+  }
+
+  // right side would be executed and partitioned again for every batch
+  void on_visit(const JoinNode &node) override {
+    found = true;
+  }
+
+  void on_visit(const SortNode &node) override {
+    found = true;
+  }
+};
+
+// table may be nullptr, if plan starts with scan
+std::shared_ptr<arrow::Table>
+execute_plan(const LogicalPlan &plan, const std::shared_ptr<arrow::Table> &table,
+             std::shared_ptr<const execution::ExecutionConfig> config) {
+  std::shared_ptr<execution::ExecutionContext> ctx;
+  if (table) {
+    ctx = std::make_shared<execution::ExecutionContext>(table, config);
+  }
+  auto visitor = ExecutePlanVisitor(ctx, std::move(config));
+  plan.visit(visitor);
+  if (!visitor.ctx) {
+    throw NotImplementedException("Query without scan should be executed over table");
+  }
   return visitor.ctx->table;
 }
+
+// Executes plan over every batch of input separately. Result of a batch is returned in several
+// batches, if materialization splits it into several chunks
+class StreamingPlanReader : public arrow::RecordBatchReader {
+private:
+  std::shared_ptr<LogicalPlan> m_plan;
+  std::shared_ptr<arrow::RecordBatchReader> m_input;
+  std::shared_ptr<const execution::ExecutionConfig> m_config;
+  std::shared_ptr<arrow::Schema> m_schema;
+  // result of the last input batch, which is not completely read yet
+  std::shared_ptr<arrow::Table> m_result;
+  std::unique_ptr<arrow::TableBatchReader> m_result_reader;
+
+public:
+  StreamingPlanReader(std::shared_ptr<LogicalPlan> plan,
+                      std::shared_ptr<arrow::RecordBatchReader> input,
+                      std::shared_ptr<const execution::ExecutionConfig> config)
+      : m_plan(std::move(plan))
+      , m_input(std::move(input))
+      , m_config(std::move(config)) {
+    BlockingNodeVisitor blocking_node;
+    m_plan->visit(blocking_node);
+    if (blocking_node.found) {
+      // every batch would be aggregated or sorted separately, which gives several rows per group
+      // and unordered result
+      throw NotImplementedException(
+          "Aggregation, join and sort are not supported in streaming mode");
+    }
+    // resulting schema does not depend on data, so it is taken from result of an empty table
+    std::vector<std::shared_ptr<arrow::ChunkedArray>> columns;
+    for (auto &field : m_input->schema()->fields()) {
+      columns.push_back(std::make_shared<arrow::ChunkedArray>(arrow::ArrayVector{}, field->type()));
+    }
+    m_schema = execute_plan(*m_plan, arrow::Table::Make(m_input->schema(), columns), m_config)
+                   ->schema();
+  }
+
+  [[nodiscard]] std::shared_ptr<arrow::Schema> schema() const override {
+    return m_schema;
+  }
+
+  arrow::Status ReadNext(std::shared_ptr<arrow::RecordBatch> *batch) override {
+    while (true) {
+      if (m_result_reader) {
+        RETURN_NOT_OK(m_result_reader->ReadNext(batch));
+        if (*batch) {
+          return arrow::Status::OK();
+        }
+        m_result_reader = nullptr;
+        m_result = nullptr;
+      }
+
+      std::shared_ptr<arrow::RecordBatch> input;
+      RETURN_NOT_OK(m_input->ReadNext(&input));
+      if (!input) {
+        *batch = nullptr;
+        return arrow::Status::OK();
+      }
+      try {
+        m_result = execute_plan(
+            *m_plan, arrow::Table::Make(input->schema(), input->columns(), input->num_rows()),
+            m_config);
+      } catch (const BaseException &e) {
+        return arrow::Status::ExecutionError(e.what());
+      }
+      // batches without selected rows are not returned
+      if (m_result->num_rows() != 0) {
+        m_result_reader = std::make_unique<arrow::TableBatchReader>(*m_result);
+      }
+    }
+  }
+};
+
+std::shared_ptr<LogicalPlan> QueryCompiler::optimized_plan() const {
+  return optimize_plan(m_plan);
+}
+
+std::shared_ptr<arrow::Table>
+QueryCompiler::execute(const std::shared_ptr<arrow::Table> &table,
+                       std::shared_ptr<const execution::ExecutionConfig> config) const {
+  return execute_plan(*optimized_plan(), table, std::move(config));
+}
+
+std::shared_ptr<arrow::Table>
+QueryCompiler::execute(std::shared_ptr<const execution::ExecutionConfig> config) const {
+  return execute_plan(*optimized_plan(), nullptr, std::move(config));
+}
+
+std::shared_ptr<arrow::RecordBatchReader>
+QueryCompiler::execute(std::shared_ptr<arrow::RecordBatchReader> input,
+                       std::shared_ptr<const execution::ExecutionConfig> config) const {
+  return std::make_shared<StreamingPlanReader>(optimized_plan(), std::move(input),
+                                               std::move(config));
+}
 } // namespace pefa::query_compiler
\ No newline at end of file
@@ -1,9 +1,12 @@
 #pragma once
 #include "expressions.h"
 #include "logical_plan.h"
+#include "pefa/execution/execution_context.h"
 
+#include <arrow/record_batch.h>
 #include <arrow/table.h>
 #include <memory>
+#include <string>
 #include <utility>
 
 namespace pefa::query_compiler {
@@ -13,14 +16,65 @@ private:
 
   explicit QueryCompiler(std::shared_ptr<LogicalPlan> plan);
 
+  [[nodiscard]] std::shared_ptr<LogicalPlan> optimized_plan() const;
+
 public:
   explicit QueryCompiler();
 
+  // query, which reads rows from file instead of table passed to execute
+  [[nodiscard]] static QueryCompiler scan(std::string path, FileFormat format);
+
   [[nodiscard]] QueryCompiler project(const std::vector<std::string> &columns) const;
 
+  // Projection, which computes columns from expressions, like SELECT a * 1.1 AS b. Only numeric
+  // expressions are computed, and result is null if any column, referenced by expression, is null
+  [[nodiscard]] QueryCompiler select(const std::vector<Projection> &projections) const;
+
   [[nodiscard]] QueryCompiler filter(std::shared_ptr<BooleanExpr> expr) const;
 
+  [[nodiscard]] QueryCompiler aggregate(const std::vector<std::string> &keys,
+                                        const std::vector<Aggregate> &aggregates) const;
+
+  // Equi-join with rows of right table, which are produced by right query. Right table is nullptr,
+  // if right query starts with scan. Filters of both sides are consumed by join without
+  // materialization
+  [[nodiscard]] QueryCompiler join(const QueryCompiler &right,
+                                   std::shared_ptr<arrow::Table> right_table,
+                                   const std::string &left_key, const std::string &right_key,
+                                   JoinType type = JoinType::INNER) const;
+
+  [[nodiscard]] QueryCompiler join(std::shared_ptr<arrow::Table> right_table,
+                                   const std::string &left_key, const std::string &right_key,
+                                   JoinType type = JoinType::INNER) const;
+
+  // orders rows by numeric key, rows with null keys go last
+  [[nodiscard]] QueryCompiler sort(const std::string &key, bool ascending = true) const;
+
+  // the first n rows in order of key, like ORDER BY key LIMIT n
+  [[nodiscard]] QueryCompiler top_n(const std::string &key, int64_t n,
+                                    bool ascending = true) const;
+
+  // Columns of input table, which are needed to execute query, so sources may skip reading others.
+  // Empty list means all columns are needed
+  [[nodiscard]] std::vector<std::string> input_columns() const;
+
   [[nodiscard]] std::shared_ptr<arrow::Table>
-  execute(const std::shared_ptr<arrow::Table> &table) const;
+  execute(const std::shared_ptr<arrow::Table> &table,
+          std::shared_ptr<const execution::ExecutionConfig> config =
+              std::make_shared<const execution::ExecutionConfig>()) const;
+
+  // executes query, which starts with scan
+  [[nodiscard]] std::shared_ptr<arrow::Table>
+  execute(std::shared_ptr<const execution::ExecutionConfig> config =
+              std::make_shared<const execution::ExecutionConfig>()) const;
+
+  // Streaming mode: batches are pulled from input one at a time, when result is read, so only
+  // a single input batch and its result are kept in memory. Aggregation and sort need all rows of
+  // input and join would build its right side for every batch, so they are not supported in this
+  // mode
+  [[nodiscard]] std::shared_ptr<arrow::RecordBatchReader>
+  execute(std::shared_ptr<arrow::RecordBatchReader> input,
+          std::shared_ptr<const execution::ExecutionConfig> config =
+              std::make_shared<const execution::ExecutionConfig>()) const;
 };
 } // namespace pefa::query_compiler
\ No newline at end of file
@@ -0,0 +1,23 @@
+#include "bloom_filter.h"
+
+#include <cstring>
+#include <utility>
+
+namespace pefa::utils {
+void BloomFilter::reset(int64_t num_keys) {
+  const int64_t bits_per_key = 16;
+  const int64_t block_bits = block_words * 32;
+  int64_t num_blocks = 1;
+  while (num_blocks * block_bits < num_keys * bits_per_key) {
+    num_blocks *= 2;
+  }
+  auto size = num_blocks * block_words * static_cast<int64_t>(sizeof(uint32_t));
+  if (!m_buffer || num_blocks != m_num_blocks) {
+    // arrow buffers are 64-byte aligned
+    std::shared_ptr<arrow::Buffer> buffer = arrow::AllocateBuffer(size).ValueOrDie();
+    m_buffer = std::move(buffer);
+    m_num_blocks = num_blocks;
+  }
+  std::memset(m_buffer->mutable_data(), 0, size);
+}
+} // namespace pefa::utils
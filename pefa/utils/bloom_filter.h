@@ -0,0 +1,83 @@
+#pragma once
+#include <arrow/buffer.h>
+#include <cstdint>
+#include <memory>
+
+namespace pefa::utils {
+// Blocked Bloom filter over 64-bit keys. Every key sets one bit in each of 8 words of a single
+// 32-byte block, so a probe touches one cache line and is checked by a single vector compare.
+// Filter kernels emit the same hashing in IR, so both should be changed together
+class BloomFilter {
+public:
+  static constexpr int block_words = 8;
+  // odd multipliers, which select bit of every word from lower half of hash
+  static constexpr uint32_t salt[block_words] = {0x47b6137bU, 0x44974d91U, 0x8824ad5bU,
+                                                 0xa2b7289dU, 0x705495c7U, 0x2df1424bU,
+                                                 0x9efc4947U, 0x5c6bfb31U};
+  static constexpr uint64_t hash_multiplier = 0x9e3779b97f4a7c15ULL;
+
+  // filter is not built until reset is called and accepts every key
+  BloomFilter() = default;
+
+  // allocates empty filter with about 16 bits per key, which gives less than 1% false positives
+  void reset(int64_t num_keys);
+
+  void insert(int64_t key) {
+    auto h = hash(key);
+    auto block = mutable_block(h);
+    for (int i = 0; i < block_words; i++) {
+      block[i] |= bit(h, i);
+    }
+  }
+
+  [[nodiscard]] bool may_contain(int64_t key) const {
+    if (!is_built()) {
+      return true;
+    }
+    auto h = hash(key);
+    auto block = data() + block_index(h) * block_words;
+    for (int i = 0; i < block_words; i++) {
+      if ((block[i] & bit(h, i)) == 0) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  [[nodiscard]] bool is_built() const {
+    return m_buffer != nullptr;
+  }
+
+  // power of two
+  [[nodiscard]] int64_t num_blocks() const {
+    return m_num_blocks;
+  }
+
+  // blocks are 32-byte aligned, so they can be loaded as vectors
+  [[nodiscard]] const uint32_t *data() const {
+    return reinterpret_cast<const uint32_t *>(m_buffer->data());
+  }
+
+  // upper half of hash selects block, lower half selects bits in it
+  static uint64_t hash(int64_t key) {
+    auto h = static_cast<uint64_t>(key) * hash_multiplier;
+    return h ^ (h >> 32);
+  }
+
+private:
+  std::shared_ptr<arrow::Buffer> m_buffer;
+  int64_t m_num_blocks = 0;
+
+  [[nodiscard]] int64_t block_index(uint64_t h) const {
+    return static_cast<int64_t>((h >> 32) & static_cast<uint64_t>(m_num_blocks - 1));
+  }
+
+  static uint32_t bit(uint64_t h, int word) {
+    return uint32_t{1} << ((static_cast<uint32_t>(h) * salt[word]) >> 27);
+  }
+
+  uint32_t *mutable_block(uint64_t h) {
+    return reinterpret_cast<uint32_t *>(m_buffer->mutable_data()) + block_index(h) * block_words;
+  }
+};
+} // namespace pefa::utils
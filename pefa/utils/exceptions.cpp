@@ -17,3 +17,9 @@ pefa::KernelNotCompiledException::KernelNotCompiledException()
 
 pefa::UnreachableException::UnreachableException()
     : BaseException("Unreachable branch invoked") {}
+
+pefa::ColumnNotFoundException::ColumnNotFoundException(const std::string &name)
+    : BaseException("Column " + name + " does not exist") {}
+
+pefa::IOException::IOException(std::string msg)
+    : BaseException(std::move(msg)) {}
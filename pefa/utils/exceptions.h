@@ -27,4 +27,14 @@ class UnreachableException : public BaseException {
 public:
   UnreachableException();
 };
+
+class ColumnNotFoundException : public BaseException {
+public:
+  explicit ColumnNotFoundException(const std::string &name);
+};
+
+class IOException : public BaseException {
+public:
+  explicit IOException(std::string msg);
+};
 } // namespace pefa
@@ -0,0 +1,78 @@
+#include "string_match.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string_view>
+
+namespace pefa::utils {
+int32_t compare_bytes(const uint8_t *lhs, int32_t lhs_len, const uint8_t *rhs, int32_t rhs_len) {
+  auto common = std::min(lhs_len, rhs_len);
+  // memcmp compares bytes as unsigned chars
+  int result = common > 0 ? std::memcmp(lhs, rhs, common) : 0;
+  if (result != 0) {
+    return result < 0 ? -1 : 1;
+  }
+  return lhs_len < rhs_len ? -1 : (lhs_len > rhs_len ? 1 : 0);
+}
+
+int32_t contains_bytes(const uint8_t *data, int32_t len, const uint8_t *needle,
+                       int32_t needle_len) {
+  std::string_view haystack(reinterpret_cast<const char *>(data), len);
+  return haystack.find(std::string_view(reinterpret_cast<const char *>(needle), needle_len)) !=
+         std::string_view::npos;
+}
+
+int32_t match_like(const uint8_t *data, int32_t len, const uint8_t *pattern, int32_t pattern_len) {
+  // greedy matching, which returns to the last '%' on mismatch and lets it consume one more byte
+  int32_t i = 0;
+  int32_t p = 0;
+  int32_t star = -1;
+  int32_t mark = 0;
+  while (i < len) {
+    if (p < pattern_len && pattern[p] == '%') {
+      star = p++;
+      mark = i;
+    } else if (p < pattern_len && (pattern[p] == '_' || pattern[p] == data[i])) {
+      i++;
+      p++;
+    } else if (star >= 0) {
+      p = star + 1;
+      i = ++mark;
+    } else {
+      return 0;
+    }
+  }
+  while (p < pattern_len && pattern[p] == '%') {
+    p++;
+  }
+  return p == pattern_len;
+}
+
+LikePattern simplify_like(const std::string &pattern) {
+  if (pattern.find('_') != std::string::npos) {
+    return {LikePattern::Kind::GENERAL, pattern};
+  }
+  auto begin = pattern.find_first_not_of('%');
+  if (begin == std::string::npos) {
+    // only '%', which matches every string
+    return {pattern.empty() ? LikePattern::Kind::EQ : LikePattern::Kind::CONTAINS, ""};
+  }
+  auto end = pattern.find_last_not_of('%') + 1;
+  auto literal = pattern.substr(begin, end - begin);
+  if (literal.find('%') != std::string::npos) {
+    return {LikePattern::Kind::GENERAL, pattern};
+  }
+  bool leading = begin != 0;
+  bool trailing = end != pattern.size();
+  if (leading && trailing) {
+    return {LikePattern::Kind::CONTAINS, literal};
+  }
+  if (leading) {
+    return {LikePattern::Kind::ENDS_WITH, literal};
+  }
+  if (trailing) {
+    return {LikePattern::Kind::STARTS_WITH, literal};
+  }
+  return {LikePattern::Kind::EQ, literal};
+}
+} // namespace pefa::utils
@@ -0,0 +1,35 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+namespace pefa::utils {
+// Byte string routines, which filter kernels call for predicates, that are not inlined into IR.
+// They return int32_t instead of bool, so that generated calls do not depend on ABI of bool
+
+// three-way lexicographic comparison of unsigned bytes, shorter string is less than its extension
+int32_t compare_bytes(const uint8_t *lhs, int32_t lhs_len, const uint8_t *rhs, int32_t rhs_len);
+
+// 1 if needle occurs in data, empty needle occurs everywhere
+int32_t contains_bytes(const uint8_t *data, int32_t len, const uint8_t *needle,
+                       int32_t needle_len);
+
+// 1 if data matches SQL LIKE pattern, where '%' matches any sequence of bytes and '_' matches any
+// single byte. Escaping is not supported
+int32_t match_like(const uint8_t *data, int32_t len, const uint8_t *pattern, int32_t pattern_len);
+
+// LIKE pattern, reduced to the cheapest equivalent match of its literal part, e.g. 'abc%' is
+// STARTS_WITH 'abc'. Patterns with '_' or '%' in the middle stay GENERAL
+struct LikePattern {
+  enum class Kind {
+    EQ,
+    STARTS_WITH,
+    ENDS_WITH,
+    CONTAINS,
+    GENERAL,
+  };
+  Kind kind;
+  std::string literal;
+};
+
+[[nodiscard]] LikePattern simplify_like(const std::string &pattern);
+} // namespace pefa::utils
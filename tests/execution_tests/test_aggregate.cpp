@@ -0,0 +1,234 @@
+#include "../generated_columns.h"
+
+#include <arrow/api.h>
+#include <arrow/testing/gtest_util.h>
+#include <gtest/gtest.h>
+#include <map>
+#include <memory>
+#include <optional>
+#include <pefa/execution/execution.h>
+#include <pefa/execution/thread_pool.h>
+#include <pefa/query_compiler/query_compiler.h>
+#include <tuple>
+
+using namespace pefa::query_compiler;
+using namespace pefa::execution;
+
+class AggregateTest : public ::testing::Test {
+protected:
+  std::shared_ptr<arrow::Table> m_table;
+  static constexpr int64_t m_rows = 200000;
+
+  static int32_t key_a(int64_t i) {
+    return static_cast<int32_t>(i % 7);
+  }
+
+  static std::optional<int16_t> key_b(int64_t i) {
+    return i % 11 == 0 ? std::nullopt : std::optional<int16_t>(i % 3);
+  }
+
+  static std::optional<double> value_c(int64_t i) {
+    return i % 5 == 0 ? std::nullopt : std::optional<double>(static_cast<double>(i % 1000) / 4);
+  }
+
+  static int8_t value_d(int64_t i) {
+    return static_cast<int8_t>(i * 31 % 256 - 128);
+  }
+
+public:
+  void SetUp() override {
+    std::vector<int64_t> chunk_lengths{70000, 5, 0, 129995};
+    auto schema = arrow::schema({arrow::field("A", arrow::int32()),
+                                 arrow::field("B", arrow::int16()),
+                                 arrow::field("C", arrow::float64()),
+                                 arrow::field("D", arrow::int8())});
+    m_table = arrow::Table::Make(schema,
+                                 {generated_column<arrow::Int32Type>(chunk_lengths, key_a),
+                                  generated_column<arrow::Int16Type>(chunk_lengths, key_b),
+                                  generated_column<arrow::DoubleType>(chunk_lengths, value_c),
+                                  generated_column<arrow::Int8Type>(chunk_lengths, value_d)});
+  }
+};
+
+TEST_F(AggregateTest, testGroupByMatchesScalar) {
+  set_num_threads(4);
+  auto query = QueryCompiler()
+                   .filter(col("D")->GE(lit(0)))
+                   .aggregate({"A", "B"}, {{Aggregate::Op::SUM, "C", "sum_c"},
+                                           {Aggregate::Op::COUNT, "C", "count_c"},
+                                           {Aggregate::Op::MIN, "D", "min_d"},
+                                           {Aggregate::Op::MAX, "D", "max_d"},
+                                           {Aggregate::Op::AVG, "D", "avg_d"},
+                                           {Aggregate::Op::SUM, "D", "sum_d"}});
+  auto result = query.execute(m_table);
+
+  // groups are expected in order of their first selected row
+  struct Group {
+    int32_t a;
+    std::optional<int16_t> b;
+    double sum_c = 0;
+    int64_t count_c = 0;
+    int8_t min_d = 127;
+    int8_t max_d = -128;
+    int64_t sum_d = 0;
+    int64_t count_d = 0;
+  };
+  std::vector<Group> groups;
+  std::map<std::tuple<int32_t, bool, int16_t>, size_t> index;
+  for (int64_t i = 0; i < m_rows; i++) {
+    if (value_d(i) < 0) {
+      continue;
+    }
+    auto key = std::make_tuple(key_a(i), key_b(i).has_value(), key_b(i).value_or(0));
+    auto it = index.find(key);
+    if (it == index.end()) {
+      it = index.emplace(key, groups.size()).first;
+      groups.push_back(Group{key_a(i), key_b(i)});
+    }
+    auto &group = groups[it->second];
+    if (value_c(i)) {
+      group.sum_c += *value_c(i);
+      group.count_c++;
+    }
+    group.min_d = std::min(group.min_d, value_d(i));
+    group.max_d = std::max(group.max_d, value_d(i));
+    group.sum_d += value_d(i);
+    group.count_d++;
+  }
+
+  arrow::Int32Builder a_builder;
+  arrow::Int16Builder b_builder;
+  arrow::DoubleBuilder sum_c_builder;
+  arrow::Int64Builder count_c_builder;
+  arrow::Int8Builder min_d_builder;
+  arrow::Int8Builder max_d_builder;
+  arrow::DoubleBuilder avg_d_builder;
+  arrow::Int64Builder sum_d_builder;
+  for (auto &group : groups) {
+    ASSERT_OK(a_builder.Append(group.a));
+    ASSERT_OK(group.b ? b_builder.Append(*group.b) : b_builder.AppendNull());
+    ASSERT_OK(group.count_c ? sum_c_builder.Append(group.sum_c) : sum_c_builder.AppendNull());
+    ASSERT_OK(count_c_builder.Append(group.count_c));
+    ASSERT_OK(min_d_builder.Append(group.min_d));
+    ASSERT_OK(max_d_builder.Append(group.max_d));
+    ASSERT_OK(avg_d_builder.Append(static_cast<double>(group.sum_d) / group.count_d));
+    ASSERT_OK(sum_d_builder.Append(group.sum_d));
+  }
+  std::vector<std::shared_ptr<arrow::Array>> expected_columns(8);
+  ASSERT_OK(a_builder.Finish(&expected_columns[0]));
+  ASSERT_OK(b_builder.Finish(&expected_columns[1]));
+  ASSERT_OK(sum_c_builder.Finish(&expected_columns[2]));
+  ASSERT_OK(count_c_builder.Finish(&expected_columns[3]));
+  ASSERT_OK(min_d_builder.Finish(&expected_columns[4]));
+  ASSERT_OK(max_d_builder.Finish(&expected_columns[5]));
+  ASSERT_OK(avg_d_builder.Finish(&expected_columns[6]));
+  ASSERT_OK(sum_d_builder.Finish(&expected_columns[7]));
+  auto expected_schema = arrow::schema(
+      {arrow::field("A", arrow::int32()), arrow::field("B", arrow::int16()),
+       arrow::field("sum_c", arrow::float64()), arrow::field("count_c", arrow::int64()),
+       arrow::field("min_d", arrow::int8()), arrow::field("max_d", arrow::int8()),
+       arrow::field("avg_d", arrow::float64()), arrow::field("sum_d", arrow::int64())});
+  auto expected = arrow::Table::Make(expected_schema, expected_columns);
+
+  ASSERT_EQ(groups.size(), 7 * 4);
+  AssertTablesEqual(*expected, *result, false);
+}
+
+TEST_F(AggregateTest, testSparseSelectionMatchesBitmap) {
+  auto query =
+      QueryCompiler()
+          .filter(col("D")->EQ(lit(5))->AND(col("A")->LT(lit(3))))
+          .aggregate({"B"}, {{Aggregate::Op::SUM, "C", "sum_c"}, {Aggregate::Op::MAX, "A", "a"}});
+  auto sparse_config = std::make_shared<ExecutionConfig>();
+  sparse_config->selection_vector_ratio = 1;
+  sparse_config->selection_vector_min_rows = 0;
+  auto dense_config = std::make_shared<ExecutionConfig>();
+  dense_config->selection_vector_ratio = 0;
+
+  auto sparse = query.execute(m_table, sparse_config);
+  auto dense = query.execute(m_table, dense_config);
+  ASSERT_GT(dense->num_rows(), 0);
+  AssertTablesEqual(*dense, *sparse, false);
+}
+
+TEST_F(AggregateTest, testGlobalAggregateOfEmptySelection) {
+  auto result = QueryCompiler()
+                    .filter(col("A")->GT(lit(100)))
+                    .aggregate({}, {{Aggregate::Op::COUNT, "C", "count"},
+                                    {Aggregate::Op::SUM, "C", "sum"}})
+                    .execute(m_table);
+  auto expected = arrow::Table::Make(
+      arrow::schema({arrow::field("count", arrow::int64()), arrow::field("sum", arrow::float64())}),
+      {arrow::ArrayFromJSON(arrow::int64(), "[0]"),
+       arrow::ArrayFromJSON(arrow::float64(), "[null]")});
+  AssertTablesEqual(*expected, *result, false);
+}
+
+TEST_F(AggregateTest, testAggregatedColumnsAreInputColumns) {
+  auto query = QueryCompiler()
+                   .filter(col("D")->GE(lit(0)))
+                   .aggregate({"A"}, {{Aggregate::Op::SUM, "C", "sum_c"}})
+                   .filter(col("sum_c")->GT(lit(0.0)));
+  ASSERT_EQ(query.input_columns(), (std::vector<std::string>{"D", "A", "C"}));
+  auto result = query.execute(m_table);
+  ASSERT_EQ(result->num_rows(), 7);
+  ASSERT_EQ(result->num_columns(), 2);
+}
+
+TEST_F(AggregateTest, testFusedReductionMatchesScalar) {
+  set_num_threads(4);
+  auto result = QueryCompiler()
+                    .filter(col("D")->GE(lit(-50)))
+                    .filter(col("A")->NEQ(lit(2)))
+                    .aggregate({}, {{Aggregate::Op::COUNT, "", "count"},
+                                    {Aggregate::Op::COUNT, "C", "count_c"},
+                                    {Aggregate::Op::SUM, "C", "sum_c"},
+                                    {Aggregate::Op::MIN, "D", "min_d"},
+                                    {Aggregate::Op::MAX, "B", "max_b"},
+                                    {Aggregate::Op::AVG, "D", "avg_d"}})
+                    .execute(m_table);
+
+  int64_t count = 0, count_c = 0, sum_d = 0;
+  double sum_c = 0;
+  int8_t min_d = 127;
+  int16_t max_b = -32768;
+  for (int64_t i = 0; i < m_rows; i++) {
+    if (value_d(i) < -50 || key_a(i) == 2) {
+      continue;
+    }
+    count++;
+    if (value_c(i)) {
+      sum_c += *value_c(i);
+      count_c++;
+    }
+    if (key_b(i)) {
+      max_b = std::max(max_b, *key_b(i));
+    }
+    min_d = std::min(min_d, value_d(i));
+    sum_d += value_d(i);
+  }
+  ASSERT_EQ(result->num_rows(), 1);
+  auto value = [&](int i) { return result->column(i)->chunk(0); };
+  ASSERT_EQ(std::static_pointer_cast<arrow::Int64Array>(value(0))->Value(0), count);
+  ASSERT_EQ(std::static_pointer_cast<arrow::Int64Array>(value(1))->Value(0), count_c);
+  ASSERT_DOUBLE_EQ(std::static_pointer_cast<arrow::DoubleArray>(value(2))->Value(0), sum_c);
+  ASSERT_EQ(std::static_pointer_cast<arrow::Int8Array>(value(3))->Value(0), min_d);
+  ASSERT_EQ(std::static_pointer_cast<arrow::Int16Array>(value(4))->Value(0), max_b);
+  ASSERT_DOUBLE_EQ(std::static_pointer_cast<arrow::DoubleArray>(value(5))->Value(0),
+                   static_cast<double>(sum_d) / count);
+}
+
+TEST_F(AggregateTest, testCountOfRowsMatchesHashAggregation) {
+  // filter, which is separated from aggregation by projection, is not folded into it
+  auto fused = QueryCompiler()
+                   .filter(col("B")->EQ(lit(1)))
+                   .aggregate({}, {{Aggregate::Op::COUNT, "", "count"}});
+  auto hashed = QueryCompiler()
+                    .filter(col("B")->EQ(lit(1)))
+                    .project({"A", "B"})
+                    .aggregate({}, {{Aggregate::Op::COUNT, "", "count"}});
+  ASSERT_EQ(fused.input_columns(), std::vector<std::string>{"B"});
+  auto expected = fused.execute(m_table);
+  ASSERT_EQ(expected->num_rows(), 1);
+  AssertTablesEqual(*expected, *hashed.execute(m_table), false);
+}
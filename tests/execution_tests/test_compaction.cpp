@@ -0,0 +1,162 @@
+#include "pefa/execution/compaction.h"
+
+#include <algorithm>
+#include <arrow/util/bit_util.h>
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+using namespace pefa;
+
+class CompactionTest : public ::testing::Test {
+protected:
+  std::mt19937 m_random{42};
+
+  // bitmap with given probability of row selection, which has runs of all-zero and all-one words
+  std::vector<uint8_t> random_bitmap(int64_t length, double probability) {
+    std::vector<uint8_t> bitmap((length + 7) / 8);
+    std::bernoulli_distribution selected(probability);
+    for (size_t byte = 0; byte < bitmap.size(); byte++) {
+      auto word = byte / 8;
+      if (word % 5 == 1) {
+        bitmap[byte] = 0;
+      } else if (word % 5 == 2) {
+        bitmap[byte] = 255;
+      } else {
+        for (int bit = 0; bit < 8; bit++) {
+          bitmap[byte] |= selected(m_random) << (7 - bit);
+        }
+      }
+    }
+    return bitmap;
+  }
+};
+
+TEST_F(CompactionTest, testCompactValuesMatchesScalar) {
+  const int64_t length = 1000;
+  std::vector<int32_t> values(length);
+  for (int64_t i = 0; i < length; i++) {
+    values[i] = static_cast<int32_t>(i * 7);
+  }
+  for (double probability : {0.0, 0.1, 0.5, 0.9, 1.0}) {
+    auto bitmap = random_bitmap(length, probability);
+    for (int64_t offset : {0, 3, 8, 61}) {
+      auto rows = length - offset - 5;
+      std::vector<int32_t> expected;
+      for (int64_t i = 0; i < rows; i++) {
+        if (execution::is_selected(bitmap.data(), offset + i)) {
+          expected.push_back(values[i]);
+        }
+      }
+      // values after the output should stay untouched
+      std::vector<int32_t> out(expected.size() + 8, -1);
+      auto count = execution::compact_values(values.data(), bitmap.data(), offset, rows,
+                                             out.data(), expected.size());
+      ASSERT_EQ(std::vector<int32_t>(8, -1), std::vector<int32_t>(out.begin() + count, out.end()));
+      out.resize(count);
+      ASSERT_EQ(expected, out) << "offset " << offset << ", probability " << probability;
+      ASSERT_EQ(count, execution::count_selected(bitmap.data(), offset, rows));
+    }
+  }
+}
+
+TEST_F(CompactionTest, testCompactValidityMatchesScalar) {
+  const int64_t length = 1000;
+  auto validity = random_bitmap(length + 8, 0.7);
+  for (double probability : {0.1, 0.5, 1.0}) {
+    auto bitmap = random_bitmap(length, probability);
+    for (int64_t offset : {0, 5, 64}) {
+      auto rows = length - offset;
+      std::vector<bool> expected;
+      for (int64_t i = 0; i < rows; i++) {
+        if (execution::is_selected(bitmap.data(), offset + i)) {
+          expected.push_back(arrow::BitUtil::GetBit(validity.data(), 3 + i));
+        }
+      }
+      // output starts in the middle of a byte, as it happens for the second chunk of a column
+      std::vector<uint8_t> out((rows + 16) / 8);
+      auto count = execution::compact_validity(validity.data(), 3, bitmap.data(), offset, rows,
+                                               out.data(), 5);
+      ASSERT_EQ(count, static_cast<int64_t>(expected.size()));
+      for (int64_t i = 0; i < count; i++) {
+        ASSERT_EQ(expected[i], arrow::BitUtil::GetBit(out.data(), 5 + i)) << "at position " << i;
+      }
+    }
+  }
+}
+
+TEST_F(CompactionTest, testFindSelectedMatchesScalar) {
+  const int64_t length = 1000;
+  for (double probability : {0.0, 0.01, 0.5}) {
+    auto bitmap = random_bitmap(length, probability);
+    for (int64_t offset : {0, 3, 64, 130}) {
+      for (int64_t rows : {int64_t(0), int64_t(5), length - offset}) {
+        int64_t first = offset + rows;
+        int64_t last = offset - 1;
+        for (int64_t i = offset; i < offset + rows; i++) {
+          if (execution::is_selected(bitmap.data(), i)) {
+            first = std::min(first, i);
+            last = i;
+          }
+        }
+        ASSERT_EQ(first, execution::find_first_selected(bitmap.data(), offset, rows));
+        ASSERT_EQ(last, execution::find_last_selected(bitmap.data(), offset, rows));
+      }
+    }
+  }
+}
+
+TEST_F(CompactionTest, testSelectedRowIdsMatchesScalar) {
+  const int64_t length = 1000;
+  for (double probability : {0.0, 0.01, 0.5}) {
+    auto bitmap = random_bitmap(length, probability);
+    for (int64_t offset : {0, 3, 64}) {
+      std::vector<uint32_t> expected;
+      for (int64_t i = offset; i < length; i++) {
+        if (execution::is_selected(bitmap.data(), i)) {
+          expected.push_back(static_cast<uint32_t>(i));
+        }
+      }
+      std::vector<uint32_t> ids(length);
+      auto count = execution::selected_row_ids(bitmap.data(), offset, length - offset, ids.data());
+      ids.resize(count);
+      ASSERT_EQ(expected, ids);
+
+      // ids are filtered by bitmap of their positions
+      auto filter = random_bitmap(count, 0.5);
+      std::vector<uint32_t> retained;
+      for (int64_t i = 0; i < count; i++) {
+        if (execution::is_selected(filter.data(), i)) {
+          retained.push_back(ids[i]);
+        }
+      }
+      ids.resize(execution::retain_selected_ids(ids.data(), count, filter.data()));
+      ASSERT_EQ(retained, ids);
+    }
+  }
+}
+
+TEST_F(CompactionTest, testGatherMatchesScalar) {
+  const int64_t length = 1000;
+  std::vector<int64_t> values(length);
+  for (int64_t i = 0; i < length; i++) {
+    values[i] = i * 3;
+  }
+  auto validity = random_bitmap(length + 8, 0.7);
+  std::vector<uint64_t> ids;
+  for (uint64_t row = 100; row < length; row += 1 + row % 7) {
+    ids.push_back(row);
+  }
+  // values and validity start from row 100, validity has an offset of 3 bits
+  std::vector<int64_t> out(ids.size());
+  execution::gather_values(values.data() + 100, 100, ids.data(), ids.size(), out.data());
+  std::vector<uint8_t> out_validity((ids.size() + 16) / 8);
+  execution::gather_validity(validity.data(), 3, 100, ids.data(), ids.size(),
+                             out_validity.data(), 5);
+  for (size_t i = 0; i < ids.size(); i++) {
+    ASSERT_EQ(values[ids[i]], out[i]);
+    ASSERT_EQ(arrow::BitUtil::GetBit(validity.data(), 3 + ids[i] - 100),
+              arrow::BitUtil::GetBit(out_validity.data(), 5 + i))
+        << "at position " << i;
+  }
+}
@@ -1,11 +1,20 @@
 #include "../utils.h"
 
 #include <arrow/api.h>
+#include <arrow/io/api.h>
+#include <arrow/ipc/api.h>
 #include <arrow/testing/gtest_util.h>
 #include <arrow/testing/random.h>
+#include <filesystem>
 #include <gtest/gtest.h>
 #include <memory>
 #include <pefa/execution/execution.h>
+#include <pefa/execution/thread_pool.h>
+#include <parquet/arrow/writer.h>
+#include <pefa/io/file_scan.h>
+#include <pefa/io/ipc_source.h>
+#include <pefa/query_compiler/lp_optimizer/in_list_pass.h>
+#include <pefa/query_compiler/lp_optimizer/scan_pushdown_pass.h>
 #include <pefa/query_compiler/query_compiler.h>
 
 class FilterExecutorTest : public ::testing::Test {
@@ -95,6 +104,502 @@ TEST_F(FilterExecutorTest, testFilterBitmapGeneration) {
   }
 }
 
+TEST_F(FilterExecutorTest, testFilterBitmapManySmallChunks) {
+  using namespace pefa::query_compiler;
+  pefa::execution::set_num_threads(4);
+
+  // chunks of different sizes, including ones which lie inside a single bitmap byte
+  std::vector<std::string> chunks;
+  std::vector<int32_t> values;
+  for (int chunk_len : {3, 2, 1, 13, 7, 64, 5, 1, 1, 30, 100, 4}) {
+    std::string json = "[";
+    for (int i = 0; i < chunk_len; i++) {
+      values.push_back((values.size() * 7) % 23);
+      json += (i ? "," : "") + std::to_string(values.back());
+    }
+    chunks.push_back(json + "]");
+  }
+  auto schema = std::make_shared<arrow::Schema>(std::vector<std::shared_ptr<arrow::Field>>{
+      std::make_shared<arrow::Field>("A", arrow::int32())});
+  auto table = arrow::Table::Make(schema, {arrow::ChunkedArrayFromJSON(arrow::int32(), chunks)});
+
+  auto ctx = std::make_shared<pefa::execution::ExecutionContext>(table);
+  ctx = pefa::execution::generate_filter_bitmap(ctx, col("A")->LT(lit(9)));
+  auto bitmap = ctx->metadata->filter_bitmap->data();
+  for (size_t i = 0; i < values.size(); i++) {
+    ASSERT_EQ(values[i] < 9, (bitmap[i / 8] >> (7 - i % 8)) & 1) << "at position " << i;
+  }
+}
+
+TEST_F(FilterExecutorTest, testShortCircuitMatchesFused) {
+  using namespace pefa::query_compiler;
+  using namespace pefa::execution;
+  auto short_circuit = std::make_shared<ExecutionConfig>();
+  short_circuit->filter_strategy = FilterStrategy::SHORT_CIRCUIT;
+
+  std::vector<std::shared_ptr<BooleanExpr>> exprs{
+      col("A")->GE(lit(10))->AND(col("B")->LE(lit(7)))->AND(col("C")->GE(lit(5.0))),
+      col("A")->EQ(lit(3))->OR(col("B")->GT(lit(5)))->OR(col("C")->LT(lit(10.0))),
+      col("A")->GE(lit(10))->AND(col("B")->EQ(lit(2))->OR(col("C")->GT(lit(300.0)))),
+      col("A")->LT(lit(5))->OR(col("B")->NEQ(lit(2))->AND(col("C")->LE(lit(50.0)))),
+  };
+  for (auto &expr : exprs) {
+    auto fused = generate_filter_bitmap(std::make_shared<ExecutionContext>(m_table), expr);
+    auto res = generate_filter_bitmap(std::make_shared<ExecutionContext>(m_table, short_circuit),
+                                      expr);
+    auto expected = fused->metadata->filter_bitmap->data();
+    auto actual = res->metadata->filter_bitmap->data();
+    for (int64_t i = 0; i < m_table->num_rows(); i++) {
+      ASSERT_EQ((expected[i / 8] >> (7 - i % 8)) & 1, (actual[i / 8] >> (7 - i % 8)) & 1)
+          << "at position " << i;
+    }
+  }
+}
+
+TEST_F(FilterExecutorTest, testLateMaterialization) {
+  using namespace pefa::query_compiler;
+  using namespace pefa::execution;
+  auto ctx = std::make_shared<ExecutionContext>(m_table);
+  ctx = generate_filter_bitmap(ctx, col("A")->GE(lit(10)));
+  ctx = project(ctx, {"A", "C"});
+  ASSERT_NE(ctx->metadata->filter_bitmap, nullptr);
+  ctx = generate_filter_bitmap(ctx, col("C")->GE(lit(40.0)));
+
+  std::vector<bool> expected;
+  for (auto &chunk : m_table->column(0)->chunks()) {
+    auto array = std::static_pointer_cast<arrow::Int32Array>(chunk);
+    for (int64_t i = 0; i < array->length(); i++) {
+      expected.push_back(array->Value(i) >= 10);
+    }
+  }
+  int64_t offset = 0;
+  for (auto &chunk : m_table->column(2)->chunks()) {
+    auto array = std::static_pointer_cast<arrow::DoubleArray>(chunk);
+    for (int64_t i = 0; i < array->length(); i++, offset++) {
+      expected[offset] = expected[offset] && array->Value(i) >= 40.0;
+    }
+  }
+
+  auto bitmap = ctx->metadata->filter_bitmap->data();
+  for (int64_t i = 0; i < m_table->num_rows(); i++) {
+    ASSERT_EQ(expected[i], (bitmap[i / 8] >> (7 - i % 8)) & 1) << "at position " << i;
+  }
+
+  QueryCompiler qc;
+  auto result = qc.filter(col("A")->GE(lit(10)))
+                    .project({"A", "C"})
+                    .filter(col("C")->GE(lit(40.0)))
+                    .execute(m_table);
+  auto materialized = materialize_filter(ctx)->table;
+  ASSERT_EQ(result->num_columns(), 2);
+  ASSERT_TRUE(result->Equals(*materialized));
+}
+
+TEST(FilterZoneMapsTest, testZoneMapsMatchKernel) {
+  using namespace pefa::query_compiler;
+  using namespace pefa::execution;
+  auto schema = std::make_shared<arrow::Schema>(std::vector<std::shared_ptr<arrow::Field>>{
+      std::make_shared<arrow::Field>("A", arrow::int32()),
+      std::make_shared<arrow::Field>("B", arrow::float64())});
+  auto table = arrow::Table::Make(
+      schema, {arrow::ChunkedArrayFromJSON(
+                   arrow::int32(), {"[1,2,3,4,5,6,7,8,9,10]", "[11,12,13,14,15,16,17,18,19,20,21]",
+                                    "[22,23,24,25,26]", "[27,28,29,30,31,32,33,34]"}),
+               arrow::ChunkedArrayFromJSON(
+                   arrow::float64(), {"[0.5,1.5,2.5,3.5,4.5,5.5,6.5,7.5,8.5,9.5,10.5,11.5,12.5]",
+                                      "[1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1]"})});
+  auto no_zone_maps = std::make_shared<ExecutionConfig>();
+  no_zone_maps->use_zone_maps = false;
+
+  std::vector<std::shared_ptr<BooleanExpr>> exprs{
+      col("A")->LT(lit(12)),
+      col("A")->GE(lit(22))->AND(col("A")->LE(lit(26))),
+      col("A")->EQ(lit(40))->OR(col("B")->EQ(lit(1))),
+      col("B")->NEQ(lit(1.0))->AND(col("A")->GT(lit(5))),
+      col("A")->GT(lit(100))->OR(col("A")->LT(lit(-100))),
+  };
+  for (auto &expr : exprs) {
+    auto ctx = std::make_shared<ExecutionContext>(table);
+    auto res = generate_filter_bitmap(ctx, expr);
+    auto fused = generate_filter_bitmap(std::make_shared<ExecutionContext>(table, no_zone_maps),
+                                        expr);
+    auto expected = fused->metadata->filter_bitmap->data();
+    auto actual = res->metadata->filter_bitmap->data();
+    for (int64_t i = 0; i < table->num_rows(); i++) {
+      ASSERT_EQ((expected[i / 8] >> (7 - i % 8)) & 1, (actual[i / 8] >> (7 - i % 8)) & 1)
+          << "at position " << i;
+    }
+  }
+
+  // statistics are computed by the filter and shared with resulting context
+  auto ctx = generate_filter_bitmap(std::make_shared<ExecutionContext>(table),
+                                    col("A")->LT(lit(12)));
+  auto &chunk = dynamic_cast<TypedChunkMetadata<int32_t> &>(*ctx->metadata->columns[0]->chunks[1]);
+  ASSERT_EQ(chunk.min, 11);
+  ASSERT_EQ(chunk.max, 21);
+  ASSERT_EQ(chunk.value_count, 11);
+}
+
+TEST(FilterNullsTest, testNullsAreFilteredOutAndKept) {
+  using namespace pefa::query_compiler;
+  auto schema = std::make_shared<arrow::Schema>(std::vector<std::shared_ptr<arrow::Field>>{
+      std::make_shared<arrow::Field>("A", arrow::int32()),
+      std::make_shared<arrow::Field>("B", arrow::float64())});
+  auto table = arrow::Table::Make(
+      schema,
+      {arrow::ChunkedArrayFromJSON(arrow::int32(), {"[1, null, 3, 4, null]", "[6, 7, null, 9]"}),
+       arrow::ChunkedArrayFromJSON(arrow::float64(),
+                                   {"[1.0, 2.0, null, 4.0]", "[null, 6.0, 7.0, 8.0, null]"})});
+
+  QueryCompiler qc;
+  auto result =
+      qc.filter(col("A")->GT(lit(2))->OR(col("B")->LT(lit(3.0)))).execute(table)->CombineChunks();
+  ASSERT_TRUE(result.ok());
+  auto expected = arrow::Table::Make(
+      schema, {arrow::ChunkedArrayFromJSON(arrow::int32(), {"[1, null, 3, 4, 6, 7, 9]"}),
+               arrow::ChunkedArrayFromJSON(arrow::float64(),
+                                           {"[1.0, 2.0, null, 4.0, 6.0, 7.0, null]"})});
+  AssertTablesEqual(*expected, **result);
+}
+
+TEST(FilterStringsTest, testStringPredicatesAndMaterialization) {
+  using namespace pefa::query_compiler;
+  auto schema = arrow::schema(
+      {arrow::field("payment", arrow::utf8()), arrow::field("fare", arrow::float64())});
+  auto table = arrow::Table::Make(
+      schema,
+      {arrow::ChunkedArrayFromJSON(
+           arrow::utf8(),
+           {R"(["Cash", "Credit Card", null, "No Charge", "Cash", "Dispute"])",
+            R"(["Credit Card", "Cashless", null, "Cash", "Unknown", "Prcard", "Credit"])"}),
+       arrow::ChunkedArrayFromJSON(arrow::float64(), {"[1, 2, 3, 4, 5, 6]",
+                                                      "[7, 8, 9, 10, 11, 12, 13]"})});
+  auto expected = arrow::Table::Make(
+      schema,
+      {arrow::ChunkedArrayFromJSON(
+           arrow::utf8(), {R"(["Cash", "Credit Card", "Cash", "Credit Card", "Cash", "Credit"])"}),
+       arrow::ChunkedArrayFromJSON(arrow::float64(), {"[1, 2, 5, 7, 10, 13]"})});
+
+  auto query = QueryCompiler().filter(
+      col("payment")->STARTS_WITH("Cred")->OR(col("payment")->EQ(lit(std::string("Cash")))));
+  auto sparse_config = std::make_shared<pefa::execution::ExecutionConfig>();
+  sparse_config->selection_vector_ratio = 1;
+  sparse_config->selection_vector_min_rows = 0;
+  for (auto &config : {std::make_shared<pefa::execution::ExecutionConfig>(), sparse_config}) {
+    AssertTablesEqual(*expected, *query.execute(table, config), false);
+  }
+
+  // reduction kernel does not read strings, so aggregation filters rows by bitmap first
+  auto count = QueryCompiler()
+                   .filter(col("payment")->LIKE("%a%"))
+                   .aggregate({}, {{Aggregate::Op::COUNT, "fare", "count"}})
+                   .execute(table);
+  ASSERT_EQ(std::static_pointer_cast<arrow::Int64Array>(count->column(0)->chunk(0))->Value(0), 8);
+}
+
+TEST(FilterDictionaryTest, testDictionaryPredicatesKeepEncoding) {
+  using namespace pefa::query_compiler;
+  auto type = arrow::dictionary(arrow::int8(), arrow::utf8());
+  auto schema =
+      arrow::schema({arrow::field("payment", type), arrow::field("fare", arrow::float64())});
+  // chunks have different dictionaries, and taken codes keep dictionary of their chunk
+  const std::string first = R"(["Cash", "Credit Card", "No Charge"])";
+  const std::string second = R"(["Dispute", "Cash", "Credit"])";
+  auto table = arrow::Table::Make(
+      schema, {std::make_shared<arrow::ChunkedArray>(arrow::ArrayVector{
+                   arrow::DictArrayFromJSON(type, "[0, 1, null, 2, 0]", first),
+                   arrow::DictArrayFromJSON(type, "[1, 0, null, 2, 1]", second)}),
+               arrow::ChunkedArrayFromJSON(arrow::float64(), {"[1, 2, 3, 4, 5]",
+                                                              "[6, 7, 8, 9, 10]"})});
+  auto expected = arrow::Table::Make(
+      schema, {std::make_shared<arrow::ChunkedArray>(
+                   arrow::ArrayVector{arrow::DictArrayFromJSON(type, "[0, 1, 0]", first),
+                                      arrow::DictArrayFromJSON(type, "[1, 2, 1]", second)}),
+               arrow::ChunkedArrayFromJSON(arrow::float64(), {"[1, 2, 5]", "[6, 9, 10]"})});
+
+  auto query = QueryCompiler().filter(
+      col("payment")->EQ(lit(std::string("Cash")))->OR(col("payment")->STARTS_WITH("Cred")));
+  auto sparse_config = std::make_shared<pefa::execution::ExecutionConfig>();
+  sparse_config->selection_vector_ratio = 1;
+  sparse_config->selection_vector_min_rows = 0;
+  for (auto &config : {std::make_shared<pefa::execution::ExecutionConfig>(), sparse_config}) {
+    AssertTablesEqual(*expected, *query.execute(table, config), false);
+  }
+
+  auto count = QueryCompiler()
+                   .filter(col("payment")->LIKE("%a%"))
+                   .aggregate({}, {{Aggregate::Op::COUNT, "fare", "count"}})
+                   .execute(table);
+  ASSERT_EQ(std::static_pointer_cast<arrow::Int64Array>(count->column(0)->chunk(0))->Value(0), 6);
+}
+
+TEST(FilterArithmeticTest, testArithmeticPredicatesAreFused) {
+  using namespace pefa::query_compiler;
+  auto schema = arrow::schema({arrow::field("fare", arrow::float64()),
+                               arrow::field("tips", arrow::float32()),
+                               arrow::field("tolls", arrow::int32())});
+  auto table = arrow::Table::Make(
+      schema, {arrow::ChunkedArrayFromJSON(arrow::float64(), {"[1, 2, 3, null]", "[5, 6, 7]"}),
+               arrow::ChunkedArrayFromJSON(arrow::float32(), {"[1.5, 0, 2, 1]", "[null, 1, 0]"}),
+               arrow::ChunkedArrayFromJSON(arrow::int32(), {"[1, 2, 1, 0]", "[0, 4, 3]"})});
+  auto expected = arrow::Table::Make(
+      schema, {arrow::ChunkedArrayFromJSON(arrow::float64(), {"[1, 3]", "[7]"}),
+               arrow::ChunkedArrayFromJSON(arrow::float32(), {"[1.5, 2]", "[0]"}),
+               arrow::ChunkedArrayFromJSON(arrow::int32(), {"[1, 1]", "[3]"})});
+
+  // rows with null in any referenced column are filtered out
+  auto predicate = col("fare")->ADD(col("tips"))->GT(lit(2)->MUL(col("tolls")));
+  auto query = QueryCompiler().filter(predicate);
+  auto sparse_config = std::make_shared<pefa::execution::ExecutionConfig>();
+  sparse_config->selection_vector_ratio = 1;
+  sparse_config->selection_vector_min_rows = 0;
+  for (auto &config : {std::make_shared<pefa::execution::ExecutionConfig>(), sparse_config}) {
+    AssertTablesEqual(*expected, *query.execute(table, config), false);
+  }
+
+  auto count = QueryCompiler()
+                   .filter(predicate->OR(col("tolls")->CAST(arrow::float64())->GE(col("fare"))))
+                   .aggregate({}, {{Aggregate::Op::COUNT, "tolls", "count"}})
+                   .execute(table);
+  ASSERT_EQ(std::static_pointer_cast<arrow::Int64Array>(count->column(0)->chunk(0))->Value(0), 4);
+}
+
+TEST(FilterInListTest, testEqualityChainsAreRewrittenIntoLists) {
+  using namespace pefa::query_compiler;
+  // lists inside of AND are merged too, while other operands keep their places
+  auto chain = col("x")
+                   ->EQ(lit(1))
+                   ->OR(col("s")->EQ(lit(std::string("b"))))
+                   ->OR(col("x")->EQ(lit(3)))
+                   ->OR(col("x")->IN({5, 7}))
+                   ->OR(col("y")->EQ(lit(2)));
+  std::shared_ptr<LogicalPlan> plan =
+      std::make_shared<FilterNode>(nullptr, col("y")->GT(lit(0))->AND(chain));
+  auto optimized = std::dynamic_pointer_cast<FilterNode>(InListPass().execute(plan));
+  ASSERT_NE(optimized, nullptr);
+  auto conjunction = std::dynamic_pointer_cast<const PredicateExpr>(optimized->expr);
+  ASSERT_NE(conjunction, nullptr);
+  // merged list takes place of the first comparison of its column: (x IN (...) OR s = b) OR y = 2
+  auto outer = std::dynamic_pointer_cast<const PredicateExpr>(conjunction->rhs);
+  ASSERT_NE(outer, nullptr);
+  auto inner = std::dynamic_pointer_cast<const PredicateExpr>(outer->lhs);
+  ASSERT_NE(inner, nullptr);
+  ASSERT_EQ(inner->op, PredicateExpr::Op::OR);
+  auto in = std::dynamic_pointer_cast<const InExpr>(inner->lhs);
+  ASSERT_NE(in, nullptr);
+  ASSERT_EQ(in->column->name, "x");
+  ASSERT_EQ(in->values, (std::vector<std::variant<int, double, std::string, bool>>{1, 3, 5, 7}));
+  ASSERT_NE(std::dynamic_pointer_cast<const CompareExpr>(inner->rhs), nullptr);
+  ASSERT_NE(std::dynamic_pointer_cast<const CompareExpr>(outer->rhs), nullptr);
+
+  // single comparison of column is left as it is
+  auto single = col("x")->EQ(lit(1))->OR(col("y")->EQ(lit(2)));
+  plan = std::make_shared<FilterNode>(nullptr, single);
+  optimized = std::dynamic_pointer_cast<FilterNode>(InListPass().execute(plan));
+  ASSERT_EQ(optimized->expr, single);
+}
+
+TEST(FilterInListTest, testListsAndRangesMatchComparisons) {
+  using namespace pefa::query_compiler;
+  auto type = arrow::dictionary(arrow::int8(), arrow::utf8());
+  auto schema = arrow::schema({arrow::field("x", arrow::int32()), arrow::field("s", type)});
+  const std::string dictionary = R"(["a", "b", "c"])";
+  auto table = arrow::Table::Make(
+      schema, {arrow::ChunkedArrayFromJSON(arrow::int32(), {"[1, 2, 3, null, 5]", "[6, 7, 1, 9]"}),
+               std::make_shared<arrow::ChunkedArray>(arrow::ArrayVector{
+                   arrow::DictArrayFromJSON(type, "[0, 1, 2, 0, null]", dictionary),
+                   arrow::DictArrayFromJSON(type, "[2, 1, 0, 1]", dictionary)})});
+  auto count = [&](const std::shared_ptr<BooleanExpr> &predicate) {
+    auto result = QueryCompiler()
+                      .filter(predicate)
+                      .aggregate({}, {{Aggregate::Op::COUNT, "x", "count"}})
+                      .execute(table);
+    return std::static_pointer_cast<arrow::Int64Array>(result->column(0)->chunk(0))->Value(0);
+  };
+  // x of 1, 2 or 5 or s of "b"
+  auto chain = col("x")
+                   ->EQ(lit(1))
+                   ->OR(col("s")->EQ(lit(std::string("b"))))
+                   ->OR(col("x")->EQ(lit(5)))
+                   ->OR(col("x")->EQ(lit(2)));
+  ASSERT_EQ(count(chain), 6);
+  ASSERT_EQ(count(col("x")->IN({1, 2, 5})->OR(col("s")->IN({std::string("b")}))), 6);
+  ASSERT_EQ(count(col("x")->BETWEEN(2, 6)), 4);
+  ASSERT_EQ(count(col("s")->BETWEEN(std::string("b"), std::string("c"))), 5);
+
+  auto expected = arrow::Table::Make(
+      schema, {arrow::ChunkedArrayFromJSON(arrow::int32(), {"[1, 2, 5]", "[7, 1, 9]"}),
+               std::make_shared<arrow::ChunkedArray>(
+                   arrow::ArrayVector{arrow::DictArrayFromJSON(type, "[0, 1, null]", dictionary),
+                                      arrow::DictArrayFromJSON(type, "[1, 0, 1]", dictionary)})});
+  auto result = QueryCompiler().filter(chain).execute(table);
+  AssertTablesEqual(*expected, *result, false);
+}
+
+TEST(FilterMaterializeTest, testParallelMaterializationKeepsOrder) {
+  using namespace pefa::query_compiler;
+  pefa::execution::set_num_threads(4);
+  const int64_t length = 200003;
+  const int64_t input_chunk = 30011;
+  std::vector<std::shared_ptr<arrow::Array>> a_chunks;
+  std::vector<std::shared_ptr<arrow::Array>> b_chunks;
+  for (int64_t begin = 0; begin < length; begin += input_chunk) {
+    arrow::Int64Builder a_builder;
+    arrow::Int64Builder b_builder;
+    for (int64_t i = begin; i < std::min(begin + input_chunk, length); i++) {
+      ASSERT_OK(a_builder.Append(i));
+      ASSERT_OK(b_builder.Append(i % 3));
+    }
+    std::shared_ptr<arrow::Array> chunk;
+    ASSERT_OK(a_builder.Finish(&chunk));
+    a_chunks.push_back(chunk);
+    ASSERT_OK(b_builder.Finish(&chunk));
+    b_chunks.push_back(chunk);
+  }
+  auto schema = std::make_shared<arrow::Schema>(std::vector<std::shared_ptr<arrow::Field>>{
+      std::make_shared<arrow::Field>("A", arrow::int64()),
+      std::make_shared<arrow::Field>("B", arrow::int64())});
+  auto table = arrow::Table::Make(schema, {std::make_shared<arrow::ChunkedArray>(a_chunks),
+                                           std::make_shared<arrow::ChunkedArray>(b_chunks)});
+
+  QueryCompiler qc;
+  auto result = qc.filter(col("B")->NEQ(lit(0))->AND(col("A")->LT(lit(70000)))->OR(
+                              col("A")->GT(lit(190000))))
+                    .execute(table);
+  auto &column = *result->column(0);
+  std::vector<int64_t> expected;
+  for (int64_t i = 0; i < length; i++) {
+    if ((i % 3 != 0 && i < 70000) || i > 190000) {
+      expected.push_back(i);
+    }
+  }
+  ASSERT_EQ(column.length(), expected.size());
+  int64_t pos = 0;
+  for (int chunk_num = 0; chunk_num < column.num_chunks(); chunk_num++) {
+    auto chunk = std::static_pointer_cast<arrow::Int64Array>(column.chunk(chunk_num));
+    for (int64_t i = 0; i < chunk->length(); i++, pos++) {
+      ASSERT_EQ(chunk->Value(i), expected[pos]);
+    }
+  }
+
+  // compacted rows are split into chunks, which do not depend on scheduling
+  for (int chunk_num = 0; chunk_num + 2 < column.num_chunks(); chunk_num++) {
+    ASSERT_EQ(column.chunk(chunk_num)->length(), 2 << 13);
+  }
+  // contiguous run of the last input chunk is not copied
+  ASSERT_EQ(column.chunk(column.num_chunks() - 1)->data()->buffers[1],
+            a_chunks.back()->data()->buffers[1]);
+}
+
+TEST(FilterMaterializeTest, testValidityOfNeighbourChunksIsKept) {
+  using namespace pefa::query_compiler;
+  pefa::execution::set_num_threads(4);
+  // every chunk is compacted and selects a number of rows, which is not a multiple of 8, so
+  // neighbour chunks share output validity bytes
+  const int64_t num_chunks = 64;
+  const int64_t input_chunk = 1001;
+  std::vector<std::shared_ptr<arrow::Array>> a_chunks;
+  std::vector<std::shared_ptr<arrow::Array>> b_chunks;
+  arrow::Int32Builder expected_builder;
+  for (int64_t begin = 0; begin < num_chunks * input_chunk; begin += input_chunk) {
+    arrow::Int32Builder a_builder;
+    arrow::Int32Builder b_builder;
+    for (int64_t i = begin; i < begin + input_chunk; i++) {
+      auto value = static_cast<int32_t>(i);
+      ASSERT_OK(i % 7 == 0 ? a_builder.AppendNull() : a_builder.Append(value));
+      ASSERT_OK(b_builder.Append(value % 3));
+      if (i % 3 != 0) {
+        ASSERT_OK(i % 7 == 0 ? expected_builder.AppendNull() : expected_builder.Append(value));
+      }
+    }
+    std::shared_ptr<arrow::Array> chunk;
+    ASSERT_OK(a_builder.Finish(&chunk));
+    a_chunks.push_back(chunk);
+    ASSERT_OK(b_builder.Finish(&chunk));
+    b_chunks.push_back(chunk);
+  }
+  std::shared_ptr<arrow::Array> expected;
+  ASSERT_OK(expected_builder.Finish(&expected));
+  auto schema =
+      arrow::schema({arrow::field("A", arrow::int32()), arrow::field("B", arrow::int32())});
+  auto table = arrow::Table::Make(schema, {std::make_shared<arrow::ChunkedArray>(a_chunks),
+                                           std::make_shared<arrow::ChunkedArray>(b_chunks)});
+
+  // lost bits depend on scheduling, so materialization is repeated
+  for (int attempt = 0; attempt < 20; attempt++) {
+    auto result = QueryCompiler().filter(col("B")->NEQ(lit(0))).execute(table);
+    ASSERT_TRUE(result->column(0)->Equals(arrow::ChunkedArray({expected})));
+  }
+}
+
+TEST(FilterMaterializeTest, testAllSelectedIsZeroCopy) {
+  using namespace pefa::query_compiler;
+  auto schema = std::make_shared<arrow::Schema>(std::vector<std::shared_ptr<arrow::Field>>{
+      std::make_shared<arrow::Field>("A", arrow::int32())});
+  auto column =
+      arrow::ChunkedArrayFromJSON(arrow::int32(), {"[1, 2, 3]", "[4, 5, 6, 7, 8, 9, 10]"});
+  auto table = arrow::Table::Make(schema, {column});
+
+  QueryCompiler qc;
+  auto result = qc.filter(col("A")->GT(lit(1))).execute(table)->column(0);
+  ASSERT_EQ(result->num_chunks(), 2);
+  ASSERT_ARRAYS_EQUAL(*result->chunk(0), *arrow::ArrayFromJSON(arrow::int32(), "[2, 3]"));
+  ASSERT_EQ(result->chunk(0)->data()->buffers[1], column->chunk(0)->data()->buffers[1]);
+  ASSERT_EQ(result->chunk(1), column->chunk(1));
+}
+
+TEST(FilterSelectionVectorTest, testSparseSelectionMatchesBitmap) {
+  using namespace pefa::query_compiler;
+  using namespace pefa::execution;
+  pefa::execution::set_num_threads(4);
+  std::vector<std::shared_ptr<arrow::Array>> a_chunks;
+  std::vector<std::shared_ptr<arrow::Array>> b_chunks;
+  int64_t length = 0;
+  for (int64_t chunk_length : {100000, 3, 50000, 150000}) {
+    arrow::Int32Builder a_builder;
+    arrow::Int64Builder b_builder;
+    for (int64_t i = length; i < length + chunk_length; i++) {
+      ASSERT_OK(a_builder.Append(static_cast<int32_t>(i)));
+      ASSERT_OK(i % 13 == 0 ? b_builder.AppendNull() : b_builder.Append(i * 7 % 1000));
+    }
+    std::shared_ptr<arrow::Array> chunk;
+    ASSERT_OK(a_builder.Finish(&chunk));
+    a_chunks.push_back(chunk);
+    ASSERT_OK(b_builder.Finish(&chunk));
+    b_chunks.push_back(chunk);
+    length += chunk_length;
+  }
+  auto schema = std::make_shared<arrow::Schema>(std::vector<std::shared_ptr<arrow::Field>>{
+      std::make_shared<arrow::Field>("A", arrow::int32()),
+      std::make_shared<arrow::Field>("B", arrow::int64())});
+  auto table = arrow::Table::Make(schema, {std::make_shared<arrow::ChunkedArray>(a_chunks),
+                                           std::make_shared<arrow::ChunkedArray>(b_chunks)});
+
+  auto first =
+      col("A")->LT(lit(1000))->OR(col("A")->GE(lit(99990))->AND(col("A")->LT(lit(100010))));
+  auto second = col("B")->GE(lit(500));
+
+  auto ctx = generate_filter_bitmap(std::make_shared<ExecutionContext>(table), first);
+  ASSERT_EQ(ctx->metadata->filter_bitmap, nullptr);
+  ASSERT_NE(ctx->metadata->selection_vector, nullptr);
+  ASSERT_EQ(ctx->metadata->selection_vector->type_id(), arrow::Type::UINT32);
+  ASSERT_EQ(ctx->metadata->selection_vector->length(), 1020);
+  ctx = generate_filter_bitmap(ctx, second);
+  ASSERT_NE(ctx->metadata->selection_vector, nullptr);
+  auto sparse = materialize_filter(ctx)->table;
+
+  auto dense_config = std::make_shared<ExecutionConfig>();
+  dense_config->selection_vector_ratio = 0;
+  auto dense_ctx = std::make_shared<ExecutionContext>(table, dense_config);
+  dense_ctx = generate_filter_bitmap(generate_filter_bitmap(dense_ctx, first), second);
+  ASSERT_EQ(dense_ctx->metadata->selection_vector, nullptr);
+  auto dense = materialize_filter(dense_ctx)->table;
+
+  ASSERT_GT(sparse->num_rows(), 0);
+  // chunks of sparse and dense results are different
+  AssertTablesEqual(*dense, *sparse, false);
+}
+
 class FilterEndToEndTest : public ::testing::Test {
 protected:
   std::shared_ptr<arrow::Table> m_table;
@@ -141,6 +646,207 @@ TEST_F(FilterEndToEndTest, filterIdTest) {
       192525);
 }
 
+TEST_F(FilterEndToEndTest, streamingTest) {
+  using namespace pefa::query_compiler;
+  auto query = QueryCompiler()
+                   .project({"taxi_id", "trip_seconds"})
+                   .filter((col("taxi_id")->LE(lit(1000)))->AND(col("trip_seconds")->LT(lit(20))));
+  auto input = std::make_shared<arrow::TableBatchReader>(*m_table);
+  input->set_chunksize(10000);
+  auto reader = query.execute(input);
+  ASSERT_EQ(reader->schema()->num_fields(), 2);
+
+  std::shared_ptr<arrow::Table> result;
+  ASSERT_OK(reader->ReadAll(&result));
+  ASSERT_EQ(result->num_rows(), 18571);
+  AssertTablesEqual(*query.execute(m_table), *result, false);
+}
+
+TEST_F(FilterEndToEndTest, ipcSourceTest) {
+  using namespace pefa::query_compiler;
+  auto path = (std::filesystem::temp_directory_path() / "pefa_ipc_source_test.arrow").string();
+  {
+    auto sink = arrow::io::FileOutputStream::Open(path).ValueOrDie();
+    auto writer =
+        arrow::ipc::RecordBatchFileWriter::Open(sink.get(), m_table->schema()).ValueOrDie();
+    ASSERT_OK(writer->WriteTable(*m_table, 10000));
+    ASSERT_OK(writer->Close());
+    ASSERT_OK(sink->Close());
+  }
+
+  auto query = QueryCompiler()
+                   .filter(col("trip_seconds")->LT(lit(20)))
+                   .project({"taxi_id", "trip_miles"})
+                   .filter(col("taxi_id")->LE(lit(1000)));
+  std::vector<std::string> expected_columns{"trip_seconds", "taxi_id", "trip_miles"};
+  ASSERT_EQ(query.input_columns(), expected_columns);
+
+  auto source = pefa::io::IpcFileSource::open(path, query.input_columns());
+  ASSERT_EQ(source->schema()->num_fields(), 3);
+  std::shared_ptr<arrow::Table> result;
+  ASSERT_OK(query.execute(source)->ReadAll(&result));
+  AssertTablesEqual(*query.execute(m_table), *result, false);
+  std::filesystem::remove(path);
+}
+
+TEST_F(FilterEndToEndTest, csvScanTest) {
+  using namespace pefa::query_compiler;
+  auto query = QueryCompiler::scan(TEST_DATA_DIR "chicago_taxi_trips_2016_01.csv", FileFormat::CSV)
+                   .project({"taxi_id"})
+                   .filter(col("taxi_id")->EQ(lit(523)));
+  auto result = query.execute();
+  ASSERT_EQ(result->num_columns(), 1);
+  ASSERT_EQ(result->num_rows(), 406);
+}
+
+TEST_F(FilterEndToEndTest, parquetScanTest) {
+  using namespace pefa::query_compiler;
+  auto path = (std::filesystem::temp_directory_path() / "pefa_parquet_scan_test.parquet").string();
+  {
+    auto sink = arrow::io::FileOutputStream::Open(path).ValueOrDie();
+    ASSERT_OK(parquet::arrow::WriteTable(*m_table, arrow::default_memory_pool(), sink, 10000));
+    ASSERT_OK(sink->Close());
+  }
+
+  auto predicate = col("taxi_id")->LE(lit(1000))->AND(col("trip_seconds")->LT(lit(20)));
+  auto query = QueryCompiler::scan(path, FileFormat::PARQUET)
+                   .project({"taxi_id", "trip_seconds"})
+                   .filter(predicate);
+  auto expected =
+      QueryCompiler().project({"taxi_id", "trip_seconds"}).filter(predicate).execute(m_table);
+  AssertTablesEqual(*expected, *query.execute(), false);
+  std::filesystem::remove(path);
+}
+
+TEST(ScanPushdownTest, testParquetRowGroupsArePruned) {
+  using namespace pefa::query_compiler;
+  arrow::Int32Builder builder;
+  for (int32_t i = 0; i < 100000; i++) {
+    ASSERT_OK(builder.Append(i));
+  }
+  std::shared_ptr<arrow::Array> a;
+  ASSERT_OK(builder.Finish(&a));
+  auto b = arrow::random::RandomArrayGenerator(42).Numeric<arrow::DoubleType>(100000, 0.0, 1.0);
+  auto table = arrow::Table::Make(
+      arrow::schema({arrow::field("a", arrow::int32()), arrow::field("b", arrow::float64())}),
+      {a, b});
+  auto path = (std::filesystem::temp_directory_path() / "pefa_row_groups_test.parquet").string();
+  {
+    auto sink = arrow::io::FileOutputStream::Open(path).ValueOrDie();
+    ASSERT_OK(parquet::arrow::WriteTable(*table, arrow::default_memory_pool(), sink, 10000));
+    ASSERT_OK(sink->Close());
+  }
+
+  // "a" is sorted, so only the first 2 row groups of 10 may contain rows with a < 15000
+  auto predicate = col("a")->LT(lit(15000))->AND(col("b")->GE(lit(0.5)));
+  auto scanned = pefa::io::read_file(path, FileFormat::PARQUET, {"b"}, predicate);
+  ASSERT_EQ(scanned->num_columns(), 1);
+  ASSERT_EQ(scanned->num_rows(), 20000);
+
+  auto rejected = pefa::io::read_file(path, FileFormat::PARQUET, {"a"}, col("a")->LT(lit(-5)));
+  ASSERT_EQ(rejected->num_rows(), 0);
+
+  auto result = QueryCompiler::scan(path, FileFormat::PARQUET).filter(predicate).execute();
+  ASSERT_EQ(result->num_columns(), 2);
+  for (auto &chunk : result->column(0)->chunks()) {
+    auto values = std::static_pointer_cast<arrow::Int32Array>(chunk);
+    for (int64_t i = 0; i < values->length(); i++) {
+      ASSERT_LT(values->Value(i), 15000);
+    }
+  }
+  std::filesystem::remove(path);
+}
+
+TEST(ScanPushdownTest, testFiltersOfComputedColumnsAreNotPushed) {
+  using namespace pefa::query_compiler;
+  arrow::Int32Builder a_builder;
+  arrow::Int32Builder b_builder;
+  for (int32_t i = 0; i < 100000; i++) {
+    ASSERT_OK(a_builder.Append(i));
+    ASSERT_OK(b_builder.Append(99999 - i));
+  }
+  std::shared_ptr<arrow::Array> a, b;
+  ASSERT_OK(a_builder.Finish(&a));
+  ASSERT_OK(b_builder.Finish(&b));
+  auto table = arrow::Table::Make(
+      arrow::schema({arrow::field("a", arrow::int32()), arrow::field("b", arrow::int32())}),
+      {a, b});
+  auto path = (std::filesystem::temp_directory_path() / "pefa_computed_test.parquet").string();
+  {
+    auto sink = arrow::io::FileOutputStream::Open(path).ValueOrDie();
+    ASSERT_OK(parquet::arrow::WriteTable(*table, arrow::default_memory_pool(), sink, 10000));
+    ASSERT_OK(sink->Close());
+  }
+
+  // statistics of file column "a" would reject every row group
+  auto computed = QueryCompiler::scan(path, FileFormat::PARQUET)
+                      .select({{col("a")->MUL(lit(2)), "a"}})
+                      .filter(col("a")->GT(lit(100000)));
+  ASSERT_EQ(computed.execute()->num_rows(), 49999);
+  // statistics of file column "a" would keep only the first row group, where "b" is large
+  auto renamed = QueryCompiler::scan(path, FileFormat::PARQUET)
+                     .select({{col("b"), "a"}})
+                     .filter(col("a")->LT(lit(10000)));
+  ASSERT_EQ(renamed.execute()->num_rows(), 10000);
+  std::filesystem::remove(path);
+
+  // projection of column under its own name does not stop pushdown
+  for (bool same_name : {true, false}) {
+    std::shared_ptr<LogicalPlan> plan = std::make_shared<ScanNode>("file", FileFormat::PARQUET);
+    plan = std::make_shared<ProjectionNode>(
+        plan, std::vector<Projection>{{col("a"), same_name ? "a" : "c"}});
+    plan = std::make_shared<FilterNode>(plan, col(same_name ? "a" : "c")->LT(lit(1)));
+    auto filter = std::dynamic_pointer_cast<FilterNode>(ScanPushdownPass().execute(plan));
+    ASSERT_NE(filter, nullptr);
+    auto projection = std::dynamic_pointer_cast<ProjectionNode>(filter->input);
+    ASSERT_NE(projection, nullptr);
+    auto scan = std::dynamic_pointer_cast<ScanNode>(projection->input);
+    ASSERT_NE(scan, nullptr);
+    ASSERT_EQ(scan->predicate != nullptr, same_name);
+  }
+}
+
+TEST(ScanPushdownTest, testColumnsAndPredicateArePushed) {
+  using namespace pefa::query_compiler;
+  std::shared_ptr<LogicalPlan> plan = std::make_shared<ScanNode>("file", FileFormat::PARQUET);
+  plan = std::make_shared<FilterNode>(plan, col("a")->LT(lit(1)));
+  plan = std::make_shared<ProjectionNode>(plan, std::vector<std::string>{"b", "c"});
+  plan = std::make_shared<FilterNode>(plan, col("c")->GT(lit(2)));
+
+  auto optimized = std::dynamic_pointer_cast<FilterNode>(ScanPushdownPass().execute(plan));
+  ASSERT_NE(optimized, nullptr);
+  auto projection = std::dynamic_pointer_cast<ProjectionNode>(optimized->input);
+  ASSERT_NE(projection, nullptr);
+  auto filter = std::dynamic_pointer_cast<FilterNode>(projection->input);
+  ASSERT_NE(filter, nullptr);
+  auto scan = std::dynamic_pointer_cast<ScanNode>(filter->input);
+  ASSERT_NE(scan, nullptr);
+  std::vector<std::string> expected_columns{"a", "b", "c"};
+  ASSERT_EQ(scan->columns, expected_columns);
+  ASSERT_NE(std::dynamic_pointer_cast<PredicateExpr>(scan->predicate), nullptr);
+}
+
+TEST(ScanPushdownTest, testColumnsOfFiltersAfterTopNAreRead) {
+  using namespace pefa::query_compiler;
+  std::shared_ptr<LogicalPlan> plan = std::make_shared<ScanNode>("file", FileFormat::PARQUET);
+  plan = std::make_shared<SortNode>(plan, "a", true, 10);
+  plan = std::make_shared<FilterNode>(plan, col("b")->LT(lit(1)));
+  plan = std::make_shared<ProjectionNode>(plan, std::vector<std::string>{"c"});
+
+  auto projection = std::dynamic_pointer_cast<ProjectionNode>(ScanPushdownPass().execute(plan));
+  ASSERT_NE(projection, nullptr);
+  auto filter = std::dynamic_pointer_cast<FilterNode>(projection->input);
+  ASSERT_NE(filter, nullptr);
+  auto sort = std::dynamic_pointer_cast<SortNode>(filter->input);
+  ASSERT_NE(sort, nullptr);
+  auto scan = std::dynamic_pointer_cast<ScanNode>(sort->input);
+  ASSERT_NE(scan, nullptr);
+  std::vector<std::string> expected_columns{"a", "b", "c"};
+  ASSERT_EQ(scan->columns, expected_columns);
+  // filter after limit would change rows, which reach it
+  ASSERT_EQ(scan->predicate, nullptr);
+}
+
 TEST_F(FilterEndToEndTest, complexFilteringTest) {
   using namespace pefa::query_compiler;
   QueryCompiler qc;
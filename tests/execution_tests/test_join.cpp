@@ -0,0 +1,181 @@
+#include "../generated_columns.h"
+
+#include <arrow/api.h>
+#include <arrow/testing/gtest_util.h>
+#include <gtest/gtest.h>
+#include <map>
+#include <memory>
+#include <optional>
+#include <pefa/execution/thread_pool.h>
+#include <pefa/query_compiler/query_compiler.h>
+#include <pefa/utils/exceptions.h>
+#include <set>
+#include <tuple>
+
+using namespace pefa::query_compiler;
+using namespace pefa::execution;
+
+class JoinTest : public ::testing::Test {
+protected:
+  std::shared_ptr<arrow::Table> m_left;
+  std::shared_ptr<arrow::Table> m_right;
+  static constexpr int64_t m_left_rows = 100000;
+  static constexpr int64_t m_right_rows = 40000;
+
+  static std::optional<int32_t> left_key(int64_t i) {
+    return i % 13 == 0 ? std::nullopt : std::optional<int32_t>(i * 7 % 50000);
+  }
+
+  static double left_value(int64_t i) {
+    return static_cast<double>(i % 100);
+  }
+
+  static int64_t right_key(int64_t i) {
+    return i % 30000;
+  }
+
+  static std::optional<int16_t> right_value(int64_t i) {
+    return i % 3 == 0 ? std::nullopt : std::optional<int16_t>(i % 1000);
+  }
+
+  // rows of right table, which pass filter of right query, by their keys
+  static std::multimap<int64_t, int64_t> right_rows() {
+    std::multimap<int64_t, int64_t> rows;
+    for (int64_t i = 0; i < m_right_rows; i++) {
+      if (i % 4 != 1) {
+        rows.emplace(right_key(i), i);
+      }
+    }
+    return rows;
+  }
+
+  static QueryCompiler right_query() {
+    return QueryCompiler().filter(col("R")->NEQ(lit(1)));
+  }
+
+public:
+  void SetUp() override {
+    std::vector<int64_t> chunk_lengths{40000, 0, 60000};
+    m_left = arrow::Table::Make(
+        arrow::schema({arrow::field("key", arrow::int32()), arrow::field("A", arrow::float64())}),
+        {generated_column<arrow::Int32Type>(chunk_lengths, left_key),
+         generated_column<arrow::DoubleType>(chunk_lengths, left_value)});
+
+    auto rows = row_range(m_right_rows);
+    m_right = arrow::Table::Make(
+        arrow::schema({arrow::field("key", arrow::int64()), arrow::field("B", arrow::int16()),
+                       arrow::field("R", arrow::int64())}),
+        {generated_array<arrow::Int64Type>(rows, right_key),
+         generated_array<arrow::Int16Type>(rows, right_value),
+         generated_array<arrow::Int64Type>(rows, [](auto i) { return i % 4; })});
+  }
+};
+
+TEST_F(JoinTest, testInnerJoinMatchesNestedLoop) {
+  set_num_threads(4);
+  using Row = std::tuple<int32_t, double, std::optional<int16_t>, int64_t>;
+  std::multiset<Row> expected;
+  auto right = right_rows();
+  for (int64_t i = 0; i < m_left_rows; i++) {
+    if (!left_key(i) || left_value(i) >= 50) {
+      continue;
+    }
+    auto range = right.equal_range(*left_key(i));
+    for (auto it = range.first; it != range.second; it++) {
+      expected.emplace(*left_key(i), left_value(i), right_value(it->second), it->second % 4);
+    }
+  }
+
+  auto query = QueryCompiler()
+                   .filter(col("A")->LT(lit(50.0)))
+                   .join(right_query(), m_right, "key", "key", JoinType::INNER);
+  auto sparse_config = std::make_shared<ExecutionConfig>();
+  sparse_config->selection_vector_ratio = 1;
+  sparse_config->selection_vector_min_rows = 0;
+  for (auto &config : {std::make_shared<ExecutionConfig>(), sparse_config}) {
+    auto result = query.execute(m_left, config);
+    ASSERT_EQ(result->schema()->ToString(),
+              arrow::schema({arrow::field("key", arrow::int32()),
+                             arrow::field("A", arrow::float64()), arrow::field("B", arrow::int16()),
+                             arrow::field("R", arrow::int64())})
+                  ->ToString());
+    auto combined = result->CombineChunks().ValueOrDie();
+    auto keys = std::static_pointer_cast<arrow::Int32Array>(combined->column(0)->chunk(0));
+    auto a = std::static_pointer_cast<arrow::DoubleArray>(combined->column(1)->chunk(0));
+    auto b = std::static_pointer_cast<arrow::Int16Array>(combined->column(2)->chunk(0));
+    auto r = std::static_pointer_cast<arrow::Int64Array>(combined->column(3)->chunk(0));
+    std::multiset<Row> actual;
+    for (int64_t i = 0; i < combined->num_rows(); i++) {
+      actual.emplace(keys->Value(i), a->Value(i),
+                     b->IsNull(i) ? std::nullopt : std::optional<int16_t>(b->Value(i)),
+                     r->Value(i));
+    }
+    ASSERT_FALSE(expected.empty());
+    ASSERT_EQ(actual, expected);
+  }
+}
+
+TEST_F(JoinTest, testSemiJoinKeepsOrderOfLeftRows) {
+  set_num_threads(4);
+  auto right = right_rows();
+  arrow::Int32Builder key_builder;
+  arrow::DoubleBuilder value_builder;
+  for (int64_t i = 0; i < m_left_rows; i++) {
+    if (left_key(i) && left_value(i) < 80 && right.count(*left_key(i)) != 0) {
+      ASSERT_OK(key_builder.Append(*left_key(i)));
+      ASSERT_OK(value_builder.Append(left_value(i)));
+    }
+  }
+  std::shared_ptr<arrow::Array> key, value;
+  ASSERT_OK(key_builder.Finish(&key));
+  ASSERT_OK(value_builder.Finish(&value));
+  auto expected = arrow::Table::Make(m_left->schema(), {key, value});
+
+  auto query = QueryCompiler()
+                   .join(right_query(), m_right, "key", "key", JoinType::SEMI)
+                   .filter(col("A")->LT(lit(80.0)))
+                   .project({"key", "A"});
+  ASSERT_EQ(query.input_columns(), (std::vector<std::string>{"key", "A"}));
+  auto result = query.execute(m_left);
+  ASSERT_GT(result->num_rows(), 0);
+  AssertTablesEqual(*expected, *result, false);
+}
+
+TEST_F(JoinTest, testJoinOfEmptySelection) {
+  auto result = QueryCompiler()
+                    .filter(col("A")->GT(lit(1000.0)))
+                    .join(m_right, "key", "key")
+                    .execute(m_left);
+  ASSERT_EQ(result->num_rows(), 0);
+  ASSERT_EQ(result->num_columns(), 4);
+  // inner join output may reference any column of input
+  ASSERT_TRUE(QueryCompiler().join(m_right, "key", "key").project({"A"}).input_columns().empty());
+}
+
+TEST_F(JoinTest, testJoinIsRejectedInStreamingMode) {
+  auto input = std::make_shared<arrow::TableBatchReader>(*m_left);
+  for (auto type : {JoinType::INNER, JoinType::SEMI}) {
+    ASSERT_THROW(QueryCompiler().join(right_query(), m_right, "key", "key", type).execute(input),
+                 pefa::NotImplementedException);
+  }
+}
+
+TEST_F(JoinTest, testRuntimeFilterDoesNotChangeResult) {
+  set_num_threads(4);
+  auto without_filters = std::make_shared<ExecutionConfig>();
+  without_filters->use_runtime_filters = false;
+  // right side is filtered by key, so bloom filter rejects most of left rows
+  auto right = QueryCompiler().filter(col("key")->LT(lit(5000)));
+  auto semi = QueryCompiler()
+                  .filter(col("A")->LT(lit(80.0)))
+                  .join(right, m_right, "key", "key", JoinType::SEMI);
+  auto expected = semi.execute(m_left, without_filters);
+  ASSERT_GT(expected->num_rows(), 0);
+  AssertTablesEqual(*expected, *semi.execute(m_left), false);
+
+  auto inner = QueryCompiler()
+                   .join(right, m_right, "key", "key")
+                   .aggregate({}, {{Aggregate::Op::COUNT, "B", "count_b"},
+                                   {Aggregate::Op::SUM, "R", "sum_r"}});
+  AssertTablesEqual(*inner.execute(m_left, without_filters), *inner.execute(m_left), false);
+}
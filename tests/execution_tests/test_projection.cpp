@@ -0,0 +1,122 @@
+#include "../generated_columns.h"
+
+#include <arrow/api.h>
+#include <arrow/testing/gtest_util.h>
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <memory>
+#include <optional>
+#include <pefa/execution/thread_pool.h>
+#include <pefa/query_compiler/query_compiler.h>
+#include <pefa/utils/exceptions.h>
+#include <vector>
+
+using namespace pefa::query_compiler;
+using namespace pefa::execution;
+
+class ProjectionTest : public ::testing::Test {
+protected:
+  std::shared_ptr<arrow::Table> m_table;
+  static constexpr int64_t m_num_rows = 200000;
+
+  static std::optional<int32_t> a(int64_t i) {
+    return scattered_int32(i, 13);
+  }
+
+  static double b(int64_t i) {
+    return static_cast<double>((i * 31) % 1000) / 8 - 60.3;
+  }
+
+  static uint8_t c(int64_t i) {
+    return static_cast<uint8_t>(i * 17);
+  }
+
+  // x = a * 1.1, y = CAST(b AS int32), z = c + 1 and a itself for given rows
+  static std::shared_ptr<arrow::Table> expected_table(const std::vector<int64_t> &rows) {
+    auto x = generated_array<arrow::DoubleType>(rows, [](auto i) {
+      return a(i) ? std::optional<double>(*a(i) * 1.1) : std::nullopt;
+    });
+    auto y = generated_array<arrow::Int32Type>(rows,
+                                               [](auto i) { return static_cast<int32_t>(b(i)); });
+    auto z = generated_array<arrow::UInt8Type>(
+        rows, [](auto i) { return static_cast<uint8_t>(c(i) + 1); });
+    auto renamed = generated_array<arrow::Int32Type>(rows, a);
+    auto schema = arrow::schema(
+        {arrow::field("x", arrow::float64()), arrow::field("y", arrow::int32()),
+         arrow::field("z", arrow::uint8()), arrow::field("renamed", arrow::int32())});
+    return arrow::Table::Make(schema, {x, y, z, renamed});
+  }
+
+  static std::vector<Projection> projections() {
+    return {{col("a")->MUL(lit(1.1)), "x"},
+            {col("b")->CAST(arrow::int32()), "y"},
+            {col("c")->ADD(lit(1)), "z"},
+            {col("a"), "renamed"}};
+  }
+
+public:
+  void SetUp() override {
+    // columns are chunked differently, so expressions over several of them are computed by
+    // segments, which do not match chunks
+    auto a_column = generated_column<arrow::Int32Type>({70000, 0, 130000}, a);
+    auto b_column = generated_column<arrow::DoubleType>({1000, 99001, 99999}, b);
+    auto c_column = generated_column<arrow::UInt8Type>({200000}, c);
+    m_table = arrow::Table::Make(
+        arrow::schema({arrow::field("a", arrow::int32()), arrow::field("b", arrow::float64()),
+                       arrow::field("c", arrow::uint8())}),
+        {a_column, b_column, c_column});
+  }
+};
+
+TEST_F(ProjectionTest, testComputedColumnsMatchScalarEvaluation) {
+  set_num_threads(4);
+  auto expected = expected_table(row_range(m_num_rows));
+  AssertTablesEqual(*expected, *QueryCompiler().select(projections()).execute(m_table), false);
+}
+
+TEST_F(ProjectionTest, testComputedColumnsOfFilteredRows) {
+  set_num_threads(4);
+  std::vector<int64_t> rows;
+  for (int64_t i = 0; i < m_num_rows; i++) {
+    if (b(i) < -55) {
+      rows.push_back(i);
+    }
+  }
+  auto expected = expected_table(rows);
+  auto sparse_config = std::make_shared<ExecutionConfig>();
+  sparse_config->selection_vector_ratio = 1;
+  sparse_config->selection_vector_min_rows = 0;
+  for (auto &config : {std::make_shared<ExecutionConfig>(), sparse_config}) {
+    auto before = QueryCompiler().filter(col("b")->LT(lit(-55.0))).select(projections());
+    AssertTablesEqual(*expected, *before.execute(m_table, config), false);
+    // filter after projection references computed column
+    auto after = QueryCompiler()
+                     .select({{col("a")->MUL(lit(1.1)), "x"},
+                              {col("b")->CAST(arrow::int32()), "y"},
+                              {col("c")->ADD(lit(1)), "z"},
+                              {col("a"), "renamed"},
+                              {col("b")->SUB(lit(5.0)), "w"}})
+                     .filter(col("w")->LT(lit(-60.0)))
+                     .project({"x", "y", "z", "renamed"});
+    AssertTablesEqual(*expected, *after.execute(m_table, config), false);
+  }
+}
+
+TEST_F(ProjectionTest, testInputColumnsOfExpressions) {
+  auto query = QueryCompiler().select(
+      {{col("c")->ADD(col("a"))->MUL(lit(2)), "x"}, {col("a"), "y"}, {col("b"), "b"}});
+  ASSERT_EQ(query.input_columns(), (std::vector<std::string>{"c", "a", "b"}));
+  auto table = arrow::Table::Make(
+      arrow::schema({arrow::field("s", arrow::utf8()), arrow::field("a", arrow::int32())}),
+      {arrow::ArrayFromJSON(arrow::utf8(), R"(["x", "y"])"),
+       arrow::ArrayFromJSON(arrow::int32(), "[1, 2]")});
+  ASSERT_THROW(QueryCompiler().select({{col("s")->ADD(lit(1)), "x"}}).execute(table),
+               pefa::NotImplementedException);
+  // string column is not computed, so it is taken as is
+  auto result = QueryCompiler().select({{col("s"), "t"}, {col("a")->SUB(lit(1)), "b"}});
+  auto expected = arrow::Table::Make(
+      arrow::schema({arrow::field("t", arrow::utf8()), arrow::field("b", arrow::int32())}),
+      {arrow::ArrayFromJSON(arrow::utf8(), R"(["x", "y"])"),
+       arrow::ArrayFromJSON(arrow::int32(), "[0, 1]")});
+  AssertTablesEqual(*expected, *result.execute(table), false);
+}
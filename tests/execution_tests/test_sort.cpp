@@ -0,0 +1,136 @@
+#include "../generated_columns.h"
+
+#include <algorithm>
+#include <arrow/api.h>
+#include <arrow/testing/gtest_util.h>
+#include <gtest/gtest.h>
+#include <memory>
+#include <optional>
+#include <pefa/execution/thread_pool.h>
+#include <pefa/query_compiler/query_compiler.h>
+#include <string>
+#include <vector>
+
+using namespace pefa::query_compiler;
+using namespace pefa::execution;
+
+class SortTest : public ::testing::Test {
+protected:
+  std::shared_ptr<arrow::Table> m_table;
+  static constexpr int64_t m_num_rows = 200000;
+
+  static std::optional<int32_t> key(int64_t i) {
+    return scattered_int32(i, 17);
+  }
+
+  static double value(int64_t i) {
+    return static_cast<double>((i * 31) % 1000) - 500.5;
+  }
+
+  // ids of rows with value below 400, ordered like sort with nulls last and equal keys in order
+  // of rows
+  static std::vector<int64_t> expected_rows(bool ascending) {
+    std::vector<int64_t> rows;
+    for (int64_t i = 0; i < m_num_rows; i++) {
+      if (value(i) < 400) {
+        rows.push_back(i);
+      }
+    }
+    std::stable_sort(rows.begin(), rows.end(), [&](int64_t lhs, int64_t rhs) {
+      if (!key(lhs) || !key(rhs)) {
+        return key(lhs) && !key(rhs);
+      }
+      return ascending ? *key(lhs) < *key(rhs) : *key(lhs) > *key(rhs);
+    });
+    return rows;
+  }
+
+  static std::shared_ptr<arrow::Schema> schema() {
+    return arrow::schema(
+        {arrow::field("key", arrow::int32()), arrow::field("value", arrow::float64())});
+  }
+
+  static std::shared_ptr<arrow::Table> rows_table(const std::vector<int64_t> &rows) {
+    return arrow::Table::Make(schema(), {generated_array<arrow::Int32Type>(rows, key),
+                                         generated_array<arrow::DoubleType>(rows, value)});
+  }
+
+public:
+  void SetUp() override {
+    std::vector<int64_t> chunk_lengths{70000, 0, 130000};
+    m_table =
+        arrow::Table::Make(schema(), {generated_column<arrow::Int32Type>(chunk_lengths, key),
+                                      generated_column<arrow::DoubleType>(chunk_lengths, value)});
+  }
+};
+
+TEST_F(SortTest, testSortMatchesStableSort) {
+  set_num_threads(4);
+  auto sparse_config = std::make_shared<ExecutionConfig>();
+  sparse_config->selection_vector_ratio = 1;
+  sparse_config->selection_vector_min_rows = 0;
+  for (bool ascending : {true, false}) {
+    auto expected = rows_table(expected_rows(ascending));
+    auto query = QueryCompiler().filter(col("value")->LT(lit(400.0))).sort("key", ascending);
+    for (auto &config : {std::make_shared<ExecutionConfig>(), sparse_config}) {
+      AssertTablesEqual(*expected, *query.execute(m_table, config), false);
+    }
+  }
+}
+
+TEST_F(SortTest, testTopNMatchesSort) {
+  set_num_threads(4);
+  for (bool ascending : {true, false}) {
+    auto rows = expected_rows(ascending);
+    // the last limit is served by full sort, and limit above number of rows returns all of them
+    for (int64_t limit : {0, 1, 100, 20000, 1000000}) {
+      auto expected = rows_table(
+          {rows.begin(), rows.begin() + std::min(limit, static_cast<int64_t>(rows.size()))});
+      auto result = QueryCompiler()
+                        .filter(col("value")->LT(lit(400.0)))
+                        .top_n("key", limit, ascending)
+                        .execute(m_table);
+      AssertTablesEqual(*expected, *result, false);
+    }
+  }
+}
+
+TEST_F(SortTest, testFloatingKeysAreOrderedByValue) {
+  auto values = arrow::ArrayFromJSON(arrow::float32(), "[1.5, -2.0, null, 0.0, -0.5, 3.0, -7.25]");
+  auto ids = arrow::ArrayFromJSON(arrow::int64(), "[0, 1, 2, 3, 4, 5, 6]");
+  auto table = arrow::Table::Make(
+      arrow::schema({arrow::field("x", arrow::float32()), arrow::field("id", arrow::int64())}),
+      {values, ids});
+  auto result = QueryCompiler().sort("x", false).project({"id"}).execute(table);
+  auto expected =
+      arrow::Table::Make(arrow::schema({arrow::field("id", arrow::int64())}),
+                         {arrow::ArrayFromJSON(arrow::int64(), "[5, 0, 3, 4, 1, 6, 2]")});
+  AssertTablesEqual(*expected, *result, false);
+  ASSERT_EQ(QueryCompiler().top_n("x", 2).project({"id"}).input_columns(),
+            (std::vector<std::string>{"x", "id"}));
+}
+
+TEST_F(SortTest, testDictionariesOfChunksAreUnified) {
+  // chunks have different dictionaries, and the first one holds null, which a row references
+  auto type = arrow::dictionary(arrow::int8(), arrow::utf8());
+  auto table = arrow::Table::Make(
+      arrow::schema({arrow::field("x", arrow::int32()), arrow::field("s", type)}),
+      {arrow::ChunkedArrayFromJSON(arrow::int32(), {"[3, 1, null, 0]", "[2, 4, 5]"}),
+       std::make_shared<arrow::ChunkedArray>(arrow::ArrayVector{
+           arrow::DictArrayFromJSON(type, "[3, 0, null, 2]", R"(["a", "b", null, "c"])"),
+           arrow::DictArrayFromJSON(type, "[0, 2, 1]", R"(["b", "d", "a"])")})});
+  auto result = QueryCompiler().sort("x").project({"s"}).execute(table);
+
+  std::vector<std::optional<std::string>> values;
+  for (auto &chunk : result->column(0)->chunks()) {
+    auto &dictionary_chunk = static_cast<const arrow::DictionaryArray &>(*chunk);
+    auto &dictionary = static_cast<const arrow::StringArray &>(*dictionary_chunk.dictionary());
+    for (int64_t i = 0; i < chunk->length(); i++) {
+      values.push_back(chunk->IsNull(i) ? std::nullopt
+                                        : std::optional<std::string>(dictionary.GetString(
+                                              dictionary_chunk.GetValueIndex(i))));
+    }
+  }
+  ASSERT_EQ(values, (std::vector<std::optional<std::string>>{std::nullopt, "a", "b", "c", "a", "d",
+                                                             std::nullopt}));
+}
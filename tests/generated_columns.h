@@ -0,0 +1,62 @@
+#pragma once
+#include <arrow/api.h>
+#include <arrow/testing/gtest_util.h>
+#include <cstdint>
+#include <memory>
+#include <numeric>
+#include <optional>
+#include <vector>
+
+// Columns of execution tests are generated from positions of rows, so expected results are computed
+// by the same functions, which fill tables. Value function maps position of row to value or to
+// std::optional of it, where std::nullopt is null
+
+// pseudo-random int32 in [-50000, 50003), which is null for every null_period-th row
+inline std::optional<int32_t> scattered_int32(int64_t i, int64_t null_period) {
+  return i % null_period == 0 ? std::nullopt
+                              : std::optional<int32_t>((i * 7919) % 100003 - 50000);
+}
+
+template <typename Builder, typename T> void append_value(Builder &builder, const T &value) {
+  ARROW_EXPECT_OK(builder.Append(value));
+}
+
+template <typename Builder, typename T>
+void append_value(Builder &builder, const std::optional<T> &value) {
+  ARROW_EXPECT_OK(value ? builder.Append(*value) : builder.AppendNull());
+}
+
+// array with value(i) for every i of rows
+template <typename ArrowType, typename ValueFn>
+std::shared_ptr<arrow::Array> generated_array(const std::vector<int64_t> &rows, ValueFn value) {
+  typename arrow::TypeTraits<ArrowType>::BuilderType builder;
+  for (auto i : rows) {
+    append_value(builder, value(i));
+  }
+  std::shared_ptr<arrow::Array> array;
+  ARROW_EXPECT_OK(builder.Finish(&array));
+  return array;
+}
+
+// rows [0, length)
+inline std::vector<int64_t> row_range(int64_t length) {
+  std::vector<int64_t> rows(length);
+  std::iota(rows.begin(), rows.end(), 0);
+  return rows;
+}
+
+// column of consecutive rows, which is split into chunks of chunk_lengths
+template <typename ArrowType, typename ValueFn>
+std::shared_ptr<arrow::ChunkedArray> generated_column(const std::vector<int64_t> &chunk_lengths,
+                                                      ValueFn value) {
+  std::vector<std::shared_ptr<arrow::Array>> chunks;
+  int64_t row = 0;
+  for (auto length : chunk_lengths) {
+    std::vector<int64_t> rows(length);
+    std::iota(rows.begin(), rows.end(), row);
+    chunks.push_back(generated_array<ArrowType>(rows, value));
+    row += length;
+  }
+  return std::make_shared<arrow::ChunkedArray>(
+      chunks, arrow::TypeTraits<ArrowType>::type_singleton());
+}
@@ -1,9 +1,21 @@
 #include "pefa/kernels/filter.h"
+#include "pefa/kernels/value_types.h"
+#include "pefa/utils/bloom_filter.h"
+#include "pefa/utils/string_match.h"
 
+#include <algorithm>
 #include <arrow/api.h>
 #include <arrow/testing/gtest_util.h>
+#include <arrow/testing/random.h>
 #include <arrow/type_traits.h>
+#include <cmath>
+#include <functional>
 #include <gtest/gtest.h>
+#include <random>
+#include <regex>
+#include <string>
+#include <tuple>
+#include <vector>
 
 using namespace pefa;
 using namespace pefa::query_compiler;
@@ -94,3 +106,513 @@ TYPED_TEST(FilterKernelOffsetsTest, testRemainingEnd4) {
                                     this->m_array->length() - 4, 0);
   arrow::AssertBufferEqual(*this->m_bitmap, std::vector<uint8_t>({0b00101111, 0b11111111}));
 }
+
+template <typename ArrowType>
+class FilterKernelVectorizedTest : public ::testing::Test {
+protected:
+  std::shared_ptr<arrow::Array> m_array;
+  std::shared_ptr<arrow::Field> m_field;
+
+  void SetUp() override {
+    auto type = arrow::TypeTraits<ArrowType>::type_singleton();
+    // long enough to be processed by both vectorized and tail loops
+    arrow::random::RandomArrayGenerator generator(42);
+    m_array = generator.Numeric<ArrowType>(1000, 0, 100);
+    m_field = std::make_shared<arrow::Field>("field", type);
+  }
+};
+
+TYPED_TEST_SUITE(FilterKernelVectorizedTest, arrow::NumericArrowTypes);
+TYPED_TEST(FilterKernelVectorizedTest, testMatchesScalarEvaluation) {
+  using CType = typename TypeParam::c_type;
+  auto expr = (col("field")->LT(lit(30)))->OR(col("field")->EQ(lit(50)));
+  auto filter = kernels::FilterKernel::create_cpu(this->m_field, expr);
+  filter->compile();
+
+  auto length = this->m_array->length();
+  auto bitmap = arrow::AllocateEmptyBitmap(length).ValueOrDie();
+  std::memset(bitmap->mutable_data(), 255, bitmap->size());
+  filter->execute(this->m_array, bitmap->mutable_data(), 0);
+
+  auto values = reinterpret_cast<const CType *>(this->m_array->data()->buffers[1]->data());
+  for (int64_t i = 0; i < length / 8 * 8; i++) {
+    bool expected = values[i] < 30 || values[i] == 50;
+    ASSERT_EQ(expected, (bitmap->data()[i / 8] >> (7 - i % 8)) & 1) << "at position " << i;
+  }
+}
+
+TYPED_TEST(FilterKernelVectorizedTest, testNullsAreFilteredOut) {
+  auto expr = (col("field")->LT(lit(30)))->OR(col("field")->EQ(lit(50)));
+  auto filter = kernels::FilterKernel::create_cpu(this->m_field, expr);
+  filter->compile();
+
+  // slice makes validity bitmap start from the middle of a byte
+  arrow::random::RandomArrayGenerator generator(42);
+  auto array = std::static_pointer_cast<arrow::NumericArray<TypeParam>>(
+      generator.Numeric<TypeParam>(1005, 0, 100, 0.2)->Slice(3));
+  auto length = array->length();
+  auto bitmap = arrow::AllocateEmptyBitmap(length).ValueOrDie();
+  std::memset(bitmap->mutable_data(), 255, bitmap->size());
+  filter->execute(array, bitmap->mutable_data(), 0);
+  filter->execute_remaining(array, bitmap->mutable_data() + length / 8, length / 8 * 8, 0);
+
+  for (int64_t i = 0; i < length; i++) {
+    bool expected = array->IsValid(i) && (array->Value(i) < 30 || array->Value(i) == 50);
+    ASSERT_EQ(expected, (bitmap->data()[i / 8] >> (7 - i % 8)) & 1) << "at position " << i;
+  }
+}
+
+TEST(FusedFilterKernelTest, testMultipleColumns) {
+  auto a = std::make_shared<arrow::Field>("a", arrow::int16());
+  auto b = std::make_shared<arrow::Field>("b", arrow::float64());
+  auto filter = kernels::FilterKernel::create_cpu(
+      {a, b}, (col("a")->GE(lit(3)))->AND(col("b")->LT(lit(1.5)))->OR(col("a")->EQ(lit(0))));
+  filter->compile();
+
+  auto a_array = arrow::ArrayFromJSON(arrow::int16(), "[0, 4, 2, 4, 4, 5, 4, 7, 4, 9, 12, 4, 3]");
+  auto b_array = arrow::ArrayFromJSON(
+      arrow::float64(), "[9.0, 1.0, 0.0, 2.0, 1.4, 1.5, 0.1, 8.0, 1.0, 3.0, 0.0, 0.0, 1.0]");
+  auto bitmap = arrow::AllocateEmptyBitmap(a_array->length()).ValueOrDie();
+  std::memset(bitmap->mutable_data(), 255, bitmap->size());
+
+  filter->execute({a_array, b_array}, bitmap->mutable_data(), 0);
+  filter->execute_remaining({a_array, b_array}, bitmap->mutable_data() + 1, 8, 0);
+  arrow::AssertBufferEqual(*bitmap, std::vector<uint8_t>({0b11001010, 0b10111111}));
+}
+
+TEST(FusedFilterKernelTest, testNullsInMultipleColumns) {
+  auto a = std::make_shared<arrow::Field>("a", arrow::int32());
+  auto b = std::make_shared<arrow::Field>("b", arrow::int32());
+  auto filter = kernels::FilterKernel::create_cpu(
+      {a, b}, (col("a")->LT(lit(5)))->OR(col("b")->GT(lit(5))));
+  filter->compile();
+
+  // null in one operand of OR does not filter out row, if other operand is true
+  auto a_array = arrow::ArrayFromJSON(arrow::int32(), "[1, null, null, 9, 1, null, 9, 9, 1, 9]");
+  auto b_array = arrow::ArrayFromJSON(arrow::int32(), "[1, 9, 1, null, null, null, 9, 1, 9, 9]");
+  auto bitmap = arrow::AllocateEmptyBitmap(a_array->length()).ValueOrDie();
+  std::memset(bitmap->mutable_data(), 255, bitmap->size());
+
+  filter->execute({a_array, b_array}, bitmap->mutable_data(), 0);
+  filter->execute_remaining({a_array, b_array}, bitmap->mutable_data() + 1, 8, 0);
+  arrow::AssertBufferEqual(*bitmap, std::vector<uint8_t>({0b11001010, 0b11111111}));
+}
+
+TEST(BloomFilterKernelTest, testMatchesBloomFilter) {
+  auto filter = std::make_shared<utils::BloomFilter>();
+  filter->reset(1000);
+  for (int64_t key = 0; key < 3000; key += 3) {
+    filter->insert(key);
+  }
+  auto field = std::make_shared<arrow::Field>("key", arrow::int32());
+  auto kernel =
+      kernels::FilterKernel::create_cpu(field, BloomFilterExpr::create(col("key"), filter));
+  kernel->compile();
+
+  arrow::random::RandomArrayGenerator generator(42);
+  auto array = std::static_pointer_cast<arrow::Int32Array>(
+      generator.Int32(1005, -100, 3100, 0.1)->Slice(3));
+  auto length = array->length();
+  auto bitmap = arrow::AllocateEmptyBitmap(length).ValueOrDie();
+  std::memset(bitmap->mutable_data(), 255, bitmap->size());
+  kernel->execute(array, bitmap->mutable_data(), 0);
+  kernel->execute_remaining(array, bitmap->mutable_data() + length / 8, length / 8 * 8, 0);
+
+  int64_t false_positives = 0;
+  for (int64_t i = 0; i < length; i++) {
+    bool expected = array->IsValid(i) && filter->may_contain(array->Value(i));
+    ASSERT_EQ(expected, (bitmap->data()[i / 8] >> (7 - i % 8)) & 1) << "at position " << i;
+    // keys, which were inserted, are never rejected
+    if (array->IsValid(i) && array->Value(i) >= 0 && array->Value(i) < 3000) {
+      ASSERT_EQ(expected, array->Value(i) % 3 == 0) << "at position " << i;
+    }
+    false_positives += expected && (array->Value(i) % 3 != 0 || array->Value(i) < 0);
+  }
+  ASSERT_LT(false_positives, 20);
+}
+
+TEST(BloomFilterKernelTest, testUnbuiltFilterAcceptsNonNullKeys) {
+  auto field = std::make_shared<arrow::Field>("key", arrow::uint64());
+  auto kernel = kernels::FilterKernel::create_cpu(
+      field, BloomFilterExpr::create(col("key"), std::make_shared<utils::BloomFilter>()));
+  kernel->compile();
+
+  auto array = arrow::ArrayFromJSON(arrow::uint64(), "[1, 2, null, 4, 5, 6, 7, 8, 9]");
+  auto bitmap = arrow::AllocateEmptyBitmap(array->length()).ValueOrDie();
+  std::memset(bitmap->mutable_data(), 255, bitmap->size());
+  kernel->execute(array, bitmap->mutable_data(), 0);
+  kernel->execute_remaining(array, bitmap->mutable_data() + 1, 8, 0);
+  arrow::AssertBufferEqual(*bitmap, std::vector<uint8_t>({0b11011111, 0b11111111}));
+}
+
+TEST(StringFilterKernelTest, testMatchesScalarEvaluation) {
+  // values share prefixes and suffixes, and some of them are longer than a vector load
+  const std::vector<std::string> values = {"Cash",
+                                           "Credit Card",
+                                           "No Charge",
+                                           "Unknown",
+                                           "Dispute",
+                                           "Prcard",
+                                           "",
+                                           "Cas",
+                                           "Cashless",
+                                           "a value longer than sixteen bytes",
+                                           "a value longer than sixteen bytez",
+                                           "value longer than sixteen bytes"};
+  auto like = [](const std::string &regex) {
+    return [regex](const std::string &value) { return std::regex_match(value, std::regex(regex)); };
+  };
+  std::vector<std::pair<std::shared_ptr<BooleanExpr>, std::function<bool(const std::string &)>>>
+      cases = {
+          {col("s")->EQ(lit(std::string("Cash"))), like("Cash")},
+          {col("s")->NEQ(lit(std::string("Cash"))), [](auto &value) { return value != "Cash"; }},
+          {col("s")->EQ(lit(std::string())), [](auto &value) { return value.empty(); }},
+          {col("s")->EQ(lit(values[9])), [&](auto &value) { return value == values[9]; }},
+          {col("s")->LT(lit(std::string("Credit"))), [](auto &value) { return value < "Credit"; }},
+          {col("s")->GE(lit(std::string("No Charge"))),
+           [](auto &value) { return value >= "No Charge"; }},
+          {col("s")->GT(lit(std::string())), [](auto &value) { return !value.empty(); }},
+          {col("s")->STARTS_WITH("Cas"), like("Cas.*")},
+          {col("s")->STARTS_WITH("a value longer than sixteen"),
+           like("a value longer than sixteen.*")},
+          {col("s")->ENDS_WITH("ard"), like(".*ard")},
+          {col("s")->ENDS_WITH("sixteen bytes"), like(".*sixteen bytes")},
+          {col("s")->CONTAINS("ar"), like(".*ar.*")},
+          {col("s")->LIKE("%a_h%"), like(".*a.h.*")},
+          {col("s")->LIKE("_a%s"), like(".a.*s")},
+          {col("s")->LIKE("C%"), like("C.*")},
+          {col("s")->LIKE("%"), like(".*")},
+          {col("s")->LIKE("Cash"), like("Cash")},
+      };
+
+  for (auto &type : {arrow::utf8(), arrow::binary()}) {
+    std::unique_ptr<arrow::ArrayBuilder> builder;
+    ASSERT_OK(arrow::MakeBuilder(arrow::default_memory_pool(), type, &builder));
+    auto &binary_builder = static_cast<arrow::BinaryBuilder &>(*builder);
+    std::mt19937 random(42);
+    for (int i = 0; i < 1005; i++) {
+      auto value = random() % (values.size() + 1);
+      ASSERT_OK(value == values.size() ? binary_builder.AppendNull()
+                                       : binary_builder.Append(values[value]));
+    }
+    std::shared_ptr<arrow::Array> array;
+    ASSERT_OK(binary_builder.Finish(&array));
+    // slice makes offsets and validity bitmap start from the middle
+    auto strings = std::static_pointer_cast<arrow::BinaryArray>(array->Slice(3));
+    auto length = strings->length();
+    auto field = std::make_shared<arrow::Field>("s", type);
+
+    for (bool skip_zero_words : {false, true}) {
+      for (auto &[expr, expected_fn] : cases) {
+        auto kernel = kernels::FilterKernel::create_cpu({field}, expr, skip_zero_words);
+        kernel->compile();
+        auto bitmap = arrow::AllocateEmptyBitmap(length).ValueOrDie();
+        std::memset(bitmap->mutable_data(), 255, bitmap->size());
+        kernel->execute(strings, bitmap->mutable_data(), 0);
+        kernel->execute_remaining(strings, bitmap->mutable_data() + length / 8, length / 8 * 8,
+                                  0);
+        for (int64_t i = 0; i < length; i++) {
+          bool expected = strings->IsValid(i) && expected_fn(strings->GetString(i));
+          ASSERT_EQ(expected, (bitmap->data()[i / 8] >> (7 - i % 8)) & 1)
+              << "at position " << i << " of " << type->ToString();
+        }
+      }
+    }
+  }
+}
+
+TEST(StringFilterKernelTest, testLikePatternsAreSimplified) {
+  using Kind = utils::LikePattern::Kind;
+  auto check = [](const std::string &pattern, Kind kind, const std::string &literal) {
+    auto simplified = utils::simplify_like(pattern);
+    ASSERT_EQ(simplified.kind, kind) << pattern;
+    ASSERT_EQ(simplified.literal, literal) << pattern;
+  };
+  check("Cash", Kind::EQ, "Cash");
+  check("Cred%", Kind::STARTS_WITH, "Cred");
+  check("%%Card", Kind::ENDS_WITH, "Card");
+  check("%ar%", Kind::CONTAINS, "ar");
+  check("%", Kind::CONTAINS, "");
+  check("C%d", Kind::GENERAL, "C%d");
+  check("Cas_", Kind::GENERAL, "Cas_");
+
+  auto match = [](const std::string &value, const std::string &pattern) {
+    return utils::match_like(reinterpret_cast<const uint8_t *>(value.data()),
+                             static_cast<int32_t>(value.size()),
+                             reinterpret_cast<const uint8_t *>(pattern.data()),
+                             static_cast<int32_t>(pattern.size()));
+  };
+  ASSERT_TRUE(match("Credit Card", "C%d"));
+  ASSERT_TRUE(match("Credit Card", "%e_i%C%"));
+  ASSERT_TRUE(match("", "%%"));
+  ASSERT_FALSE(match("Cash", "C%d"));
+  ASSERT_FALSE(match("Cas", "Cas_"));
+}
+
+TEST(DictionaryFilterKernelTest, testMatchesDecodedEvaluation) {
+  // the first dictionary holds null and value, which no row references. One kernel filters chunks
+  // of both dictionaries, so their truth tables do not mix
+  const std::vector<std::shared_ptr<arrow::Array>> dictionaries = {
+      arrow::ArrayFromJSON(arrow::utf8(),
+                           R"(["Cash", "Credit Card", null, "No Charge", "Cashless", "Unused"])"),
+      arrow::ArrayFromJSON(arrow::utf8(), R"(["Prcard", "Cash"])")};
+  std::vector<std::pair<std::shared_ptr<BooleanExpr>, std::function<bool(const std::string &)>>>
+      cases = {
+          {col("s")->EQ(lit(std::string("Cash"))), [](auto &value) { return value == "Cash"; }},
+          {col("s")->NEQ(lit(std::string("Cash"))), [](auto &value) { return value != "Cash"; }},
+          {col("s")->GE(lit(std::string("No"))), [](auto &value) { return value >= "No"; }},
+          {col("s")->STARTS_WITH("Cas"), [](auto &value) { return value.rfind("Cas", 0) == 0; }},
+          {col("s")->LIKE("%ar%"),
+           [](auto &value) { return value.find("ar") != std::string::npos; }},
+          {col("s")->IN({std::string("Cash"), std::string("Prcard"), std::string("Missing")}),
+           [](auto &value) { return value == "Cash" || value == "Prcard"; }},
+          {col("s")->BETWEEN(std::string("C"), std::string("D")),
+           [](auto &value) { return value >= "C" && value <= "D"; }},
+          {col("s")->EQ(lit(std::string("Cash")))->OR(col("s")->ENDS_WITH("Card")),
+           [](auto &value) {
+             return value == "Cash" ||
+                    (value.size() >= 4 && value.compare(value.size() - 4, 4, "Card") == 0);
+           }},
+      };
+
+  for (auto &index_type : {arrow::int8(), arrow::int32()}) {
+    auto type = arrow::dictionary(index_type, arrow::utf8());
+    std::vector<std::shared_ptr<arrow::DictionaryArray>> chunks;
+    std::mt19937 random(42);
+    for (auto &dictionary : dictionaries) {
+      std::string codes = "[";
+      for (int i = 0; i < 1005; i++) {
+        auto code = random() % (dictionary->length() + 1);
+        codes += (i == 0 ? "" : ", ") +
+                 (code == dictionary->length() ? std::string("null") : std::to_string(code));
+      }
+      auto indices = arrow::ArrayFromJSON(index_type, codes + "]");
+      // slice makes codes and validity bitmap start from the middle
+      chunks.push_back(std::static_pointer_cast<arrow::DictionaryArray>(
+          std::make_shared<arrow::DictionaryArray>(type, indices, dictionary)->Slice(3)));
+    }
+    auto field = arrow::field("s", type);
+
+    for (bool skip_zero_words : {false, true}) {
+      for (auto &[expr, expected_fn] : cases) {
+        auto kernel = kernels::FilterKernel::create_cpu({field}, expr, skip_zero_words);
+        kernel->compile();
+        for (auto &chunk : chunks) {
+          auto length = chunk->length();
+          auto &values = static_cast<const arrow::StringArray &>(*chunk->dictionary());
+          auto bitmap = arrow::AllocateEmptyBitmap(length).ValueOrDie();
+          std::memset(bitmap->mutable_data(), 255, bitmap->size());
+          kernel->execute(chunk, bitmap->mutable_data(), 0);
+          kernel->execute_remaining(chunk, bitmap->mutable_data() + length / 8, length / 8 * 8,
+                                    0);
+          for (int64_t i = 0; i < length; i++) {
+            auto code = chunk->GetValueIndex(i);
+            bool expected = chunk->IsValid(i) && values.IsValid(code) &&
+                            expected_fn(values.GetString(code));
+            ASSERT_EQ(expected, (bitmap->data()[i / 8] >> (7 - i % 8)) & 1)
+                << "at position " << i << " of " << type->ToString();
+          }
+        }
+      }
+    }
+  }
+}
+
+TEST(ArithmeticFilterKernelTest, testMatchesScalarEvaluation) {
+  arrow::random::RandomArrayGenerator generator(42);
+  // slice makes values and validity bitmaps start from the middle
+  auto fare = std::static_pointer_cast<arrow::DoubleArray>(
+      generator.Float64(1005, -10, 10, 0.1)->Slice(3));
+  auto tips = std::static_pointer_cast<arrow::FloatArray>(
+      generator.Float32(1005, -10, 10, 0.1)->Slice(3));
+  auto tolls =
+      std::static_pointer_cast<arrow::Int32Array>(generator.Int32(1005, -5, 5, 0.1)->Slice(3));
+  auto passengers =
+      std::static_pointer_cast<arrow::UInt8Array>(generator.UInt8(1005, 0, 255, 0.1)->Slice(3));
+  std::vector<std::shared_ptr<const arrow::Field>> fields = {
+      arrow::field("fare", arrow::float64()), arrow::field("tips", arrow::float32()),
+      arrow::field("tolls", arrow::int32()), arrow::field("passengers", arrow::uint8())};
+  std::vector<std::shared_ptr<const arrow::Array>> columns = {fare, tips, tolls, passengers};
+
+  // every case lists columns, which make row null, and evaluates expression for valid row
+  struct Case {
+    std::shared_ptr<BooleanExpr> expr;
+    std::vector<std::shared_ptr<arrow::Array>> operands;
+    std::function<bool(int64_t)> expected;
+  };
+  std::vector<Case> cases = {
+      {col("fare")->ADD(col("tips"))->GT(lit(2)->MUL(col("tolls"))),
+       {fare, tips, tolls},
+       [&](int64_t i) {
+         return fare->Value(i) + static_cast<double>(tips->Value(i)) > 2 * tolls->Value(i);
+       }},
+      {col("tolls")->GT(col("passengers")),
+       {tolls, passengers},
+       [&](int64_t i) { return tolls->Value(i) > passengers->Value(i); }},
+      // uint8 product wraps
+      {col("passengers")->MUL(col("passengers"))->LT(lit(100)),
+       {passengers},
+       [&](int64_t i) {
+         return static_cast<uint8_t>(passengers->Value(i) * passengers->Value(i)) < 100;
+       }},
+      {col("tolls")->DIV(lit(2))->GE(lit(1)),
+       {tolls},
+       [&](int64_t i) { return tolls->Value(i) / 2.0 >= 1; }},
+      {col("fare")->CAST(arrow::int32())->EQ(col("tolls")),
+       {fare, tolls},
+       [&](int64_t i) { return static_cast<int32_t>(fare->Value(i)) == tolls->Value(i); }},
+      {col("tolls")->GT(lit(1.5)), {tolls}, [&](int64_t i) { return tolls->Value(i) > 1.5; }},
+      {lit(3)->SUB(col("tolls"))->LT(col("fare"))->OR(col("tips")->LT(lit(-9.0))),
+       {fare, tips, tolls},
+       [&](int64_t i) { return 3 - tolls->Value(i) < fare->Value(i) || tips->Value(i) < -9; }},
+  };
+
+  auto length = fare->length();
+  for (bool skip_zero_words : {false, true}) {
+    for (auto &test_case : cases) {
+      auto kernel = kernels::FilterKernel::create_cpu(fields, test_case.expr, skip_zero_words);
+      kernel->compile();
+      auto bitmap = arrow::AllocateEmptyBitmap(length).ValueOrDie();
+      std::memset(bitmap->mutable_data(), 255, bitmap->size());
+      kernel->execute(columns, bitmap->mutable_data(), 0);
+      kernel->execute_remaining(columns, bitmap->mutable_data() + length / 8, length / 8 * 8, 0);
+      for (int64_t i = 0; i < length; i++) {
+        bool valid = std::all_of(test_case.operands.begin(), test_case.operands.end(),
+                                 [&](auto &operand) { return operand->IsValid(i); });
+        ASSERT_EQ(valid && test_case.expected(i), (bitmap->data()[i / 8] >> (7 - i % 8)) & 1)
+            << "at position " << i;
+      }
+    }
+  }
+}
+
+TEST(ArithmeticFilterKernelTest, testTypePromotion) {
+  std::vector<std::shared_ptr<const arrow::Field>> fields = {
+      arrow::field("i8", arrow::int8()),     arrow::field("u8", arrow::uint8()),
+      arrow::field("i16", arrow::int16()),   arrow::field("i32", arrow::int32()),
+      arrow::field("u32", arrow::uint32()),  arrow::field("i64", arrow::int64()),
+      arrow::field("u64", arrow::uint64()),  arrow::field("f32", arrow::float32()),
+      arrow::field("f64", arrow::float64()), arrow::field("s", arrow::utf8())};
+  auto check = [&](const std::shared_ptr<ValueExpr> &lhs, const std::shared_ptr<ValueExpr> &rhs,
+                   const std::shared_ptr<arrow::DataType> &expected) {
+    auto type = kernels::operands_type(*lhs, *rhs, fields);
+    ASSERT_TRUE(type->Equals(expected)) << type->ToString() << " != " << expected->ToString();
+  };
+  check(col("i8"), col("i16"), arrow::int16());
+  check(col("u8"), col("i8"), arrow::int16());
+  check(col("i32"), col("u32"), arrow::int64());
+  check(col("i64"), col("u64"), arrow::int64());
+  check(col("u8"), col("u32"), arrow::uint32());
+  check(col("f32"), col("f32"), arrow::float32());
+  check(col("f32"), col("i8"), arrow::float64());
+  check(col("u8"), lit(1000), arrow::uint8());
+  check(col("i16"), lit(2.5), arrow::float64());
+  check(col("f32"), lit(2.5), arrow::float32());
+  check(lit(1), lit(2), arrow::int32());
+  check(col("i8")->DIV(col("i8")), col("f32"), arrow::float64());
+  check(col("i8")->CAST(arrow::int64()), col("u32"), arrow::int64());
+  ASSERT_THROW(kernels::operands_type(*col("s"), *lit(1), fields), NotImplementedException);
+  ASSERT_THROW(kernels::operands_type(*col("i8"), *lit(std::string("1")), fields),
+               NotImplementedException);
+}
+
+// filters all rows of columns by expression and returns filter bitmap
+static std::shared_ptr<arrow::Buffer>
+filter_bitmap(const std::vector<std::shared_ptr<const arrow::Field>> &fields,
+              const std::vector<std::shared_ptr<const arrow::Array>> &columns,
+              const std::shared_ptr<BooleanExpr> &expr, bool skip_zero_words) {
+  auto kernel = kernels::FilterKernel::create_cpu(fields, expr, skip_zero_words);
+  kernel->compile();
+  auto length = columns.front()->length();
+  auto bitmap = arrow::AllocateEmptyBitmap(length).ValueOrDie();
+  std::memset(bitmap->mutable_data(), 255, bitmap->size());
+  kernel->execute(columns, bitmap->mutable_data(), 0);
+  kernel->execute_remaining(columns, bitmap->mutable_data() + length / 8, length / 8 * 8, 0);
+  return bitmap;
+}
+
+TEST(InListFilterKernelTest, testMatchesComparisons) {
+  arrow::random::RandomArrayGenerator generator(42);
+  // floating values are multiples of 0.5, so some of them are equal to values of lists
+  arrow::DoubleBuilder builder;
+  for (int i = 0; i < 1005; i++) {
+    ASSERT_OK(i % 11 == 0 ? builder.AppendNull() : builder.Append((i % 9) * 0.5));
+  }
+  std::shared_ptr<arrow::Array> halves;
+  ASSERT_OK(builder.Finish(&halves));
+  // slice makes values and validity bitmaps start from the middle
+  std::vector<std::shared_ptr<const arrow::Array>> columns = {
+      generator.Int32(1005, -100, 1000, 0.1)->Slice(3),
+      generator.UInt8(1005, 0, 255, 0.1)->Slice(3),
+      generator.Int64(1005, -100000, 100000, 0.1)->Slice(3), halves->Slice(3)};
+  std::vector<std::shared_ptr<const arrow::Field>> fields = {
+      arrow::field("i32", arrow::int32()), arrow::field("u8", arrow::uint8()),
+      arrow::field("i64", arrow::int64()), arrow::field("f64", arrow::float64())};
+
+  // short list is compared with every value, dense lists use bitset and sparse ones - binary search
+  std::vector<std::pair<std::string, std::vector<std::variant<int, double, std::string, bool>>>>
+      lists = {{"i32", {5, -7, 999}},
+               {"i32", {}},
+               {"u8", {0, 255, 256, 300, -1}},
+               {"f64", {1, 2.5, std::nan(""), 7}},
+               {"f64", {0.5, 1.5, 2, 3, 3.5, 4, 100, -1, 2.5, 0.25, std::nan("")}}};
+  std::mt19937 random(42);
+  for (auto &[name, bound] : std::vector<std::pair<std::string, int>>{
+           {"i32", 600}, {"i32", 1000000}, {"u8", 255}, {"i64", 100000}, {"i64", 1 << 30}}) {
+    std::vector<std::variant<int, double, std::string, bool>> values;
+    for (int i = 0; i < 50; i++) {
+      values.emplace_back(static_cast<int>(random() % bound) - (name == "u8" ? 0 : bound / 2));
+    }
+    lists.emplace_back(name, values);
+  }
+  // fractional literals of integer column are compared as float64
+  lists.push_back({"i32", {1, 2.5, 3.0, 4, 5, 6, 7, 8, 9, 10}});
+
+  for (bool skip_zero_words : {false, true}) {
+    for (auto &[name, values] : lists) {
+      std::shared_ptr<BooleanExpr> expected = BooleanConst::create(false);
+      for (auto &value : values) {
+        expected = expected->OR(col(name)->EQ(lit(value)));
+      }
+      auto actual = filter_bitmap(fields, columns, col(name)->IN(values), skip_zero_words);
+      auto expected_bitmap = filter_bitmap(fields, columns, expected, skip_zero_words);
+      auto length = columns.front()->length();
+      for (int64_t i = 0; i < length; i++) {
+        ASSERT_EQ((expected_bitmap->data()[i / 8] >> (7 - i % 8)) & 1,
+                  (actual->data()[i / 8] >> (7 - i % 8)) & 1)
+            << "at position " << i << " of " << values.size() << " values of " << name;
+      }
+    }
+  }
+}
+
+TEST(InListFilterKernelTest, testBetweenMatchesComparisons) {
+  arrow::random::RandomArrayGenerator generator(42);
+  std::vector<std::shared_ptr<const arrow::Array>> columns = {
+      generator.Int32(1005, -100, 1000, 0.1)->Slice(3),
+      generator.UInt8(1005, 0, 255, 0.1)->Slice(3),
+      generator.Float64(1005, -100, 1000, 0.1)->Slice(3)};
+  std::vector<std::shared_ptr<const arrow::Field>> fields = {
+      arrow::field("i32", arrow::int32()), arrow::field("u8", arrow::uint8()),
+      arrow::field("f64", arrow::float64())};
+  // bounds are converted like literals of comparisons, so -5 is 251 for uint8 column
+  std::vector<std::tuple<std::string, std::variant<int, double, std::string, bool>,
+                         std::variant<int, double, std::string, bool>>>
+      ranges = {{"i32", -50, 500},  {"i32", 500, -50}, {"i32", 7, 7},     {"i32", 2.5, 300},
+                {"u8", 10, 200},    {"u8", -5, 5},     {"u8", 0, 255},    {"f64", -0.5, 10},
+                {"f64", 10.5, 3.0}, {"f64", 0, 1000}};
+  for (bool skip_zero_words : {false, true}) {
+    for (auto &[name, lower, upper] : ranges) {
+      auto expected = col(name)->GE(lit(lower))->AND(col(name)->LE(lit(upper)));
+      auto actual =
+          filter_bitmap(fields, columns, col(name)->BETWEEN(lower, upper), skip_zero_words);
+      auto expected_bitmap = filter_bitmap(fields, columns, expected, skip_zero_words);
+      auto length = columns.front()->length();
+      for (int64_t i = 0; i < length; i++) {
+        ASSERT_EQ((expected_bitmap->data()[i / 8] >> (7 - i % 8)) & 1,
+                  (actual->data()[i / 8] >> (7 - i % 8)) & 1)
+            << "at position " << i << " of " << name;
+      }
+    }
+  }
+}
@@ -0,0 +1,126 @@
+#include "pefa/kernels/kernel_cache.h"
+#include "pefa/utils/bloom_filter.h"
+
+#include <arrow/api.h>
+#include <arrow/testing/gtest_util.h>
+#include <cstring>
+#include <gtest/gtest.h>
+
+using namespace pefa;
+using namespace pefa::query_compiler;
+
+class KernelCacheTest : public ::testing::Test {
+protected:
+  std::shared_ptr<kernels::KernelCache> m_cache;
+
+  void SetUp() override {
+    m_cache = std::make_shared<kernels::KernelCache>(2);
+  }
+
+  static std::shared_ptr<arrow::Field> field(const std::string &name,
+                                             std::shared_ptr<arrow::DataType> type) {
+    return std::make_shared<arrow::Field>(name, std::move(type));
+  }
+};
+
+TEST_F(KernelCacheTest, testRepeatedExpressionIsHit) {
+  auto a = field("a", arrow::int32());
+  auto first = m_cache->get_filter_kernel(a, col("a")->GE(lit(10)));
+  auto second = m_cache->get_filter_kernel(a, col("a")->GE(lit(10)));
+  ASSERT_EQ(first, second);
+  ASSERT_EQ(m_cache->hits(), 1);
+  ASSERT_EQ(m_cache->misses(), 1);
+}
+
+TEST_F(KernelCacheTest, testColumnNameDoesNotAffectKey) {
+  auto first = m_cache->get_filter_kernel(field("a", arrow::int32()), col("a")->GE(lit(10)));
+  auto second = m_cache->get_filter_kernel(field("b", arrow::int32()), col("b")->GE(lit(10)));
+  ASSERT_EQ(first, second);
+  ASSERT_EQ(m_cache->hits(), 1);
+}
+
+TEST_F(KernelCacheTest, testDifferentTypesAndLiteralsAreMisses) {
+  auto a = field("a", arrow::int32());
+  auto first = m_cache->get_filter_kernel(a, col("a")->GE(lit(10)));
+  auto second = m_cache->get_filter_kernel(a, col("a")->GE(lit(11)));
+  auto third = m_cache->get_filter_kernel(field("a", arrow::int64()), col("a")->GE(lit(10)));
+  ASSERT_NE(first, second);
+  ASSERT_NE(first, third);
+  ASSERT_EQ(m_cache->hits(), 0);
+  ASSERT_EQ(m_cache->misses(), 3);
+}
+
+TEST_F(KernelCacheTest, testLeastRecentlyUsedIsEvicted) {
+  auto a = field("a", arrow::int16());
+  auto first = m_cache->get_filter_kernel(a, col("a")->EQ(lit(1)));
+  auto second = m_cache->get_filter_kernel(a, col("a")->EQ(lit(2)));
+  // touch first kernel, so second one becomes least recently used
+  ASSERT_EQ(m_cache->get_filter_kernel(a, col("a")->EQ(lit(1))), first);
+  auto third = m_cache->get_filter_kernel(a, col("a")->EQ(lit(3)));
+  ASSERT_EQ(m_cache->size(), 2);
+
+  ASSERT_EQ(m_cache->get_filter_kernel(a, col("a")->EQ(lit(1))), first);
+  ASSERT_NE(m_cache->get_filter_kernel(a, col("a")->EQ(lit(2))), second);
+  ASSERT_EQ(m_cache->misses(), 4);
+}
+
+TEST_F(KernelCacheTest, testEvictedKernelIsStillUsable) {
+  auto a = field("a", arrow::int32());
+  auto kernel = m_cache->get_filter_kernel(a, col("a")->LT(lit(3)));
+  m_cache->set_capacity(0);
+  ASSERT_EQ(m_cache->size(), 0);
+
+  auto array = arrow::ArrayFromJSON(arrow::int32(), "[1, 5, 2, 7, 0, 3, 4, 1]");
+  auto bitmap = arrow::AllocateEmptyBitmap(array->length()).ValueOrDie();
+  std::memset(bitmap->mutable_data(), 255, bitmap->size());
+  kernel->execute(array, bitmap->mutable_data(), 0);
+  ASSERT_EQ(bitmap->data()[0], 0b10101001);
+}
+
+TEST_F(KernelCacheTest, testBloomFiltersOfOneColumnShareKernel) {
+  auto a = field("a", arrow::int32());
+  // filters of different sizes hold different keys
+  std::vector<std::shared_ptr<BloomFilterExpr>> exprs;
+  for (int64_t num_keys : {100, 10000}) {
+    auto filter = std::make_shared<utils::BloomFilter>();
+    filter->reset(num_keys);
+    for (int64_t key = 0; key < num_keys; key++) {
+      filter->insert(key * (num_keys == 100 ? 2 : 3));
+    }
+    exprs.push_back(BloomFilterExpr::create(col("a"), filter));
+  }
+  auto kernel = m_cache->get_filter_kernel(a, exprs[0]);
+  ASSERT_EQ(m_cache->get_filter_kernel(a, exprs[1]), kernel);
+  ASSERT_EQ(m_cache->misses(), 1);
+
+  auto array = arrow::ArrayFromJSON(arrow::int32(), "[0, 2, 3, 4, 6, 9, 12, 15]");
+  for (auto &expr : exprs) {
+    auto bitmap = arrow::AllocateEmptyBitmap(array->length()).ValueOrDie();
+    std::memset(bitmap->mutable_data(), 255, bitmap->size());
+    kernel->execute({array}, bitmap->mutable_data(), 0, kernels::FilterInputs(*expr));
+    auto &values = static_cast<const arrow::Int32Array &>(*array);
+    for (int64_t i = 0; i < array->length(); i++) {
+      ASSERT_EQ(expr->filter->may_contain(values.Value(i)), (bitmap->data()[0] >> (7 - i)) & 1)
+          << "at position " << i;
+    }
+  }
+}
+
+TEST_F(KernelCacheTest, testCachedKernelDoesNotKeepDictionaries) {
+  auto type = arrow::dictionary(arrow::int8(), arrow::utf8());
+  auto a = field("a", type);
+  auto kernel = m_cache->get_filter_kernel(a, col("a")->EQ(lit(std::string("y"))));
+  std::weak_ptr<arrow::ArrayData> dictionary_data;
+  {
+    auto dictionary = arrow::ArrayFromJSON(arrow::utf8(), R"(["x", "y"])");
+    auto indices = arrow::ArrayFromJSON(arrow::int8(), "[1, 0, 0, 1, 1, 0, 1, 0]");
+    auto array = std::make_shared<arrow::DictionaryArray>(type, indices, dictionary);
+    dictionary_data = dictionary->data();
+    auto bitmap = arrow::AllocateEmptyBitmap(array->length()).ValueOrDie();
+    std::memset(bitmap->mutable_data(), 255, bitmap->size());
+    kernel->execute(array, bitmap->mutable_data(), 0);
+    ASSERT_EQ(bitmap->data()[0], 0b10011010);
+  }
+  ASSERT_TRUE(dictionary_data.expired());
+  ASSERT_EQ(m_cache->get_filter_kernel(a, col("a")->EQ(lit(std::string("y")))), kernel);
+}